@@ -0,0 +1,211 @@
+# Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+#
+# This file is part of CP Editor.
+#
+# CP Editor is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# I will not be responsible if CP Editor behaves in unexpected way and
+# causes your ratings to go down and or lose any important contest.
+#
+# Believe Software is "Software" and it isn't immune to bugs.
+
+# The fork server used by Core::PythonForkServer.
+#
+# It imports the commonly used modules once, then forks itself for each execution, so the programs don't pay for the
+# startup of the interpreter. The requests are read from stdin and the replies are written to stdout, one JSON object
+# per line:
+#
+#   {"id": 1, "script": ..., "args": [...], "cwd": ..., "stdin": ..., "stdout": ..., "stderr": ..., "limit": ...,
+#    "cpuLimit": ...}
+#       run a program, the replies are {"id": 1, "pid": ...} and then
+#       {"id": 1, "exitCode": ..., "crashed": ..., "cpuTime": ...}, or {"id": 1, "error": ...} if it fails to fork.
+#       "limit" is the file size limit in bytes, "cpuLimit" is the CPU time limit in seconds, 0 for no limit.
+#       "cpuTime" is the CPU time used by the program in milliseconds.
+#   {"kill": 1}
+#       kill the program started by the request with id 1, if it's still running
+#
+# The server exits when its stdin is closed, and all running programs are killed.
+
+import json
+import os
+import selectors
+import signal
+import sys
+
+# These are imported only to warm up the interpreter
+import array  # noqa: F401
+import bisect  # noqa: F401
+import collections  # noqa: F401
+import copy  # noqa: F401
+import decimal  # noqa: F401
+import fractions  # noqa: F401
+import functools  # noqa: F401
+import heapq  # noqa: F401
+import io  # noqa: F401
+import itertools  # noqa: F401
+import math  # noqa: F401
+import operator  # noqa: F401
+import random
+import re  # noqa: F401
+import runpy
+import string  # noqa: F401
+import traceback
+
+try:
+    import resource
+except ImportError:
+    resource = None
+
+children = {}  # pid -> request id
+running = {}  # request id -> pid
+wakeup_r, wakeup_w = os.pipe()
+
+
+def reply(obj):
+    os.write(1, (json.dumps(obj) + "\n").encode())
+
+
+def execute(request):
+    # in the child process, never returns
+    code = 0
+    try:
+        signal.set_wakeup_fd(-1)
+        signal.signal(signal.SIGCHLD, signal.SIG_DFL)
+        os.close(wakeup_r)
+        os.close(wakeup_w)
+
+        for fd, key, flags in ((0, "stdin", os.O_RDONLY),
+                               (1, "stdout", os.O_WRONLY | os.O_CREAT | os.O_TRUNC),
+                               (2, "stderr", os.O_WRONLY | os.O_CREAT | os.O_TRUNC)):
+            f = os.open(request[key], flags, 0o600)
+            os.dup2(f, fd)
+            os.close(f)
+
+        if resource is not None and request.get("limit", 0) > 0:
+            limit = int(request["limit"])
+            resource.setrlimit(resource.RLIMIT_FSIZE, (limit, limit))
+
+        if resource is not None and request.get("cpuLimit", 0) > 0:
+            # the soft limit sends SIGXCPU, the hard limit one second later sends SIGKILL
+            limit = int(request["cpuLimit"])
+            resource.setrlimit(resource.RLIMIT_CPU, (limit, limit + 1))
+
+        os.chdir(request["cwd"])
+        sys.stdin = open(0, "r", closefd=False)
+        sys.stdout = open(1, "w", closefd=False)
+        sys.stderr = open(2, "w", closefd=False)
+        script = request["script"]
+        sys.argv = [script] + request["args"]
+        sys.path[0] = os.path.dirname(script)
+
+        # random is imported before forking, so it's seeded again like in a new interpreter,
+        # otherwise all children start with the same state
+        random.seed()
+    except BaseException:
+        os._exit(127)
+
+    try:
+        runpy.run_path(script, run_name="__main__")
+    except SystemExit as e:
+        if e.code is None:
+            code = 0
+        elif isinstance(e.code, int):
+            code = e.code
+        else:
+            print(e.code, file=sys.stderr)
+            code = 1
+    except BaseException:
+        traceback.print_exc()
+        code = 1
+
+    try:
+        sys.stdout.flush()
+        sys.stderr.flush()
+    except BaseException:
+        code = code or 1
+
+    os._exit(code & 0xff)
+
+
+def start(request):
+    if "kill" in request:
+        pid = running.get(request["kill"])
+        if pid is not None:
+            os.kill(pid, signal.SIGKILL)
+        return
+
+    try:
+        pid = os.fork()
+    except OSError as e:
+        reply({"id": request["id"], "error": str(e)})
+        return
+
+    if pid == 0:
+        execute(request)
+
+    children[pid] = request["id"]
+    running[request["id"]] = pid
+    reply({"id": request["id"], "pid": pid})
+
+
+def reap():
+    while children:
+        try:
+            pid, status, usage = os.wait4(-1, os.WNOHANG)
+        except ChildProcessError:
+            return
+        if pid == 0:
+            return
+        id = children.pop(pid, None)
+        if id is None:
+            continue
+        del running[id]
+        cpu_time = int((usage.ru_utime + usage.ru_stime) * 1000)
+        if os.WIFSIGNALED(status):
+            reply({"id": id, "exitCode": os.WTERMSIG(status), "crashed": True, "cpuTime": cpu_time})
+        else:
+            reply({"id": id, "exitCode": os.WEXITSTATUS(status), "crashed": False, "cpuTime": cpu_time})
+
+
+def main():
+    os.set_blocking(wakeup_r, False)
+    os.set_blocking(wakeup_w, False)
+    signal.set_wakeup_fd(wakeup_w)
+    signal.signal(signal.SIGCHLD, lambda signum, frame: None)
+
+    selector = selectors.DefaultSelector()
+    selector.register(0, selectors.EVENT_READ, "request")
+    selector.register(wakeup_r, selectors.EVENT_READ, "child")
+
+    buffer = b""
+    while True:
+        for key, _ in selector.select():
+            if key.data == "child":
+                try:
+                    while os.read(wakeup_r, 4096):
+                        pass
+                except BlockingIOError:
+                    pass
+                reap()
+            else:
+                data = os.read(0, 65536)
+                if not data:
+                    return
+                lines = (buffer + data).split(b"\n")
+                buffer = lines.pop()
+                for line in lines:
+                    if line.strip():
+                        start(json.loads(line))
+
+
+try:
+    main()
+finally:
+    for pid in children:
+        try:
+            os.kill(pid, signal.SIGKILL)
+        except OSError:
+            pass
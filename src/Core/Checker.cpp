@@ -22,12 +22,107 @@
 #include "Core/Runner.hpp"
 #include "Util/FileUtil.hpp"
 #include "generated/SettingsHelper.hpp"
+#include <QCryptographicHash>
 #include <QFile>
+#include <QFileInfo>
 #include <QTemporaryDir>
+#include <algorithm>
 
 namespace Core
 {
 
+namespace
+{
+// a line of a UTF-8 content, without the line break
+struct Line
+{
+    const char *begin;
+    const char *end;
+};
+
+// reads the lines of a UTF-8 content one by one without copying it, \r\n, \r and \n are all line breaks
+class LineReader
+{
+  public:
+    explicit LineReader(const QByteArray &content) : pos(content.constData()), end(pos + content.size())
+    {
+    }
+
+    // whether all lines are read, a content ending with a line break has an empty last line
+    bool atEnd() const
+    {
+        return finished;
+    }
+
+    Line next()
+    {
+        const char *lineEnd = std::find_if(pos, end, [](char c) { return c == '\n' || c == '\r'; });
+        Line line{pos, lineEnd};
+        if (lineEnd == end)
+            finished = true;
+        else if (*lineEnd == '\r' && lineEnd + 1 != end && lineEnd[1] == '\n')
+            pos = lineEnd + 2;
+        else
+            pos = lineEnd + 1;
+        return line;
+    }
+
+  private:
+    const char *pos;
+    const char *end;
+    bool finished = false;
+};
+
+bool isAscii(Line line)
+{
+    return std::all_of(line.begin, line.end, [](char c) { return uchar(c) < 0x80; });
+}
+
+bool isAsciiSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+QString decode(Line line)
+{
+    return QString::fromUtf8(line.begin, int(line.end - line.begin));
+}
+
+QString chopTrailingSpaces(QString line)
+{
+    while (!line.isEmpty() && line.back().isSpace())
+        line.chop(1);
+    return line;
+}
+
+// whether the line contains only spaces
+bool isBlank(Line line)
+{
+    if (isAscii(line))
+        return std::all_of(line.begin, line.end, isAsciiSpace);
+    return decode(line).trimmed().isEmpty();
+}
+
+// compare the lines as QStrings, but only decode them when they contain non-ASCII characters and differ in bytes
+bool sameLine(Line a, Line b, bool ignoreTrailingSpaces)
+{
+    if (ignoreTrailingSpaces)
+    {
+        while (a.end != a.begin && isAsciiSpace(a.end[-1]))
+            --a.end;
+        while (b.end != b.begin && isAsciiSpace(b.end[-1]))
+            --b.end;
+    }
+    if (a.end - a.begin == b.end - b.begin && std::equal(a.begin, a.end, b.begin))
+        return true;
+    if (isAscii(a) && isAscii(b))
+        return false;
+    if (ignoreTrailingSpaces)
+        return chopTrailingSpaces(decode(a)) == chopTrailingSpaces(decode(b));
+    return decode(a) == decode(b);
+}
+} // namespace
+
 Checker::Checker(CheckerType type, MessageLogger *logger, QObject *parent)
     : QObject(parent), checkerType(type), log(logger), compiled(false)
 {
@@ -115,7 +210,7 @@ void Checker::prepare()
     compiler->start(checkerTmpPath, "", SettingsHelper::getCppCompileCommand(), "C++");
 }
 
-void Checker::reqeustCheck(int index, const QString &input, const QString &output, const QString &expected)
+void Checker::reqeustCheck(int index, const TestData &input, const QString &output, const TestData &expected)
 {
     recompileIfChanged();
     LOG_INFO(BOOL_INFO_OF(compiled));
@@ -140,6 +235,27 @@ void Checker::clearTasks()
     runners.clear();
 }
 
+QString Checker::identity() const
+{
+    if (checkerOriginalPath.isEmpty())
+        return QString::number(checkerType);
+
+    // it's called for every test case, so the checker is read again only if it may be changed
+    const QFileInfo info(checkerOriginalPath);
+    if (!cachedIdentity.isEmpty() && info.lastModified() == identityModified && info.size() == identitySize)
+        return cachedIdentity;
+
+    const auto code = Util::readFile(checkerOriginalPath);
+    identityModified = info.lastModified();
+    identitySize = info.size();
+    cachedIdentity =
+        QString("%1:%2:%3")
+            .arg(checkerType)
+            .arg(checkerOriginalPath)
+            .arg(QString::fromLatin1(QCryptographicHash::hash(code.toUtf8(), QCryptographicHash::Sha1).toHex()));
+    return cachedIdentity;
+}
+
 void Checker::onCompilationFinished()
 {
     if (recompileIfChanged())
@@ -170,10 +286,12 @@ void Checker::onCompilationKilled()
 }
 
 void Checker::onRunFinished(int index, const QString & /*unused*/, const QString &err, int exitCode, int /*unused*/,
-                            bool tle)
+                            qint64 /*unused*/, bool tle, bool ile)
 {
     if (tle)
         log->warn(head(index), tr("Time Limit Exceeded"));
+    else if (ile)
+        log->warn(head(index), tr("Idleness Limit Exceeded"));
 
     switch (TResult(exitCode))
     {
@@ -230,41 +348,27 @@ void Checker::onRunKilled(int index)
     log->error(head(index), tr("The checker is killed"));
 }
 
-bool Checker::checkIgnoreTrailingSpaces(const QString &output, const QString &expected)
+bool Checker::checkIgnoreTrailingSpaces(const QByteArray &output, const QByteArray &expected)
 {
-    // first, replace \r\n and \r by \n
-    auto out = output;
-    out.replace("\r\n", "\n").replace("\r", "\n");
-    auto ans = expected;
-    ans.replace("\r\n", "\n").replace("\r", "\n");
-
-    // split output and answer into lines
-    auto outputLines = out.split('\n');
-    auto answerLines = ans.split('\n');
-
-    // remove trailing empty lines
-    while (!outputLines.isEmpty() && outputLines.back().trimmed().isEmpty())
-        outputLines.pop_back();
-    while (!answerLines.isEmpty() && answerLines.back().trimmed().isEmpty())
-        answerLines.pop_back();
-
-    // if they are considered the same, they must have the same number of lines after removing trailing empty lines
-    if (outputLines.size() != answerLines.size())
-        return false;
+    LineReader outputReader(output);
+    LineReader answerReader(expected);
 
-    for (int i = 0; i < outputLines.size(); ++i)
+    // the current lines should be exactly the same after removing trailing spaces
+    while (!outputReader.atEnd() && !answerReader.atEnd())
     {
-        auto outputLine = outputLines[i];
-        auto answerLine = answerLines[i];
-
-        // remove trailing spaces at the end of the current line
-        while (!outputLine.isEmpty() && outputLine.back().isSpace())
-            outputLine.chop(1);
-        while (!answerLine.isEmpty() && answerLine.back().isSpace())
-            answerLine.chop(1);
+        if (!sameLine(outputReader.next(), answerReader.next(), true))
+            return false;
+    }
 
-        // if they are considered the same, the current line should be exactly the same after removing trailing spaces
-        if (outputLine != answerLine)
+    // the remaining lines of the longer one are trailing empty lines if they are considered the same
+    while (!outputReader.atEnd())
+    {
+        if (!isBlank(outputReader.next()))
+            return false;
+    }
+    while (!answerReader.atEnd())
+    {
+        if (!isBlank(answerReader.next()))
             return false;
     }
 
@@ -272,15 +376,20 @@ bool Checker::checkIgnoreTrailingSpaces(const QString &output, const QString &ex
     return true;
 }
 
-bool Checker::checkStrict(const QString &output, const QString &expected)
+bool Checker::checkStrict(const QByteArray &output, const QByteArray &expected)
 {
-    auto a = output;
-    auto b = expected;
-    // replace \r\n and \r with \n, then directly compare them
-    return a.replace("\r\n", "\n").replace("\r", "\n") == b.replace("\r\n", "\n").replace("\r", "\n");
+    // \r\n, \r and \n are all line breaks, other than that the lines are directly compared
+    LineReader outputReader(output);
+    LineReader answerReader(expected);
+    while (!outputReader.atEnd() && !answerReader.atEnd())
+    {
+        if (!sameLine(outputReader.next(), answerReader.next(), false))
+            return false;
+    }
+    return outputReader.atEnd() && answerReader.atEnd();
 }
 
-void Checker::check(int index, const QString &input, const QString &output, const QString &expected)
+void Checker::check(int index, const TestData &input, const QString &output, const TestData &expected)
 {
     LOG_INFO(INFO_OF(index));
     switch (checkerType)
@@ -288,19 +397,27 @@ void Checker::check(int index, const QString &input, const QString &output, cons
     // check directly if it's a built-in checker
     case IgnoreTrailingSpaces:
         emit checkFinished(index,
-                           checkIgnoreTrailingSpaces(output, expected) ? Widgets::TestCase::AC : Widgets::TestCase::WA);
+                           checkIgnoreTrailingSpaces(output.toUtf8(), expected.bytes()) ? Widgets::TestCase::AC
+                                                                                        : Widgets::TestCase::WA);
         break;
     case Strict:
-        emit checkFinished(index, checkStrict(output, expected) ? Widgets::TestCase::AC : Widgets::TestCase::WA);
+        emit checkFinished(index,
+                           checkStrict(output.toUtf8(), expected.bytes()) ? Widgets::TestCase::AC
+                                                                          : Widgets::TestCase::WA);
         break;
     default:
         // if it's a testlib checker, save the input, output and expected files first
+        // the file-backed input and expected are already in files, so the checker reads them directly
         auto inputPath = tmpDir->filePath(QString::number(index) + ".in");
         auto outputPath = tmpDir->filePath(QString::number(index) + ".out");
         auto expectedPath = tmpDir->filePath(QString::number(index) + ".ans");
-        if (Util::saveFile(inputPath, input, tr("Checker"), false, log) &&
+        if (input.isFileBacked())
+            inputPath = input.filePath();
+        if (expected.isFileBacked())
+            expectedPath = expected.filePath();
+        if ((input.isFileBacked() || Util::saveFile(inputPath, input.text(), tr("Checker"), false, log)) &&
             Util::saveFile(outputPath, output, tr("Checker"), false, log) &&
-            Util::saveFile(expectedPath, expected, tr("Checker"), false, log))
+            (expected.isFileBacked() || Util::saveFile(expectedPath, expected.text(), tr("Checker"), false, log)))
         {
             // if files are successfully saved, run the checker
             auto *tmp = new Runner(index);
@@ -310,7 +427,7 @@ void Checker::check(int index, const QString &input, const QString &output, cons
             connect(tmp, &Runner::runOutputLimitExceeded, this, &Checker::onRunOutputLimitExceeded);
             connect(tmp, &Runner::runKilled, this, &Checker::onRunKilled);
             tmp->run(checkerTmpPath, "", "C++", "",
-                     "\"" + inputPath + "\" \"" + outputPath + "\" \"" + expectedPath + "\"", "",
+                     "\"" + inputPath + "\" \"" + outputPath + "\" \"" + expectedPath + "\"", TestData(),
                      SettingsHelper::getDefaultTimeLimit());
         }
         break;
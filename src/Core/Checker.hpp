@@ -28,7 +28,9 @@
 #ifndef CHECKER_HPP
 #define CHECKER_HPP
 
+#include "Core/TestData.hpp"
 #include "Widgets/TestCase.hpp"
+#include <QDateTime>
 
 class QTemporaryDir;
 class MessageLogger;
@@ -99,13 +101,21 @@ class Checker : public QObject
      * @note This function doesn't return anything, it request the checker to check,
      *       and the checker emits a signal when it's done
      */
-    void reqeustCheck(int index, const QString &input, const QString &output, const QString &expected);
+    void reqeustCheck(int index, const TestData &input, const QString &output, const TestData &expected);
 
     /**
      * @brief clear the pending tasks and kill executing tasks
      */
     void clearTasks();
 
+    /**
+     * @brief get a string which identifies the checker and the content of it
+     * @note two checkers with the same identity give the same verdicts
+     * @note the checker is hashed only when its size or last modified time is changed, so it's cheap to call this for
+     *       every test case
+     */
+    QString identity() const;
+
   signals:
     /**
      * @brief return the check result
@@ -125,7 +135,7 @@ class Checker : public QObject
 
     void onCompilationKilled();
 
-    void onRunFinished(int index, const QString &, const QString &err, int exitCode, int, bool tle);
+    void onRunFinished(int index, const QString &, const QString &err, int exitCode, int, qint64, bool tle, bool ile);
 
     void onFailedToStartRun(int index, const QString &error);
 
@@ -136,19 +146,21 @@ class Checker : public QObject
   private:
     /**
      * @brief check the output against the expected output in IgnoreTrailingSpaces mode
-     * @param output the output to check
-     * @param expected the expected output to check the output against
+     * @param output the output to check, encoded in UTF-8
+     * @param expected the expected output to check the output against, encoded in UTF-8
      * @return whether this output is accepted or not
+     * @note the lines are compared one by one, so a mapped expected output is never decoded as a whole
      */
-    static bool checkIgnoreTrailingSpaces(const QString &output, const QString &expected);
+    static bool checkIgnoreTrailingSpaces(const QByteArray &output, const QByteArray &expected);
 
     /**
      * @brief check the output against the expected output in Strict mode
-     * @param output the output to check
-     * @param expected the expected output to check the output against
+     * @param output the output to check, encoded in UTF-8
+     * @param expected the expected output to check the output against, encoded in UTF-8
      * @return whether this output is accepted or not
+     * @note the lines are compared one by one, so a mapped expected output is never decoded as a whole
      */
-    static bool checkStrict(const QString &output, const QString &expected);
+    static bool checkStrict(const QByteArray &output, const QByteArray &expected);
 
     /**
      * @brief check a testcase
@@ -157,7 +169,7 @@ class Checker : public QObject
      * @param expected the expected output of the testcase
      * @note this should only be called when the checker is compiled
      */
-    void check(int index, const QString &input, const QString &output, const QString &expected);
+    void check(int index, const TestData &input, const QString &output, const TestData &expected);
 
     /**
      * @param index the index of the testcase
@@ -174,7 +186,9 @@ class Checker : public QObject
     struct Task
     {
         int index;
-        QString input, output, expected;
+        TestData input;
+        QString output;
+        TestData expected;
     };
 
     // copied from testlib.h, see #746 for why not include testlib.h
@@ -202,6 +216,10 @@ class Checker : public QObject
     QVector<Task> pendingTasks;      // the unsolved check requests
     std::atomic<bool> compiled;      // whether the testlib checker is compiled or not
                                      // It should be true for built-in checkers.
+
+    mutable QString cachedIdentity;     // the identity computed last time, see identity()
+    mutable QDateTime identityModified; // the last modified time of the checker when cachedIdentity is computed
+    mutable qint64 identitySize = -1;   // the size of the checker when cachedIdentity is computed
 };
 
 } // namespace Core
@@ -20,9 +20,11 @@
 #include "Settings/SettingsManager.hpp"
 #include "Util/FileUtil.hpp"
 #include "generated/SettingsHelper.hpp"
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
 #include <QTextCodec>
+#include <QTimer>
 
 namespace Core
 {
@@ -39,6 +41,15 @@ Compiler::Compiler()
 
 Compiler::~Compiler()
 {
+    if (archiveProcess != nullptr && archiveProcess->state() != QProcess::NotRunning)
+    {
+        LOG_WARN("Java archive process was running and is being forcefully killed");
+        archiveProcess->disconnect(this);
+        archiveProcess->kill();
+        archiveProcess->waitForFinished();
+        emit compilationKilled();
+    }
+
     if (compileProcess != nullptr)
     {
         if (compileProcess->state() != QProcess::NotRunning)
@@ -53,9 +64,11 @@ Compiler::~Compiler()
 }
 
 void Compiler::start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand,
-                     const QString &lang)
+                     const QString &lang, bool coverage)
 {
     this->lang = lang;
+    this->tmpFilePath = tmpFilePath;
+    this->sourceFilePath = sourceFilePath;
     if (!QFile::exists(tmpFilePath))
     {
         // quit with error if the source file is not found
@@ -65,8 +78,50 @@ void Compiler::start(const QString &tmpFilePath, const QString &sourceFilePath,
 
     if (lang == "Python")
     {
-        emit compilationFinished(""); // we don't actually compile Python
-        return;
+        if (!SettingsHelper::isPythonPrecompile())
+        {
+            emit compilationFinished(""); // we don't actually compile Python
+            return;
+        }
+
+        // the bytecode file is up to date if it's compiled from the same source file by the same interpreter
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(compileCommand.toUtf8());
+        hash.addData(Util::readFile(tmpFilePath).toUtf8());
+        bytecodeHash = QString::fromLatin1(hash.result().toHex());
+        bytecodeHashPath = outputPath(tmpFilePath, sourceFilePath, "Python") + ".sha1";
+
+        if (QFile::exists(outputPath(tmpFilePath, sourceFilePath, "Python")) &&
+            Util::readFile(bytecodeHashPath) == bytecodeHash)
+        {
+            LOG_INFO("The Python bytecode file is up to date");
+            emit compilationFinished("");
+            return;
+        }
+    }
+
+    if (coverage)
+    {
+        if (lang != "C++")
+        {
+            emit compilationFailed(tr("The coverage build is only supported for C++"));
+            return;
+        }
+
+        // the coverage build is up to date if it's compiled from the same source file by the same command
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(compileCommand.toUtf8());
+        hash.addData(Util::readFile(tmpFilePath).toUtf8());
+        coverageHash = QString::fromLatin1(hash.result().toHex());
+        coverageHashPath = coverageOutputPath(tmpFilePath, sourceFilePath) + ".sha1";
+
+        if (QFile::exists(coverageOutputPath(tmpFilePath, sourceFilePath)) &&
+            Util::readFile(coverageHashPath) == coverageHash)
+        {
+            LOG_INFO("The coverage build is up to date");
+            emit compilationFinished("");
+            return;
+        }
     }
 
     // get the compile command
@@ -75,13 +130,30 @@ void Compiler::start(const QString &tmpFilePath, const QString &sourceFilePath,
 
     if (args.isEmpty())
     {
-        emit compilationFailed(tr("%1 is empty").arg(SettingsManager::getPathText(lang + "/Compile Command")));
+        emit compilationFailed(tr("%1 is empty").arg(SettingsManager::getPathText(compileCommandKey(lang))));
         return;
     }
 
     QString program = args.takeFirst();
 
-    if (lang == "C++")
+    if (lang == "C++" && coverage)
+    {
+        // the instrumentation is added at the back, so it's not overridden by the flags in the compile command
+        if (isClang(compileCommand))
+            args << "-fprofile-instr-generate"
+                 << "-fcoverage-mapping";
+        else
+            args << "--coverage";
+        args << QFileInfo(tmpFilePath).canonicalFilePath() << "-o" << coverageOutputPath(tmpFilePath, sourceFilePath);
+        if (QFile::exists(sourceFilePath))
+            args << "-I" << QFileInfo(sourceFilePath).canonicalPath();
+
+        // the data of the old build doesn't match the new one
+        QDir coverageDir = QFileInfo(coverageOutputPath(tmpFilePath, sourceFilePath)).dir();
+        for (const auto &file : coverageDir.entryList({"*.gcda", "*.gcno", "*.profraw", "*.profdata"}, QDir::Files))
+            coverageDir.remove(file);
+    }
+    else if (lang == "C++")
     {
         args << QFileInfo(tmpFilePath).canonicalFilePath() << "-o" << outputPath(tmpFilePath, sourceFilePath, "C++");
         if (QFile::exists(sourceFilePath))
@@ -90,6 +162,18 @@ void Compiler::start(const QString &tmpFilePath, const QString &sourceFilePath,
     else if (lang == "Java")
     {
         args << QFileInfo(tmpFilePath).canonicalFilePath() << "-d" << outputPath(tmpFilePath, sourceFilePath, "Java");
+        // the archive is invalidated by the new classes
+        QFile::remove(javaArchivePath(tmpFilePath, sourceFilePath));
+    }
+    else if (lang == "Python")
+    {
+        args << "-c"
+             << "import py_compile, sys\n"
+                "try:\n"
+                "    py_compile.compile(sys.argv[1], cfile=sys.argv[2], doraise=True)\n"
+                "except py_compile.PyCompileError as e:\n"
+                "    sys.exit(e.msg)"
+             << QFileInfo(tmpFilePath).canonicalFilePath() << outputPath(tmpFilePath, sourceFilePath, "Python");
     }
     else
     {
@@ -99,8 +183,12 @@ void Compiler::start(const QString &tmpFilePath, const QString &sourceFilePath,
 
     LOG_INFO(INFO_OF(lang) << INFO_OF(program) << INFO_OF(args.join(" ")));
 
-    compileProcess->setWorkingDirectory(
-        QFileInfo(QFile::exists(sourceFilePath) ? sourceFilePath : tmpFilePath).canonicalPath());
+    // the notes files of gcov are created in the working directory by old versions of GCC
+    if (coverage)
+        compileProcess->setWorkingDirectory(QFileInfo(coverageOutputPath(tmpFilePath, sourceFilePath)).path());
+    else
+        compileProcess->setWorkingDirectory(
+            QFileInfo(QFile::exists(sourceFilePath) ? sourceFilePath : tmpFilePath).canonicalPath());
 
     compileProcess->start(program, args);
 }
@@ -109,7 +197,12 @@ QString Compiler::outputPath(const QString &tmpFilePath, const QString &sourceFi
                              bool createDirectory)
 {
     if (lang == "Python")
-        return tmpFilePath;
+    {
+        if (!SettingsHelper::isPythonPrecompile())
+            return tmpFilePath;
+        QFileInfo tmpFileInfo(tmpFilePath);
+        return tmpFileInfo.dir().filePath(tmpFileInfo.completeBaseName() + ".pyc");
+    }
 
     QFileInfo fileInfo(sourceFilePath.isEmpty() ? tmpFilePath : sourceFilePath);
     QString res = fileInfo.dir().filePath(SettingsManager::get(lang + "/Output Path")
@@ -133,6 +226,25 @@ QString Compiler::outputPath(const QString &tmpFilePath, const QString &sourceFi
     return res;
 }
 
+QString Compiler::javaArchivePath(const QString &tmpFilePath, const QString &sourceFilePath)
+{
+    return QDir(outputPath(tmpFilePath, sourceFilePath, "Java", false))
+        .filePath(SettingsHelper::getJavaClassName() + ".jsa");
+}
+
+QString Compiler::coverageOutputPath(const QString &tmpFilePath, const QString &sourceFilePath)
+{
+    const QFileInfo output(outputPath(tmpFilePath, sourceFilePath, "C++"));
+    const QDir dir(output.dir().filePath(output.completeBaseName() + "-coverage"));
+    QDir().mkpath(dir.path());
+    return dir.filePath(output.fileName());
+}
+
+bool Compiler::isClang(const QString &compileCommand)
+{
+    return QFileInfo(QProcess::splitCommand(compileCommand).value(0)).fileName().contains("clang");
+}
+
 QString Compiler::outputFilePath(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                                  bool createDirectory)
 {
@@ -157,7 +269,16 @@ void Compiler::onProcessFinished(int exitCode, QProcess::ExitStatus e)
     QString output = codec->toUnicode(compileProcess->readAllStandardError());
     // emit different signals due to different exit codes
     if (exitCode == 0)
-        emit compilationFinished(output);
+    {
+        if (lang == "Python")
+            Util::saveFile(bytecodeHashPath, bytecodeHash, "Python Bytecode Hash", false);
+        if (!coverageHashPath.isEmpty())
+            Util::saveFile(coverageHashPath, coverageHash, "Coverage Build Hash", false);
+        if (lang == "Java" && SettingsHelper::isJavaUseClassDataSharing())
+            createJavaArchive(output); // compilationFinished is emitted after the archive is created
+        else
+            emit compilationFinished(output);
+    }
     else
         emit compilationErrorOccurred(output);
 }
@@ -169,8 +290,60 @@ void Compiler::onProcessErrorOccurred(QProcess::ProcessError error)
     {
         emit compilationFailed(
             tr("Failed to start the compiler. Please check %1 or add the compiler in the PATH environment variable.")
-                .arg(SettingsManager::getPathText(lang + "/Compile Command")));
+                .arg(SettingsManager::getPathText(compileCommandKey(lang))));
+    }
+}
+
+void Compiler::onArchiveProcessFinished()
+{
+    const bool archiveCreated = QFile::exists(javaArchivePath(tmpFilePath, sourceFilePath));
+    LOG_INFO("Java archive process finished " << BOOL_INFO_OF(archiveCreated));
+    emit compilationFinished(compileWarning);
+}
+
+void Compiler::createJavaArchive(const QString &warning)
+{
+    compileWarning = warning;
+
+    QStringList args = QProcess::splitCommand(SettingsHelper::getJavaRunCommand());
+    if (args.isEmpty())
+    {
+        emit compilationFinished(compileWarning);
+        return;
     }
+
+    QString program = args.takeFirst();
+    args << "-XX:ArchiveClassesAtExit=" + javaArchivePath(tmpFilePath, sourceFilePath) << "-classpath"
+         << outputPath(tmpFilePath, sourceFilePath, "Java") << SettingsHelper::getJavaClassName();
+
+    LOG_INFO("Creating Java archive " << INFO_OF(program) << INFO_OF(args.join(" ")));
+
+    // run the program once on an empty input, the classes it loads are dumped into the archive when the JVM exits
+    archiveProcess = new QProcess(this);
+    archiveProcess->setWorkingDirectory(outputPath(tmpFilePath, sourceFilePath, "Java"));
+    archiveProcess->setStandardInputFile(QProcess::nullDevice());
+    archiveProcess->setStandardOutputFile(QProcess::nullDevice());
+    archiveProcess->setStandardErrorFile(QProcess::nullDevice());
+    connect(archiveProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &Compiler::onArchiveProcessFinished);
+    connect(archiveProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            onArchiveProcessFinished();
+    });
+
+    // the program may wait for nothing, kill it after the default time limit, and there will be no archive
+    QTimer::singleShot(SettingsHelper::getDefaultTimeLimit(), archiveProcess, [this] {
+        LOG_WARN("Java archive process timed out");
+        archiveProcess->kill();
+    });
+
+    archiveProcess->start(program, args);
+}
+
+QString Compiler::compileCommandKey(const QString &lang)
+{
+    // Python is compiled by the interpreter
+    return lang == "Python" ? "Python/Run Command" : lang + "/Compile Command";
 }
 
 } // namespace Core
@@ -21,7 +21,14 @@
  * please use multiple Compilers.
  * The compilation process will be automatically killed when the Compiler is destructed,
  * so it's convenient to use one Compiler for one compilation.
- * When using it to "compile" Python, it will emit compilationFinished("") immediately.
+ * When using it to "compile" Python, it will emit compilationFinished("") immediately,
+ * unless precompilation is enabled, in which case the source file is compiled into a bytecode file by py_compile.
+ * The bytecode file is reused if neither the source file nor the interpreter is changed.
+ * When AppCDS is enabled for Java, the compiled program is run once after the compilation to create an archive of
+ * the loaded classes, and compilationFinished is emitted after that. The archive is removed when recompiling.
+ * A C++ program can also be compiled into a coverage build, which is instrumented to count the executions of each line.
+ * The coverage build is put in its own directory, so it doesn't replace the normal build, and it's reused if neither
+ * the source file nor the compile command is changed.
  */
 
 #ifndef COMPILER_HPP
@@ -53,15 +60,17 @@ class Compiler : public QObject
      * @brief start the compilation
      * @param tmpFilePath the path to the temporary file which is compiled
      * @param sourceFilePath the path to the original source file
-     * @param compileCommand the command for compiling
+     * @param compileCommand the command for compiling, the Python interpreter for Python
      * @param lang the language to compile, one of "C++", "Java", "Python"
+     * @param coverage whether to compile the coverage build of a C++ program, see Compiler::coverageOutputPath
      * @note this should be called only once per Compiler
      */
     void start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand,
-               const QString &lang);
+               const QString &lang, bool coverage = false);
 
     /**
-     * @brief get the output path (executable file path for C++, class path for Java, tmp file path for Python)
+     * @brief get the output path (executable file path for C++, class path for Java, bytecode file path for Python
+     * if precompilation is enabled, tmp file path for Python otherwise)
      * This should be used as an argument in the compilation command
      * @param tmpFilePath the path to the temporary file which is compiled
      * @param sourceFilePath the path to the original source file, if it's empty, tmpFilePath will be used instead of it
@@ -78,6 +87,27 @@ class Compiler : public QObject
     static QString outputFilePath(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                                   bool createDirectory = true);
 
+    /**
+     * @brief get the path of the AppCDS archive of a Java program, which is next to the class files
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     */
+    static QString javaArchivePath(const QString &tmpFilePath, const QString &sourceFilePath);
+
+    /**
+     * @brief get the path of the executable file of the coverage build of a C++ program
+     * The coverage build is in a directory next to the normal executable file, together with its coverage data.
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     */
+    static QString coverageOutputPath(const QString &tmpFilePath, const QString &sourceFilePath);
+
+    /**
+     * @brief whether the compiler in the compile command is Clang, which uses the coverage tools of LLVM
+     * The other compilers are considered to be GCC, which uses gcov.
+     */
+    static bool isClang(const QString &compileCommand);
+
   signals:
     /**
      * @brief the compilation has just started
@@ -117,9 +147,33 @@ class Compiler : public QObject
 
     void onProcessErrorOccurred(QProcess::ProcessError error);
 
+    /**
+     * @brief the process creating the Java archive has finished, emit compilationFinished
+     */
+    void onArchiveProcessFinished();
+
   private:
+    /**
+     * @brief run the compiled Java program to create the AppCDS archive
+     * @param warning the compile warnings, which are emitted after the archive is created
+     */
+    void createJavaArchive(const QString &warning);
+
+    /**
+     * @brief get the settings key of the command used to compile a language
+     */
+    static QString compileCommandKey(const QString &lang);
+
     QProcess *compileProcess = nullptr; // the compilation process
     QString lang;
+    QString bytecodeHashPath;           // the file saving the hash of the source of the Python bytecode file
+    QString bytecodeHash;               // the hash of the Python source file and the interpreter being compiled
+    QString coverageHashPath;           // the file saving the hash of the source of the coverage build
+    QString coverageHash;               // the hash of the C++ source file and the compile command of the coverage build
+    QString tmpFilePath;                // the path to the temporary file which is compiled
+    QString sourceFilePath;             // the path to the original source file
+    QProcess *archiveProcess = nullptr; // the process creating the Java archive
+    QString compileWarning;             // the compile warnings kept while creating the Java archive
 };
 
 } // namespace Core
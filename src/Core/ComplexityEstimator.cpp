@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/ComplexityEstimator.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/Runner.hpp"
+#include <QFileInfo>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace Core
+{
+
+namespace
+{
+const int GENERATOR_TIME_LIMIT = 30000; // the time limit of the generator in milliseconds
+
+// the common complexities, from the simplest to the most complex
+struct Model
+{
+    const char *name;
+    double (*function)(double n);
+};
+
+const Model MODELS[] = {
+    {"O(1)", [](double) { return 0.0; }},
+    {"O(log n)", [](double n) { return std::log2(n); }},
+    {"O(sqrt n)", [](double n) { return std::sqrt(n); }},
+    {"O(n)", [](double n) { return n; }},
+    {"O(n log n)", [](double n) { return n * std::log2(n); }},
+    {"O(n log^2 n)", [](double n) { return n * std::log2(n) * std::log2(n); }},
+    {"O(n sqrt n)", [](double n) { return n * std::sqrt(n); }},
+    {"O(n^2)", [](double n) { return n * n; }},
+    {"O(n^2 log n)", [](double n) { return n * n * std::log2(n); }},
+    {"O(n^3)", [](double n) { return n * n * n; }},
+    {"O(2^n)", [](double n) { return std::exp2(n); }},
+};
+
+// a simpler complexity is chosen if its error is at most this much larger, so that the noise is not overfitted
+const double SIMPLER_TOLERANCE = 1.1;
+} // namespace
+
+double ComplexityEstimator::Fit::predict(qint64 size) const
+{
+    return overhead + coefficient * MODELS[model].function(double(size));
+}
+
+ComplexityEstimator::ComplexityEstimator(const QString &generatorCommand, qint64 minimumSize, qint64 maximumSize,
+                                         int growthFactor)
+    : generatorCommand(generatorCommand)
+{
+    for (auto size = qMax(minimumSize, qint64(1)); size < maximumSize; size *= qMax(growthFactor, 2))
+        sizes.push_back(size);
+    sizes.push_back(maximumSize);
+}
+
+ComplexityEstimator::~ComplexityEstimator()
+{
+    if (generator != nullptr && generator->state() != QProcess::NotRunning)
+    {
+        LOG_WARN("The generator is still running and forcefully killed");
+        generator->disconnect(this);
+        generator->kill();
+        generator->waitForFinished();
+    }
+    delete runner;
+}
+
+void ComplexityEstimator::start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                                const QString &runCommand, const QString &args, int timeLimit)
+{
+    LOG_INFO(INFO_OF(generatorCommand) << INFO_OF(sizes.size()) << INFO_OF(timeLimit));
+
+    this->tmpFilePath = tmpFilePath;
+    this->sourceFilePath = sourceFilePath;
+    this->lang = lang;
+    this->runCommand = runCommand;
+    this->args = args;
+    this->timeLimit = timeLimit;
+
+    if (QProcess::splitCommand(generatorCommand).isEmpty())
+    {
+        emit failed(tr("The generator command is empty."));
+        return;
+    }
+
+    generatorTimer = new QTimer(this);
+    generatorTimer->setSingleShot(true);
+    generatorTimer->setInterval(GENERATOR_TIME_LIMIT);
+    connect(generatorTimer, &QTimer::timeout, this, &ComplexityEstimator::onGeneratorTimeout);
+
+    next();
+}
+
+QVector<ComplexityEstimator::Fit> ComplexityEstimator::fit(const QVector<Measurement> &measurements)
+{
+    QVector<Fit> fits;
+    if (measurements.size() < 3) // any complexity fits two measurements
+        return fits;
+
+    for (int model = 0; model < int(sizeof MODELS / sizeof MODELS[0]); ++model)
+    {
+        // Weighted least squares of time = overhead + coefficient * f(n). The weights are 1 / time^2, so the
+        // relative errors are minimized, otherwise the largest size would dominate the fit.
+        double sw = 0, swf = 0, swff = 0, swt = 0, swft = 0;
+        bool finite = true;
+        for (const auto &measurement : measurements)
+        {
+            const double f = MODELS[model].function(double(measurement.size));
+            const double t = double(measurement.timeUsed);
+            const double w = 1.0 / std::max(t * t, 1.0);
+            finite = finite && std::isfinite(f);
+            sw += w;
+            swf += w * f;
+            swff += w * f * f;
+            swt += w * t;
+            swft += w * f * t;
+        }
+        if (!finite)
+            continue;
+
+        Fit fit;
+        fit.model = model;
+        fit.complexity = MODELS[model].name;
+
+        const double det = sw * swff - swf * swf;
+        if (model > 0 && std::abs(det) > 1e-12 * sw * swff)
+        {
+            fit.overhead = (swt * swff - swf * swft) / det;
+            fit.coefficient = (sw * swft - swf * swt) / det;
+        }
+        // the overhead and the coefficient can't be negative, fit without the negative one
+        if (model > 0 && (fit.overhead < 0 || std::abs(det) <= 1e-12 * sw * swff) && swff > 0)
+        {
+            fit.overhead = 0;
+            fit.coefficient = swft / swff;
+        }
+        if (model == 0 || fit.coefficient <= 0)
+        {
+            fit.overhead = swt / sw;
+            fit.coefficient = 0;
+        }
+
+        double squaredError = 0;
+        for (const auto &measurement : measurements)
+        {
+            const double t = std::max(double(measurement.timeUsed), 1.0);
+            const double relative = (fit.predict(measurement.size) - t) / t;
+            squaredError += relative * relative;
+        }
+        fit.error = std::sqrt(squaredError / measurements.size());
+
+        fits.push_back(fit);
+    }
+
+    std::stable_sort(fits.begin(), fits.end(), [](const Fit &a, const Fit &b) { return a.error < b.error; });
+
+    // move the simplest complexity which fits almost as well as the best one to the front
+    const double bestError = fits.isEmpty() ? 0 : fits[0].error;
+    for (int i = 1; i < fits.size(); ++i)
+    {
+        if (fits[i].model < fits[0].model && fits[i].error <= bestError * SIMPLER_TOLERANCE + 1e-9)
+            std::rotate(fits.begin(), fits.begin() + i, fits.begin() + i + 1);
+    }
+
+    return fits;
+}
+
+void ComplexityEstimator::next()
+{
+    if (++current >= sizes.size())
+    {
+        emit finished(measurements, 0);
+        return;
+    }
+
+    auto args = QProcess::splitCommand(QString(generatorCommand).replace("${n}", QString::number(sizes[current])));
+    const auto program = args.takeFirst();
+
+    delete generator;
+    generator = new QProcess(this);
+    connect(generator, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &ComplexityEstimator::onGeneratorFinished);
+    connect(generator, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+        {
+            generatorTimer->stop();
+            emit failed(tr("Failed to start the generator: %1").arg(generator->errorString()));
+        }
+    });
+    generator->setWorkingDirectory(
+        QFileInfo(QFile::exists(sourceFilePath) ? sourceFilePath : tmpFilePath).canonicalPath());
+    generator->start(program, args);
+    generatorTimer->start();
+}
+
+void ComplexityEstimator::onGeneratorFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    generatorTimer->stop();
+
+    if (exitCode != 0 || exitStatus != QProcess::NormalExit)
+    {
+        emit failed(tr("The generator exited with code %1 at n = %2\n%3")
+                        .arg(exitCode)
+                        .arg(sizes[current])
+                        .arg(QString::fromLocal8Bit(generator->readAllStandardError())));
+        return;
+    }
+
+    delete runner;
+    runner = new Runner(current);
+    connect(runner, &Runner::runFinished, this, &ComplexityEstimator::onRunFinished);
+    connect(runner, &Runner::failedToStartRun, this, &ComplexityEstimator::onFailedToStartRun);
+    runner->run(tmpFilePath, sourceFilePath, lang, runCommand, args,
+                QString::fromUtf8(generator->readAllStandardOutput()), timeLimit);
+}
+
+void ComplexityEstimator::onGeneratorTimeout()
+{
+    generator->disconnect(this);
+    generator->kill();
+    emit failed(tr("The generator didn't finish in %1ms at n = %2").arg(GENERATOR_TIME_LIMIT).arg(sizes[current]));
+}
+
+void ComplexityEstimator::onRunFinished(int index, const QString &, const QString &, int exitCode, qint64 timeUsed,
+                                        qint64 cpuTimeUsed, bool tle, bool ile)
+{
+    if (index != current)
+        return;
+
+    if (tle || ile)
+    {
+        emit finished(measurements, sizes[current]);
+        return;
+    }
+
+    if (exitCode != 0)
+    {
+        emit failed(tr("The solution exited with code %1 at n = %2").arg(exitCode).arg(sizes[current]));
+        return;
+    }
+
+    const Measurement measurement{sizes[current], cpuTimeUsed >= 0 ? cpuTimeUsed : timeUsed};
+    measurements.push_back(measurement);
+    emit measured(measurement);
+    next();
+}
+
+void ComplexityEstimator::onFailedToStartRun(int index, const QString &error)
+{
+    if (index == current)
+        emit failed(error);
+}
+
+} // namespace Core
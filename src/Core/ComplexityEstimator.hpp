@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The ComplexityEstimator estimates the time complexity of a solution empirically.
+ * A generator is executed with geometrically increasing sizes to create the inputs, and the solution is executed on
+ * them by Runners, one at a time so that the timings are not affected by each other. It stops at the maximum size or
+ * at the first size exceeding the time limit. The timings are fitted against the common complexities with a constant
+ * overhead, and the best fit is used to predict the time used at the maximum size.
+ */
+
+#ifndef COMPLEXITYESTIMATOR_HPP
+#define COMPLEXITYESTIMATOR_HPP
+
+#include <QObject>
+#include <QProcess>
+#include <QVector>
+
+class QTimer;
+
+namespace Core
+{
+class Runner;
+
+class ComplexityEstimator : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // the time used on an input size
+    struct Measurement
+    {
+        qint64 size = 0;
+        qint64 timeUsed = 0; // in milliseconds, the CPU time if it's known
+    };
+
+    // a complexity fitted to the measurements, time = overhead + coefficient * complexity(size)
+    struct Fit
+    {
+        int model = 0;      // the index of the complexity function
+        QString complexity; // the name of the complexity, e.g. "O(n log n)"
+        double overhead = 0;
+        double coefficient = 0;
+        double error = 0;   // the root mean square of the relative errors on the measurements
+
+        /**
+         * @brief predict the time used on a size in milliseconds
+         */
+        double predict(qint64 size) const;
+    };
+
+    /**
+     * @brief construct a complexity estimator
+     * @param generatorCommand the command of the generator, "${n}" in it is replaced by the size
+     * @param minimumSize the first size to test
+     * @param maximumSize the size to predict, it's the last size to test
+     * @param growthFactor the ratio of two consecutive sizes
+     */
+    ComplexityEstimator(const QString &generatorCommand, qint64 minimumSize, qint64 maximumSize, int growthFactor);
+
+    /**
+     * @brief destruct a complexity estimator
+     * @note the generator and the solution are killed if they are running
+     */
+    ~ComplexityEstimator() override;
+
+    /**
+     * @brief start the estimation
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param lang the language of the solution, one of "C++", "Java" and "Python"
+     * @param runCommand the command for running a program
+     * @param args the command line arguments added at the back to start the program
+     * @param timeLimit the time limit of each execution in milliseconds
+     */
+    void start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+               const QString &runCommand, const QString &args, int timeLimit);
+
+    /**
+     * @brief fit the measurements against the common complexities
+     * @returns the fits sorted from the best to the worst, empty if there are less than three measurements
+     * @note a simpler complexity is preferred if it fits almost as well as a more complex one
+     */
+    static QVector<Fit> fit(const QVector<Measurement> &measurements);
+
+  signals:
+    /**
+     * @brief the solution is executed on a size
+     */
+    void measured(const Core::ComplexityEstimator::Measurement &measurement);
+
+    /**
+     * @brief the estimation is finished
+     * @param measurements the sizes which are accepted within the time limit
+     * @param exceededSize the first size exceeding the time limit, 0 if all sizes are within the time limit
+     */
+    void finished(const QVector<Core::ComplexityEstimator::Measurement> &measurements, qint64 exceededSize);
+
+    /**
+     * @brief the generator or the solution failed
+     */
+    void failed(const QString &error);
+
+  private slots:
+    void onGeneratorFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onGeneratorTimeout();
+    void onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed,
+                       qint64 cpuTimeUsed, bool tle, bool ile);
+    void onFailedToStartRun(int index, const QString &error);
+
+  private:
+    /**
+     * @brief generate the input of the next size, or finish if all sizes are tested
+     */
+    void next();
+
+    QString generatorCommand;
+    QVector<qint64> sizes;            // the sizes to test, in increasing order
+    int current = -1;                 // the index of the size being tested
+    QVector<Measurement> measurements;
+    QString tmpFilePath, sourceFilePath, lang, runCommand, args;
+    int timeLimit = 0;
+    QProcess *generator = nullptr;
+    QTimer *generatorTimer = nullptr; // kills the generator if it runs for too long
+    Runner *runner = nullptr;
+};
+
+} // namespace Core
+
+#endif // COMPLEXITYESTIMATOR_HPP
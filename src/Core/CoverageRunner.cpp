@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/CoverageRunner.hpp"
+#include "Core/Compiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Util/FileUtil.hpp"
+#include <QDir>
+#include <QFileInfo>
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+#include <QTemporaryFile>
+#include <QTimer>
+
+namespace Core
+{
+
+namespace
+{
+const int TIME_LIMIT_FACTOR = 3; // the instrumentation slows down the program, so it gets a longer time limit
+const QString RAW_PROFILE = "coverage.profraw";
+const QString PROFILE = "coverage.profdata";
+} // namespace
+
+CoverageRunner::CoverageRunner(int index) : index(index)
+{
+}
+
+CoverageRunner::~CoverageRunner()
+{
+    delete compiler;
+
+    for (auto *process : {runProcess, toolProcess})
+    {
+        if (process != nullptr && process->state() != QProcess::NotRunning)
+        {
+            LOG_WARN("The coverage process is still running and forcefully killed");
+            process->disconnect(this);
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+}
+
+void CoverageRunner::start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand,
+                           const QString &args, const TestData &input, int timeLimit)
+{
+    LOG_INFO(INFO_OF(tmpFilePath) << INFO_OF(sourceFilePath) << INFO_OF(compileCommand) << INFO_OF(timeLimit));
+
+    if (!QFile::exists(tmpFilePath))
+    {
+        emit coverageFailed(index, tr("The source file %1 doesn't exist.").arg(tmpFilePath));
+        return;
+    }
+
+    compilerPath = QProcess::splitCommand(compileCommand).value(0);
+    if (compilerPath.isEmpty())
+    {
+        emit coverageFailed(index, tr("The compile command is empty."));
+        return;
+    }
+
+    this->args = args;
+    this->input = input;
+    this->timeLimit = timeLimit;
+    clang = Compiler::isClang(compileCommand);
+    sourcePath = QFileInfo(tmpFilePath).canonicalFilePath();
+    executable = Compiler::coverageOutputPath(tmpFilePath, sourceFilePath);
+    workingDirectory = QFileInfo(Compiler::outputFilePath(tmpFilePath, sourceFilePath, "C++", false)).path();
+
+    compiler = new Compiler();
+    connect(compiler, &Compiler::compilationFinished, this, &CoverageRunner::onCompilationFinished);
+    connect(compiler, &Compiler::compilationErrorOccurred, this, &CoverageRunner::fail);
+    connect(compiler, &Compiler::compilationFailed, this, &CoverageRunner::fail);
+    compiler->start(tmpFilePath, sourceFilePath, compileCommand, "C++", true);
+}
+
+void CoverageRunner::onCompilationFinished()
+{
+    // the counts of the previous executions are accumulated in the data files
+    QDir coverageDir = QFileInfo(executable).dir();
+    for (const auto &file : coverageDir.entryList({"*.gcda", RAW_PROFILE, PROFILE}, QDir::Files))
+        coverageDir.remove(file);
+
+    // a file-backed input is read by the program directly
+    QString inputPath = input.filePath();
+    if (!input.isFileBacked())
+    {
+        inputFile = new QTemporaryFile(this);
+        if (!inputFile->open())
+        {
+            fail(tr("Failed to create temporary file."));
+            return;
+        }
+        Util::saveFile(inputFile->fileName(), input.text(), "Coverage Input", false);
+        inputPath = inputFile->fileName();
+    }
+
+    killTimer = new QTimer(this);
+    killTimer->setSingleShot(true);
+    killTimer->setInterval(timeLimit * TIME_LIMIT_FACTOR);
+    connect(killTimer, &QTimer::timeout, this, &CoverageRunner::onTimeout);
+
+    runProcess = new QProcess(this);
+    connect(runProcess, &QProcess::started, this, [this] {
+        killTimer->start();
+        emit coverageStarted(index);
+    });
+    connect(runProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            fail(tr("Failed to start the program: %1").arg(runProcess->errorString()));
+    });
+    connect(runProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &CoverageRunner::onFinished);
+    if (clang)
+    {
+        auto environment = QProcessEnvironment::systemEnvironment();
+        environment.insert("LLVM_PROFILE_FILE", coverageDir.filePath(RAW_PROFILE));
+        runProcess->setProcessEnvironment(environment);
+    }
+    runProcess->setWorkingDirectory(workingDirectory);
+    runProcess->setStandardInputFile(inputPath);
+    runProcess->setStandardOutputFile(QProcess::nullDevice());
+    runProcess->setStandardErrorFile(QProcess::nullDevice());
+    runProcess->start(executable, QProcess::splitCommand(args));
+}
+
+void CoverageRunner::onFinished()
+{
+    killTimer->stop();
+
+    // the data is written when the program exits normally, a crashed program may write nothing
+    const QDir coverageDir = QFileInfo(executable).dir();
+    if (clang)
+    {
+        if (!coverageDir.exists(RAW_PROFILE))
+        {
+            fail(tr("No coverage data is written, the program probably crashed."));
+            return;
+        }
+        startTool(toolPath({"clang++", "clang"}, "llvm-profdata"),
+                  {"merge", "-sparse", coverageDir.filePath(RAW_PROFILE), "-o", coverageDir.filePath(PROFILE)});
+    }
+    else
+    {
+        QStringList dataFiles;
+        for (const auto &file : coverageDir.entryList({"*.gcda"}, QDir::Files))
+            dataFiles.push_back(coverageDir.filePath(file));
+        if (dataFiles.isEmpty())
+        {
+            fail(tr("No coverage data is written, the program probably crashed."));
+            return;
+        }
+        // the notes file is found next to the data file
+        startTool(toolPath({"g++", "gcc", "c++"}, "gcov"), QStringList{"--stdout"} + dataFiles);
+    }
+}
+
+void CoverageRunner::onTimeout()
+{
+    fail(tr("The program is killed at the time limit, the coverage data is only written when it exits."));
+}
+
+void CoverageRunner::startTool(const QString &tool, const QStringList &args)
+{
+    LOG_INFO(INFO_OF(tool) << INFO_OF(args.join(" ")));
+
+    if (toolProcess != nullptr)
+        toolProcess->deleteLater();
+
+    toolProcess = new QProcess(this);
+    connect(toolProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &CoverageRunner::onToolFinished);
+    connect(toolProcess, &QProcess::errorOccurred, this, [this, tool](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            fail(tr("Failed to start %1, please make sure it's installed with the compiler: %2")
+                     .arg(tool, toolProcess->errorString()));
+    });
+    // gcov writes the reports to the working directory if --stdout is not supported
+    toolProcess->setWorkingDirectory(QFileInfo(executable).path());
+    toolProcess->start(tool, args);
+}
+
+void CoverageRunner::onToolFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitCode != 0 || exitStatus != QProcess::NormalExit)
+    {
+        fail(tr("%1 failed: %2")
+                 .arg(QFileInfo(toolProcess->program()).fileName(),
+                      QString::fromLocal8Bit(toolProcess->readAllStandardError())));
+        return;
+    }
+
+    if (clang && !merged)
+    {
+        merged = true;
+        const QDir coverageDir = QFileInfo(executable).dir();
+        startTool(toolPath({"clang++", "clang"}, "llvm-cov"),
+                  {"export", "-format=lcov", "-instr-profile=" + coverageDir.filePath(PROFILE), executable});
+        return;
+    }
+
+    const auto output = QString::fromLocal8Bit(toolProcess->readAllStandardOutput());
+    const auto result = clang ? parseLcov(output) : parseGcov(output);
+    if (result.lineCounts.isEmpty())
+    {
+        fail(tr("No execution counts of the source file are found in the coverage data."));
+        return;
+    }
+
+    LOG_INFO(INFO_OF(result.lineCounts.size()) << INFO_OF(result.executedLines));
+    emit coverageFinished(index, result);
+}
+
+QString CoverageRunner::toolPath(const QStringList &from, const QString &to) const
+{
+    const QFileInfo compilerInfo(compilerPath);
+    auto name = compilerInfo.fileName();
+    for (const auto &compilerName : from)
+    {
+        const int position = name.lastIndexOf(compilerName);
+        if (position != -1)
+        {
+            name.replace(position, compilerName.size(), to);
+            // a compiler found in PATH has no directory, so is the tool
+            return compilerPath.contains('/') || compilerPath.contains('\\') ? compilerInfo.dir().filePath(name)
+                                                                              : name;
+        }
+    }
+    return to;
+}
+
+CoverageRunner::Result CoverageRunner::parseGcov(const QString &output) const
+{
+    // Each line of the report is "count:line:source". The count is "-" for the lines without code, "#####" or
+    // "=====" for the lines not executed, and it may be followed by "*" if some blocks of the line are not executed.
+    // Each file starts with "-:0:Source:path". The instantiations of the templates are listed again after the
+    // template between the "------------------" lines, they are skipped because they are counted in the template.
+    static const QRegularExpression lineRegex(R"(^\s*([^:]+):\s*(\d+):(.*)$)");
+
+    Result result;
+    bool inSourceFile = false;
+    bool afterSeparator = false;
+    bool inInstantiation = false;
+
+    for (const auto &line : output.split('\n'))
+    {
+        const auto match = lineRegex.match(line);
+        if (!match.hasMatch())
+        {
+            if (line.startsWith("------------------"))
+            {
+                afterSeparator = true;
+            }
+            else if (afterSeparator)
+            {
+                // the name of an instantiation follows the separator
+                inInstantiation = true;
+                afterSeparator = false;
+            }
+            continue;
+        }
+
+        if (afterSeparator)
+        {
+            // the lines of the template continue after the last instantiation
+            inInstantiation = false;
+            afterSeparator = false;
+        }
+
+        const auto count = match.captured(1).trimmed();
+        const int lineNumber = match.captured(2).toInt();
+        if (lineNumber == 0)
+        {
+            if (match.captured(3).startsWith("Source:"))
+                inSourceFile = QFileInfo(match.captured(3).mid(7)).canonicalFilePath() == sourcePath;
+            continue;
+        }
+        if (!inSourceFile || inInstantiation || count == "-")
+            continue;
+
+        bool ok = false;
+        const auto executions = QString(count).remove('*').toLongLong(&ok);
+        if (ok)
+            result.lineCounts[lineNumber] = executions;
+        else if (count.startsWith("#####") || count.startsWith("=====") || count.startsWith("%%%%%"))
+            result.lineCounts[lineNumber] = 0;
+    }
+
+    for (auto executions : qAsConst(result.lineCounts))
+        result.executedLines += executions > 0;
+
+    return result;
+}
+
+CoverageRunner::Result CoverageRunner::parseLcov(const QString &output) const
+{
+    // "SF:path" starts a file, "DA:line,count" is the count of a line, and "end_of_record" ends a file
+    Result result;
+    bool inSourceFile = false;
+
+    for (const auto &line : output.split('\n'))
+    {
+        if (line.startsWith("SF:"))
+            inSourceFile = QFileInfo(line.mid(3).trimmed()).canonicalFilePath() == sourcePath;
+        else if (line.startsWith("end_of_record"))
+            inSourceFile = false;
+        else if (inSourceFile && line.startsWith("DA:"))
+        {
+            const auto fields = line.mid(3).trimmed().split(',');
+            const int lineNumber = fields.value(0).toInt();
+            const auto executions = fields.value(1).toLongLong();
+            if (lineNumber > 0)
+                result.lineCounts[lineNumber] = qMax(result.lineCounts.value(lineNumber), executions);
+        }
+    }
+
+    for (auto executions : qAsConst(result.lineCounts))
+        result.executedLines += executions > 0;
+
+    return result;
+}
+
+void CoverageRunner::fail(const QString &error)
+{
+    LOG_WARN(INFO_OF(error));
+    if (killTimer != nullptr)
+        killTimer->stop();
+    if (runProcess != nullptr && runProcess->state() != QProcess::NotRunning)
+    {
+        runProcess->disconnect(this);
+        runProcess->kill();
+    }
+    emit coverageFailed(index, error);
+}
+
+} // namespace Core
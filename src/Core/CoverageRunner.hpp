@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The CoverageRunner counts how many times each line of a C++ solution is executed on a test case.
+ * The solution is compiled into the coverage build by the Compiler, then it's executed with the input of the test case,
+ * and the coverage data written at its exit is read by gcov for GCC, or by llvm-profdata and llvm-cov for Clang.
+ * The tools are found by the name of the compiler, e.g. gcov-12 for g++-12 and llvm-cov-15 for clang++-15.
+ * Like the Compiler, it should be used only once, and the processes are killed when it's destructed.
+ */
+
+#ifndef COVERAGERUNNER_HPP
+#define COVERAGERUNNER_HPP
+
+#include "Core/TestData.hpp"
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+
+class QTemporaryFile;
+class QTimer;
+
+namespace Core
+{
+
+class Compiler;
+
+class CoverageRunner : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // the execution counts of the lines in the source file
+    struct Result
+    {
+        QMap<int, qint64> lineCounts; // the execution count of each executable line, starting from 1
+        int executedLines = 0;        // the number of executable lines executed at least once
+    };
+
+    /**
+     * @brief construct a coverage runner
+     * @param index the index of the test case
+     */
+    explicit CoverageRunner(int index);
+
+    /**
+     * @brief destruct a coverage runner
+     * @note the compilation, the execution and the coverage tools are killed if they are running
+     */
+    ~CoverageRunner() override;
+
+    /**
+     * @brief compile and run the coverage build of a C++ program
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param compileCommand the command for compiling, the instrumentation is added to it
+     * @param args the command line arguments added at the back to start the program
+     * @param input the input of the test case
+     * @param timeLimit the time limit of the normal execution in milliseconds
+     */
+    void start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand,
+               const QString &args, const TestData &input, int timeLimit);
+
+  signals:
+    /**
+     * @brief the coverage build is compiled and started
+     */
+    void coverageStarted(int index);
+
+    /**
+     * @brief the execution counts are read
+     */
+    void coverageFinished(int index, const Core::CoverageRunner::Result &result);
+
+    /**
+     * @brief failed to compile or execute the program, or failed to read the coverage data
+     * @param error the reason of the failure, the compile errors if it fails to compile
+     */
+    void coverageFailed(int index, const QString &error);
+
+  private slots:
+    void onCompilationFinished();
+    void onFinished();
+    void onTimeout();
+    void onToolFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+  private:
+    /**
+     * @brief start a coverage tool, onToolFinished is called when it finishes
+     */
+    void startTool(const QString &tool, const QStringList &args);
+
+    /**
+     * @brief get the path of a coverage tool from the path of the compiler
+     * @param from the names of the compiler to be replaced, the longer ones first
+     * @param to the name of the tool
+     */
+    QString toolPath(const QStringList &from, const QString &to) const;
+
+    /**
+     * @brief parse the output of gcov in the text format
+     */
+    Result parseGcov(const QString &output) const;
+
+    /**
+     * @brief parse the output of llvm-cov in the LCOV format
+     */
+    Result parseLcov(const QString &output) const;
+
+    /**
+     * @brief kill the processes and emit coverageFailed
+     */
+    void fail(const QString &error);
+
+    int index;
+    QString executable;                // the executable file of the coverage build
+    QString sourcePath;                // the canonical path of the compiled file, to find its lines
+    QString workingDirectory;          // the working directory of the normal execution
+    QString compilerPath;              // the path of the compiler, to find the coverage tools
+    bool clang = false;                // whether the coverage tools of LLVM are used
+    bool merged = false;               // whether the raw profile of LLVM is merged, then llvm-cov is started
+    QString args;
+    TestData input;
+    int timeLimit = 0;
+    Compiler *compiler = nullptr;
+    QProcess *runProcess = nullptr;
+    QProcess *toolProcess = nullptr;
+    QTemporaryFile *inputFile = nullptr;
+    QTimer *killTimer = nullptr;       // kills the program at the time limit
+};
+
+} // namespace Core
+
+#endif // COVERAGERUNNER_HPP
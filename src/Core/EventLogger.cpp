@@ -34,6 +34,7 @@ namespace Core
 
 QFile Log::logFile;
 QTextStream Log::logStream;
+QRecursiveMutex Log::logMutex;
 
 const int Log::NUMBER_OF_LOGS_TO_KEEP = 50;
 const int Log::MAXIMUM_FUNCTION_NAME_SIZE = 30;
@@ -135,6 +136,11 @@ QTextStream &Log::log(const QString &priority, QString funcName, int line, QStri
                      << "(" << line << ")::";
 }
 
+QRecursiveMutex *Log::mutex()
+{
+    return &logMutex;
+}
+
 void Log::revealInFileManager()
 {
     Util::revealInFileManager(logFile.fileName()).first();
@@ -26,6 +26,7 @@
 #ifdef QT_DEBUG
 #include <QDebug>
 #endif
+#include <QMutex>
 #include <QTextStream>
 
 class QFile;
@@ -43,10 +44,20 @@ class QFile;
  * pure string replacement, we cannot put braces, and hence the no lint.
  */
 
-#define LOG_INFO(stream) Core::Log::log("INFO ", __func__, __LINE__, __FILE__) << stream << Qt::endl; // NOLINT
-#define LOG_WARN(stream) Core::Log::log("WARN ", __func__, __LINE__, __FILE__) << stream << Qt::endl; // NOLINT
-#define LOG_ERR(stream) Core::Log::log("ERROR", __func__, __LINE__, __FILE__) << stream << Qt::endl;  // NOLINT
-#define LOG_WTF(stream) Core::Log::log(" WTF ", __func__, __LINE__, __FILE__) << stream << Qt::endl;  // NOLINT
+/*
+ * The logs are written by the judge thread too, so the whole line is written with Core::Log::mutex() locked.
+ */
+
+#define LOG_INFO(stream) LOG_LINE("INFO ", stream)
+#define LOG_WARN(stream) LOG_LINE("WARN ", stream)
+#define LOG_ERR(stream) LOG_LINE("ERROR", stream)
+#define LOG_WTF(stream) LOG_LINE(" WTF ", stream)
+
+#define LOG_LINE(priority, stream)                                                                                     \
+    {                                                                                                                  \
+        QMutexLocker logLocker(Core::Log::mutex());                                                                    \
+        Core::Log::log(priority, __func__, __LINE__, __FILE__) << stream << Qt::endl; /* NOLINT */                     \
+    }
 
 #define LOG_INFO_IF(cond, stream)                                                                                      \
     if (cond)                                                                                                          \
@@ -112,12 +123,19 @@ class Log
 
     static QTextStream &log(const QString &priority, QString funcName, int line, QString fileName);
 
+    /**
+     * @brief the mutex which should be locked when writing a line of log
+     * @note it's recursive, so the arguments of a log can log something else
+     */
+    static QRecursiveMutex *mutex();
+
   private:
     static QString dateTimeStamp();
     static void platformInformation();
 
-    static QTextStream logStream; // the text stream for logging, writes to logFile
-    static QFile logFile;         // the device for logging, a file or stderr
+    static QTextStream logStream;    // the text stream for logging, writes to logFile
+    static QFile logFile;            // the device for logging, a file or stderr
+    static QRecursiveMutex logMutex; // locked when writing a line of log
 
     const static int NUMBER_OF_LOGS_TO_KEEP; // Number of log files to keep in Temporary directory
     const static QString LOG_FILE_NAME;      // Base Name of the log file
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/JudgeThread.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/PerfCounters.hpp"
+#include <QCoreApplication>
+
+namespace Core
+{
+
+JudgeThread::JudgeThread() : QThread(QCoreApplication::instance())
+{
+    setObjectName("Judge");
+    PerfCounters::registerMetaType();
+    // the thread is idle most of the time, a high priority makes the time limits more precise
+    start(QThread::HighPriority);
+    LOG_INFO("The judge thread is started");
+}
+
+JudgeThread::~JudgeThread()
+{
+    quit();
+    wait();
+}
+
+JudgeThread *JudgeThread::instance()
+{
+    static JudgeThread *thread = nullptr;
+    if (thread == nullptr)
+        thread = new JudgeThread();
+    return thread;
+}
+
+} // namespace Core
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The JudgeThread is the thread where the executions of the test cases are managed.
+ * The processes, their outputs and the time limits are handled by Core::RunnerWorker in the event loop of this thread,
+ * so they are not delayed by the GUI, and the GUI is not blocked by them. Only the final results are sent back to the
+ * GUI thread by Core::Runner.
+ * The objects created on this thread and shared by the workers (e.g. Core::PythonForkServer) are deleted when the
+ * thread finishes.
+ */
+
+#ifndef JUDGETHREAD_HPP
+#define JUDGETHREAD_HPP
+
+#include <QThread>
+
+namespace Core
+{
+
+class JudgeThread : public QThread
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief get the judge thread, it's started when it's created
+     * @note this should be called on the GUI thread
+     */
+    static JudgeThread *instance();
+
+    /**
+     * @brief stop the event loop and wait for the thread to finish
+     */
+    ~JudgeThread() override;
+
+  private:
+    JudgeThread();
+};
+
+} // namespace Core
+
+#endif // JUDGETHREAD_HPP
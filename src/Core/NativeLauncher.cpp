@@ -0,0 +1,686 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/NativeLauncher.hpp"
+#include <QFile>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <chrono>
+#include <memory>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+// posix_spawn_file_actions_addchdir_np is added in glibc 2.29, pidfd_open is added in Linux 5.3
+#if defined(SYS_pidfd_open) && defined(SYS_pidfd_send_signal) && defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2, 29)
+#define NATIVE_LAUNCHER_SUPPORTED
+#endif
+#endif
+#endif
+
+namespace Core
+{
+
+struct NativeLauncher::Process
+{
+    int id = -1;                                     // the id of the launch
+    qint64 pid = -1;                                 // the pid of the process
+    int pidFd = -1;                                  // the pidfd of the process, readable when the process exits
+    int outFd = -1;                                  // the read end of the stdout pipe
+    int errFd = -1;                                  // the read end of the stderr pipe
+    int timerFd = -1;                                // the timerfd of the wall time limit
+    int cpuTimerFd = -1;                             // the timerfd used to check the CPU time limit
+    QByteArray out;                                  // the stdout read so far
+    QByteArray err;                                  // the stderr read so far
+    qint64 outputLimit = 0;                          // the maximum length of the stdout/stderr
+    int cpuTimeLimit = 0;                            // the CPU time limit in milliseconds, 0 for no limit
+    bool tle = false;                                // whether the process is killed because of the time limit
+    bool ile = false;                                // whether the process is killed because of the wall time limit
+    bool outputLimitExceeded = false;                // whether the process is killed because of the output limit
+    std::chrono::steady_clock::time_point startTime; // the time when the process is spawned
+    std::unique_ptr<PerfCounters> counters;          // the hardware event counters, null if they are not counted
+};
+
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+namespace
+{
+// the kinds of the file descriptors watched by epoll, the data of an epoll event is (id << 3 | kind)
+enum FdKind : quint64
+{
+    Stdout,
+    Stderr,
+    Pid,
+    Timer,
+    CpuTimer
+};
+
+const quint64 WAKE_UP = ~quint64(0); // the data of the eventfd
+
+quint64 eventData(int id, FdKind kind)
+{
+    return (quint64(id) << 3) | kind;
+}
+
+void setTimer(int fd, qint64 milliseconds)
+{
+    itimerspec value{};
+    value.it_value.tv_sec = milliseconds / 1000;
+    value.it_value.tv_nsec = (milliseconds % 1000) * 1000000L;
+    timerfd_settime(fd, 0, &value, nullptr);
+}
+
+// the CPU time used by a running process so far, in milliseconds, or -1 if it can't be read
+qint64 cpuTimeOf(qint64 pid)
+{
+    clockid_t clock;
+    timespec time{};
+    if (clock_getcpuclockid(pid_t(pid), &clock) != 0 || clock_gettime(clock, &time) != 0)
+        return -1;
+    return qint64(time.tv_sec) * 1000 + time.tv_nsec / 1000000;
+}
+
+// start a process by fork and execve, and attach the counters while the child process waits before execve
+// returns 0 on success, or the errno like posix_spawn
+int forkWithCounters(pid_t *pid, const QString &program, char *const argv[], int inputFd, int outFd, int errFd,
+                     const QByteArray &workingDirectory, PerfCounters *counters)
+{
+    // execvp isn't async-signal-safe, so the program is found in the parent
+    const auto path = QFile::encodeName(program.contains('/') ? program : QStandardPaths::findExecutable(program));
+    if (path.isEmpty())
+        return ENOENT;
+    const char *directory = workingDirectory.isEmpty() ? nullptr : workingDirectory.constData();
+
+    // the child waits for syncPipe to be closed, and writes the errno to errorPipe if it fails to execve
+    int syncPipe[2], errorPipe[2];
+    if (pipe2(syncPipe, O_CLOEXEC) == -1)
+        return errno;
+    if (pipe2(errorPipe, O_CLOEXEC) == -1)
+    {
+        const int error = errno;
+        ::close(syncPipe[0]);
+        ::close(syncPipe[1]);
+        return error;
+    }
+
+    const pid_t child = fork();
+    if (child == 0)
+    {
+        // only async-signal-safe functions can be called in the child of a multithreaded process
+        ::close(syncPipe[1]);
+        ::close(errorPipe[0]);
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigprocmask(SIG_SETMASK, &signals, nullptr);
+        signal(SIGPIPE, SIG_DFL);
+        char byte;
+        while (::read(syncPipe[0], &byte, 1) == -1 && errno == EINTR)
+        {
+        }
+        if (dup2(inputFd, STDIN_FILENO) != -1 && dup2(outFd, STDOUT_FILENO) != -1 &&
+            dup2(errFd, STDERR_FILENO) != -1 && (directory == nullptr || chdir(directory) == 0))
+        {
+            execve(path.constData(), argv, environ);
+        }
+        const int error = errno;
+        const auto written = ::write(errorPipe[1], &error, sizeof error);
+        Q_UNUSED(written)
+        _exit(127);
+    }
+
+    const int forkError = errno;
+    ::close(syncPipe[0]);
+    ::close(errorPipe[1]);
+    if (child == -1)
+    {
+        ::close(syncPipe[1]);
+        ::close(errorPipe[0]);
+        return forkError;
+    }
+
+    counters->attach(child);
+    ::close(syncPipe[1]);
+
+    // the error pipe is closed without data if execve succeeds
+    int error = 0;
+    ssize_t size;
+    while ((size = ::read(errorPipe[0], &error, sizeof error)) == -1 && errno == EINTR)
+    {
+    }
+    ::close(errorPipe[0]);
+    if (size == sizeof error)
+    {
+        waitpid(child, nullptr, 0);
+        return error;
+    }
+
+    *pid = child;
+    return 0;
+}
+} // namespace
+#endif
+
+NativeLauncher::NativeLauncher()
+{
+    PerfCounters::registerMetaType();
+
+    // the launcher is deleted when the thread creating it, usually the judge thread, finishes
+    connect(QThread::currentThread(), &QThread::finished, this, &QObject::deleteLater, Qt::DirectConnection);
+
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_UP;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, eventFd, &event);
+#endif
+    start();
+}
+
+NativeLauncher::~NativeLauncher()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+    }
+    wake();
+    wait();
+    closeFd(eventFd);
+    closeFd(epollFd);
+}
+
+bool NativeLauncher::isSupported()
+{
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+    static const bool supported = [] {
+        const int fd = int(syscall(SYS_pidfd_open, getpid(), 0));
+        if (fd == -1)
+            return false;
+        ::close(fd);
+        return true;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+NativeLauncher *NativeLauncher::instance()
+{
+    static NativeLauncher *launcher = nullptr;
+    if (launcher == nullptr)
+        launcher = new NativeLauncher();
+    return launcher;
+}
+
+NativeLaunch::NativeLaunch(NativeLauncher *launcher, int id, QObject *parent)
+    : QObject(parent), launcher(launcher), id(id)
+{
+}
+
+NativeLaunch::~NativeLaunch()
+{
+    launcher->forget(id);
+}
+
+NativeLaunch *NativeLauncher::launch(const Request &request, QObject *parent)
+{
+    QMutexLocker locker(&mutex);
+    const int id = nextId++;
+    auto *result = new NativeLaunch(this, id, parent);
+    receivers.insert(id, result);
+    pendingLaunches.push_back({id, request});
+    locker.unlock();
+    wake();
+    return result;
+}
+
+void NativeLauncher::forget(int id)
+{
+    QMutexLocker locker(&mutex);
+    // the results are delivered only while it's in receivers, so the process is still running if it's there
+    if (receivers.remove(id) == 0)
+        return;
+    pendingKills.push_back(id);
+    locker.unlock();
+    wake();
+}
+
+template <typename Emit> void NativeLauncher::notify(int id, Emit emitSignal, bool last)
+{
+    // the NativeLaunch can't be deleted while the mutex is locked, and the signal is only queued to its receivers
+    QMutexLocker locker(&mutex);
+    auto *receiver = last ? receivers.take(id) : receivers.value(id);
+    if (receiver != nullptr)
+        emitSignal(receiver);
+}
+
+void NativeLauncher::run()
+{
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+    // qWarning is used instead of Core::Log, so the launcher can be built without the rest of the editor
+    epoll_event events[64];
+
+    while (true)
+    {
+        const int count = epoll_wait(epollFd, events, 64, -1);
+        if (count == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            qWarning("NativeLauncher: epoll_wait failed: %s", qPrintable(qt_error_string(errno)));
+            break;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto data = events[i].data.u64;
+
+            if (data == WAKE_UP)
+            {
+                quint64 value;
+                while (::read(eventFd, &value, sizeof value) > 0)
+                    ;
+
+                QMutexLocker locker(&mutex);
+                if (stopping)
+                {
+                    locker.unlock();
+                    for (auto *process : processes)
+                    {
+                        killProcess(process);
+                        waitpid(pid_t(process->pid), nullptr, 0);
+                        closeFd(process->pidFd);
+                        closeFd(process->outFd);
+                        closeFd(process->errFd);
+                        closeFd(process->timerFd);
+                        closeFd(process->cpuTimerFd);
+                        delete process;
+                    }
+                    processes.clear();
+                    return;
+                }
+                const auto launches = pendingLaunches;
+                const auto kills = pendingKills;
+                pendingLaunches.clear();
+                pendingKills.clear();
+                locker.unlock();
+
+                for (auto const &launch : launches)
+                    spawn(launch.first, launch.second);
+                for (int id : kills)
+                {
+                    if (auto *process = processes.value(id))
+                        killProcess(process);
+                }
+                continue;
+            }
+
+            auto *process = processes.value(int(data >> 3));
+            if (process == nullptr) // it's reaped when handling an earlier event
+                continue;
+
+            switch (data & 7)
+            {
+            case Stdout:
+                readOutput(process, true);
+                break;
+            case Stderr:
+                readOutput(process, false);
+                break;
+            case Timer:
+                if (process->cpuTimeLimit > 0)
+                    process->ile = true;
+                else
+                    process->tle = true;
+                killProcess(process);
+                closeFd(process->timerFd);
+                break;
+            case CpuTimer:
+                checkCpuTime(process);
+                break;
+            case Pid:
+                reap(process);
+                break;
+            default:
+                Q_UNREACHABLE();
+                break;
+            }
+        }
+    }
+#endif
+}
+
+void NativeLauncher::wake()
+{
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+    const quint64 value = 1;
+    if (::write(eventFd, &value, sizeof value) == -1)
+        qWarning("NativeLauncher: failed to wake up the launcher thread: %s", qPrintable(qt_error_string(errno)));
+#endif
+}
+
+void NativeLauncher::spawn(int id, const Request &request)
+{
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+    // the stdin is the pre-opened input file, the stdout and stderr are pipes
+    int outPipe[2] = {-1, -1}, errPipe[2] = {-1, -1};
+    const int inputFd = ::open(QFile::encodeName(request.inputPath).constData(), O_RDONLY | O_CLOEXEC);
+    if (inputFd == -1 || pipe2(outPipe, O_CLOEXEC) == -1 || pipe2(errPipe, O_CLOEXEC) == -1)
+    {
+        const auto error = qt_error_string(errno);
+        for (int fd : {inputFd, outPipe[0], outPipe[1], errPipe[0], errPipe[1]})
+        {
+            if (fd != -1)
+                ::close(fd);
+        }
+        const auto message = tr("Failed to open the input file or create the pipes: %1").arg(error);
+        notify(id, [&message](NativeLaunch *launch) { emit launch->failedToLaunch(message); }, true);
+        return;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, inputFd, STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+    const auto workingDirectory = QFile::encodeName(request.workingDirectory);
+    if (!workingDirectory.isEmpty())
+        posix_spawn_file_actions_addchdir_np(&actions, workingDirectory.constData());
+
+    // the launcher thread may have blocked or ignored signals, the child process should start with the defaults
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attributes, &signals);
+    sigaddset(&signals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &signals);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    QVector<QByteArray> arguments{QFile::encodeName(request.program)};
+    for (auto const &arg : request.args)
+        arguments.push_back(arg.toLocal8Bit());
+    QVector<char *> argv;
+    for (auto &arg : arguments)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    pid_t pid = -1;
+    int error;
+    std::unique_ptr<PerfCounters> counters;
+    if (request.countEvents)
+    {
+        // posix_spawn can't run code before exec, and a short program may have exited before the counters are attached
+        // after it returns, so the slower fork is used to attach them while the child process waits
+        counters.reset(new PerfCounters);
+        error = forkWithCounters(&pid, request.program, argv.data(), inputFd, outPipe[1], errPipe[1], workingDirectory,
+                                 counters.get());
+    }
+    else
+    {
+        // glibc implements posix_spawn with clone(CLONE_VM | CLONE_VFORK), which doesn't copy the page tables
+        error = posix_spawnp(&pid, argv.first(), &actions, &attributes, argv.data(), environ);
+    }
+    const auto startTime = std::chrono::steady_clock::now();
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    ::close(inputFd);
+    ::close(outPipe[1]);
+    ::close(errPipe[1]);
+
+    if (error != 0)
+    {
+        ::close(outPipe[0]);
+        ::close(errPipe[0]);
+        const auto message = tr("Failed to start %1: %2").arg(request.program, qt_error_string(error));
+        notify(id, [&message](NativeLaunch *launch) { emit launch->failedToLaunch(message); }, true);
+        return;
+    }
+
+    auto *process = new Process;
+    process->id = id;
+    process->pid = pid;
+    process->startTime = startTime;
+    process->counters = std::move(counters);
+    process->outputLimit = request.outputLimit;
+    process->outFd = outPipe[0];
+    process->errFd = errPipe[0];
+    process->pidFd = int(syscall(SYS_pidfd_open, pid, 0));
+    process->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+
+    if (request.cpuTimeLimit > 0)
+    {
+        process->cpuTimeLimit = request.cpuTimeLimit;
+        process->cpuTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    }
+
+    if (process->pidFd == -1 || process->timerFd == -1 || (request.cpuTimeLimit > 0 && process->cpuTimerFd == -1))
+    {
+        const auto error = qt_error_string(errno);
+        ::kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        closeFd(process->pidFd);
+        closeFd(process->outFd);
+        closeFd(process->errFd);
+        closeFd(process->timerFd);
+        closeFd(process->cpuTimerFd);
+        delete process;
+        const auto message = tr("Failed to watch the process: %1").arg(error);
+        notify(id, [&message](NativeLaunch *launch) { emit launch->failedToLaunch(message); }, true);
+        return;
+    }
+
+    // only the read ends are non-blocking, the child process gets blocking stdout and stderr
+    for (int fd : {process->outFd, process->errFd})
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    setTimer(process->timerFd, request.timeLimit);
+
+    if (request.cpuTimeLimit > 0)
+    {
+        // RLIMIT_CPU is in seconds, so it's only a fallback in case the launcher thread is too late to kill it.
+        // The CPU time of a single thread is never more than the wall time, so it's checked when the wall time reaches
+        // the CPU time limit, and then again after the remaining CPU time.
+        rlimit cpuLimit{};
+        cpuLimit.rlim_cur = rlim_t((request.cpuTimeLimit + 999) / 1000);
+        cpuLimit.rlim_max = cpuLimit.rlim_cur + 1;
+        prlimit(pid, RLIMIT_CPU, &cpuLimit, nullptr);
+        setTimer(process->cpuTimerFd, request.cpuTimeLimit);
+    }
+
+    const auto watch = [this, id](int fd, FdKind kind) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = eventData(id, kind);
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    };
+    watch(process->outFd, Stdout);
+    watch(process->errFd, Stderr);
+    watch(process->pidFd, Pid);
+    watch(process->timerFd, Timer);
+    if (process->cpuTimerFd != -1)
+        watch(process->cpuTimerFd, CpuTimer);
+
+    processes.insert(id, process);
+    notify(id, [process](NativeLaunch *launch) { emit launch->launched(process->pid); });
+#else
+    Q_UNUSED(request)
+    const auto message = tr("The native launcher is not supported on this system");
+    notify(id, [&message](NativeLaunch *launch) { emit launch->failedToLaunch(message); }, true);
+#endif
+}
+
+void NativeLauncher::killProcess(Process *process)
+{
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+    // the pidfd refers to this process even if the pid is reused
+    if (process->pidFd != -1)
+        syscall(SYS_pidfd_send_signal, process->pidFd, SIGKILL, nullptr, 0);
+#else
+    Q_UNUSED(process)
+#endif
+}
+
+void NativeLauncher::checkCpuTime(Process *process)
+{
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+    const auto cpuTime = cpuTimeOf(process->pid);
+    if (cpuTime == -1) // it has exited, the CPU time is checked when it's reaped
+    {
+        closeFd(process->cpuTimerFd);
+        return;
+    }
+    if (cpuTime >= process->cpuTimeLimit)
+    {
+        process->tle = true;
+        killProcess(process);
+        closeFd(process->cpuTimerFd);
+        return;
+    }
+    setTimer(process->cpuTimerFd, qMax(process->cpuTimeLimit - cpuTime, qint64(1)));
+#else
+    Q_UNUSED(process)
+#endif
+}
+
+void NativeLauncher::readOutput(Process *process, bool isStdout)
+{
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+    int &fd = isStdout ? process->outFd : process->errFd;
+    auto &buffer = isStdout ? process->out : process->err;
+    char chunk[65536];
+
+    while (fd != -1)
+    {
+        const auto size = ::read(fd, chunk, sizeof chunk);
+        if (size > 0)
+        {
+            if (process->outputLimitExceeded)
+                continue; // the process is being killed, drop the rest
+            buffer.append(chunk, int(size));
+            if (process->outputLimit > 0 && buffer.size() > process->outputLimit)
+            {
+                process->outputLimitExceeded = true;
+                killProcess(process);
+                notify(process->id, [isStdout](NativeLaunch *launch) {
+                    emit launch->outputLimitExceeded(isStdout ? "stdout" : "stderr");
+                });
+            }
+        }
+        else if (size == -1 && errno == EINTR)
+            continue;
+        else if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        else
+            closeFd(fd); // EOF or error
+    }
+#else
+    Q_UNUSED(process)
+    Q_UNUSED(isStdout)
+#endif
+}
+
+void NativeLauncher::reap(Process *process)
+{
+#ifdef NATIVE_LAUNCHER_SUPPORTED
+    int status = 0;
+    rusage usage{};
+    pid_t result;
+    do
+        result = wait4(pid_t(process->pid), &status, WNOHANG, &usage);
+    while (result == -1 && errno == EINTR);
+    if (result == 0) // not exited yet
+        return;
+
+    const auto timeUsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - process->startTime)
+            .count();
+
+    // everything written by the process is in the pipes now, the pipes may be kept open by its own children
+    readOutput(process, true);
+    readOutput(process, false);
+    closeFd(process->pidFd);
+    closeFd(process->outFd);
+    closeFd(process->errFd);
+    closeFd(process->timerFd);
+    closeFd(process->cpuTimerFd);
+
+    int exitCode = -1;
+    bool crashed = false;
+    qint64 cpuTimeUsed = -1;
+    if (result != -1)
+    {
+        crashed = WIFSIGNALED(status);
+        exitCode = crashed ? WTERMSIG(status) : WEXITSTATUS(status);
+        cpuTimeUsed = (qint64(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000 +
+                      (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+    }
+
+    // the process may have exceeded the CPU time limit a little before it exited or was killed
+    if (process->cpuTimeLimit > 0 && (cpuTimeUsed > process->cpuTimeLimit ||
+                                      (WIFSIGNALED(status) && WTERMSIG(status) == SIGXCPU)))
+        process->tle = true;
+    if (process->tle)
+        process->ile = false;
+
+    processes.remove(process->id);
+    if (process->counters)
+    {
+        const auto counters = process->counters->read();
+        notify(process->id, [&counters](NativeLaunch *launch) { emit launch->countersRead(counters); });
+    }
+    notify(
+        process->id,
+        [&](NativeLaunch *launch) {
+            emit launch->finished(process->out, process->err, exitCode, crashed, timeUsed, cpuTimeUsed, process->tle,
+                                  process->ile);
+        },
+        true);
+    delete process;
+#else
+    Q_UNUSED(process)
+#endif
+}
+
+void NativeLauncher::closeFd(int &fd)
+{
+#ifdef Q_OS_LINUX
+    if (fd != -1)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+} // namespace Core
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The NativeLauncher starts processes by posix_spawn on Linux instead of QProcess.
+ * The stdin of a process is a pre-opened file and the stdout/stderr are pipes. All processes are watched by a single
+ * epoll loop on the thread of the launcher: the pipes are read there, the time limits are timerfds and the processes
+ * are reaped through their pidfds, so nothing goes through the GUI event loop until the results are ready.
+ * The launcher is shared by all Runners. Each launch has its own NativeLaunch object which receives the results by
+ * queued signals, so a result is delivered only to the one waiting for it.
+ * It requires glibc 2.29 and Linux 5.3 or newer, see isSupported.
+ */
+
+#ifndef NATIVELAUNCHER_HPP
+#define NATIVELAUNCHER_HPP
+
+#include "Core/PerfCounters.hpp"
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+namespace Core
+{
+
+class NativeLauncher;
+
+// the results of a launch by Core::NativeLauncher, the signals are emitted on the launcher thread
+class NativeLaunch : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief kill the process if it's still running, no more signals are emitted after this
+     */
+    ~NativeLaunch() override;
+
+  signals:
+    /**
+     * @brief the process has been spawned
+     * @param pid the pid of the process
+     */
+    void launched(qint64 pid);
+
+    /**
+     * @brief failed to spawn the process
+     */
+    void failedToLaunch(const QString &error);
+
+    /**
+     * @brief the stdout/stderr of the process is too long, the process is killed
+     * @param type either stdout or stderr
+     */
+    void outputLimitExceeded(const QString &type);
+
+    /**
+     * @brief the hardware events of the process are counted, it's emitted right before finished
+     * @note it's only emitted if countEvents is set in the request
+     */
+    void countersRead(const Core::PerfCounters::Counters &counters);
+
+    /**
+     * @brief the process has exited and it's outputs are read
+     * @param exitCode the exit code of the process, or the signal number if it's crashed
+     * @param crashed whether the process is killed by a signal
+     * @param timeUsed the time between the process is spawned and it's reaped, in milliseconds
+     * @param cpuTimeUsed the user and system CPU time used by the process, in milliseconds
+     * @param tle whether the time limit is exceeded, it's the CPU time limit if there is one
+     * @param ile whether the wall time limit is exceeded while the CPU time limit is not, i.e. the process is idle or
+     * blocked, this is only possible when there is a CPU time limit
+     */
+    void finished(const QByteArray &out, const QByteArray &err, int exitCode, bool crashed, qint64 timeUsed,
+                  qint64 cpuTimeUsed, bool tle, bool ile);
+
+  private:
+    friend class NativeLauncher;
+
+    NativeLaunch(NativeLauncher *launcher, int id, QObject *parent);
+
+    NativeLauncher *const launcher; // the launcher of the process
+    const int id;                   // the id of the launch in the launcher
+};
+
+class NativeLauncher : public QThread
+{
+    Q_OBJECT
+
+  public:
+    // the information needed to launch a process
+    struct Request
+    {
+        QString program;          // the program to run, searched in PATH if it's not a path
+        QStringList args;         // the arguments of the program
+        QString workingDirectory; // the working directory of the process, empty for the current one
+        QString inputPath;        // the file used as the stdin of the process
+        int timeLimit = 0;        // the process is killed after this wall time in milliseconds
+        int cpuTimeLimit = 0;     // the process is killed after using this CPU time in milliseconds, 0 for no limit
+        qint64 outputLimit = 0;   // the process is killed if its stdout or stderr is longer than this
+        bool countEvents = false; // whether to count the hardware events of the process, see Core::PerfCounters
+    };
+
+    /**
+     * @brief whether the launcher can be used on this system
+     */
+    static bool isSupported();
+
+    /**
+     * @brief get the launcher, it's started when it's used for the first time
+     * @note the launcher is deleted when the thread calling this for the first time finishes
+     */
+    static NativeLauncher *instance();
+
+    /**
+     * @brief kill all running processes and stop the launcher thread
+     */
+    ~NativeLauncher() override;
+
+    /**
+     * @brief launch a process
+     * @param parent the parent of the returned NativeLaunch
+     * @returns the object receiving the results, delete it to kill the process
+     * @note this is thread-safe, the signals of the NativeLaunch are emitted on the launcher thread, so they should be
+     *       received by queued connections
+     */
+    NativeLaunch *launch(const Request &request, QObject *parent = nullptr);
+
+  protected:
+    void run() override;
+
+  private:
+    struct Process;
+
+    friend class NativeLaunch;
+
+    NativeLauncher();
+
+    /**
+     * @brief wake up the epoll loop to handle the pending launches and kills
+     */
+    void wake();
+
+    /**
+     * @brief stop delivering the results of a launch, and kill the process if it's still running
+     * @note this is thread-safe, it's called when the NativeLaunch is deleted
+     */
+    void forget(int id);
+
+    /**
+     * @brief emit a signal of the NativeLaunch of a launch, if it's not deleted
+     * @param last whether it's the last signal of the launch
+     */
+    template <typename Emit> void notify(int id, Emit emitSignal, bool last = false);
+
+    void spawn(int id, const Request &request);
+    void killProcess(Process *process);
+    void checkCpuTime(Process *process);
+    void readOutput(Process *process, bool isStdout);
+    void reap(Process *process);
+    void closeFd(int &fd);
+
+    int epollFd = -1;                             // the epoll instance watching everything
+    int eventFd = -1;                             // used to wake up the epoll loop
+    QHash<int, Process *> processes;              // the running processes, only used on the launcher thread
+    QMutex mutex;                                 // protects the members below
+    int nextId = 0;                               // the id of the next launch
+    QHash<int, NativeLaunch *> receivers;         // the NativeLaunch of each launch whose results are not delivered
+    QVector<QPair<int, Request>> pendingLaunches; // the launches waiting for the epoll loop
+    QVector<int> pendingKills;                    // the ids of the processes to be killed
+    bool stopping = false;                        // whether the launcher is being destructed
+};
+
+} // namespace Core
+
+#endif // NATIVELAUNCHER_HPP
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/PerfCounters.hpp"
+#include <QCoreApplication>
+#include <QFile>
+#include <cerrno>
+
+#ifdef Q_OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Core
+{
+
+#ifdef Q_OS_LINUX
+namespace
+{
+const quint64 EVENTS[] = {PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES,
+                          PERF_COUNT_HW_BRANCH_MISSES};
+
+int openCounter(qint64 pid, quint64 config, int groupFd)
+{
+    perf_event_attr attr{};
+    attr.size = sizeof attr;
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // the process is attached before exec, only the program after exec is counted
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    // the counters may be multiplexed if there are not enough hardware counters, the times are used for scaling
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return int(syscall(SYS_perf_event_open, &attr, pid_t(pid), -1, groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+} // namespace
+#endif
+
+QString PerfCounters::errorString(int error)
+{
+    if (error == EACCES || error == EPERM)
+    {
+        QFile file("/proc/sys/kernel/perf_event_paranoid");
+        const auto paranoid = file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll()).trimmed() : "?";
+        return QCoreApplication::translate(
+                   "Core::PerfCounters",
+                   "The access to the performance counters is denied. /proc/sys/kernel/perf_event_paranoid is %1, it "
+                   "should be 2 or lower.")
+            .arg(paranoid);
+    }
+    if (error == ENOENT || error == EOPNOTSUPP || error == ENODEV)
+    {
+        return QCoreApplication::translate("Core::PerfCounters",
+                                           "The hardware performance counters are not supported on this system.");
+    }
+    return QCoreApplication::translate("Core::PerfCounters", "Failed to open the performance counters: %1")
+        .arg(qt_error_string(error));
+}
+
+bool PerfCounters::Counters::isValid() const
+{
+    return instructions != -1 || cycles != -1 || cacheMisses != -1 || branchMisses != -1;
+}
+
+double PerfCounters::Counters::ipc() const
+{
+    if (instructions == -1 || cycles <= 0)
+        return -1;
+    return double(instructions) / double(cycles);
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef Q_OS_LINUX
+    for (int fd : fds)
+    {
+        if (fd != -1)
+            ::close(fd);
+    }
+#endif
+}
+
+void PerfCounters::attach(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    // the counters are in a group so that they are scheduled together, a counter which can't join the group is opened
+    // alone, e.g. when there are not enough hardware counters
+    for (int i = 0; i < 4; ++i)
+    {
+        if (i > 0 && fds[0] != -1)
+            fds[i] = openCounter(pid, EVENTS[i], fds[0]);
+        if (fds[i] == -1)
+            fds[i] = openCounter(pid, EVENTS[i], -1);
+        if (fds[i] == -1 && error.isEmpty())
+            error = errorString(errno);
+    }
+#else
+    Q_UNUSED(pid)
+    error = QCoreApplication::translate("Core::PerfCounters", "The performance counters are only supported on Linux.");
+#endif
+}
+
+PerfCounters::Counters PerfCounters::read() const
+{
+    Counters counters;
+    counters.error = error;
+
+#ifdef Q_OS_LINUX
+    qint64 *values[] = {&counters.instructions, &counters.cycles, &counters.cacheMisses, &counters.branchMisses};
+    for (int i = 0; i < 4; ++i)
+    {
+        quint64 data[3]; // value, time enabled, time running
+        if (fds[i] == -1 || ::read(fds[i], data, sizeof data) != sizeof data)
+            continue;
+        if (data[2] == 0)
+        {
+            // opened but never on the PMU, e.g. the exec failed or the hardware counters are taken by other events
+            if (counters.error.isEmpty())
+            {
+                counters.error = QCoreApplication::translate(
+                    "Core::PerfCounters", "The performance counters were not scheduled while the program was running.");
+            }
+            continue;
+        }
+        if (data[2] < data[1]) // multiplexed, scale it to the whole time
+            *values[i] = qint64(double(data[0]) * double(data[1]) / double(data[2]));
+        else
+            *values[i] = qint64(data[0]);
+    }
+#endif
+
+    return counters;
+}
+
+void PerfCounters::registerMetaType()
+{
+    qRegisterMetaType<Core::PerfCounters::Counters>();
+}
+
+} // namespace Core
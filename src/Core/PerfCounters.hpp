@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The PerfCounters counts the hardware events of a process by perf_event_open on Linux.
+ * The counters are inherited by the threads and the child processes of the process. Only the user space is counted,
+ * which is allowed for the processes of the same user when /proc/sys/kernel/perf_event_paranoid is 2 or lower.
+ * If some counters can't be opened, e.g. the access is denied or there is no PMU in a virtual machine, they are
+ * reported as unknown with the reason, and the execution isn't affected.
+ * The counters should be attached before the process calls exec, and they are enabled by the exec, otherwise a short
+ * program may have exited before they are attached.
+ * It doesn't depend on the other parts of the editor, so it can be used on any thread.
+ */
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <QMetaType>
+#include <QString>
+
+namespace Core
+{
+
+class PerfCounters
+{
+  public:
+    // the counted events of a process, -1 for unknown
+    struct Counters
+    {
+        qint64 instructions = -1; // the number of retired instructions
+        qint64 cycles = -1;       // the number of CPU cycles
+        qint64 cacheMisses = -1;  // the number of last level cache misses
+        qint64 branchMisses = -1; // the number of mispredicted branches
+        QString error;            // why some of the events are not counted, empty if all of them are counted
+
+        /**
+         * @brief whether any of the events is counted
+         */
+        bool isValid() const;
+
+        /**
+         * @brief the instructions per cycle, -1 if it's unknown
+         */
+        double ipc() const;
+    };
+
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /**
+     * @brief close the counters
+     */
+    ~PerfCounters();
+
+    /**
+     * @brief start counting the events of a process when it calls exec
+     * @param pid the process to count, it should be waiting before exec
+     */
+    void attach(qint64 pid);
+
+    /**
+     * @brief read the counters
+     * @note the counts of the child processes are added when they exit, so read them after the process is reaped
+     */
+    Counters read() const;
+
+    /**
+     * @brief register Counters for the queued connections
+     */
+    static void registerMetaType();
+
+    /**
+     * @brief get the reason why perf_event_open fails
+     * @param error the errno set by perf_event_open
+     */
+    static QString errorString(int error);
+
+  private:
+    int fds[4] = {-1, -1, -1, -1}; // the counters of instructions, cycles, cache misses and branch misses
+    QString error;                 // why some of the counters can't be opened
+};
+
+} // namespace Core
+
+Q_DECLARE_METATYPE(Core::PerfCounters::Counters)
+
+#endif // PERFCOUNTERS_HPP
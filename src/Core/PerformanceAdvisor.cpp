@@ -0,0 +1,688 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/PerformanceAdvisor.hpp"
+#include <QCoreApplication>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <algorithm>
+
+namespace Core
+{
+
+namespace
+{
+struct Token
+{
+    enum Kind
+    {
+        Identifier,
+        Number,
+        String,
+        Punctuation,
+        Directive // a preprocessor directive in C++, the whole line is a token
+    };
+
+    Kind kind;
+    QString text;
+    int line;       // starting from 1
+    int column;     // starting from 0
+    bool lineStart; // whether it's the first token on its line
+};
+
+class Tokenizer
+{
+  public:
+    Tokenizer(const QString &code, const QString &lang) : code(code), lang(lang)
+    {
+    }
+
+    QVector<Token> tokenize()
+    {
+        QVector<Token> tokens;
+        bool lineStart = true;
+        while (pos < code.size())
+        {
+            const QChar c = code[pos];
+            if (c == '\n')
+            {
+                advance();
+                lineStart = true;
+                continue;
+            }
+            if (c.isSpace())
+            {
+                advance();
+                continue;
+            }
+
+            Token token{Token::Punctuation, QString(), line, column, lineStart};
+            const int begin = pos;
+
+            if (lang == "Python" ? c == '#' : startsWith("//"))
+            {
+                skipUntil("\n", false);
+                continue;
+            }
+            if (lang != "Python" && startsWith("/*"))
+            {
+                skipUntil("*/", true);
+                continue;
+            }
+
+            if (lang == "C++" && c == '#' && lineStart)
+            {
+                token.kind = Token::Directive;
+                // a directive ends at a new line which is not escaped
+                while (pos < code.size() && (code[pos] != '\n' || code[pos - 1] == '\\'))
+                    advance();
+            }
+            else if (c.isLetter() || c == '_')
+            {
+                while (pos < code.size() && (code[pos].isLetterOrNumber() || code[pos] == '_'))
+                    advance();
+                const auto word = code.mid(begin, pos - begin);
+                if (pos < code.size() && (code[pos] == '"' || code[pos] == '\'') && isStringPrefix(word))
+                {
+                    token.kind = Token::String;
+                    skipString(word.contains('R', Qt::CaseInsensitive));
+                }
+                else
+                {
+                    token.kind = Token::Identifier;
+                }
+            }
+            else if (c.isDigit())
+            {
+                token.kind = Token::Number;
+                while (pos < code.size() && (code[pos].isLetterOrNumber() || code[pos] == '.' || code[pos] == '\''))
+                    advance();
+            }
+            else if (c == '"' || c == '\'')
+            {
+                token.kind = Token::String;
+                skipString(false);
+            }
+            else
+            {
+                static const QStringList operators = {"::", "&&", "->"};
+                const auto op = std::find_if(operators.cbegin(), operators.cend(),
+                                             [this](const QString &op) { return startsWith(op); });
+                advance(op == operators.cend() ? 1 : op->size());
+            }
+
+            token.text = code.mid(begin, pos - begin);
+            tokens.push_back(token);
+            lineStart = false;
+        }
+        return tokens;
+    }
+
+  private:
+    bool startsWith(const QString &str) const
+    {
+        return code.midRef(pos, str.size()) == str;
+    }
+
+    void advance(int count = 1)
+    {
+        while (count-- > 0 && pos < code.size())
+        {
+            if (code[pos] == '\n')
+            {
+                ++line;
+                column = 0;
+            }
+            else
+            {
+                ++column;
+            }
+            ++pos;
+        }
+    }
+
+    void skipUntil(const QString &end, bool skipEnd)
+    {
+        while (pos < code.size() && !startsWith(end))
+            advance();
+        if (skipEnd)
+            advance(end.size());
+    }
+
+    bool isStringPrefix(const QString &word) const
+    {
+        if (lang == "C++")
+            return QStringList({"L", "u", "U", "u8", "R", "LR", "uR", "UR", "u8R"}).contains(word);
+        if (lang == "Python")
+            return word.size() <= 2 && QString(word).remove(QRegularExpression("[rRbBuUfF]")).isEmpty();
+        return false;
+    }
+
+    // skip a string starting at pos, which is a quote
+    void skipString(bool raw)
+    {
+        const QChar quote = code[pos];
+        if (raw && lang == "C++")
+        {
+            // R"delimiter(...)delimiter"
+            const int open = code.indexOf('(', pos);
+            if (open == -1)
+            {
+                advance(code.size() - pos);
+                return;
+            }
+            const auto end = ")" + code.mid(pos + 1, open - pos - 1) + quote;
+            advance(open - pos);
+            skipUntil(end, true);
+            return;
+        }
+
+        if ((lang == "Python" || lang == "Java") && startsWith(QString(3, quote)))
+        {
+            // triple-quoted strings in Python and text blocks in Java
+            advance(3);
+            while (pos < code.size() && !startsWith(QString(3, quote)))
+                advance(code[pos] == '\\' ? 2 : 1);
+            advance(3);
+            return;
+        }
+
+        advance();
+        while (pos < code.size() && code[pos] != quote && code[pos] != '\n')
+            advance(code[pos] == '\\' ? 2 : 1);
+        advance();
+    }
+
+    const QString &code;
+    const QString &lang;
+    int pos = 0;
+    int line = 1;
+    int column = 0;
+};
+
+bool isIdentifier(const QVector<Token> &tokens, int index, const QString &text)
+{
+    return index >= 0 && index < tokens.size() && tokens[index].kind == Token::Identifier &&
+           tokens[index].text == text;
+}
+
+bool isPunctuation(const QVector<Token> &tokens, int index, const QString &text)
+{
+    return index >= 0 && index < tokens.size() && tokens[index].kind == Token::Punctuation &&
+           tokens[index].text == text;
+}
+
+// the index of the bracket matching the opening bracket at index, or tokens.size() if it's not closed
+int matchingBracket(const QVector<Token> &tokens, int index)
+{
+    const auto open = tokens[index].text;
+    const QString close = open == "(" ? ")" : open == "[" ? "]" : open == "{" ? "}" : ">";
+    int depth = 0;
+    for (int i = index; i < tokens.size(); ++i)
+    {
+        if (tokens[i].kind != Token::Punctuation)
+            continue;
+        if (tokens[i].text == open)
+            ++depth;
+        else if (tokens[i].text == close && --depth == 0)
+            return i;
+        else if (open == "<" && (tokens[i].text == ";" || tokens[i].text == "{" || tokens[i].text == ")"))
+            break; // it's a less-than operator rather than a template argument list
+    }
+    return tokens.size();
+}
+
+// whether each token is executed repeatedly in a loop, for languages with C-like syntax
+QVector<bool> loopTokensOfCLike(const QVector<Token> &tokens)
+{
+    QVector<bool> inLoop(tokens.size(), false);
+    QVector<bool> braceIsLoop;   // whether each open brace is in a loop
+    QVector<int> statementLoops; // the brace depths of the loops whose bodies are single statements
+    bool expectingBody = false;  // whether the next token starts the body of a loop
+
+    for (int i = 0; i < tokens.size(); ++i)
+    {
+        const auto &token = tokens[i];
+        const bool looping = (!braceIsLoop.isEmpty() && braceIsLoop.back()) || !statementLoops.isEmpty();
+
+        if (expectingBody)
+        {
+            expectingBody = false;
+            if (isPunctuation(tokens, i, "{"))
+            {
+                braceIsLoop.push_back(true);
+                inLoop[i] = true;
+                continue;
+            }
+            if (isPunctuation(tokens, i, ";"))
+                continue; // an empty body, or the end of a do-while loop
+            statementLoops.push_back(braceIsLoop.size());
+        }
+
+        if ((isIdentifier(tokens, i, "for") || isIdentifier(tokens, i, "while")) && isPunctuation(tokens, i + 1, "("))
+        {
+            // the condition and the increment are executed in every iteration
+            const int close = matchingBracket(tokens, i + 1);
+            for (int j = i; j <= close && j < tokens.size(); ++j)
+                inLoop[j] = true;
+            i = close;
+            expectingBody = true;
+            continue;
+        }
+        if (isIdentifier(tokens, i, "do"))
+        {
+            expectingBody = true;
+            continue;
+        }
+
+        inLoop[i] = looping || !statementLoops.isEmpty();
+
+        if (isPunctuation(tokens, i, "{"))
+        {
+            braceIsLoop.push_back(inLoop[i]);
+        }
+        else if (isPunctuation(tokens, i, "}"))
+        {
+            if (!braceIsLoop.isEmpty())
+                braceIsLoop.pop_back();
+            while (!statementLoops.isEmpty() && statementLoops.back() >= braceIsLoop.size())
+                statementLoops.pop_back();
+        }
+        else if (isPunctuation(tokens, i, ";"))
+        {
+            while (!statementLoops.isEmpty() && statementLoops.back() == braceIsLoop.size())
+                statementLoops.pop_back();
+        }
+    }
+
+    return inLoop;
+}
+
+// whether each token is executed repeatedly in a loop or a comprehension, for Python
+QVector<bool> loopTokensOfPython(const QVector<Token> &tokens)
+{
+    QVector<bool> inLoop(tokens.size(), false);
+    QVector<int> loopIndents; // the indents of the loop statements containing the current line
+    int depth = 0;            // the depth of the brackets, a logical line doesn't end in brackets
+
+    for (int begin = 0, end; begin < tokens.size(); begin = end)
+    {
+        // find the end of the logical line
+        for (end = begin; end < tokens.size(); ++end)
+        {
+            if (end > begin && tokens[end].lineStart && depth == 0 && !isPunctuation(tokens, end - 1, "\\"))
+                break;
+            if (tokens[end].kind == Token::Punctuation)
+            {
+                if (QString("([{").contains(tokens[end].text))
+                    ++depth;
+                else if (QString(")]}").contains(tokens[end].text) && depth > 0)
+                    --depth;
+            }
+        }
+
+        const int indent = tokens[begin].column;
+        while (!loopIndents.isEmpty() && loopIndents.back() >= indent)
+            loopIndents.pop_back();
+
+        const bool loopStatement = isIdentifier(tokens, begin, "for") || isIdentifier(tokens, begin, "while") ||
+                                   (isIdentifier(tokens, begin, "async") && isIdentifier(tokens, begin + 1, "for"));
+        bool comprehension = false;
+        for (int i = begin + 1; i < end; ++i)
+            comprehension |= isIdentifier(tokens, i, "for") && !loopStatement;
+
+        // the body of a loop statement can be on the same line, after the colon out of brackets
+        bool afterColon = false;
+        int lineDepth = 0;
+        for (int i = begin; i < end; ++i)
+        {
+            inLoop[i] = !loopIndents.isEmpty() || comprehension || (loopStatement && afterColon);
+            if (tokens[i].kind != Token::Punctuation)
+                continue;
+            if (QString("([{").contains(tokens[i].text))
+                ++lineDepth;
+            else if (QString(")]}").contains(tokens[i].text))
+                --lineDepth;
+            else if (tokens[i].text == ":" && lineDepth == 0)
+                afterColon = true;
+        }
+
+        if (loopStatement)
+            loopIndents.push_back(indent);
+    }
+
+    return inLoop;
+}
+
+class Analyzer
+{
+    Q_DECLARE_TR_FUNCTIONS(Core::PerformanceAdvisor)
+
+  public:
+    Analyzer(const QString &code, const QString &lang) : lang(lang), tokens(Tokenizer(code, lang).tokenize())
+    {
+        inLoop = lang == "Python" ? loopTokensOfPython(tokens) : loopTokensOfCLike(tokens);
+    }
+
+    QVector<PerformanceAdvisor::Finding> analyze()
+    {
+        if (lang == "C++")
+        {
+            checkEndlInLoops();
+            checkUnsyncedCin();
+            checkContainersPassedByValue();
+            checkMapsWithIntegerKeys();
+        }
+        else if (lang == "Java")
+        {
+            checkScanner();
+            checkSystemOutInLoops();
+        }
+        else if (lang == "Python")
+        {
+            checkPythonIOInLoops();
+        }
+
+        std::sort(findings.begin(), findings.end(), [](const auto &lhs, const auto &rhs) {
+            return qMakePair(lhs.startLine, lhs.startColumn) < qMakePair(rhs.startLine, rhs.startColumn);
+        });
+        return findings;
+    }
+
+  private:
+    void report(PerformanceAdvisor::Severity severity, int first, int last, const QString &message,
+                const QString &fix)
+    {
+        PerformanceAdvisor::Finding finding;
+        finding.severity = severity;
+        finding.startLine = tokens[first].line;
+        finding.startColumn = tokens[first].column;
+        finding.endLine = tokens[last].line;
+        finding.endColumn = tokens[last].column + tokens[last].text.size();
+        finding.message = message;
+        finding.fix = fix;
+        findings.push_back(finding);
+    }
+
+    bool containsIdentifier(const QString &text) const
+    {
+        return std::any_of(tokens.cbegin(), tokens.cend(), [&text](const Token &token) {
+            return token.kind == Token::Identifier && token.text == text;
+        });
+    }
+
+    // whether the name is defined as a macro, e.g. "#define endl '\n'"
+    bool isMacro(const QString &name) const
+    {
+        const QRegularExpression regex(QString(R"(^#\s*define\s+%1\b)").arg(QRegularExpression::escape(name)));
+        return std::any_of(tokens.cbegin(), tokens.cend(), [&regex](const Token &token) {
+            return token.kind == Token::Directive && regex.match(token.text).hasMatch();
+        });
+    }
+
+    // the index of the first token of a name which may be qualified by "std::"
+    int qualifiedBegin(int index) const
+    {
+        if (isPunctuation(tokens, index - 1, "::") && isIdentifier(tokens, index - 2, "std"))
+            return index - 2;
+        return index;
+    }
+
+    void checkEndlInLoops()
+    {
+        if (isMacro("endl"))
+            return;
+        for (int i = 0; i < tokens.size(); ++i)
+        {
+            if (inLoop[i] && isIdentifier(tokens, i, "endl"))
+            {
+                report(PerformanceAdvisor::Warning, qualifiedBegin(i), i,
+                       tr("std::endl flushes the output stream every time, which is slow in a loop."),
+                       tr("Use '\\n' instead, the output is flushed when the program exits."));
+            }
+        }
+    }
+
+    void checkUnsyncedCin()
+    {
+        if (containsIdentifier("sync_with_stdio"))
+            return;
+        for (int i = 0; i < tokens.size(); ++i)
+        {
+            if (isIdentifier(tokens, i, "cin") && !isPunctuation(tokens, i - 1, "."))
+            {
+                report(PerformanceAdvisor::Warning, qualifiedBegin(i), i,
+                       tr("cin is synchronized with the C standard streams, which makes reading large input slow."),
+                       tr("Add \"ios::sync_with_stdio(false); cin.tie(nullptr);\" at the beginning of main, and "
+                          "don't mix cin with scanf after that."));
+                return;
+            }
+        }
+    }
+
+    void checkContainersPassedByValue()
+    {
+        static const QSet<QString> notFunctions = {"if", "for", "while", "switch", "catch", "return", "sizeof"};
+
+        for (int open = 1; open < tokens.size(); ++open)
+        {
+            // a function definition or a lambda: "name(...) {" or "](...) {", maybe with "const" or "mutable"
+            if (!isPunctuation(tokens, open, "("))
+                continue;
+            const bool function = tokens[open - 1].kind == Token::Identifier &&
+                                  !notFunctions.contains(tokens[open - 1].text);
+            if (!function && !isPunctuation(tokens, open - 1, "]"))
+                continue;
+            const int close = matchingBracket(tokens, open);
+            int next = close + 1;
+            while (isIdentifier(tokens, next, "const") || isIdentifier(tokens, next, "mutable") ||
+                   isIdentifier(tokens, next, "noexcept"))
+                ++next;
+            if (!isPunctuation(tokens, next, "{"))
+                continue;
+
+            // check the parameters separated by the commas out of brackets
+            for (int first = open + 1, last; first < close; first = last + 1)
+            {
+                int depth = 0;
+                for (last = first; last < close; ++last)
+                {
+                    if (tokens[last].kind != Token::Punctuation)
+                        continue;
+                    if (QString("<([").contains(tokens[last].text))
+                        ++depth;
+                    else if (QString(">)]").contains(tokens[last].text))
+                        --depth;
+                    else if (tokens[last].text == "," && depth == 0)
+                        break;
+                }
+                checkParameter(first, last - 1);
+            }
+        }
+    }
+
+    void checkParameter(int first, int last)
+    {
+        static const QSet<QString> containers = {"vector", "string", "map", "set", "multimap", "multiset",
+                                                 "unordered_map", "unordered_set", "deque", "list", "basic_string"};
+        int type = first;
+        while (isIdentifier(tokens, type, "const"))
+            ++type;
+        if (isIdentifier(tokens, type, "std") && isPunctuation(tokens, type + 1, "::"))
+            type += 2;
+        if (type > last || tokens[type].kind != Token::Identifier || !containers.contains(tokens[type].text))
+            return;
+        for (int i = type; i <= last; ++i)
+        {
+            if (isPunctuation(tokens, i, "&") || isPunctuation(tokens, i, "&&") || isPunctuation(tokens, i, "*"))
+                return;
+        }
+        report(PerformanceAdvisor::Warning, first, last,
+               tr("The %1 is passed by value, so it's copied in every call.").arg(tokens[type].text),
+               tr("Pass it by reference (e.g. \"const %1<...> &\"), unless a copy is really needed.")
+                   .arg(tokens[type].text));
+    }
+
+    void checkMapsWithIntegerKeys()
+    {
+        QSet<QString> integers = {"int", "long", "short", "unsigned", "signed", "char", "size_t", "int64_t",
+                                  "uint64_t", "int32_t", "uint32_t"};
+
+        // the common aliases, e.g. "#define ll long long", "using ll = long long;" and "typedef long long ll;"
+        const QRegularExpression defineRegex(R"(^#\s*define\s+(\w+)\s+((?:\w+\s*)+)$)");
+        for (int i = 0; i < tokens.size(); ++i)
+        {
+            if (tokens[i].kind == Token::Directive)
+            {
+                const auto match = defineRegex.match(tokens[i].text.trimmed());
+                if (match.hasMatch() && isIntegerType(match.captured(2).simplified().split(' '), integers))
+                    integers.insert(match.captured(1));
+            }
+            else if (isIdentifier(tokens, i, "using") && isPunctuation(tokens, i + 2, "="))
+            {
+                const int end = nextSemicolon(i);
+                if (isIntegerType(texts(i + 3, end - 1), integers))
+                    integers.insert(tokens[i + 1].text);
+            }
+            else if (isIdentifier(tokens, i, "typedef"))
+            {
+                const int end = nextSemicolon(i);
+                if (end - i >= 3 && isIntegerType(texts(i + 1, end - 2), integers))
+                    integers.insert(tokens[end - 1].text);
+            }
+        }
+
+        for (int i = 0; i + 1 < tokens.size(); ++i)
+        {
+            if (!isIdentifier(tokens, i, "map") || !isPunctuation(tokens, i + 1, "<"))
+                continue;
+            int comma = i + 2;
+            while (comma < tokens.size() && !isPunctuation(tokens, comma, ",") && !isPunctuation(tokens, comma, ">") &&
+                   !isPunctuation(tokens, comma, ";"))
+                ++comma;
+            if (!isPunctuation(tokens, comma, ",") || !isIntegerType(texts(i + 2, comma - 1), integers))
+                continue;
+            const int close = matchingBracket(tokens, i + 1);
+            if (close == tokens.size())
+                continue;
+            report(PerformanceAdvisor::Information, qualifiedBegin(i), close,
+                   tr("std::map is a balanced binary tree, every operation is O(log n) with poor cache locality."),
+                   tr("If the keys are small, use an array or a vector indexed by the keys. If the order of the keys "
+                      "is not needed, use std::unordered_map with reserve, and a custom hash against anti-hash "
+                      "tests."));
+        }
+    }
+
+    void checkScanner()
+    {
+        for (int i = 0; i + 2 < tokens.size(); ++i)
+        {
+            if (isIdentifier(tokens, i, "new") && isIdentifier(tokens, i + 1, "Scanner") &&
+                isPunctuation(tokens, i + 2, "("))
+            {
+                report(PerformanceAdvisor::Warning, i, i + 1,
+                       tr("Scanner parses the input with regular expressions, which is slow for large input."),
+                       tr("Use a BufferedReader with a StringTokenizer, or a custom reader based on "
+                          "DataInputStream."));
+            }
+        }
+    }
+
+    void checkSystemOutInLoops()
+    {
+        for (int i = 0; i + 4 < tokens.size(); ++i)
+        {
+            if (inLoop[i] && isIdentifier(tokens, i, "System") && isPunctuation(tokens, i + 1, ".") &&
+                isIdentifier(tokens, i + 2, "out") && isPunctuation(tokens, i + 3, ".") &&
+                QStringList({"print", "println", "printf"}).contains(tokens[i + 4].text))
+            {
+                report(PerformanceAdvisor::Information, i, i + 4,
+                       tr("Every call of System.out is synchronized and may flush the output, which is slow in a "
+                          "loop."),
+                       tr("Use a PrintWriter wrapping a BufferedOutputStream and flush it at the end, or append to "
+                          "a StringBuilder and print it once."));
+            }
+        }
+    }
+
+    void checkPythonIOInLoops()
+    {
+        // "input = sys.stdin.readline" makes input() fast
+        bool inputReplaced = false;
+        for (int i = 0; i + 1 < tokens.size(); ++i)
+        {
+            if (tokens[i].lineStart && isIdentifier(tokens, i, "input") && isPunctuation(tokens, i + 1, "="))
+                inputReplaced = true;
+        }
+
+        for (int i = 0; i + 1 < tokens.size(); ++i)
+        {
+            if (!inLoop[i] || !isPunctuation(tokens, i + 1, "(") || isPunctuation(tokens, i - 1, "."))
+                continue;
+            if (isIdentifier(tokens, i, "input") && !inputReplaced)
+            {
+                report(PerformanceAdvisor::Warning, i, i,
+                       tr("input() is slow for reading many lines in a loop."),
+                       tr("Use \"input = sys.stdin.readline\" (and strip the trailing new line if needed), or read "
+                          "the whole input at once by \"sys.stdin.buffer.read().split()\"."));
+            }
+            else if (isIdentifier(tokens, i, "print"))
+            {
+                report(PerformanceAdvisor::Hint, i, i, tr("print() is slow for printing many lines in a loop."),
+                       tr("Collect the lines in a list and print \"\\n\".join(lines) once, or use "
+                          "sys.stdout.write."));
+            }
+        }
+    }
+
+    int nextSemicolon(int index) const
+    {
+        while (index < tokens.size() && !isPunctuation(tokens, index, ";"))
+            ++index;
+        return index;
+    }
+
+    QStringList texts(int first, int last) const
+    {
+        QStringList result;
+        for (int i = first; i <= last && i < tokens.size(); ++i)
+            result.push_back(tokens[i].text);
+        return result;
+    }
+
+    static bool isIntegerType(const QStringList &words, const QSet<QString> &integers)
+    {
+        return !words.isEmpty() && std::all_of(words.cbegin(), words.cend(), [&integers](const QString &word) {
+            return integers.contains(word) || word == "const" || word == "std" || word == "::";
+        });
+    }
+
+    const QString &lang;
+    QVector<Token> tokens;
+    QVector<bool> inLoop; // whether each token is executed repeatedly
+    QVector<PerformanceAdvisor::Finding> findings;
+};
+
+} // namespace
+
+QVector<PerformanceAdvisor::Finding> PerformanceAdvisor::analyze(const QString &code, const QString &lang)
+{
+    return Analyzer(code, lang).analyze();
+}
+
+} // namespace Core
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The PerformanceAdvisor finds the well-known slow patterns in competitive programming solutions, such as std::endl
+ * in loops, cin without sync_with_stdio(false), Scanner in Java and input() in Python loops.
+ * It's a heuristic based on a lightweight tokenizer, it doesn't parse the code, so it works on incomplete code and
+ * doesn't need a language server, but it may miss some patterns and report some false positives.
+ * Each finding contains a quick fix in text, which tells how to fix it.
+ */
+
+#ifndef PERFORMANCEADVISOR_HPP
+#define PERFORMANCEADVISOR_HPP
+
+#include <QString>
+#include <QVector>
+
+namespace Core
+{
+
+class PerformanceAdvisor
+{
+  public:
+    enum Severity
+    {
+        Warning,     // it's slow in most cases
+        Information, // it's slow in some cases
+        Hint         // it's only slow for very large input or output
+    };
+
+    // a slow pattern found in the code
+    struct Finding
+    {
+        Severity severity = Warning;
+        int startLine = 0;   // starting from 1
+        int startColumn = 0; // starting from 0
+        int endLine = 0;     // starting from 1
+        int endColumn = 0;   // starting from 0, exclusive
+        QString message;     // what the problem is
+        QString fix;         // how to fix it
+    };
+
+    /**
+     * @brief find the slow patterns in the code
+     * @param code the source code
+     * @param lang the language of the code, one of "C++", "Java" and "Python"
+     * @returns the findings in the order of their positions
+     */
+    static QVector<Finding> analyze(const QString &code, const QString &lang);
+};
+
+} // namespace Core
+
+#endif // PERFORMANCEADVISOR_HPP
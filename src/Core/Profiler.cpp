@@ -0,0 +1,475 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/Profiler.hpp"
+#include "Core/Compiler.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/PerfCounters.hpp"
+#include "Util/FileUtil.hpp"
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTemporaryFile>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Core
+{
+
+namespace
+{
+const int SAMPLE_FREQUENCY = 1000; // samples per second of CPU time
+const int DATA_PAGES = 64;         // the size of the ring buffer in pages, it must be a power of two
+const int DRAIN_INTERVAL = 100;    // the interval of reading the ring buffer in milliseconds
+
+/**
+ * @brief sort the samples in descending order
+ */
+QVector<Profiler::Hotspot> sorted(QVector<Profiler::Hotspot> hotspots)
+{
+    std::stable_sort(hotspots.begin(), hotspots.end(),
+                     [](const Profiler::Hotspot &a, const Profiler::Hotspot &b) { return a.samples > b.samples; });
+    return hotspots;
+}
+} // namespace
+
+bool Profiler::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+Profiler::Profiler(int index) : index(index)
+{
+}
+
+Profiler::~Profiler()
+{
+    for (auto *process : {compileProcess, runProcess, resolveProcess})
+    {
+        if (process != nullptr && process->state() != QProcess::NotRunning)
+        {
+            LOG_WARN("The profiling process is still running and forcefully killed");
+            process->disconnect(this);
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+
+#ifdef Q_OS_LINUX
+    if (ringBuffer != nullptr)
+        munmap(ringBuffer, size_t(DATA_PAGES + 1) * size_t(sysconf(_SC_PAGESIZE)));
+    if (eventFd != -1)
+        ::close(eventFd);
+#endif
+}
+
+void Profiler::start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand,
+                     const QString &args, const TestData &input, int timeLimit)
+{
+    LOG_INFO(INFO_OF(tmpFilePath) << INFO_OF(sourceFilePath) << INFO_OF(compileCommand) << INFO_OF(timeLimit));
+
+    if (!isSupported())
+    {
+        emit profilingFailed(index, tr("Profiling is only supported on Linux."));
+        return;
+    }
+
+    if (!QFile::exists(tmpFilePath))
+    {
+        emit profilingFailed(index, tr("The source file %1 doesn't exist.").arg(tmpFilePath));
+        return;
+    }
+
+    QStringList compileArgs = QProcess::splitCommand(compileCommand);
+    if (compileArgs.isEmpty())
+    {
+        emit profilingFailed(index, tr("The compile command is empty."));
+        return;
+    }
+
+    this->args = args;
+    this->input = input;
+    this->timeLimit = timeLimit;
+    sourcePath = QFileInfo(tmpFilePath).canonicalFilePath();
+    // it's next to the executable file, so that the working directory is the same as the normal execution
+    executable = Compiler::outputPath(tmpFilePath, sourceFilePath, "C++") + "-profile";
+
+    // the debug information is added at the back, so it's not overridden by the flags in the compile command
+    const auto program = compileArgs.takeFirst();
+    compileArgs << "-g" << sourcePath << "-o" << executable;
+    if (QFile::exists(sourceFilePath))
+        compileArgs << "-I" << QFileInfo(sourceFilePath).canonicalPath();
+
+    compileProcess = new QProcess(this);
+    connect(compileProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &Profiler::onCompilationFinished);
+    connect(compileProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            fail(tr("Failed to start the compiler: %1").arg(compileProcess->errorString()));
+    });
+    compileProcess->setWorkingDirectory(
+        QFileInfo(QFile::exists(sourceFilePath) ? sourceFilePath : tmpFilePath).canonicalPath());
+    compileProcess->start(program, compileArgs);
+}
+
+void Profiler::onCompilationFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitCode != 0 || exitStatus != QProcess::NormalExit)
+    {
+        fail(QString::fromLocal8Bit(compileProcess->readAllStandardError()));
+        return;
+    }
+
+    // a file-backed input is read by the program directly
+    QString inputPath = input.filePath();
+    if (!input.isFileBacked())
+    {
+        inputFile = new QTemporaryFile(this);
+        if (!inputFile->open())
+        {
+            fail(tr("Failed to create temporary file."));
+            return;
+        }
+        Util::saveFile(inputFile->fileName(), input.text(), "Profiler Input", false);
+        inputPath = inputFile->fileName();
+    }
+
+    killTimer = new QTimer(this);
+    killTimer->setSingleShot(true);
+    killTimer->setInterval(timeLimit);
+    connect(killTimer, &QTimer::timeout, this, &Profiler::onTimeout);
+
+    drainTimer = new QTimer(this);
+    drainTimer->setInterval(DRAIN_INTERVAL);
+    connect(drainTimer, &QTimer::timeout, this, &Profiler::drainSamples);
+
+    runProcess = new QProcess(this);
+    connect(runProcess, &QProcess::started, this, &Profiler::onStarted);
+    connect(runProcess, &QProcess::errorOccurred, this, &Profiler::onErrorOccurred);
+    connect(runProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &Profiler::onFinished);
+    runProcess->setWorkingDirectory(QFileInfo(executable).path());
+    runProcess->setStandardInputFile(inputPath);
+    runProcess->setStandardOutputFile(QProcess::nullDevice());
+    runProcess->setStandardErrorFile(QProcess::nullDevice());
+    runProcess->start(executable, QProcess::splitCommand(args));
+}
+
+void Profiler::onStarted()
+{
+    // the samples before attaching are lost, it's only a few milliseconds after the start
+    if (!attach(runProcess->processId()))
+        return;
+
+    killTimer->start();
+    drainTimer->start();
+    emit profilingStarted(index);
+}
+
+void Profiler::onFinished()
+{
+    LOG_INFO(INFO_OF(totalSamples) << INFO_OF(timeLimitExceeded));
+    killTimer->stop();
+    drainTimer->stop();
+    drainSamples();
+    resolve();
+}
+
+void Profiler::onErrorOccurred(QProcess::ProcessError error)
+{
+    // a crash is followed by finished(), the samples until the crash are still useful
+    if (error == QProcess::FailedToStart)
+        fail(tr("Failed to start the program: %1").arg(runProcess->errorString()));
+}
+
+void Profiler::onTimeout()
+{
+    timeLimitExceeded = true;
+    runProcess->kill();
+}
+
+bool Profiler::attach(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    // the CPU clock of the process is sampled, it's available even if there is no PMU
+    perf_event_attr attr{};
+    attr.size = sizeof attr;
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_TASK_CLOCK;
+    attr.freq = 1;
+    attr.sample_freq = SAMPLE_FREQUENCY;
+    attr.sample_type = PERF_SAMPLE_IP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    eventFd = int(syscall(SYS_perf_event_open, &attr, pid_t(pid), -1, -1, PERF_FLAG_FD_CLOEXEC));
+    if (eventFd == -1)
+    {
+        fail(PerfCounters::errorString(errno));
+        return false;
+    }
+
+    const auto pageSize = size_t(sysconf(_SC_PAGESIZE));
+    ringBuffer = mmap(nullptr, (DATA_PAGES + 1) * pageSize, PROT_READ | PROT_WRITE, MAP_SHARED, eventFd, 0);
+    if (ringBuffer == MAP_FAILED)
+    {
+        ringBuffer = nullptr;
+        fail(tr("Failed to map the ring buffer of the samples: %1").arg(qt_error_string(errno)));
+        return false;
+    }
+
+    // The addresses of a position independent executable are relative to where it's loaded. The load address is
+    // read now, because /proc/<pid>/maps is gone after the process exits.
+    QFile elf(executable);
+    if (elf.open(QIODevice::ReadOnly))
+    {
+        const auto header = elf.read(18);
+        positionIndependent = header.size() < 18 || (uchar(header[16]) | uchar(header[17]) << 8) != 2; // ET_EXEC
+    }
+
+    QFile maps(QString("/proc/%1/maps").arg(pid));
+    if (maps.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        // start-end perms offset dev inode path
+        const auto canonicalExecutable = QFileInfo(executable).canonicalFilePath();
+        for (const auto &line : QString::fromLocal8Bit(maps.readAll()).split('\n'))
+        {
+            const auto fields = line.simplified().split(' ');
+            if (fields.size() < 6 || fields[1].size() < 3 || fields[1][2] != 'x')
+                continue;
+            if (fields.mid(5).join(' ') != canonicalExecutable)
+                continue;
+            const auto range = fields[0].split('-');
+            Mapping mapping;
+            mapping.start = range.value(0).toULongLong(nullptr, 16);
+            mapping.end = range.value(1).toULongLong(nullptr, 16);
+            mapping.offset = fields[2].toULongLong(nullptr, 16);
+            mappings.push_back(mapping);
+        }
+    }
+
+    if (mappings.isEmpty())
+        LOG_WARN("The executable file is not found in the memory maps of " << INFO_OF(pid));
+
+    return true;
+#else
+    Q_UNUSED(pid)
+    fail(tr("Profiling is only supported on Linux."));
+    return false;
+#endif
+}
+
+void Profiler::drainSamples()
+{
+#ifdef Q_OS_LINUX
+    if (ringBuffer == nullptr)
+        return;
+
+    auto *page = static_cast<perf_event_mmap_page *>(ringBuffer);
+    const auto *data = static_cast<const char *>(ringBuffer) + sysconf(_SC_PAGESIZE);
+    const auto size = quint64(DATA_PAGES) * quint64(sysconf(_SC_PAGESIZE));
+
+    // a record may wrap around the end of the ring buffer
+    const auto copy = [data, size](quint64 position, void *dest, size_t length) {
+        const auto offset = position % size;
+        const auto first = std::min<quint64>(length, size - offset);
+        memcpy(dest, data + offset, first);
+        memcpy(static_cast<char *>(dest) + first, data, length - first);
+    };
+
+    const quint64 head = page->data_head;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    quint64 tail = page->data_tail;
+    while (tail + sizeof(perf_event_header) <= head)
+    {
+        perf_event_header header;
+        copy(tail, &header, sizeof header);
+        if (header.size == 0)
+            break;
+
+        if (header.type == PERF_RECORD_SAMPLE)
+        {
+            quint64 ip = 0;
+            copy(tail + sizeof header, &ip, sizeof ip);
+            ++totalSamples;
+            for (const auto &mapping : qAsConst(mappings))
+            {
+                if (ip >= mapping.start && ip < mapping.end)
+                {
+                    ++addressSamples[positionIndependent ? ip - mapping.start + mapping.offset : ip];
+                    break;
+                }
+            }
+        }
+        else if (header.type == PERF_RECORD_LOST)
+        {
+            quint64 lost[2]; // id, the number of lost records
+            copy(tail + sizeof header, lost, sizeof lost);
+            LOG_WARN(INFO_OF(lost[1]) << " samples are lost");
+            totalSamples += qint64(lost[1]);
+        }
+
+        tail += header.size;
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    page->data_tail = tail;
+#endif
+}
+
+void Profiler::resolve()
+{
+#ifdef Q_OS_LINUX
+    if (ringBuffer != nullptr)
+    {
+        munmap(ringBuffer, size_t(DATA_PAGES + 1) * size_t(sysconf(_SC_PAGESIZE)));
+        ringBuffer = nullptr;
+    }
+    if (eventFd != -1)
+    {
+        ::close(eventFd);
+        eventFd = -1;
+    }
+#endif
+
+    if (addressSamples.isEmpty())
+    {
+        onResolverFinished(0, QProcess::NormalExit);
+        return;
+    }
+
+    // the addresses are written to the stdin of addr2line, there may be too many of them for the command line
+    resolveProcess = new QProcess(this);
+    connect(resolveProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+            &Profiler::onResolverFinished);
+    connect(resolveProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            fail(tr("Failed to start addr2line, please make sure GNU Binutils is installed: %1")
+                     .arg(resolveProcess->errorString()));
+    });
+    resolveProcess->start("addr2line", {"-e", executable, "-a", "-f", "-C", "-i"});
+
+    QByteArray addresses;
+    for (auto it = addressSamples.cbegin(); it != addressSamples.cend(); ++it)
+        addresses += "0x" + QByteArray::number(it.key(), 16) + '\n';
+    resolveProcess->write(addresses);
+    resolveProcess->closeWriteChannel();
+}
+
+void Profiler::onResolverFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitCode != 0 || exitStatus != QProcess::NormalExit)
+    {
+        fail(tr("addr2line failed: %1").arg(QString::fromLocal8Bit(resolveProcess->readAllStandardError())));
+        return;
+    }
+
+    // The output is the address followed by pairs of function and location (file:line) of each address. With the
+    // inlined functions, the innermost one comes first. The innermost location in the source file is used, so the
+    // samples in an inlined library function are counted on the line calling it.
+    static const QRegularExpression locationRegex(R"(^(.*):(\d+))");
+    QStringList lines;
+    if (resolveProcess != nullptr)
+        lines = QString::fromLocal8Bit(resolveProcess->readAll()).trimmed().split('\n');
+
+    QHash<int, qint64> lineSamples;
+    QHash<int, QString> lineFunction;
+    QHash<QString, qint64> functionSamples;
+    qint64 resolvedSamples = 0;
+
+    for (int i = 0; i < lines.size();)
+    {
+        const auto samples = addressSamples.value(lines[i].toULongLong(nullptr, 16));
+        int end = i + 1;
+        while (end < lines.size() && !lines[end].startsWith("0x"))
+            ++end;
+
+        QString function;
+        int line = 0;
+        for (int j = i + 1; j + 1 < end; j += 2)
+        {
+            if (function.isEmpty())
+                function = lines[j];
+            const auto match = locationRegex.match(lines[j + 1]);
+            if (match.hasMatch() && QDir::cleanPath(match.captured(1)) == sourcePath)
+            {
+                function = lines[j];
+                line = match.captured(2).toInt();
+                break;
+            }
+        }
+        if (function.isEmpty() || function == "??")
+            function = tr("[unknown]");
+
+        functionSamples[function] += samples;
+        if (line > 0)
+        {
+            lineSamples[line] += samples;
+            lineFunction.insert(line, function);
+        }
+        resolvedSamples += samples;
+        i = end;
+    }
+
+    if (totalSamples > resolvedSamples)
+        functionSamples[tr("[shared libraries]")] += totalSamples - resolvedSamples;
+
+    Result result;
+    result.totalSamples = totalSamples;
+    result.timeLimitExceeded = timeLimitExceeded;
+    for (auto it = lineSamples.cbegin(); it != lineSamples.cend(); ++it)
+    {
+        result.lineSamples[it.key()] = it.value();
+        result.lines.push_back({lineFunction[it.key()], it.key(), it.value()});
+    }
+    for (auto it = functionSamples.cbegin(); it != functionSamples.cend(); ++it)
+        result.functions.push_back({it.key(), 0, it.value()});
+    result.lines = sorted(result.lines);
+    result.functions = sorted(result.functions);
+
+    emit profilingFinished(index, result);
+}
+
+void Profiler::fail(const QString &error)
+{
+    LOG_WARN(INFO_OF(error));
+    if (killTimer != nullptr)
+        killTimer->stop();
+    if (drainTimer != nullptr)
+        drainTimer->stop();
+    if (runProcess != nullptr && runProcess->state() != QProcess::NotRunning)
+    {
+        runProcess->disconnect(this);
+        runProcess->kill();
+    }
+    emit profilingFailed(index, error);
+}
+
+} // namespace Core
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The Profiler finds the hot lines of a C++ solution on a test case.
+ * The solution is compiled again with debug information, then it's executed with the input of the test case, and
+ * its instruction pointer is sampled by perf_event_open on Linux. After the execution, the samples are resolved to
+ * the functions and the source lines by addr2line, and aggregated per line of the source file and per function.
+ * Only the user space is sampled, which is allowed for the processes of the same user when
+ * /proc/sys/kernel/perf_event_paranoid is 2 or lower. The CPU clock is sampled, so it works without a PMU.
+ * Like the Compiler, it should be used only once, and the processes are killed when it's destructed.
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "Core/TestData.hpp"
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+#include <QVector>
+
+class QTemporaryFile;
+class QTimer;
+
+namespace Core
+{
+
+class Profiler : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // a function or a source line and the number of samples in it
+    struct Hotspot
+    {
+        QString function; // the name of the function
+        int line = 0;     // the line in the source file, starting from 1, 0 if it's not in the source file
+        qint64 samples = 0;
+    };
+
+    // the aggregated samples of an execution
+    struct Result
+    {
+        QMap<int, qint64> lineSamples;  // the number of samples of each line in the source file
+        QVector<Hotspot> lines;         // the lines in the source file, sorted by the samples in descending order
+        QVector<Hotspot> functions;     // the functions, sorted by the samples in descending order
+        qint64 totalSamples = 0;        // the number of all samples, including the ones in the shared libraries
+        bool timeLimitExceeded = false; // whether the execution is killed at the time limit
+    };
+
+    /**
+     * @brief whether profiling is supported on this platform
+     */
+    static bool isSupported();
+
+    /**
+     * @brief construct a profiler
+     * @param index the index of the test case
+     */
+    explicit Profiler(int index);
+
+    /**
+     * @brief destruct a profiler
+     * @note the compilation, the execution and addr2line are killed if they are running
+     */
+    ~Profiler() override;
+
+    /**
+     * @brief compile and profile a C++ program
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param compileCommand the command for compiling, the debug information is added to it
+     * @param args the command line arguments added at the back to start the program
+     * @param input the input of the test case
+     * @param timeLimit the time limit of the execution in milliseconds, the samples until it are kept
+     */
+    void start(const QString &tmpFilePath, const QString &sourceFilePath, const QString &compileCommand,
+               const QString &args, const TestData &input, int timeLimit);
+
+  signals:
+    /**
+     * @brief the program is compiled and started
+     */
+    void profilingStarted(int index);
+
+    /**
+     * @brief the samples are resolved
+     */
+    void profilingFinished(int index, const Core::Profiler::Result &result);
+
+    /**
+     * @brief failed to compile, execute or resolve the program
+     * @param error the reason of the failure, the compile errors if it fails to compile
+     */
+    void profilingFailed(int index, const QString &error);
+
+  private slots:
+    void onCompilationFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onStarted();
+    void onFinished();
+    void onErrorOccurred(QProcess::ProcessError error);
+    void onTimeout();
+    void onResolverFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+  private:
+    // an executable mapping of the program in its address space
+    struct Mapping
+    {
+        quint64 start = 0;
+        quint64 end = 0;
+        quint64 offset = 0; // the offset in the executable file
+    };
+
+    /**
+     * @brief start sampling the program and find where it's mapped
+     */
+    bool attach(qint64 pid);
+
+    /**
+     * @brief read the samples from the ring buffer and count them by the addresses in the executable file
+     */
+    void drainSamples();
+
+    /**
+     * @brief close the sampling event and start addr2line to resolve the sampled addresses
+     */
+    void resolve();
+
+    /**
+     * @brief kill the processes and emit profilingFailed
+     */
+    void fail(const QString &error);
+
+    int index;
+    QString executable;                    // the executable file with the debug information
+    QString sourcePath;                    // the canonical path of the compiled file, to find its lines
+    QString args;
+    TestData input;
+    int timeLimit = 0;
+    bool timeLimitExceeded = false;
+    QProcess *compileProcess = nullptr;
+    QProcess *runProcess = nullptr;
+    QProcess *resolveProcess = nullptr;
+    QTemporaryFile *inputFile = nullptr;
+    QTimer *killTimer = nullptr;           // kills the program at the time limit
+    QTimer *drainTimer = nullptr;          // reads the samples before the ring buffer is full
+    int eventFd = -1;                      // the sampling event
+    void *ringBuffer = nullptr;            // the mapped ring buffer of the sampling event
+    bool positionIndependent = true;       // whether the addresses are relative to where the executable file is mapped
+    QVector<Mapping> mappings;             // the executable mappings of the executable file
+    QHash<quint64, qint64> addressSamples; // the number of samples at each address in the executable file
+    qint64 totalSamples = 0;               // the number of all samples
+};
+
+} // namespace Core
+
+#endif // PROFILER_HPP
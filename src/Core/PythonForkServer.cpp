@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/PythonForkServer.hpp"
+#include "Core/EventLogger.hpp"
+#include "Settings/SettingsManager.hpp"
+#include "Util/FileUtil.hpp"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QTimer>
+
+namespace Core
+{
+
+ForkServerExecution::ForkServerExecution(PythonForkServer *server, int id, QObject *parent)
+    : QObject(parent), server(server), id(id)
+{
+}
+
+ForkServerExecution::~ForkServerExecution()
+{
+    if (server)
+        server->forget(id);
+}
+
+void ForkServerExecution::kill()
+{
+    if (server)
+        server->kill(id);
+}
+
+int PythonForkServer::nextId = 0;
+QMap<QString, PythonForkServer *> PythonForkServer::instances;
+
+PythonForkServer::PythonForkServer(const QString &runCommand) : command(runCommand)
+{
+    // the fork servers are used on the judge thread, and they are deleted when that thread finishes
+    connect(QThread::currentThread(), &QThread::finished, this, &QObject::deleteLater, Qt::DirectConnection);
+
+    process = new QProcess(this);
+    connect(process, &QProcess::started, this, &PythonForkServer::onStarted);
+    connect(process, &QProcess::readyReadStandardOutput, this, &PythonForkServer::onReadyReadStandardOutput);
+    connect(process, &QProcess::errorOccurred, this, &PythonForkServer::onErrorOccurred);
+    connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &PythonForkServer::onFinished);
+
+    auto args = QProcess::splitCommand(runCommand);
+    if (args.isEmpty())
+    {
+        // stop later, the executions haven't been requested yet
+        QTimer::singleShot(0, this, [this] {
+            stop(tr("%1 is empty").arg(SettingsManager::getPathText("Python/Run Command")));
+        });
+        return;
+    }
+
+    const auto program = args.takeFirst();
+    args << "-c" << Util::readFile(":/python/forkserver.py", "Read Python Fork Server");
+
+    LOG_INFO("Starting the Python fork server " << INFO_OF(program));
+    process->start(program, args);
+}
+
+PythonForkServer::~PythonForkServer()
+{
+    if (instances.value(command) == this)
+        instances.remove(command);
+
+    process->disconnect(this);
+
+    if (process->state() != QProcess::NotRunning)
+    {
+        // the fork server kills the running executions when its stdin is closed
+        process->closeWriteChannel();
+        if (!process->waitForFinished(1000))
+        {
+            LOG_WARN("The Python fork server didn't exit in time and is forcefully killed");
+            process->kill();
+        }
+    }
+}
+
+bool PythonForkServer::isSupported()
+{
+#ifdef Q_OS_UNIX
+    return true;
+#else
+    return false;
+#endif
+}
+
+PythonForkServer *PythonForkServer::instance(const QString &runCommand)
+{
+    auto *&server = instances[runCommand];
+    if (server == nullptr)
+        server = new PythonForkServer(runCommand);
+    return server;
+}
+
+ForkServerExecution *PythonForkServer::execute(const QString &script, const QStringList &args,
+                                              const QString &workingDirectory, const QString &inputPath,
+                                              const QString &outputPath, const QString &errorPath,
+                                              qint64 fileSizeLimit, int cpuTimeLimit, QObject *parent)
+{
+    const int id = nextId++;
+    auto *execution = new ForkServerExecution(this, id, parent);
+
+    if (stopped)
+    {
+        // the caller hasn't connected to the signals yet
+        QTimer::singleShot(0, execution,
+                           [execution] { emit execution->failed(tr("The Python fork server has stopped")); });
+        return execution;
+    }
+
+    runningExecutions.insert(id, execution);
+
+    write({{"id", id},
+           {"script", script},
+           {"args", QJsonArray::fromStringList(args)},
+           {"cwd", workingDirectory},
+           {"stdin", inputPath},
+           {"stdout", outputPath},
+           {"stderr", errorPath},
+           {"limit", fileSizeLimit},
+           {"cpuLimit", (cpuTimeLimit + 999) / 1000}});
+    return execution;
+}
+
+void PythonForkServer::kill(int id)
+{
+    if (!stopped && runningExecutions.contains(id))
+    {
+        LOG_INFO("Killing the execution in the Python fork server " << INFO_OF(id));
+        write({{"kill", id}});
+    }
+}
+
+void PythonForkServer::forget(int id)
+{
+    // keep the id until the reply arrives, so that the reply isn't reported as unexpected
+    auto it = runningExecutions.find(id);
+    if (it != runningExecutions.end() && it.value() != nullptr)
+    {
+        kill(id);
+        it.value() = nullptr;
+    }
+}
+
+void PythonForkServer::onStarted()
+{
+    LOG_INFO("The Python fork server has started, sending " << pendingRequests.count('\n') << " pending requests");
+    started = true;
+    process->write(pendingRequests);
+    pendingRequests.clear();
+}
+
+void PythonForkServer::onReadyReadStandardOutput()
+{
+    replyBuffer += process->readAllStandardOutput();
+
+    int end;
+    while ((end = replyBuffer.indexOf('\n')) != -1)
+    {
+        const auto reply = QJsonDocument::fromJson(replyBuffer.left(end)).object();
+        replyBuffer.remove(0, end + 1);
+
+        const int id = reply["id"].toInt(-1);
+        if (!runningExecutions.contains(id))
+        {
+            LOG_WARN("Unexpected reply from the Python fork server " << INFO_OF(id));
+            continue;
+        }
+
+        if (reply.contains("pid"))
+        {
+            if (auto *execution = runningExecutions.value(id))
+                emit execution->started(reply["pid"].toVariant().toLongLong());
+            continue;
+        }
+
+        auto *execution = runningExecutions.take(id);
+        if (execution == nullptr)
+            continue;
+
+        if (reply.contains("error"))
+            emit execution->failed(reply["error"].toString());
+        else
+            emit execution->finished(reply["exitCode"].toInt(), reply["crashed"].toBool(),
+                                     reply["cpuTime"].toVariant().toLongLong());
+    }
+}
+
+void PythonForkServer::onErrorOccurred(QProcess::ProcessError error)
+{
+    LOG_WARN(INFO_OF(error));
+    if (error == QProcess::FailedToStart)
+    {
+        stop(tr("Failed to start the Python fork server. Please check %1 or add Python in the PATH environment "
+                "variable.")
+                 .arg(SettingsManager::getPathText("Python/Run Command")));
+    }
+}
+
+void PythonForkServer::onFinished()
+{
+    stop(tr("The Python fork server has stopped unexpectedly.\n%1")
+             .arg(QString::fromUtf8(process->readAllStandardError())));
+}
+
+void PythonForkServer::write(const QJsonObject &request)
+{
+    const auto line = QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n';
+    if (started)
+        process->write(line);
+    else
+        pendingRequests += line;
+}
+
+void PythonForkServer::stop(const QString &error)
+{
+    if (stopped)
+        return;
+
+    LOG_WARN(error);
+    stopped = true;
+
+    // remove this fork server now, so that a new one is started for the next execution
+    if (instances.value(command) == this)
+        instances.remove(command);
+
+    const auto executions = runningExecutions.values();
+    runningExecutions.clear();
+    for (auto *execution : executions)
+    {
+        if (execution != nullptr)
+            emit execution->failed(error);
+    }
+
+    deleteLater();
+}
+
+} // namespace Core
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The PythonForkServer keeps a warm Python interpreter which has imported the commonly used modules.
+ * For each execution, the interpreter forks itself, redirects the stdin/stdout/stderr of the child process to files
+ * and runs the program in the child process, so the startup time of the interpreter is paid only once.
+ * There is one fork server for each run command, it's started when it's used for the first time.
+ * The fork server is only supported on UNIX-like systems.
+ * The script of the fork server is resources/python/forkserver.py.
+ * The fork servers are used by Core::RunnerWorker, so they live on the judge thread.
+ * Each execution has its own ForkServerExecution object which receives the results, so a reply is delivered only to
+ * the one waiting for it.
+ */
+
+#ifndef PYTHONFORKSERVER_HPP
+#define PYTHONFORKSERVER_HPP
+
+#include <QHash>
+#include <QMap>
+#include <QPointer>
+#include <QProcess>
+
+class QJsonObject;
+
+namespace Core
+{
+
+class PythonForkServer;
+
+// the results of an execution in Core::PythonForkServer
+class ForkServerExecution : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief kill the execution if it's still running, no more signals are emitted after this
+     */
+    ~ForkServerExecution() override;
+
+    /**
+     * @brief kill the execution if it's still running, finished is emitted when it's killed
+     */
+    void kill();
+
+  signals:
+    /**
+     * @brief the child process of the execution is forked
+     * @param pid the pid of the child process
+     */
+    void started(qint64 pid);
+
+    /**
+     * @brief the execution has finished
+     * @param exitCode the exit code of the program, or the signal number if it's crashed
+     * @param crashed whether the program is killed by a signal
+     * @param cpuTimeUsed the CPU time used by the program, in milliseconds
+     */
+    void finished(int exitCode, bool crashed, qint64 cpuTimeUsed);
+
+    /**
+     * @brief failed to start the execution, or the fork server stopped during the execution
+     */
+    void failed(const QString &error);
+
+  private:
+    friend class PythonForkServer;
+
+    ForkServerExecution(PythonForkServer *server, int id, QObject *parent);
+
+    QPointer<PythonForkServer> server; // the fork server running the execution
+    const int id;                      // the id of the execution in the fork server
+};
+
+class PythonForkServer : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief kill the fork server and all running executions
+     */
+    ~PythonForkServer() override;
+
+    /**
+     * @brief whether the fork server is supported on this platform
+     */
+    static bool isSupported();
+
+    /**
+     * @brief get the fork server of a run command
+     * @param runCommand the command to start the Python interpreter
+     * @note the fork server is started if it's not running
+     * @note this should be called on the judge thread
+     */
+    static PythonForkServer *instance(const QString &runCommand);
+
+    /**
+     * @brief execute a program in a forked child process
+     * @param script the path to the source file or the bytecode file of the program
+     * @param args the command line arguments of the program
+     * @param workingDirectory the working directory of the program
+     * @param inputPath the file used as the stdin of the program
+     * @param outputPath the file used as the stdout of the program
+     * @param errorPath the file used as the stderr of the program
+     * @param fileSizeLimit the maximum size of the stdout/stderr files in bytes, 0 for no limit
+     * @param cpuTimeLimit the CPU time limit in milliseconds, 0 for no limit
+     * @param parent the parent of the returned ForkServerExecution
+     * @returns the object receiving the results, delete it to kill the execution
+     * @note the CPU time limit is set by RLIMIT_CPU, which is rounded up to seconds
+     */
+    ForkServerExecution *execute(const QString &script, const QStringList &args, const QString &workingDirectory,
+                                 const QString &inputPath, const QString &outputPath, const QString &errorPath,
+                                 qint64 fileSizeLimit, int cpuTimeLimit, QObject *parent = nullptr);
+
+  private slots:
+    void onStarted();
+    void onReadyReadStandardOutput();
+    void onErrorOccurred(QProcess::ProcessError error);
+    void onFinished();
+
+  private:
+    friend class ForkServerExecution;
+
+    explicit PythonForkServer(const QString &runCommand);
+
+    /**
+     * @brief kill an execution if it's still running
+     * @param id the id of the execution
+     */
+    void kill(int id);
+
+    /**
+     * @brief stop delivering the results of an execution, and kill it if it's still running
+     */
+    void forget(int id);
+
+    /**
+     * @brief send a request to the fork server, the requests are buffered until the server is started
+     */
+    void write(const QJsonObject &request);
+
+    /**
+     * @brief fail all running executions and remove this fork server, a new one will be started when it's needed
+     */
+    void stop(const QString &error);
+
+    QString command;                                     // the run command of this fork server
+    QProcess *process = nullptr;                         // the Python interpreter running the fork server
+    QByteArray pendingRequests;                          // the requests sent before the fork server is started
+    QByteArray replyBuffer;                              // the incomplete reply line read from the fork server
+    QHash<int, ForkServerExecution *> runningExecutions; // the executions which haven't finished, null if forgotten
+    bool started = false;                                // whether the process of the fork server has started
+    bool stopped = false;                                // whether the fork server has stopped
+    static int nextId;                                   // the id of the next execution
+    static QMap<QString, PythonForkServer *> instances;  // the fork servers of the run commands
+};
+
+} // namespace Core
+
+#endif // PYTHONFORKSERVER_HPP
@@ -18,52 +18,53 @@
 #include "Core/Runner.hpp"
 #include "Core/Compiler.hpp"
 #include "Core/EventLogger.hpp"
-#include "Util/FileUtil.hpp"
-#include <QElapsedTimer>
+#include "Core/JudgeThread.hpp"
+#include "Core/NativeLauncher.hpp"
+#include "Core/PythonForkServer.hpp"
+#include "Core/RunnerWorker.hpp"
 #include <QFileInfo>
-#include <QTemporaryFile>
-#include <QTimer>
 #include <generated/SettingsHelper.hpp>
+#include <limits>
 
 namespace Core
 {
 
 Runner::Runner(int index) : runnerIndex(index)
 {
-    runProcess = new QProcess();
-    connect(runProcess, &QProcess::started, this, &Runner::onStarted);
-    connect(runProcess, &QProcess::errorOccurred, this, &Runner::onErrorOccurred);
 }
 
 Runner::~Runner()
 {
-    // The order of destructions is important, runTimer is used when emitting signals
-
-    delete killTimer;
+    if (worker != nullptr)
+    {
+        // the worker lives on the judge thread, it kills the process when it's deleted there
+        worker->deleteLater();
+        if (running)
+        {
+            LOG_WARN("Runner at index:" << runnerIndex << " was running and forcefully killed");
+            emit runKilled(runnerIndex);
+        }
+    }
 
-    if (runProcess != nullptr)
+    if (detachedProcess != nullptr)
     {
-        if (runProcess->state() == QProcess::Running)
+        if (detachedProcess->state() == QProcess::Running)
         {
             // Kill the process if it's still running when the Runner is destructed
             LOG_WARN("Runner at index:" << runnerIndex << " was running and forcefully killed");
-            runProcess->kill();
+            detachedProcess->kill();
             emit runKilled(runnerIndex);
         }
-        delete runProcess;
+        delete detachedProcess;
     }
-
-    delete runTimer;
 }
 
 void Runner::run(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
-                 const QString &runCommand, const QString &args, const QString &input, int timeLimit)
+                 const QString &runCommand, const QString &args, const TestData &input, int timeLimit)
 {
     LOG_INFO(INFO_OF(tmpFilePath) << INFO_OF(sourceFilePath) << INFO_OF(lang) << INFO_OF(runCommand) << INFO_OF(args)
                                   << INFO_OF(timeLimit));
 
-    isDetachedRun = false;
-
     if (!QFile::exists(tmpFilePath)) // make sure the source file exists, this usually means the executable file exists
     {
         emit failedToStartRun(runnerIndex, tr("The source file %1 doesn't exist.").arg(tmpFilePath));
@@ -78,62 +79,72 @@ void Runner::run(const QString &tmpFilePath, const QString &sourceFilePath, cons
         return;
     }
 
-    // connect signals and set timers
-
-    connect(runProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &Runner::onFinished);
-    connect(runProcess, &QProcess::readyReadStandardOutput, this, &Runner::onReadyReadStandardOutput);
-    connect(runProcess, &QProcess::readyReadStandardError, this, &Runner::onReadyReadStandardError);
-
-    QString program = command.takeFirst();
+    // everything depending on the settings is prepared here, the worker doesn't read the settings on the judge thread
 
-    setWorkingDirectory(tmpFilePath, sourceFilePath, lang);
-
-    inputFile = new QTemporaryFile(this);
-    if (!inputFile->open())
+    RunnerWorker::Task task;
+    task.program = command.takeFirst();
+    task.args = command;
+    task.workingDirectory = workingDirectory(tmpFilePath, sourceFilePath, lang);
+    task.input = input;
+    task.timeLimit = timeLimit;
+    if (SettingsHelper::isLimitCPUTime())
     {
-        emit failedToStartRun(runnerIndex, tr("Failed to create temporary file."));
-        return;
+        task.cpuTimeLimit = timeLimit;
+        const auto wallTimeLimit = qint64(timeLimit) * SettingsHelper::getWallTimeLimitFactor();
+        task.timeLimit = int(qMin(wallTimeLimit, qint64(std::numeric_limits<int>::max())));
     }
-    Util::saveFile(inputFile->fileName(), input, "Runner Input", false);
-    runProcess->setStandardInputFile(inputFile->fileName());
-
-    killTimer = new QTimer(runProcess);
-    killTimer->setSingleShot(true);
-    killTimer->setInterval(timeLimit);
-    connect(killTimer, &QTimer::timeout, this, &Runner::onTimeout);
+    task.outputLimit = SettingsHelper::getOutputLengthLimit();
+    task.countEvents = SettingsHelper::isCollectPerformanceCounters();
 
-    runTimer = new QElapsedTimer();
-
-    killTimer->start();
+    if (lang == "Python" && SettingsHelper::isPythonUseForkServer() && PythonForkServer::isSupported())
+    {
+        task.forkServerCommand = runCommand;
+        task.script = QFileInfo(Compiler::outputPath(tmpFilePath, sourceFilePath, "Python")).canonicalFilePath();
+        task.scriptArgs = QProcess::splitCommand(args);
+    }
+    else
+    {
+        task.nativeLauncher = SettingsHelper::isUseNativeLauncher() && NativeLauncher::isSupported();
+    }
 
-    runProcess->start(program, command);
+    worker = new RunnerWorker(task);
+    worker->moveToThread(JudgeThread::instance());
+    connect(worker, &RunnerWorker::started, this, &Runner::onWorkerStarted);
+    connect(worker, &RunnerWorker::finished, this, &Runner::onWorkerFinished);
+    connect(worker, &RunnerWorker::countersRead, this, &Runner::onWorkerCountersRead);
+    connect(worker, &RunnerWorker::failedToStart, this, &Runner::onWorkerFailedToStart);
+    connect(worker, &RunnerWorker::outputLimitExceeded, this, &Runner::onWorkerOutputLimitExceeded);
+    connect(worker, &RunnerWorker::usageSampled, this, &Runner::onWorkerUsageSampled);
+
+    running = true;
+    QMetaObject::invokeMethod(worker, "start", Qt::QueuedConnection);
 }
 
 void Runner::runDetached(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                          const QString &runCommand, const QString &args)
 {
-    isDetachedRun = true;
+    detachedProcess = new QProcess();
+    connect(detachedProcess, &QProcess::started, this, &Runner::onDetachedStarted);
+    connect(detachedProcess, &QProcess::errorOccurred, this, &Runner::onDetachedErrorOccurred);
 
-    setWorkingDirectory(tmpFilePath, sourceFilePath, lang);
+    detachedProcess->setWorkingDirectory(workingDirectory(tmpFilePath, sourceFilePath, lang));
 
     // different steps on different OSs
 #if defined(Q_OS_MACOS)
     // use apple script on Mac OS
-    runProcess->setProgram("osascript");
-    runProcess->setArguments({"-l", "AppleScript"});
+    detachedProcess->setProgram("osascript");
+    detachedProcess->setArguments({"-l", "AppleScript"});
     QString script = R"(tell app "Terminal" to do script ")" +
                      getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args).replace("\"", "'") + "\"";
-    runProcess->start();
+    detachedProcess->start();
     LOG_INFO("Running apple script\n" << script);
-    runProcess->write(script.toUtf8());
-    runProcess->closeWriteChannel();
+    detachedProcess->write(script.toUtf8());
+    detachedProcess->closeWriteChannel();
 #elif defined(Q_OS_WIN)
     // use cmd on Windows
-    runProcess->start("cmd", QProcess::splitCommand(
-                                 "/C \"start cmd /C " +
-                                 getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args).replace("\"", "^\"") +
-                                 " ^& pause\""));
-    LOG_INFO("CMD Arguemnts " << runProcess->arguments().join(" "));
+    auto command = getCommand(tmpFilePath, sourceFilePath, lang, runCommand, args).replace("\"", "^\"");
+    detachedProcess->start("cmd", QProcess::splitCommand("/C \"start cmd /C " + command + " ^& pause\""));
+    LOG_INFO("CMD Arguemnts " << detachedProcess->arguments().join(" "));
 #elif defined(Q_OS_UNIX)
     auto terminal = SettingsHelper::getDetachedRunTerminalProgram();
     LOG_INFO("Using: " << terminal << " on UNIX");
@@ -143,75 +154,67 @@ void Runner::runDetached(const QString &tmpFilePath, const QString &sourceFilePa
                                 QStringLiteral("%1 ; echo \"\n%2\" ; read -n 1")
                                     .arg(quotedCommand)
                                     .arg(tr("Program finished with exit code %1\nPress any key to exit").arg("$?"))};
-    runProcess->start(terminal, execArgs);
+    detachedProcess->start(terminal, execArgs);
 #else
     emit failedToStartRun(runnerIndex, tr("Detached execution is not supported on your platform"));
 #endif
 }
 
-void Runner::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+int Runner::index() const
+{
+    return runnerIndex;
+}
+
+bool Runner::isRunning() const
 {
-    const auto timeUsed = runTimer->isValid() ? runTimer->elapsed() : 0;
-    emit runFinished(runnerIndex, processStdout + runProcess->readAllStandardOutput(),
-                     processStderr + runProcess->readAllStandardError(), exitCode, timeUsed, timeLimitExceeded);
+    return running;
 }
 
-void Runner::onStarted()
+void Runner::onWorkerStarted()
 {
-    if (!isDetachedRun)
-        runTimer->start();
     emit runStarted(runnerIndex);
 }
 
-void Runner::onTimeout()
+void Runner::onWorkerFinished(const QString &out, const QString &err, int exitCode, qint64 timeUsed,
+                              qint64 cpuTimeUsed, bool tle, bool ile, bool crashed)
 {
-    if (runProcess->state() == QProcess::Running)
-    {
-        LOG_INFO("Process was running, and forcefully killed it because time limit was reached");
-        timeLimitExceeded = true;
-        runProcess->kill();
-    }
+    running = false;
+    emit runFinished(runnerIndex, out, err, exitCode, timeUsed, cpuTimeUsed, tle, ile, crashed);
 }
 
-void Runner::onReadyReadStandardOutput()
+void Runner::onWorkerCountersRead(const Core::PerfCounters::Counters &counters)
 {
-    processStdout.append(runProcess->readAllStandardOutput().replace('\0', ""));
-    if (!outputLimitExceededEmitted && processStdout.length() > SettingsHelper::getOutputLengthLimit())
-    {
-        outputLimitExceededEmitted = true;
-        runProcess->kill();
-        LOG_INFO("Process was running, and forcefully killed it because stdout limit was reached");
-        emit runOutputLimitExceeded(runnerIndex, "stdout");
-    }
+    emit runCountersRead(runnerIndex, counters);
 }
 
-void Runner::onReadyReadStandardError()
+void Runner::onWorkerFailedToStart(const QString &error)
 {
-    processStderr.append(runProcess->readAllStandardError().replace('\0', ""));
-    if (!outputLimitExceededEmitted && processStderr.length() > SettingsHelper::getOutputLengthLimit())
-    {
-        outputLimitExceededEmitted = true;
-        runProcess->kill();
-        LOG_INFO("Process was running, and forcefully killed it because stderr limit was reached");
-        emit runOutputLimitExceeded(runnerIndex, "stderr");
-    }
+    running = false;
+    emit failedToStartRun(runnerIndex, error);
+}
+
+void Runner::onWorkerOutputLimitExceeded(const QString &type)
+{
+    emit runOutputLimitExceeded(runnerIndex, type);
+}
+
+void Runner::onWorkerUsageSampled(int cpuUsage, qint64 memoryUsed)
+{
+    emit runUsageSampled(runnerIndex, cpuUsage, memoryUsed);
+}
+
+void Runner::onDetachedStarted()
+{
+    emit runStarted(runnerIndex);
 }
 
-void Runner::onErrorOccurred(QProcess::ProcessError error)
+void Runner::onDetachedErrorOccurred(QProcess::ProcessError error)
 {
     if (error == QProcess::FailedToStart)
     {
-        if (isDetachedRun)
-        {
-            emit failedToStartRun(
-                runnerIndex,
-                tr("Failed to start detached execution. Please check your terminal emulator settings in %1.")
-                    .arg(SettingsHelper::pathOfDetachedRunTerminalProgram(true)));
-        }
-        else
-        {
-            emit failedToStartRun(runnerIndex, tr("Failed to start running. Please compile first."));
-        }
+        emit failedToStartRun(
+            runnerIndex, tr("Failed to start detached execution. Please check your terminal emulator settings in %1.")
+                             .arg(SettingsHelper::pathOfDetachedRunTerminalProgram(true)));
     }
 }
 
@@ -229,15 +232,26 @@ QString Runner::getCommand(const QString &tmpFilePath, const QString &sourceFile
     }
     else if (lang == "Java")
     {
-        res = QString("%1 -classpath \"%2\" %3 %4")
+        // the warnings of CDS are disabled because they are printed to stdout
+        QString archive;
+        const auto archivePath = Compiler::javaArchivePath(tmpFilePath, sourceFilePath);
+        if (SettingsHelper::isJavaUseClassDataSharing() && QFile::exists(archivePath))
+            archive = QString("-XX:SharedArchiveFile=\"%1\" -Xshare:auto -Xlog:cds=off -Xlog:cds+dynamic=off ")
+                          .arg(archivePath);
+
+        res = QString("%1 %2-classpath \"%3\" %4 %5")
                   .arg(runCommand)
+                  .arg(archive)
                   .arg(Compiler::outputPath(tmpFilePath, sourceFilePath, "Java"))
                   .arg(SettingsHelper::getJavaClassName())
                   .arg(args);
     }
     else if (lang == "Python")
     {
-        res = QString("%1 \"%2\" %3").arg(runCommand).arg(QFileInfo(tmpFilePath).canonicalFilePath()).arg(args);
+        res = QString("%1 \"%2\" %3")
+                  .arg(runCommand)
+                  .arg(QFileInfo(Compiler::outputPath(tmpFilePath, sourceFilePath, "Python")).canonicalFilePath())
+                  .arg(args);
     }
 
     LOG_INFO("Returning runCommand as : " << res);
@@ -245,10 +259,9 @@ QString Runner::getCommand(const QString &tmpFilePath, const QString &sourceFile
     return res;
 }
 
-void Runner::setWorkingDirectory(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang)
+QString Runner::workingDirectory(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang)
 {
-    runProcess->setWorkingDirectory(
-        QFileInfo(Compiler::outputFilePath(tmpFilePath, sourceFilePath, lang, false)).path());
+    return QFileInfo(Compiler::outputFilePath(tmpFilePath, sourceFilePath, lang, false)).path();
 }
 
 } // namespace Core
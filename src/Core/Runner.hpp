@@ -20,19 +20,19 @@
  * The source file should be compiled by Core::Compiler before the execution.
  * You have to create a new Runner for each execution.
  * The results are returned by signals.
+ * The program is run by a Core::RunnerWorker on the judge thread, and only the results are sent back to the Runner.
  */
 
 #ifndef RUNNER_HPP
 #define RUNNER_HPP
 
+#include "Core/PerfCounters.hpp"
+#include "Core/TestData.hpp"
 #include <QProcess>
 
-class QElapsedTimer;
-class QTemporaryFile;
-class QTimer;
-
 namespace Core
 {
+class RunnerWorker;
 
 class Runner : public QObject
 {
@@ -60,10 +60,12 @@ class Runner : public QObject
      * @param args the command line arguments added at the back to start the program
      * @param input the input to the program
      * @param timeLimit the maximum time for the program to run, in milliseconds
+     * @note If "Limit CPU Time" is enabled, the time limit is the CPU time limit, and the wall time limit is
+     * "Wall Time Limit Factor" times of it.
      * @note This should be called only once. Please create multiple Runners for multiple runs.
      */
     void run(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang, const QString &runCommand,
-             const QString &args, const QString &input, int timeLimit);
+             const QString &args, const TestData &input, int timeLimit);
 
     /**
      * @brief run a program in a pop-up terminal
@@ -77,6 +79,16 @@ class Runner : public QObject
     void runDetached(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
                      const QString &runCommand, const QString &args);
 
+    /**
+     * @brief get the index of the testcase
+     */
+    int index() const;
+
+    /**
+     * @brief whether the program is started by run and the result is not received yet
+     */
+    bool isRunning() const;
+
   signals:
     /**
      * @brief the execution has just started
@@ -91,9 +103,22 @@ class Runner : public QObject
      * @param err the stderr of the program
      * @param exitCode the exit code of the program
      * @param timeUsed the time between the execution started and finished
-     * @param tle whether the time limit is exceeded
+     * @param cpuTimeUsed the CPU time used by the program, -1 if it's unknown
+     * @param tle whether the time limit is exceeded, it's the CPU time limit if CPU time is limited
+     * @param ile whether the wall time limit is exceeded while the CPU time limit is not, i.e. the program is idle or
+     * blocked, this is only possible if CPU time is limited
+     * @param crashed whether the program is killed by a signal, then exitCode is the signal number
+     */
+    void runFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed,
+                     qint64 cpuTimeUsed, bool tle, bool ile, bool crashed);
+
+    /**
+     * @brief the hardware events of the execution are counted, it's emitted right before runFinished
+     * @param index the index of the testcase
+     * @param counters the counted events
+     * @note it's only emitted if "Collect Performance Counters" is enabled
      */
-    void runFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed, bool tle);
+    void runCountersRead(int index, const Core::PerfCounters::Counters &counters);
 
     /**
      * @brief failed to start the execution
@@ -110,6 +135,15 @@ class Runner : public QObject
      */
     void runOutputLimitExceeded(int index, const QString &type);
 
+    /**
+     * @brief the resource usage of the running program is sampled
+     * @param index the index of the testcase
+     * @param cpuUsage the CPU usage since the last sample in percent
+     * @param memoryUsed the resident set size in bytes
+     * @note It's emitted periodically on Linux only.
+     */
+    void runUsageSampled(int index, int cpuUsage, qint64 memoryUsed);
+
     /**
      * @brief the program is killed
      * @param index the index of the testcase
@@ -119,39 +153,45 @@ class Runner : public QObject
 
   private slots:
     /**
-     * @brief the process is finished
-     * @param exitCode the exit code of the process
-     * @param exitStatus the exit status of the process
+     * @brief the execution on the judge thread has just started, emit runStarted
      */
-    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onWorkerStarted();
 
     /**
-     * @brief the process has just started
+     * @brief the execution on the judge thread has finished, emit runFinished
      */
-    void onStarted();
+    void onWorkerFinished(const QString &out, const QString &err, int exitCode, qint64 timeUsed, qint64 cpuTimeUsed,
+                          bool tle, bool ile, bool crashed);
 
     /**
-     * @brief the time limit is reached
-     * @note this will kill the process if it's still running and emit runTimeout
+     * @brief the hardware events of the execution on the judge thread are counted, emit runCountersRead
      */
-    void onTimeout();
+    void onWorkerCountersRead(const Core::PerfCounters::Counters &counters);
 
     /**
-     * @brief the stdout of the process updated
-     * @note kill the process if stdout is too long
+     * @brief the execution on the judge thread failed to start, emit failedToStartRun
      */
-    void onReadyReadStandardOutput();
+    void onWorkerFailedToStart(const QString &error);
 
     /**
-     * @brief the stderr of the process updated
-     * @note kill the process if stderr is too long
+     * @brief the stdout/stderr of the execution on the judge thread is too long, emit runOutputLimitExceeded
      */
-    void onReadyReadStandardError();
+    void onWorkerOutputLimitExceeded(const QString &type);
+
+    /**
+     * @brief the resource usage of the execution on the judge thread is sampled, emit runUsageSampled
+     */
+    void onWorkerUsageSampled(int cpuUsage, qint64 memoryUsed);
+
+    /**
+     * @brief the detached process has just started
+     */
+    void onDetachedStarted();
 
     /**
      * @brief if the error is FailedToStart, emit failedToStartRun
      */
-    void onErrorOccurred(QProcess::ProcessError error);
+    void onDetachedErrorOccurred(QProcess::ProcessError error);
 
   private:
     /**
@@ -167,21 +207,15 @@ class Runner : public QObject
                               const QString &runCommand, const QString &args);
 
     /**
-     * @brief set the working directory of runProcess
+     * @brief get the working directory of the program
      * @note the path of the executable file for C++, class path for Java, temp file path for Python
      */
-    void setWorkingDirectory(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang);
-
-    const int runnerIndex;                   // the index of the testcase
-    QProcess *runProcess = nullptr;          // the process to run the program
-    QTemporaryFile *inputFile = nullptr;     // redirect stdin to this file
-    QTimer *killTimer = nullptr;             // the timer used to kill the process when the time limit is reached
-    QElapsedTimer *runTimer = nullptr;       // the timer used to measure how much time did the execution use
-    QByteArray processStdout;                // the stdout of the process
-    QByteArray processStderr;                // the stderr of the process
-    bool outputLimitExceededEmitted = false; // whether runOutputLimitExceeded is emitted or not
-    bool timeLimitExceeded = false;
-    bool isDetachedRun = false;
+    static QString workingDirectory(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang);
+
+    const int runnerIndex;               // the index of the testcase
+    RunnerWorker *worker = nullptr;      // the worker running the program on the judge thread
+    bool running = false;                // whether the worker is running and the result is not received yet
+    QProcess *detachedProcess = nullptr; // the process to run the pop-up terminal
 };
 
 } // namespace Core
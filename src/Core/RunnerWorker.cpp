@@ -0,0 +1,508 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/RunnerWorker.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/NativeLauncher.hpp"
+#include "Core/PythonForkServer.hpp"
+#include "Util/FileUtil.hpp"
+#include <QFile>
+#include <QTemporaryFile>
+#include <QTimer>
+
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Core
+{
+
+namespace
+{
+// a QProcess which sets RLIMIT_CPU in the child process, and optionally waits for a pipe to be closed before exec
+class CpuLimitedProcess : public QProcess
+{
+  public:
+    explicit CpuLimitedProcess(int cpuTimeLimit) : cpuTimeLimit(cpuTimeLimit)
+    {
+    }
+
+    /**
+     * @brief let the child process wait before exec until the write end of the pipe is closed by the parent
+     * @note Qt 5 starts the child process by fork, so the parent continues while the child waits
+     */
+    void waitBeforeExec(const int pipe[2])
+    {
+        syncPipe[0] = pipe[0];
+        syncPipe[1] = pipe[1];
+    }
+
+  protected:
+    void setupChildProcess() override
+    {
+#ifdef Q_OS_UNIX
+        // it's in seconds, the CPU time is checked more precisely by RunnerWorker::onCpuTimeout on Linux
+        if (cpuTimeLimit > 0)
+        {
+            rlimit limit{};
+            limit.rlim_cur = rlim_t((cpuTimeLimit + 999) / 1000);
+            limit.rlim_max = limit.rlim_cur + 1;
+            setrlimit(RLIMIT_CPU, &limit);
+        }
+#endif
+#ifdef Q_OS_LINUX
+        if (syncPipe[0] != -1)
+        {
+            ::close(syncPipe[1]);
+            char byte;
+            while (::read(syncPipe[0], &byte, 1) == -1 && errno == EINTR)
+            {
+            }
+        }
+#endif
+    }
+
+  private:
+    const int cpuTimeLimit;
+    int syncPipe[2] = {-1, -1}; // the pipe the child process waits for before exec, -1 if it doesn't wait
+};
+
+const int USAGE_SAMPLE_INTERVAL = 500; // the interval of sampling the resource usage, in milliseconds
+
+// whether the process is killed by RLIMIT_CPU
+bool killedByCpuLimit(QProcess::ExitStatus exitStatus, int exitCode)
+{
+#ifdef Q_OS_UNIX
+    return exitStatus == QProcess::CrashExit && exitCode == SIGXCPU;
+#else
+    Q_UNUSED(exitStatus)
+    Q_UNUSED(exitCode)
+    return false;
+#endif
+}
+} // namespace
+
+RunnerWorker::RunnerWorker(const Task &task) : task(task)
+{
+}
+
+RunnerWorker::~RunnerWorker()
+{
+    delete killTimer;
+    delete cpuTimer;
+    delete usageTimer;
+    delete counters;
+
+    if (nativeLaunch != nullptr)
+    {
+        LOG_WARN("The execution in the native launcher is forcefully killed");
+        delete nativeLaunch;
+    }
+
+    if (forkRun != nullptr)
+    {
+        LOG_WARN("The execution in the Python fork server is forcefully killed");
+        delete forkRun;
+    }
+
+    if (runProcess != nullptr)
+    {
+        if (runProcess->state() != QProcess::NotRunning)
+        {
+            LOG_WARN("The process is still running and forcefully killed");
+            runProcess->disconnect(this);
+            runProcess->kill();
+        }
+        delete runProcess;
+    }
+}
+
+void RunnerWorker::start()
+{
+    if (task.input.isFileBacked())
+    {
+        // a large input is already in a file, the program reads it directly
+        inputPath = task.input.filePath();
+    }
+    else
+    {
+        inputFile = new QTemporaryFile(this);
+        if (!inputFile->open())
+        {
+            emit failedToStart(tr("Failed to create temporary file."));
+            return;
+        }
+        Util::saveFile(inputFile->fileName(), task.input.text(), "Runner Input", false);
+        inputPath = inputFile->fileName();
+    }
+
+    killTimer = new QTimer();
+    killTimer->setSingleShot(true);
+    killTimer->setTimerType(Qt::PreciseTimer);
+    killTimer->setInterval(task.timeLimit);
+    connect(killTimer, &QTimer::timeout, this, &RunnerWorker::onTimeout);
+
+    if (!task.forkServerCommand.isEmpty())
+    {
+        runInForkServer();
+        return;
+    }
+
+    if (task.nativeLauncher)
+    {
+        runInNativeLauncher();
+        return;
+    }
+
+    runProcess = new CpuLimitedProcess(task.cpuTimeLimit);
+    connect(runProcess, &QProcess::started, this, &RunnerWorker::onStarted);
+    connect(runProcess, &QProcess::errorOccurred, this, &RunnerWorker::onErrorOccurred);
+    connect(runProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, &RunnerWorker::onFinished);
+    connect(runProcess, &QProcess::readyReadStandardOutput, this, &RunnerWorker::onReadyReadStandardOutput);
+    connect(runProcess, &QProcess::readyReadStandardError, this, &RunnerWorker::onReadyReadStandardError);
+
+    runProcess->setWorkingDirectory(task.workingDirectory);
+    runProcess->setStandardInputFile(inputPath);
+
+#ifdef Q_OS_LINUX
+    if (task.cpuTimeLimit > 0)
+    {
+        cpuTimer = new QTimer();
+        cpuTimer->setSingleShot(true);
+        cpuTimer->setTimerType(Qt::PreciseTimer);
+        connect(cpuTimer, &QTimer::timeout, this, &RunnerWorker::onCpuTimeout);
+    }
+#endif
+
+#ifdef Q_OS_LINUX
+    int syncPipe[2] = {-1, -1};
+    // the counters are attached while the child process waits before exec, so they are enabled by the exec and the
+    // whole program is counted even if it exits at once
+    if (task.countEvents && pipe2(syncPipe, O_CLOEXEC) == 0)
+        runProcess->waitBeforeExec(syncPipe);
+#endif
+
+    runProcess->start(task.program, task.args);
+
+    if (task.countEvents)
+    {
+        counters = new PerfCounters;
+        if (runProcess->processId() != 0)
+            counters->attach(runProcess->processId());
+    }
+
+#ifdef Q_OS_LINUX
+    if (syncPipe[0] != -1)
+    {
+        // let the child process continue to exec
+        ::close(syncPipe[0]);
+        ::close(syncPipe[1]);
+    }
+#endif
+}
+
+void RunnerWorker::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    const auto timeUsed = runTimer.isValid() ? runTimer.elapsed() : 0;
+    killTimer->stop();
+    if (cpuTimer != nullptr)
+        cpuTimer->stop();
+    stopMonitoring();
+    if (task.cpuTimeLimit > 0 && killedByCpuLimit(exitStatus, exitCode))
+        timeLimitExceeded = true;
+    processStdout.append(runProcess->readAllStandardOutput().replace('\0', ""));
+    processStderr.append(runProcess->readAllStandardError().replace('\0', ""));
+    if (counters != nullptr)
+        emit countersRead(counters->read());
+    // QProcess reaps the process, so its CPU time is unknown
+    emit finished(processStdout, processStderr, exitCode, timeUsed, -1, timeLimitExceeded,
+                  idleLimitExceeded && !timeLimitExceeded, exitStatus == QProcess::CrashExit);
+}
+
+void RunnerWorker::onStarted()
+{
+    // the time limits start when the process has started, so they don't include the time to start it
+    runTimer.start();
+    killTimer->start();
+    if (cpuTimer != nullptr)
+        cpuTimer->start(task.cpuTimeLimit);
+    startMonitoring(runProcess->processId());
+    emit started();
+}
+
+void RunnerWorker::onTimeout()
+{
+    // with a CPU time limit, the wall time limit is only for the programs which are idle or blocked
+    auto &exceeded = task.cpuTimeLimit > 0 ? idleLimitExceeded : timeLimitExceeded;
+
+    if (runProcess != nullptr && runProcess->state() == QProcess::Running)
+    {
+        LOG_INFO("Process was running, and forcefully killed it because time limit was reached");
+        exceeded = true;
+        runProcess->kill();
+    }
+    else if (forkRun != nullptr)
+    {
+        LOG_INFO("Execution in the Python fork server was running, and killed it because time limit was reached");
+        exceeded = true;
+        forkRun->kill();
+    }
+}
+
+void RunnerWorker::onCpuTimeout()
+{
+#ifdef Q_OS_LINUX
+    if (runProcess->state() != QProcess::Running)
+        return;
+
+    // the CPU time of a single thread is never more than the wall time, so it's checked again after the remaining time
+    clockid_t clock;
+    timespec time{};
+    if (clock_getcpuclockid(pid_t(runProcess->processId()), &clock) != 0 || clock_gettime(clock, &time) != 0)
+        return;
+    const qint64 cpuTime = qint64(time.tv_sec) * 1000 + time.tv_nsec / 1000000;
+
+    if (cpuTime >= task.cpuTimeLimit)
+    {
+        LOG_INFO("Process was running, and forcefully killed it because CPU time limit was reached");
+        timeLimitExceeded = true;
+        runProcess->kill();
+    }
+    else
+    {
+        cpuTimer->start(int(qMax(task.cpuTimeLimit - cpuTime, qint64(1))));
+    }
+#endif
+}
+
+void RunnerWorker::onUsageTimeout()
+{
+#ifdef Q_OS_LINUX
+    // /proc/<pid>/stat is "pid (comm) state ...", and the comm may contain spaces and parentheses
+    QFile statFile(QString("/proc/%1/stat").arg(monitoredPid));
+    if (!statFile.open(QIODevice::ReadOnly))
+        return;
+    const auto stat = statFile.readAll();
+    const auto fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 13)
+        return;
+    // utime and stime are the 14th and the 15th fields, in clock ticks
+    const qint64 ticks = fields[11].toLongLong() + fields[12].toLongLong();
+    const qint64 cpuTime = ticks * 1000 / sysconf(_SC_CLK_TCK);
+
+    qint64 memoryUsed = 0;
+    QFile statusFile(QString("/proc/%1/status").arg(monitoredPid));
+    if (statusFile.open(QIODevice::ReadOnly))
+    {
+        for (const auto &line : statusFile.readAll().split('\n'))
+        {
+            if (line.startsWith("VmRSS:"))
+            {
+                memoryUsed = line.mid(6).simplified().split(' ').value(0).toLongLong() * 1024; // in kB
+                break;
+            }
+        }
+    }
+
+    const auto now = runTimer.elapsed();
+    const auto cpuUsage = now > lastSampleTime ? (cpuTime - lastCpuTime) * 100 / (now - lastSampleTime) : 0;
+    lastCpuTime = cpuTime;
+    lastSampleTime = now;
+    emit usageSampled(int(cpuUsage), memoryUsed);
+#endif
+}
+
+void RunnerWorker::onReadyReadStandardOutput()
+{
+    processStdout.append(runProcess->readAllStandardOutput().replace('\0', ""));
+    if (!outputLimitExceededEmitted && processStdout.length() > task.outputLimit)
+    {
+        outputLimitExceededEmitted = true;
+        runProcess->kill();
+        LOG_INFO("Process was running, and forcefully killed it because stdout limit was reached");
+        emit outputLimitExceeded("stdout");
+    }
+}
+
+void RunnerWorker::onReadyReadStandardError()
+{
+    processStderr.append(runProcess->readAllStandardError().replace('\0', ""));
+    if (!outputLimitExceededEmitted && processStderr.length() > task.outputLimit)
+    {
+        outputLimitExceededEmitted = true;
+        runProcess->kill();
+        LOG_INFO("Process was running, and forcefully killed it because stderr limit was reached");
+        emit outputLimitExceeded("stderr");
+    }
+}
+
+void RunnerWorker::onErrorOccurred(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart)
+    {
+        killTimer->stop();
+        emit failedToStart(tr("Failed to start running. Please compile first."));
+    }
+}
+
+void RunnerWorker::onForkServerExecutionStarted(qint64 pid)
+{
+    runTimer.start();
+    killTimer->start();
+    startMonitoring(pid);
+    emit started();
+}
+
+void RunnerWorker::onForkServerExecutionFinished(int exitCode, bool crashed, qint64 cpuTimeUsed)
+{
+    const auto timeUsed = runTimer.isValid() ? runTimer.elapsed() : 0;
+    forkRun->deleteLater();
+    forkRun = nullptr;
+    killTimer->stop();
+    stopMonitoring();
+
+    // the outputs are written to the files by the child process, and the file size limit kills it if they are too long
+    processStdout = outputFile->readAll().replace('\0', "");
+    processStderr = errorFile->readAll().replace('\0', "");
+    if (processStdout.length() > task.outputLimit)
+        emit outputLimitExceeded("stdout");
+    else if (processStderr.length() > task.outputLimit)
+        emit outputLimitExceeded("stderr");
+
+    // RLIMIT_CPU in the fork server is in seconds, the precise CPU time is checked here
+    if (task.cpuTimeLimit > 0 && cpuTimeUsed > task.cpuTimeLimit)
+        timeLimitExceeded = true;
+
+    emit finished(processStdout, processStderr, exitCode, timeUsed, cpuTimeUsed, timeLimitExceeded,
+                  idleLimitExceeded && !timeLimitExceeded, crashed);
+}
+
+void RunnerWorker::onForkServerExecutionFailed(const QString &error)
+{
+    forkRun->deleteLater();
+    forkRun = nullptr;
+    killTimer->stop();
+    emit failedToStart(error);
+}
+
+void RunnerWorker::onNativeLaunched(qint64 pid)
+{
+    // the native launcher measures the time itself, runTimer is only used for sampling the resource usage
+    runTimer.start();
+    startMonitoring(pid);
+    emit started();
+}
+
+void RunnerWorker::onNativeLaunchFailed(const QString &error)
+{
+    nativeLaunch->deleteLater();
+    nativeLaunch = nullptr;
+    emit failedToStart(error);
+}
+
+void RunnerWorker::onNativeOutputLimitExceeded(const QString &type)
+{
+    emit outputLimitExceeded(type);
+}
+
+void RunnerWorker::onNativeCountersRead(const Core::PerfCounters::Counters &counters)
+{
+    emit countersRead(counters);
+}
+
+void RunnerWorker::onNativeFinished(QByteArray out, QByteArray err, int exitCode, bool crashed, qint64 timeUsed,
+                                    qint64 cpuTimeUsed, bool tle, bool ile)
+{
+    nativeLaunch->deleteLater();
+    nativeLaunch = nullptr;
+    stopMonitoring();
+    emit finished(out.replace('\0', ""), err.replace('\0', ""), exitCode, timeUsed, cpuTimeUsed, tle, ile, crashed);
+}
+
+void RunnerWorker::startMonitoring(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    monitoredPid = pid;
+    lastCpuTime = lastSampleTime = 0;
+    usageTimer = new QTimer();
+    usageTimer->setInterval(USAGE_SAMPLE_INTERVAL);
+    connect(usageTimer, &QTimer::timeout, this, &RunnerWorker::onUsageTimeout);
+    usageTimer->start();
+#else
+    Q_UNUSED(pid)
+#endif
+}
+
+void RunnerWorker::stopMonitoring()
+{
+    if (usageTimer != nullptr)
+        usageTimer->stop();
+}
+
+void RunnerWorker::runInForkServer()
+{
+    LOG_INFO("Running in the Python fork server " << INFO_OF(task.script));
+
+    outputFile = new QTemporaryFile(this);
+    errorFile = new QTemporaryFile(this);
+    if (!outputFile->open() || !errorFile->open())
+    {
+        emit failedToStart(tr("Failed to create temporary file."));
+        return;
+    }
+
+    // the file size limit is one more byte than the output length limit, so that exceeding the limit can be detected
+    forkRun = PythonForkServer::instance(task.forkServerCommand)
+                  ->execute(task.script, task.scriptArgs, task.workingDirectory, inputPath, outputFile->fileName(),
+                            errorFile->fileName(), task.outputLimit + 1, task.cpuTimeLimit, this);
+    connect(forkRun, &ForkServerExecution::started, this, &RunnerWorker::onForkServerExecutionStarted);
+    connect(forkRun, &ForkServerExecution::finished, this, &RunnerWorker::onForkServerExecutionFinished);
+    connect(forkRun, &ForkServerExecution::failed, this, &RunnerWorker::onForkServerExecutionFailed);
+}
+
+void RunnerWorker::runInNativeLauncher()
+{
+    LOG_INFO("Running in the native launcher " << INFO_OF(task.program));
+
+    NativeLauncher::Request request;
+    request.program = task.program;
+    request.args = task.args;
+    request.workingDirectory = task.workingDirectory;
+    request.inputPath = inputPath;
+    request.timeLimit = task.timeLimit;
+    request.cpuTimeLimit = task.cpuTimeLimit;
+    request.countEvents = task.countEvents;
+    request.outputLimit = task.outputLimit;
+
+    // the signals of the launch are queued, so they are received after the connections are made
+    nativeLaunch = NativeLauncher::instance()->launch(request, this);
+    connect(nativeLaunch, &NativeLaunch::launched, this, &RunnerWorker::onNativeLaunched);
+    connect(nativeLaunch, &NativeLaunch::failedToLaunch, this, &RunnerWorker::onNativeLaunchFailed);
+    connect(nativeLaunch, &NativeLaunch::outputLimitExceeded, this, &RunnerWorker::onNativeOutputLimitExceeded);
+    connect(nativeLaunch, &NativeLaunch::countersRead, this, &RunnerWorker::onNativeCountersRead);
+    connect(nativeLaunch, &NativeLaunch::finished, this, &RunnerWorker::onNativeFinished);
+}
+
+} // namespace Core
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The RunnerWorker runs a program for Core::Runner on the judge thread, see Core::JudgeThread.
+ * Everything it needs is prepared by the Runner on the GUI thread, so it doesn't read the settings.
+ * It can run the program by QProcess, the Python fork server or the native launcher, and the results are returned
+ * by signals, which are queued to the Runner.
+ * While the program is running, its CPU usage and memory usage are sampled from /proc on Linux.
+ * The process is killed when the worker is destructed.
+ */
+
+#ifndef RUNNERWORKER_HPP
+#define RUNNERWORKER_HPP
+
+#include "Core/PerfCounters.hpp"
+#include "Core/TestData.hpp"
+#include <QElapsedTimer>
+#include <QProcess>
+
+class QTemporaryFile;
+class QTimer;
+
+namespace Core
+{
+class ForkServerExecution;
+class NativeLaunch;
+
+class RunnerWorker : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // the information needed to run a program
+    struct Task
+    {
+        QString program;             // the program to run
+        QStringList args;            // the arguments of the program
+        QString workingDirectory;    // the working directory of the program
+        TestData input;              // the input to the program
+        int timeLimit = 0;           // the maximum wall time for the program to run, in milliseconds
+        int cpuTimeLimit = 0;        // the maximum CPU time for the program to use, in milliseconds, 0 for no limit
+        int outputLimit = 0;         // the maximum length of the stdout and the stderr
+        bool nativeLauncher = false; // whether to run the program by Core::NativeLauncher
+        bool countEvents = false;    // whether to count the hardware events, not supported in the Python fork server
+        QString forkServerCommand;   // run the script in the Python fork server started by this command if not empty
+        QString script;              // the Python script to run in the fork server
+        QStringList scriptArgs;      // the arguments of the Python script
+    };
+
+    /**
+     * @brief construct a worker
+     * @param task the program to run
+     * @note the worker should be moved to the judge thread before calling start
+     */
+    explicit RunnerWorker(const Task &task);
+
+    /**
+     * @brief destruct the worker
+     * @note the process will be killed if it's still running
+     */
+    ~RunnerWorker() override;
+
+  public slots:
+    /**
+     * @brief start running the program
+     */
+    void start();
+
+  signals:
+    /**
+     * @brief the execution has just started
+     */
+    void started();
+
+    /**
+     * @brief the execution has just finished
+     * @param out the stdout of the program
+     * @param err the stderr of the program
+     * @param exitCode the exit code of the program
+     * @param timeUsed the time between the execution started and finished
+     * @param cpuTimeUsed the CPU time used by the program, -1 if it's unknown
+     * @param tle whether the time limit is exceeded, it's the CPU time limit if there is one
+     * @param ile whether the wall time limit is exceeded while the CPU time limit is not
+     * @param crashed whether the program is killed by a signal, then exitCode is the signal number
+     */
+    void finished(const QString &out, const QString &err, int exitCode, qint64 timeUsed, qint64 cpuTimeUsed, bool tle,
+                  bool ile, bool crashed);
+
+    /**
+     * @brief the hardware events of the program are counted, it's emitted right before finished
+     * @note it's only emitted if countEvents is set in the task
+     */
+    void countersRead(const Core::PerfCounters::Counters &counters);
+
+    /**
+     * @brief failed to start the execution
+     * @param error a string to describe the error
+     */
+    void failedToStart(const QString &error);
+
+    /**
+     * @brief the stdout/stderr is too long
+     * @param type either stdout or stderr
+     * @note this will be emitted only once
+     */
+    void outputLimitExceeded(const QString &type);
+
+    /**
+     * @brief the resource usage of the running program is sampled
+     * @param cpuUsage the CPU usage since the last sample in percent, it can be more than 100 for multiple threads
+     * @param memoryUsed the resident set size in bytes
+     */
+    void usageSampled(int cpuUsage, qint64 memoryUsed);
+
+  private slots:
+    /**
+     * @brief the process is finished
+     * @param exitCode the exit code of the process
+     * @param exitStatus the exit status of the process
+     */
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    /**
+     * @brief the process has just started
+     */
+    void onStarted();
+
+    /**
+     * @brief the time limit is reached
+     * @note this will kill the process if it's still running
+     */
+    void onTimeout();
+
+    /**
+     * @brief check the CPU time used by runProcess
+     * @note this will kill the process if the CPU time limit is exceeded
+     */
+    void onCpuTimeout();
+
+    /**
+     * @brief sample the resource usage of the running program and emit usageSampled
+     */
+    void onUsageTimeout();
+
+    /**
+     * @brief the stdout of the process updated
+     * @note kill the process if stdout is too long
+     */
+    void onReadyReadStandardOutput();
+
+    /**
+     * @brief the stderr of the process updated
+     * @note kill the process if stderr is too long
+     */
+    void onReadyReadStandardError();
+
+    /**
+     * @brief if the error is FailedToStart, emit failedToStart
+     */
+    void onErrorOccurred(QProcess::ProcessError error);
+
+    /**
+     * @brief the execution in the Python fork server has started
+     */
+    void onForkServerExecutionStarted(qint64 pid);
+
+    /**
+     * @brief the execution in the Python fork server has finished, read the outputs and emit finished
+     */
+    void onForkServerExecutionFinished(int exitCode, bool crashed, qint64 cpuTimeUsed);
+
+    /**
+     * @brief the execution in the Python fork server failed, emit failedToStart
+     */
+    void onForkServerExecutionFailed(const QString &error);
+
+    /**
+     * @brief the process is spawned by the native launcher
+     */
+    void onNativeLaunched(qint64 pid);
+
+    /**
+     * @brief the native launcher failed to spawn the process, emit failedToStart
+     */
+    void onNativeLaunchFailed(const QString &error);
+
+    /**
+     * @brief the process spawned by the native launcher is killed because of the output limit
+     */
+    void onNativeOutputLimitExceeded(const QString &type);
+
+    /**
+     * @brief the hardware events of the process spawned by the native launcher are counted, emit countersRead
+     */
+    void onNativeCountersRead(const Core::PerfCounters::Counters &counters);
+
+    /**
+     * @brief the process spawned by the native launcher has finished, emit finished
+     */
+    void onNativeFinished(QByteArray out, QByteArray err, int exitCode, bool crashed, qint64 timeUsed,
+                          qint64 cpuTimeUsed, bool tle, bool ile);
+
+  private:
+    /**
+     * @brief run the Python script in the fork server instead of runProcess
+     * @note inputPath and killTimer should be set before calling this
+     */
+    void runInForkServer();
+
+    /**
+     * @brief run the program by the native launcher instead of runProcess
+     * @note inputPath should be set before calling this
+     */
+    void runInNativeLauncher();
+
+    /**
+     * @brief start sampling the resource usage of the program
+     * @param pid the pid of the program, it should be started just now
+     */
+    void startMonitoring(qint64 pid);
+
+    /**
+     * @brief stop sampling the resource usage, it should be called when the program exits
+     */
+    void stopMonitoring();
+
+    const Task task;                         // the program to run
+    QProcess *runProcess = nullptr;          // the process to run the program
+    QTemporaryFile *inputFile = nullptr;     // the file of the input, unless the input is file-backed
+    QString inputPath;                       // redirect stdin to this file
+    QTimer *killTimer = nullptr;             // the timer used to kill the process at the wall time limit
+    QTimer *cpuTimer = nullptr;              // the timer used to check the CPU time limit of runProcess
+    QElapsedTimer runTimer;                  // the timer used to measure how much time did the execution use
+    QByteArray processStdout;                // the stdout of the process
+    QByteArray processStderr;                // the stderr of the process
+    bool outputLimitExceededEmitted = false; // whether outputLimitExceeded is emitted or not
+    bool timeLimitExceeded = false;          // whether the (CPU) time limit is exceeded
+    bool idleLimitExceeded = false;          // whether the wall time limit is exceeded while the CPU time limit is not
+    ForkServerExecution *forkRun = nullptr;  // the execution in the fork server, null if it's not running
+    QTemporaryFile *outputFile = nullptr;    // the stdout of the execution in the fork server
+    QTemporaryFile *errorFile = nullptr;     // the stderr of the execution in the fork server
+    NativeLaunch *nativeLaunch = nullptr;    // the launch in the native launcher, null if it's not running
+    PerfCounters *counters = nullptr;        // the hardware event counters of runProcess, null if they are not used
+    QTimer *usageTimer = nullptr;            // the timer used to sample the resource usage
+    qint64 monitoredPid = -1;                // the pid of the program whose resource usage is sampled
+    qint64 lastCpuTime = 0;                  // the CPU time of the program at the last sample, in milliseconds
+    qint64 lastSampleTime = 0;               // the time of the last sample since the program started, in milliseconds
+};
+
+} // namespace Core
+
+#endif // RUNNERWORKER_HPP
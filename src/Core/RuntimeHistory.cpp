@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/RuntimeHistory.hpp"
+#include "Core/EventLogger.hpp"
+#include <QDir>
+#include <QMap>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+
+namespace Core
+{
+
+namespace
+{
+const QString CONNECTION_NAME = "Runtime History"; // the database is not opened as the default connection
+const int SAMPLES_PER_TEST = 200;                  // the number of samples kept for each test
+const qint64 TIME_RESOLUTION = 5; // differences within this time in milliseconds are always considered as noise
+
+const auto CREATE_TABLE_SQL = QLatin1String(R"(
+    CREATE TABLE IF NOT EXISTS runs(
+        problem VARCHAR NOT NULL,
+        test BLOB NOT NULL,
+        build BLOB NOT NULL,
+        time_used INTEGER NOT NULL,
+        memory_used INTEGER NOT NULL,
+        recorded_at INTEGER NOT NULL
+    ))");
+
+const auto CREATE_INDEX_SQL = QLatin1String(R"(
+    CREATE INDEX IF NOT EXISTS runs_of_test ON runs(problem, test, recorded_at)
+    )");
+
+const auto INSERT_RUN_SQL = QLatin1String(R"(
+    INSERT INTO runs(problem, test, build, time_used, memory_used, recorded_at) VALUES(?, ?, ?, ?, ?, ?)
+    )");
+
+const auto DELETE_OLD_RUNS_SQL = QLatin1String(R"(
+    DELETE FROM runs WHERE problem = ? AND test = ? AND rowid NOT IN (
+        SELECT rowid FROM runs WHERE problem = ? AND test = ? ORDER BY recorded_at DESC LIMIT ?)
+    )");
+
+const auto SELECT_RUNS_SQL = QLatin1String(R"(
+    SELECT test, build, time_used, memory_used, recorded_at FROM runs WHERE problem = ? ORDER BY recorded_at DESC
+    )");
+
+double median(QVector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const int n = values.size();
+    return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+} // namespace
+
+RuntimeHistory::RuntimeHistory()
+{
+    const auto dir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    if (!QDir().mkpath(dir))
+    {
+        LOG_WARN("Failed to create " << dir);
+        return;
+    }
+
+    auto db = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+    db.setDatabaseName(QDir(dir).filePath("runtime-history.db"));
+    if (!db.open())
+    {
+        LOG_WARN("Failed to open the runtime history: " << db.lastError().text());
+        return;
+    }
+
+    // with write-ahead logging, a transaction is committed by appending to the log instead of rewriting the pages
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA journal_mode=WAL"))
+        LOG_WARN("Failed to enable the write-ahead logging: " << query.lastError().text());
+    if (!query.exec(CREATE_TABLE_SQL) || !query.exec(CREATE_INDEX_SQL))
+    {
+        LOG_WARN("Failed to create the runtime history table: " << query.lastError().text());
+        return;
+    }
+
+    isOpen = true;
+}
+
+RuntimeHistory *RuntimeHistory::instance()
+{
+    static RuntimeHistory history;
+    return &history;
+}
+
+void RuntimeHistory::record(const QString &problem, const QVector<QPair<QByteArray, Sample>> &samples)
+{
+    if (!isOpen || samples.isEmpty())
+        return;
+
+    auto db = QSqlDatabase::database(CONNECTION_NAME);
+    if (!db.transaction())
+    {
+        LOG_WARN("Failed to start a transaction of the runtime history: " << db.lastError().text());
+        return;
+    }
+
+    QSqlQuery insert(db);
+    insert.prepare(INSERT_RUN_SQL);
+    QSet<QByteArray> tests;
+    for (const auto &sample : samples)
+    {
+        insert.addBindValue(problem);
+        insert.addBindValue(sample.first);
+        insert.addBindValue(sample.second.build);
+        insert.addBindValue(sample.second.timeUsed);
+        insert.addBindValue(sample.second.memoryUsed);
+        insert.addBindValue(sample.second.recordedAt);
+        if (!insert.exec())
+        {
+            LOG_WARN("Failed to record the runtime: " << insert.lastError().text());
+            db.rollback();
+            return;
+        }
+        tests.insert(sample.first);
+    }
+
+    QSqlQuery remove(db);
+    remove.prepare(DELETE_OLD_RUNS_SQL);
+    for (const auto &test : qAsConst(tests))
+    {
+        remove.addBindValue(problem);
+        remove.addBindValue(test);
+        remove.addBindValue(problem);
+        remove.addBindValue(test);
+        remove.addBindValue(SAMPLES_PER_TEST);
+        if (!remove.exec())
+            LOG_WARN("Failed to remove the old runtimes: " << remove.lastError().text());
+    }
+
+    if (!db.commit())
+    {
+        LOG_WARN("Failed to commit the runtime history: " << db.lastError().text());
+        db.rollback();
+    }
+}
+
+RuntimeHistory::Histories RuntimeHistory::samples(const QString &problem, int limit) const
+{
+    Histories result;
+    if (!isOpen)
+        return result;
+
+    QSqlQuery query(QSqlDatabase::database(CONNECTION_NAME));
+    query.setForwardOnly(true);
+    query.prepare(SELECT_RUNS_SQL);
+    query.addBindValue(problem);
+    if (!query.exec())
+    {
+        LOG_WARN("Failed to read the runtime history: " << query.lastError().text());
+        return result;
+    }
+
+    // the rows are the newest first, so the first ones of each test are kept
+    while (query.next())
+    {
+        auto &samples = result[query.value(0).toByteArray()];
+        if (samples.size() >= limit)
+            continue;
+        Sample sample;
+        sample.build = query.value(1).toByteArray();
+        sample.timeUsed = query.value(2).toLongLong();
+        sample.memoryUsed = query.value(3).toLongLong();
+        sample.recordedAt = query.value(4).toLongLong();
+        samples.push_back(sample);
+    }
+    for (auto &samples : result)
+        std::reverse(samples.begin(), samples.end());
+    return result;
+}
+
+RuntimeHistory::Regression RuntimeHistory::detectRegression(const QVector<Sample> &samples, double minimumThreshold)
+{
+    Regression result;
+    if (samples.isEmpty())
+        return result;
+
+    // the latest build is the build of the last sample, the previous build is the last one recorded before it
+    const auto currentBuild = samples.back().build;
+    QByteArray previousBuild;
+    for (int i = samples.size() - 1; i >= 0; --i)
+    {
+        if (samples[i].build != currentBuild)
+        {
+            previousBuild = samples[i].build;
+            break;
+        }
+    }
+    if (previousBuild.isEmpty())
+        return result;
+
+    // group the times by builds, and measure the noise by the repeated executions of each build
+    QMap<QByteArray, QVector<double>> times;
+    for (const auto &sample : samples)
+        times[sample.build].push_back(sample.timeUsed);
+
+    QVector<double> deviations;
+    for (const auto &buildTimes : qAsConst(times))
+    {
+        if (buildTimes.size() < 2)
+            continue;
+        const auto center = median(buildTimes);
+        if (center < TIME_RESOLUTION)
+            continue;
+        QVector<double> relative;
+        for (auto time : buildTimes)
+            relative.push_back(std::abs(time - center) / center);
+        deviations.push_back(median(relative));
+    }
+    const double noise = deviations.isEmpty() ? 0 : median(deviations);
+
+    result.previousTime = qint64(std::round(median(times[previousBuild])));
+    result.currentTime = qint64(std::round(median(times[currentBuild])));
+    result.threshold = qMax(minimumThreshold, 3 * noise);
+    result.regressed = result.currentTime - result.previousTime > TIME_RESOLUTION &&
+                       result.currentTime > result.previousTime * (1 + result.threshold);
+    return result;
+}
+
+} // namespace Core
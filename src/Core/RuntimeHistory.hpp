@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The RuntimeHistory stores the time and memory used by every execution in a local SQLite database, identified by
+ * the problem, the id of the test case and the hash of the executable file (the build).
+ * It's used to find the performance regressions: when a new build of a solution is slower than the previous build on
+ * the same test beyond the noise, which is measured by the repeated executions of the same builds.
+ * Only the latest samples of each test are kept.
+ * The database is only accessed on Core::TestIOThread by Core::RuntimeRecorder, and the samples of a run are written in
+ * one transaction, so the GUI never waits for the disk.
+ */
+
+#ifndef RUNTIMEHISTORY_HPP
+#define RUNTIMEHISTORY_HPP
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+namespace Core
+{
+
+class RuntimeHistory
+{
+  public:
+    // an execution of a build on a test
+    struct Sample
+    {
+        QByteArray build;       // the hash of the executable file, see Core::VerdictCache::executableHash
+        qint64 timeUsed = 0;    // the time used, in milliseconds
+        qint64 memoryUsed = -1; // the peak resident set size sampled during the execution in bytes, -1 if unknown
+        qint64 recordedAt = 0;  // when it's recorded, in milliseconds since epoch
+    };
+
+    using Histories = QHash<QByteArray, QVector<Sample>>; // the samples of the tests, the oldest first
+
+    // the comparison between the latest build and the previous build on a test
+    struct Regression
+    {
+        bool regressed = false;  // whether the latest build is slower beyond the threshold
+        qint64 previousTime = 0; // the median time used by the previous build
+        qint64 currentTime = 0;  // the median time used by the latest build
+        double threshold = 0;    // the relative slowdown which is considered as noise
+    };
+
+    /**
+     * @brief get the history, the database is opened when it's used for the first time
+     * @note this should be used on the test I/O thread only
+     */
+    static RuntimeHistory *instance();
+
+    /**
+     * @brief record the executions of a run in one transaction
+     * @param problem the identity of the problem, e.g. the problem URL or the path to the source file
+     * @param samples the ids of the test cases (see Widgets::TestCasesModel::TestCaseData::id) and the executions
+     */
+    void record(const QString &problem, const QVector<QPair<QByteArray, Sample>> &samples);
+
+    /**
+     * @brief get the latest executions on the tests of a problem by one query
+     * @param limit the maximum number of samples of each test
+     */
+    Histories samples(const QString &problem, int limit) const;
+
+    /**
+     * @brief compare the latest build in the samples with the previous one
+     * @param samples the samples in the order they are recorded
+     * @param minimumThreshold the minimum relative slowdown to be considered as a regression, e.g. 0.1 for 10%
+     * @note The median times of the two builds are compared. The noise is the median relative deviation of the
+     * repeated executions of the same builds, and the threshold is the larger one of three times the noise and
+     * minimumThreshold. Differences within a few milliseconds are always ignored.
+     */
+    static Regression detectRegression(const QVector<Sample> &samples, double minimumThreshold);
+
+  private:
+    RuntimeHistory();
+
+    bool isOpen = false; // whether the database is opened and the table is created
+};
+
+} // namespace Core
+
+#endif // RUNTIMEHISTORY_HPP
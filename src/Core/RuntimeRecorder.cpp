@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/RuntimeRecorder.hpp"
+#include "Core/EventLogger.hpp"
+
+namespace Core
+{
+
+RuntimeRecorder::RuntimeRecorder(const Task &task) : task(task)
+{
+}
+
+void RuntimeRecorder::start()
+{
+    LOG_INFO(INFO_OF(task.samples.size()));
+
+    auto *history = RuntimeHistory::instance();
+    history->record(task.problem, task.samples);
+
+    // the history of the problem is read by one query, only the tests in this run are reported
+    const auto all = history->samples(task.problem, task.historyLimit);
+    RuntimeHistory::Histories histories;
+    for (const auto &sample : task.samples)
+        histories.insert(sample.first, all.value(sample.first));
+
+    emit finished(task.problem, histories);
+}
+
+} // namespace Core
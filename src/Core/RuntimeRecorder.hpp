@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The RuntimeRecorder writes the runtimes of a run to Core::RuntimeHistory and reads the updated history of the run
+ * tests back on Core::TestIOThread, so the database is never accessed on the GUI thread.
+ * The samples are buffered by MainWindow during a run and recorded by one recorder when the run finishes.
+ */
+
+#ifndef RUNTIMERECORDER_HPP
+#define RUNTIMERECORDER_HPP
+
+#include "Core/RuntimeHistory.hpp"
+#include <QObject>
+
+namespace Core
+{
+
+class RuntimeRecorder : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // the samples to record and the history to read back
+    struct Task
+    {
+        QString problem;                                            // the identity of the problem
+        QVector<QPair<QByteArray, RuntimeHistory::Sample>> samples; // the ids of the test cases and the executions
+        int historyLimit = 0;                                       // the maximum number of samples read of each test
+    };
+
+    /**
+     * @brief construct a recorder
+     * @note the recorder should be moved to the test I/O thread before calling start
+     */
+    explicit RuntimeRecorder(const Task &task);
+
+  public slots:
+    /**
+     * @brief record the samples and read the history
+     */
+    void start();
+
+  signals:
+    /**
+     * @brief the samples are recorded
+     * @param problem the problem of the task
+     * @param histories the latest samples of the tests in the task
+     */
+    void finished(const QString &problem, const Core::RuntimeHistory::Histories &histories);
+
+  private:
+    const Task task;
+};
+
+} // namespace Core
+
+#endif // RUNTIMERECORDER_HPP
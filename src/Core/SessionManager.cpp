@@ -18,11 +18,14 @@
 #include "Core/SessionManager.hpp"
 #include "../../ui/ui_appwindow.h"
 #include "Core/EventLogger.hpp"
+#include "Core/TestData.hpp"
 #include "Util/FileUtil.hpp"
 #include "appwindow.hpp"
 #include "generated/portable.hpp"
 #include "mainwindow.hpp"
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -118,7 +121,7 @@ void SessionManager::setAutoUpdateDuration(int duration)
     timer->setInterval(duration);
 }
 
-QString SessionManager::currentSessionText()
+QString SessionManager::currentSessionText(bool inlineTests)
 {
     QJsonObject json;
     json.insert("currentIndex", app->ui->tabWidget->currentIndex());
@@ -126,7 +129,7 @@ QString SessionManager::currentSessionText()
     QJsonArray arr;
     for (int t = 0; t < app->ui->tabWidget->count(); t++)
     {
-        arr.push_back(QJsonDocument::fromVariant(app->windowAt(t)->toStatus().toMap()).object());
+        arr.push_back(QJsonDocument::fromVariant(app->windowAt(t)->toStatus(inlineTests).toMap()).object());
     }
 
     json.insert("tabs", arr);
@@ -144,8 +147,46 @@ void SessionManager::saveSession(const QString &sessionText)
     Util::saveFile(Util::configFilePath(sessionFileLocations[0]), sessionText, "Save Session", true, nullptr, true);
 }
 
+QString SessionManager::testFilePath(const TestData &data)
+{
+    const QDir dir(testFilesDirectory());
+    if (!dir.mkpath("."))
+    {
+        LOG_WARN("Failed to create " << dir.path());
+        return QString();
+    }
+
+    const auto path = dir.filePath(QString::fromLatin1(data.hash().toHex()));
+    if (!QFile::exists(path) && !QFile::copy(data.filePath(), path))
+    {
+        LOG_WARN("Failed to copy " << data.filePath() << " to " << path);
+        return QString();
+    }
+    return path;
+}
+
 void SessionManager::updateSession()
 {
-    saveSession(currentSessionText());
+    const auto text = currentSessionText();
+    saveSession(text);
+    removeUnusedTestFiles(text);
+}
+
+void SessionManager::removeUnusedTestFiles(const QString &sessionText)
+{
+    const QDir dir(testFilesDirectory());
+    for (const auto &name : dir.entryList(QDir::Files))
+    {
+        if (!sessionText.contains(name))
+        {
+            LOG_INFO("Removing the unused session test case " << name);
+            QFile::remove(dir.filePath(name));
+        }
+    }
+}
+
+QString SessionManager::testFilesDirectory()
+{
+    return QFileInfo(Util::configFilePath(sessionFileLocations[0])).dir().filePath("cp_editor_session_tests");
 }
 } // namespace Core
@@ -25,6 +25,8 @@ class QTimer;
 
 namespace Core
 {
+class TestData;
+
 class SessionManager : public QObject
 {
     Q_OBJECT
@@ -38,16 +40,38 @@ class SessionManager : public QObject
 
     void setAutoUpdateDuration(int duration);
 
-    QString currentSessionText();
+    /**
+     * @brief get the JSON of the current session
+     * @param inlineTests whether to put the file-backed test cases into the JSON instead of referring to the copies
+     *        kept for the session, it's used when the session is exported to another place
+     */
+    QString currentSessionText(bool inlineTests = false);
 
     static QString lastSessionPath();
 
     static void saveSession(const QString &sessionText);
 
+    /**
+     * @brief get the path to the copy of a file-backed test case content kept for the session
+     * @returns an empty string if failed to copy it
+     * @note the copies are named by the hashes of the contents, so a content is copied only once
+     */
+    static QString testFilePath(const TestData &data);
+
   public slots:
     void updateSession();
 
   private:
+    /**
+     * @brief remove the copies of the test cases which are not referred to by the session
+     */
+    static void removeUnusedTestFiles(const QString &sessionText);
+
+    /**
+     * @brief the directory of the copies of the file-backed test cases
+     */
+    static QString testFilesDirectory();
+
     QTimer *timer = nullptr;
     AppWindow *app = nullptr;
 };
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/SpeedCalibration.hpp"
+#include "Core/EventLogger.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <generated/SettingsHelper.hpp>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace Core
+{
+
+namespace
+{
+// The kernels are fixed, changing them invalidates the reference benchmark time.
+// Each of them returns a value depending on all of its work, so the work is not optimized away.
+
+// integer arithmetic and unpredictable branches
+quint64 integerKernel()
+{
+    quint64 x = 88172645463325252ULL, sum = 0;
+    for (int i = 0; i < 100000000; ++i)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        if (x % 3 == 0)
+            sum += x >> 32;
+        else
+            sum ^= x;
+    }
+    return sum;
+}
+
+// floating-point arithmetic
+quint64 floatKernel()
+{
+    double sum = 0;
+    for (int i = 1; i <= 50000000; ++i)
+        sum += std::sqrt(double(i)) / (i + 0.5);
+    return quint64(sum);
+}
+
+// random accesses in an array much larger than the caches
+quint64 randomAccessKernel()
+{
+    const quint32 n = 1 << 22;
+    std::vector<quint32> next(n);
+    std::iota(next.begin(), next.end(), 0U);
+    quint64 x = 12345;
+    for (quint32 i = n - 1; i > 0; --i)
+    {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        std::swap(next[i], next[(x >> 33) % i]);
+    }
+    quint32 p = 0;
+    quint64 sum = 0;
+    for (int i = 0; i < 4000000; ++i)
+    {
+        p = next[p];
+        sum += p;
+    }
+    return sum;
+}
+
+// sorting, a mix of comparisons, branches and sequential memory accesses
+quint64 sortKernel()
+{
+    std::vector<quint32> a(1 << 21);
+    quint64 x = 1;
+    for (auto &value : a)
+    {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        value = quint32(x >> 32);
+    }
+    std::sort(a.begin(), a.end());
+    return a[a.size() / 2];
+}
+
+const int BENCHMARK_ROUNDS = 3; // each kernel is run this number of times, and the fastest round is used
+
+} // namespace
+
+SpeedCalibration::SpeedCalibration() : QThread(QCoreApplication::instance())
+{
+    setObjectName("Speed Calibration");
+    connect(this, &QThread::finished, this, &SpeedCalibration::onBenchmarkFinished);
+}
+
+SpeedCalibration::~SpeedCalibration()
+{
+    wait();
+}
+
+SpeedCalibration *SpeedCalibration::instance()
+{
+    static SpeedCalibration *calibration = nullptr;
+    if (calibration == nullptr)
+        calibration = new SpeedCalibration();
+    return calibration;
+}
+
+bool SpeedCalibration::isCalibrated()
+{
+    return SettingsHelper::isTimeLimitCalibrationScaleTimeLimits() &&
+           SettingsHelper::getTimeLimitCalibrationReferenceBenchmarkTime() > 0 &&
+           SettingsHelper::getTimeLimitCalibrationBenchmarkTime() > 0;
+}
+
+double SpeedCalibration::speedFactor()
+{
+    if (!isCalibrated())
+        return 1;
+    return double(SettingsHelper::getTimeLimitCalibrationBenchmarkTime()) /
+           SettingsHelper::getTimeLimitCalibrationReferenceBenchmarkTime();
+}
+
+int SpeedCalibration::scaledTimeLimit(int timeLimit)
+{
+    return int(qBound(1.0, std::round(timeLimit * speedFactor()), double(std::numeric_limits<int>::max())));
+}
+
+qint64 SpeedCalibration::normalizedTime(qint64 timeUsed)
+{
+    return qint64(std::round(timeUsed / speedFactor()));
+}
+
+void SpeedCalibration::calibrate()
+{
+    if (isRunning())
+    {
+        LOG_INFO("The benchmark is already running");
+        return;
+    }
+    LOG_INFO("Starting the benchmark");
+    start(QThread::HighPriority);
+}
+
+void SpeedCalibration::run()
+{
+    static volatile quint64 sink = 0;
+    qint64 total = 0;
+    for (auto *kernel : {integerKernel, floatKernel, randomAccessKernel, sortKernel})
+    {
+        qint64 fastest = std::numeric_limits<qint64>::max();
+        for (int i = 0; i < BENCHMARK_ROUNDS; ++i)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            sink = sink + kernel();
+            fastest = qMin(fastest, timer.nsecsElapsed());
+        }
+        total += fastest;
+    }
+    benchmarkTime = qMax(Q_INT64_C(1), total / 1000000);
+}
+
+void SpeedCalibration::onBenchmarkFinished()
+{
+    LOG_INFO(INFO_OF(benchmarkTime));
+    const auto savedTime = qMin(benchmarkTime, qint64(std::numeric_limits<int>::max()));
+    SettingsHelper::setTimeLimitCalibrationBenchmarkTime(int(savedTime));
+    const auto referenceTime = SettingsHelper::getTimeLimitCalibrationReferenceBenchmarkTime();
+    emit calibrated(savedTime, referenceTime > 0 ? double(savedTime) / referenceTime : -1);
+}
+
+} // namespace Core
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The SpeedCalibration measures the speed of this machine by a fixed benchmark, so that the time limits made for
+ * the judge can be used on machines of different speeds.
+ * The benchmark consists of a few CPU-bound and memory-bound kernels, and it runs on its own thread. The result is
+ * cached in the settings, so it only runs again when it's requested.
+ * The benchmark time on the reference judge has no default, because it depends on the compiler and the build options
+ * of the editor. The user measures it by running the benchmark on a machine with the speed of the judge.
+ * The speed factor is the benchmark time on this machine divided by the one on the reference judge, the time limits
+ * are multiplied by it and the time used is divided by it to get the time on the judge.
+ */
+
+#ifndef SPEEDCALIBRATION_HPP
+#define SPEEDCALIBRATION_HPP
+
+#include <QThread>
+
+namespace Core
+{
+
+class SpeedCalibration : public QThread
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief get the calibration, it's created when it's used for the first time
+     * @note this should be called on the GUI thread
+     */
+    static SpeedCalibration *instance();
+
+    /**
+     * @brief whether the time limits are scaled, the reference benchmark time is set and the benchmark has been run
+     */
+    static bool isCalibrated();
+
+    /**
+     * @brief get the speed factor of this machine relative to the reference judge
+     * @returns a number greater than 1 if this machine is slower than the judge, 1 if it's not calibrated
+     */
+    static double speedFactor();
+
+    /**
+     * @brief convert a time limit on the judge to the time limit on this machine
+     */
+    static int scaledTimeLimit(int timeLimit);
+
+    /**
+     * @brief convert the time used on this machine to the estimated time used on the judge
+     */
+    static qint64 normalizedTime(qint64 timeUsed);
+
+    /**
+     * @brief wait for the benchmark to finish
+     */
+    ~SpeedCalibration() override;
+
+    /**
+     * @brief run the benchmark in the background, and save the result when it finishes
+     * @note nothing happens if the benchmark is already running
+     */
+    void calibrate();
+
+  signals:
+    /**
+     * @brief the benchmark has finished and the result is saved
+     * @param benchmarkTime the time used by the benchmark on this machine, in milliseconds
+     * @param speedFactor the new speed factor, see speedFactor, -1 if the reference benchmark time is not set
+     */
+    void calibrated(qint64 benchmarkTime, double speedFactor);
+
+  protected:
+    void run() override;
+
+  private slots:
+    /**
+     * @brief save the result of the benchmark on the GUI thread, and emit calibrated
+     */
+    void onBenchmarkFinished();
+
+  private:
+    SpeedCalibration();
+
+    qint64 benchmarkTime = 0; // the result of the last benchmark, written on the benchmark thread
+};
+
+} // namespace Core
+
+#endif // SPEEDCALIBRATION_HPP
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/TestArchive.hpp"
+#include "Core/EventLogger.hpp"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+namespace Core
+{
+
+static const char MAGIC[] = "CPEDTEST";
+static const int MAGIC_SIZE = 8;
+static const quint32 VERSION = 1;
+static const int HEADER_SIZE = MAGIC_SIZE + 4 + 4;
+static const int HASH_SIZE = 20;
+static const int RECORD_SIZE = 1 + 8 + 8 + 8 + HASH_SIZE;
+
+// the contents larger than this are not compressed, because qCompress needs the whole content in the memory
+static const int MAX_COMPRESSED_LENGTH = 64 << 20;
+// a fast compression level, the test cases are usually very repetitive, so it still makes them much smaller
+static const int COMPRESSION_LEVEL = 1;
+
+template <typename T> static void appendInteger(QByteArray *bytes, T value)
+{
+    value = qToLittleEndian(value);
+    bytes->append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+QString TestArchive::path(const QString &sourceFilePath)
+{
+    return TestManifest::testCaseFilePath("./${filename}.tests", sourceFilePath, 0);
+}
+
+bool TestArchive::write(const QString &path, const QVector<TestData> &inputs, const QVector<TestData> &answers,
+                        bool compress, bool safe, QString *error)
+{
+    const auto dirPath = QFileInfo(path).absolutePath();
+    LOG_ERR_IF(!QDir().mkpath(dirPath), QString("Failed to create the directory [%1]").arg(dirPath));
+
+    QScopedPointer<QFileDevice> file(safe ? static_cast<QFileDevice *>(new QSaveFile(path)) : new QFile(path));
+    if (!file->open(QIODevice::WriteOnly))
+    {
+        *error = QCoreApplication::translate("Core::TestArchive", "Failed to open [%1]. Do I have write permission?")
+                     .arg(path);
+        return false;
+    }
+
+    // the blocks are written first, so the index is filled with zeros and written again after them
+    const int count = qMin(inputs.size(), answers.size());
+    QVector<Record> records(count * 2);
+    bool ok = file->write(QByteArray(HEADER_SIZE + records.size() * RECORD_SIZE, '\0')) != -1;
+    for (int i = 0; ok && i < records.size(); ++i)
+    {
+        const auto &data = i % 2 == 0 ? inputs[i / 2] : answers[i / 2];
+        if (data.isEmpty())
+            continue;
+
+        auto &record = records[i];
+        auto block = data.bytes();
+        record.flags = Saved;
+        record.offset = quint64(file->pos());
+        record.length = quint64(block.size());
+        record.hash = data.hash();
+        if (compress && block.size() <= MAX_COMPRESSED_LENGTH)
+        {
+            const auto compressed = qCompress(block, COMPRESSION_LEVEL);
+            if (!compressed.isEmpty() && compressed.size() < block.size())
+            {
+                block = compressed;
+                record.flags |= Compressed;
+            }
+        }
+        record.size = quint64(block.size());
+        ok = file->write(block) == block.size();
+    }
+
+    if (ok)
+    {
+        QByteArray index(MAGIC, MAGIC_SIZE);
+        index.reserve(HEADER_SIZE + records.size() * RECORD_SIZE);
+        appendInteger(&index, VERSION);
+        appendInteger(&index, quint32(count));
+        for (const auto &record : records)
+        {
+            appendInteger(&index, record.flags);
+            appendInteger(&index, record.offset);
+            appendInteger(&index, record.size);
+            appendInteger(&index, record.length);
+            index.append(record.hash.leftJustified(HASH_SIZE, '\0', true));
+        }
+        ok = file->seek(0) && file->write(index) == index.size();
+    }
+
+    auto *saveFile = qobject_cast<QSaveFile *>(file.data());
+    if (ok)
+        ok = saveFile != nullptr ? saveFile->commit() : file->flush();
+    else if (saveFile != nullptr)
+        saveFile->cancelWriting();
+
+    if (!ok)
+    {
+        *error = QCoreApplication::translate("Core::TestArchive", "Failed to save to [%1]. Do I have write permission?")
+                     .arg(path);
+        return false;
+    }
+    return true;
+}
+
+TestArchive::~TestArchive()
+{
+    if (mapped != nullptr)
+        file.unmap(mapped);
+}
+
+bool TestArchive::open(const QString &path, QString *error)
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        *error = QCoreApplication::translate("Core::TestArchive", "Failed to open [%1]. Do I have read permission?")
+                     .arg(path);
+        return false;
+    }
+
+    const auto invalid = [&error, &path] {
+        *error = QCoreApplication::translate("Core::TestArchive", "[%1] is not a valid test case archive.").arg(path);
+        return false;
+    };
+
+    const qint64 size = file.size();
+    if (size < HEADER_SIZE)
+        return invalid();
+    mapped = file.map(0, size);
+    if (mapped == nullptr)
+    {
+        *error = QCoreApplication::translate("Core::TestArchive", "Failed to map [%1] into the memory: %2")
+                     .arg(path)
+                     .arg(file.errorString());
+        return false;
+    }
+
+    if (std::memcmp(mapped, MAGIC, MAGIC_SIZE) != 0 || qFromLittleEndian<quint32>(mapped + MAGIC_SIZE) != VERSION)
+        return invalid();
+    const qint64 count = qFromLittleEndian<quint32>(mapped + MAGIC_SIZE + 4);
+    if (HEADER_SIZE + count * 2 * RECORD_SIZE > size)
+        return invalid();
+
+    records.resize(int(count * 2));
+    const uchar *position = mapped + HEADER_SIZE;
+    for (auto &record : records)
+    {
+        record.flags = *position;
+        record.offset = qFromLittleEndian<quint64>(position + 1);
+        record.size = qFromLittleEndian<quint64>(position + 9);
+        record.length = qFromLittleEndian<quint64>(position + 17);
+        record.hash = QByteArray(reinterpret_cast<const char *>(position + 25), HASH_SIZE);
+        position += RECORD_SIZE;
+        if ((record.flags & Saved) && (record.offset > quint64(size) || record.size > quint64(size) - record.offset ||
+                                       record.size > quint64(std::numeric_limits<int>::max())))
+        {
+            return invalid();
+        }
+    }
+    return true;
+}
+
+int TestArchive::count() const
+{
+    return records.size() / 2;
+}
+
+QVector<TestManifest::Entry> TestArchive::entries() const
+{
+    QVector<TestManifest::Entry> result(count());
+    for (int i = 0; i < count(); ++i)
+    {
+        if (records[i * 2].flags & Saved)
+            result[i].inputHash = records[i * 2].hash;
+        if (records[i * 2 + 1].flags & Saved)
+            result[i].answerHash = records[i * 2 + 1].hash;
+    }
+    return result;
+}
+
+bool TestArchive::read(int index, qint64 threshold, TestData *input, TestData *answer, QString *error) const
+{
+    return readRecord(records[index * 2], threshold, input, error) &&
+           readRecord(records[index * 2 + 1], threshold, answer, error);
+}
+
+bool TestArchive::readRecord(const Record &record, qint64 threshold, TestData *data, QString *error) const
+{
+    if (!(record.flags & Saved))
+    {
+        *data = TestData();
+        return true;
+    }
+
+    // the uncompressed blocks are copied from the mapped file directly
+    auto content = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped + record.offset), int(record.size));
+    if (record.flags & Compressed)
+        content = qUncompress(content);
+    if (quint64(content.size()) != record.length)
+    {
+        *error = QCoreApplication::translate("Core::TestArchive", "A test case in [%1] is corrupted.")
+                     .arg(file.fileName());
+        return false;
+    }
+
+    *data = TestData::fromBytes(content, threshold);
+    return true;
+}
+
+} // namespace Core
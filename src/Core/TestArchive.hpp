@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The TestArchive is a single file which contains all test cases of a source file, used when the Test Case Storage
+ * is "Archive". It's much faster than hundreds of small files on a network drive or in a version control system.
+ *
+ * The layout of the file, all integers are little-endian:
+ *   header:  the magic "CPEDTEST", the version (quint32), the number of test cases (quint32)
+ *   index:   two records for each test case, the input and the answer, each of them is
+ *            the flags (quint8), the offset of the block (quint64), the size of the block (quint64),
+ *            the size of the content (quint64) and the SHA-1 of the content (20 bytes), see TestData::hash
+ *   blocks:  the contents of the test cases, each of them is compressed by qCompress if the Compressed flag is set
+ *
+ * The archive is mapped into the memory when it's opened, so only the index and the test cases read are loaded.
+ */
+
+#ifndef TESTARCHIVE_HPP
+#define TESTARCHIVE_HPP
+
+#include "Core/TestData.hpp"
+#include "Core/TestManifest.hpp"
+#include <QFile>
+#include <QVector>
+
+namespace Core
+{
+
+class TestArchive
+{
+  public:
+    /**
+     * @brief get the path to the archive of a source file
+     */
+    static QString path(const QString &sourceFilePath);
+
+    /**
+     * @brief write an archive
+     * @param path the path to the archive
+     * @param inputs the inputs of the test cases, an empty input is not saved
+     * @param answers the answers of the test cases, it should be as long as inputs
+     * @param compress whether to compress the contents, a content is kept uncompressed if it's not made smaller
+     * @param safe whether to write the file with QSaveFile
+     * @param error set to the reason of the failure if failed to write the archive
+     * @note it can be used on any thread
+     */
+    static bool write(const QString &path, const QVector<TestData> &inputs, const QVector<TestData> &answers,
+                      bool compress, bool safe, QString *error);
+
+    TestArchive() = default;
+    ~TestArchive();
+
+    /**
+     * @brief open an archive and read its index
+     * @param path the path to the archive
+     * @param error set to the reason of the failure if failed to open the archive
+     * @note it can be used on any thread
+     */
+    bool open(const QString &path, QString *error);
+
+    /**
+     * @brief get the number of test cases in the opened archive
+     */
+    int count() const;
+
+    /**
+     * @brief get the hashes of the test cases in the opened archive, the paths in the entries are empty
+     */
+    QVector<TestManifest::Entry> entries() const;
+
+    /**
+     * @brief read a test case in the opened archive
+     * @param index the index of the test case
+     * @param threshold the contents larger than this number of bytes are kept in files, see TestData::fileThreshold
+     * @param input the input of the test case, set to a null TestData if it's not saved
+     * @param answer the answer of the test case, set to a null TestData if it's not saved
+     * @param error set to the reason of the failure if failed to read the test case
+     */
+    bool read(int index, qint64 threshold, TestData *input, TestData *answer, QString *error) const;
+
+  private:
+    Q_DISABLE_COPY(TestArchive)
+
+    // a record in the index
+    struct Record
+    {
+        quint8 flags = 0;   // the combination of the RecordFlags
+        quint64 offset = 0; // the offset of the block from the beginning of the file
+        quint64 size = 0;   // the size of the block
+        quint64 length = 0; // the size of the content
+        QByteArray hash;    // the SHA-1 of the content
+    };
+
+    enum RecordFlags
+    {
+        Saved = 1,     // the content is saved, otherwise it's empty
+        Compressed = 2 // the block is compressed by qCompress
+    };
+
+    /**
+     * @brief read the content of a record
+     */
+    bool readRecord(const Record &record, qint64 threshold, TestData *data, QString *error) const;
+
+    QFile file;              // the opened archive
+    uchar *mapped = nullptr; // the mapped archive, nullptr if it's not opened
+    QVector<Record> records; // the records of the test cases, the input and the answer of each test case
+};
+
+} // namespace Core
+
+#endif // TESTARCHIVE_HPP
@@ -28,8 +28,8 @@ void TestCasesCopyPaster::copy(Widgets::TestCases *testcases)
     {
         if (testcases->isChecked(i))
         {
-            inputs.append(testcases->input(i));
-            expecteds.append(testcases->expected(i));
+            inputs.append(testcases->inputData(i));
+            expecteds.append(testcases->expectedData(i));
         }
     }
 }
@@ -37,8 +37,5 @@ void TestCasesCopyPaster::copy(Widgets::TestCases *testcases)
 void TestCasesCopyPaster::paste(Widgets::TestCases *testcases) const
 {
     LOG_INFO("Paste");
-    for (int i = 0; i < inputs.count() && i < expecteds.count(); ++i)
-    {
-        testcases->addTestCase(inputs[i], expecteds[i]);
-    }
+    testcases->addTestCases(inputs, expecteds);
 }
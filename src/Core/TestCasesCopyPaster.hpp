@@ -18,8 +18,9 @@
 #ifndef TESTCASESCOPYPASTER_HPP
 #define TESTCASESCOPYPASTER_HPP
 
+#include "Core/TestData.hpp"
 #include "Util/Singleton.hpp"
-#include <QStringList>
+#include <QVector>
 
 namespace Widgets
 {
@@ -38,11 +39,12 @@ class TestCasesCopyPaster : public Util::Singleton<TestCasesCopyPaster>
     /**
      * @brief append copied test cases to *testcases*
      * @param testcases the TestCases to be pasted to
+     * @note the duplicates of the existing test cases are detected, see Widgets::TestCases::addTestCases
      */
     void paste(Widgets::TestCases *testcases) const;
 
   private:
-    QStringList inputs, expecteds;
+    QVector<Core::TestData> inputs, expecteds;
 };
 
 #endif // TESTCASESCOPYPASTER_HPP
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/TestData.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/MessageLogger.hpp"
+#include "Util/FileUtil.hpp"
+#include "generated/SettingsHelper.hpp"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <algorithm>
+
+namespace Core
+{
+
+// the number of characters or bytes written to the file at a time
+static const int CHUNK_SIZE = 1 << 20;
+
+struct TestData::Blob
+{
+    ~Blob()
+    {
+        if (mapped != nullptr)
+            file.unmap(mapped);
+    }
+
+    /**
+     * @brief get the content of the file, the file is mapped into the memory when it's read for the first time
+     * @note if the file can't be mapped, the content is read into the memory instead
+     */
+    QByteArray content()
+    {
+        QMutexLocker locker(&mutex);
+        if (mapped == nullptr)
+        {
+            mapped = file.map(0, size);
+            if (mapped == nullptr)
+            {
+                LOG_ERR("Failed to map [" << file.fileName() << "]: " << file.errorString());
+                file.seek(0);
+                return file.readAll();
+            }
+        }
+        return QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), int(size));
+    }
+
+    QTemporaryFile file;     // the file which keeps the content, it's removed when the blob is destructed
+    qint64 size = 0;         // the size of the content in bytes
+    QMutex mutex;            // the content may be read on other threads
+    uchar *mapped = nullptr; // the mapped file, nullptr if it's not mapped yet
+};
+
+struct TestData::Digest
+{
+    QMutex mutex;    // the hash may be calculated on other threads
+    QByteArray hash; // the hash of the content, empty if it's not calculated yet
+};
+
+TestData::TestData(const QString &text) : digest(new Digest())
+{
+    if (shouldBeFileBacked(text.length()))
+    {
+        auto newBlob = createBlob();
+        bool ok = !newBlob.isNull();
+        // the text is encoded chunk by chunk, so there is no second copy of the whole content
+        for (int pos = 0; ok && pos < text.length();)
+        {
+            int length = qMin(CHUNK_SIZE, text.length() - pos);
+            if (pos + length < text.length() && text[pos + length - 1].isHighSurrogate())
+                --length;
+            const auto chunk = text.midRef(pos, length).toUtf8();
+            ok = newBlob->file.write(chunk) == chunk.size();
+            pos += length;
+        }
+        if (ok && newBlob->file.flush())
+        {
+            newBlob->size = newBlob->file.size();
+            blob = newBlob;
+            return;
+        }
+        LOG_ERR("Failed to keep the test data in a file, it's kept in the memory");
+    }
+    inMemory = text;
+}
+
+TestData TestData::fromFile(const QString &path, const QString &head, MessageLogger *log, bool notExistWarning)
+{
+    if (!QFile::exists(path))
+        return TestData(Util::readFile(path, head, log, notExistWarning));
+
+    QString error;
+    auto data = readFile(path, fileThreshold(), &error);
+    if (data.isNull())
+    {
+        if (log != nullptr)
+            log->error(head, error);
+        LOG_ERR(error);
+    }
+    return data;
+}
+
+TestData TestData::readFile(const QString &path, qint64 threshold, QString *error)
+{
+    // the line endings are converted in the same way as Util::readFile
+    QFile source(path);
+    if (!source.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        *error = QCoreApplication::translate("Core::TestData", "Failed to open [%1]. Do I have read permission?")
+                     .arg(path);
+        return TestData();
+    }
+
+    TestData data;
+    data.digest.reset(new Digest());
+
+    if (source.size() <= threshold)
+    {
+        data.inMemory = QString::fromUtf8(source.readAll());
+        if (data.inMemory.isNull())
+            data.inMemory = "";
+        return data;
+    }
+
+    auto newBlob = createBlob();
+    bool ok = !newBlob.isNull();
+    while (ok && !source.atEnd())
+    {
+        const auto chunk = source.read(CHUNK_SIZE);
+        ok = !chunk.isEmpty() && newBlob->file.write(chunk) == chunk.size();
+    }
+    if (!ok || !newBlob->file.flush())
+    {
+        *error = QCoreApplication::translate("Core::TestData", "Failed to copy [%1] into the temporary directory.")
+                     .arg(path);
+        return TestData();
+    }
+
+    newBlob->size = newBlob->file.size();
+    data.blob = newBlob;
+    return data;
+}
+
+TestData TestData::fromBytes(const QByteArray &bytes, qint64 threshold)
+{
+    TestData data;
+    data.digest.reset(new Digest());
+
+    if (bytes.size() > threshold)
+    {
+        auto newBlob = createBlob();
+        if (!newBlob.isNull() && newBlob->file.write(bytes) == bytes.size() && newBlob->file.flush())
+        {
+            newBlob->size = bytes.size();
+            data.blob = newBlob;
+            return data;
+        }
+        LOG_ERR("Failed to keep the test data in a file, it's kept in the memory");
+    }
+
+    data.inMemory = QString::fromUtf8(bytes);
+    if (data.inMemory.isNull())
+        data.inMemory = "";
+    return data;
+}
+
+bool TestData::isNull() const
+{
+    return blob.isNull() && inMemory.isNull();
+}
+
+bool TestData::isEmpty() const
+{
+    return blob.isNull() ? inMemory.isEmpty() : blob->size == 0;
+}
+
+bool TestData::isBlank() const
+{
+    if (blob.isNull())
+        return inMemory.trimmed().isEmpty();
+    const auto content = blob->content();
+    return std::all_of(content.cbegin(), content.cend(), [](char c) { return QChar::isSpace(uchar(c)); });
+}
+
+bool TestData::isFileBacked() const
+{
+    return !blob.isNull();
+}
+
+QString TestData::filePath() const
+{
+    return blob.isNull() ? QString() : blob->file.fileName();
+}
+
+QString TestData::text() const
+{
+    return blob.isNull() ? inMemory : QString::fromUtf8(blob->content());
+}
+
+QString TestData::preview(int length) const
+{
+    if (blob.isNull())
+        return inMemory.left(length);
+    // a character takes at most 4 bytes in UTF-8, so only the beginning of the file is decoded
+    const auto content = blob->content();
+    return QString::fromUtf8(content.constData(), int(qMin(qint64(content.size()), qint64(length) * 4))).left(length);
+}
+
+QByteArray TestData::bytes() const
+{
+    return blob.isNull() ? inMemory.toUtf8() : blob->content();
+}
+
+QByteArray TestData::hash() const
+{
+    if (digest.isNull())
+        return QCryptographicHash::hash(bytes(), QCryptographicHash::Sha1);
+    QMutexLocker locker(&digest->mutex);
+    if (digest->hash.isEmpty())
+        digest->hash = QCryptographicHash::hash(bytes(), QCryptographicHash::Sha1);
+    return digest->hash;
+}
+
+bool TestData::operator==(const TestData &other) const
+{
+    // they are both in the memory, or they share the same file
+    if (blob == other.blob)
+        return inMemory == other.inMemory;
+    return bytes() == other.bytes();
+}
+
+bool TestData::operator!=(const TestData &other) const
+{
+    return !(*this == other);
+}
+
+QSharedPointer<TestData::Blob> TestData::createBlob()
+{
+    // the directory and the files in it are removed when the application exits
+    static QTemporaryDir directory;
+    if (!directory.isValid())
+    {
+        LOG_ERR("Failed to create the temporary directory for the test data: " << directory.errorString());
+        return QSharedPointer<Blob>();
+    }
+
+    QSharedPointer<Blob> blob(new Blob());
+    blob->file.setFileTemplate(directory.filePath("XXXXXX.txt"));
+    if (!blob->file.open())
+    {
+        LOG_ERR("Failed to create a file for the test data: " << blob->file.errorString());
+        return QSharedPointer<Blob>();
+    }
+    return blob;
+}
+
+qint64 TestData::fileThreshold()
+{
+    return SettingsHelper::getDisplayTestCaseLengthLimit();
+}
+
+bool TestData::shouldBeFileBacked(qint64 length)
+{
+    return length > fileThreshold();
+}
+
+} // namespace Core
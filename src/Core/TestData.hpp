@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * A TestData is the content of an input or an expected output of a test case.
+ * A short content is kept in the memory. A content longer than the Display Test Case Length Limit, which can't be
+ * edited in the test case editors anyway, is kept in a file in a temporary directory instead, and the file is mapped
+ * into the memory only when the bytes are needed. The programs and the checkers read such a file directly, so a large
+ * test case is never copied into the memory to be executed or checked, and the editors only show a preview of it.
+ * A TestData can't be modified after it's constructed, and copying it doesn't copy the content.
+ */
+
+#ifndef TESTDATA_HPP
+#define TESTDATA_HPP
+
+#include <QSharedPointer>
+#include <QString>
+
+class MessageLogger;
+
+namespace Core
+{
+
+class TestData
+{
+  public:
+    /**
+     * @brief construct an empty TestData
+     */
+    TestData() = default;
+
+    /**
+     * @brief construct a TestData with the text as the content
+     * @note it's implicit, so a QString can be used wherever a TestData is expected
+     */
+    TestData(const QString &text); // NOLINT: It should be implicit.
+
+    /**
+     * @brief construct a TestData with the content of a file
+     * @param path the path to the file
+     * @param head the head of the messages
+     * @param log the message logger to show the errors
+     * @param notExistWarning whether to make a warning when the file doesn't exist
+     * @returns a null TestData if failed to read the file
+     * @note a large file is copied into the temporary directory without being loaded into the memory
+     */
+    static TestData fromFile(const QString &path, const QString &head, MessageLogger *log,
+                             bool notExistWarning = false);
+
+    /**
+     * @brief construct a TestData with the content of a file, without reading the settings or showing messages
+     * @param path the path to the file
+     * @param threshold the file is copied into the temporary directory if it's larger than this number of bytes
+     * @param error set to the reason of the failure if failed to read the file
+     * @returns a null TestData if failed to read the file
+     * @note unlike fromFile, it can be used on any thread
+     */
+    static TestData readFile(const QString &path, qint64 threshold, QString *error);
+
+    /**
+     * @brief construct a TestData with the content encoded in UTF-8
+     * @param bytes the content, it's copied, so it can refer to a mapped file
+     * @param threshold the content is kept in a file if it's larger than this number of bytes
+     * @note it can be used on any thread
+     */
+    static TestData fromBytes(const QByteArray &bytes, qint64 threshold);
+
+    /**
+     * @brief get the length above which the contents are kept in files
+     * @note it reads the settings, so it should be called on the GUI thread
+     */
+    static qint64 fileThreshold();
+
+    /**
+     * @brief whether it's constructed by default or with a null QString, or failed to be read from a file
+     */
+    bool isNull() const;
+
+    bool isEmpty() const;
+
+    /**
+     * @brief whether the content contains only white spaces
+     */
+    bool isBlank() const;
+
+    /**
+     * @brief whether the content is kept in a file instead of the memory
+     */
+    bool isFileBacked() const;
+
+    /**
+     * @brief get the path to the file which keeps the content
+     * @returns an empty string if the content is kept in the memory
+     * @note the file is removed when the last copy of this TestData is destructed
+     */
+    QString filePath() const;
+
+    /**
+     * @brief get the whole content as a QString
+     * @note it decodes the whole file if it's file-backed, use preview() if only the beginning is needed
+     */
+    QString text() const;
+
+    /**
+     * @brief get at most the first *length* characters of the content
+     */
+    QString preview(int length) const;
+
+    /**
+     * @brief get the content encoded in UTF-8
+     * @note if it's file-backed, the returned QByteArray refers to the mapped file without copying it, and it's
+     *       valid only while this TestData exists
+     */
+    QByteArray bytes() const;
+
+    /**
+     * @brief get the SHA-1 hash of bytes()
+     * @note it's calculated only once and shared by the copies, so it's cheap to check whether a content is changed
+     */
+    QByteArray hash() const;
+
+    bool operator==(const TestData &other) const;
+    bool operator!=(const TestData &other) const;
+
+  private:
+    struct Blob;
+    struct Digest;
+
+    /**
+     * @brief create an empty blob in the temporary directory
+     * @returns nullptr if failed to create the file
+     */
+    static QSharedPointer<Blob> createBlob();
+
+    /**
+     * @brief whether a content of this length should be kept in a file
+     */
+    static bool shouldBeFileBacked(qint64 length);
+
+    QString inMemory;          // the content if it's kept in the memory
+    QSharedPointer<Blob> blob;     // the file which keeps the content, null if it's kept in the memory
+    QSharedPointer<Digest> digest; // the cached hash of the content, null if it's constructed by default
+};
+
+} // namespace Core
+
+#endif // TESTDATA_HPP
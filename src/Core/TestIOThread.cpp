@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/TestIOThread.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/RuntimeHistory.hpp"
+#include "Core/TestData.hpp"
+#include "Core/TestManifest.hpp"
+#include <QCoreApplication>
+#include <QVector>
+
+namespace Core
+{
+
+TestIOThread::TestIOThread() : QThread(QCoreApplication::instance())
+{
+    setObjectName("Test I/O");
+    qRegisterMetaType<QVector<Core::TestData>>("QVector<Core::TestData>");
+    qRegisterMetaType<Core::TestManifest::Snapshot>("Core::TestManifest::Snapshot");
+    qRegisterMetaType<Core::RuntimeHistory::Histories>("Core::RuntimeHistory::Histories");
+    context = new QObject();
+    context->moveToThread(this);
+    connect(this, &QThread::finished, context, &QObject::deleteLater);
+    start();
+    LOG_INFO("The test I/O thread is started");
+}
+
+TestIOThread::~TestIOThread()
+{
+    // the requests are handled in order, so all the earlier ones are handled when this function is called
+    QMetaObject::invokeMethod(
+        context, [] { LOG_INFO("The pending test I/O requests are handled"); }, Qt::BlockingQueuedConnection);
+    quit();
+    wait();
+}
+
+TestIOThread *TestIOThread::instance()
+{
+    static TestIOThread *thread = nullptr;
+    if (thread == nullptr)
+        thread = new TestIOThread();
+    return thread;
+}
+
+} // namespace Core
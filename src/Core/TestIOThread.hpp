@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The TestIOThread is the thread where the test case files are read and written, see Core::TestLoader and
+ * Core::TestWriter. The runtime history is also written on it, see Core::RuntimeRecorder.
+ * The files may be large or on a slow network drive, so they are not accessed on the GUI thread. A single thread
+ * handles the requests in the order they are made, so the files are never accessed by two requests at the same time.
+ */
+
+#ifndef TESTIOTHREAD_HPP
+#define TESTIOTHREAD_HPP
+
+#include <QThread>
+
+namespace Core
+{
+
+class TestIOThread : public QThread
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief get the test I/O thread, it's started when it's created
+     * @note this should be called on the GUI thread
+     */
+    static TestIOThread *instance();
+
+    /**
+     * @brief wait for the pending requests, then stop the event loop and wait for the thread to finish
+     * @note the saves requested just before the application exits are not lost
+     */
+    ~TestIOThread() override;
+
+  private:
+    TestIOThread();
+
+    QObject *context = nullptr; // an object living on this thread, to run a function on it
+};
+
+} // namespace Core
+
+#endif // TESTIOTHREAD_HPP
@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/TestImporter.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/TestArchive.hpp"
+#include "Core/ZipArchive.hpp"
+#include <QCollator>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+#include <algorithm>
+
+namespace Core
+{
+
+// a batch is sent when it has this number of test cases, or when it's older than BATCH_INTERVAL milliseconds
+static const int BATCH_SIZE = 256;
+static const int BATCH_INTERVAL = 50;
+
+// the layout of the Polygon and Codeforces packages, it's tried after the Testcases Matching Rules
+static const TestImporter::Rule POLYGON_RULE = {"(\\d+)", "\\1.a"};
+
+TestImporter::TestImporter(const Task &task) : task(task)
+{
+}
+
+void TestImporter::cancel()
+{
+    cancelled.storeRelaxed(1);
+}
+
+void TestImporter::start()
+{
+    LOG_INFO(INFO_OF(task.path) << INFO_OF(task.files.size()));
+    batchTimer.start();
+
+    if (!task.files.isEmpty())
+    {
+        importFiles(QString(), task.files);
+    }
+    else if (QFileInfo(task.path).isDir())
+    {
+        const QDir root(task.path);
+        QStringList names;
+        QDirIterator it(task.path, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+            names.push_back(root.relativeFilePath(it.next()));
+        importFiles(task.path, names);
+    }
+    else if (QFileInfo(task.path).suffix().compare("zip", Qt::CaseInsensitive) == 0)
+    {
+        importZip(task.path);
+    }
+    else
+    {
+        importArchive(task.path);
+    }
+}
+
+QVector<TestImporter::Pair> TestImporter::match(const QStringList &names, QStringList *unmatched) const
+{
+    // the regular expressions are compiled once for all files
+    QVector<QPair<QRegularExpression, QString>> rules;
+    for (const auto &rule : task.rules + QVector<Rule>{POLYGON_RULE})
+    {
+        QRegularExpression regex("^" + rule.input + "$");
+        if (!regex.isValid())
+        {
+            LOG_WARN("Invalid matching rule: " << rule.input);
+            continue;
+        }
+        regex.optimize();
+        rules.push_back({regex, rule.answer});
+    }
+
+    QCollator collator;
+    collator.setNumericMode(true);
+    const auto naturalLess = [&collator](const QString &a, const QString &b) { return collator.compare(a, b) < 0; };
+
+    // the files are paired in the same directory, the keys are the directories with the trailing "/"
+    QHash<QString, QStringList> directories;
+    for (const auto &name : names)
+        directories[name.left(name.lastIndexOf('/') + 1)].push_back(name.mid(name.lastIndexOf('/') + 1));
+
+    QVector<Pair> result;
+    for (auto it = directories.begin(); it != directories.end(); ++it)
+    {
+        const auto &directory = it.key();
+        auto &files = it.value();
+        std::sort(files.begin(), files.end(), naturalLess);
+        QSet<QString> remain(files.begin(), files.end());
+
+        // the pairs are found before the single inputs, so an answer is not taken as an input by another rule
+        for (const auto &rule : rules)
+        {
+            for (const auto &file : files)
+            {
+                if (!remain.contains(file) || !rule.first.match(file).hasMatch())
+                    continue;
+                auto answer = file;
+                answer.replace(rule.first, rule.second);
+                if (answer == file || !remain.contains(answer))
+                    continue;
+                remain.remove(file);
+                remain.remove(answer);
+                result.push_back({directory + file, directory + answer});
+            }
+        }
+        for (const auto &rule : rules)
+        {
+            for (const auto &file : files)
+            {
+                if (!remain.contains(file) || !rule.first.match(file).hasMatch())
+                    continue;
+                remain.remove(file);
+                result.push_back({directory + file, QString()});
+            }
+        }
+        for (const auto &file : files)
+        {
+            if (remain.contains(file))
+                unmatched->push_back(directory + file);
+        }
+    }
+
+    std::sort(result.begin(), result.end(),
+              [&naturalLess](const Pair &a, const Pair &b) { return naturalLess(a.input, b.input); });
+    std::sort(unmatched->begin(), unmatched->end(), naturalLess);
+    return result;
+}
+
+template <typename Reader>
+void TestImporter::importPairs(const QVector<Pair> &pairs, const QStringList &unmatched, Reader read)
+{
+    total = pairs.size();
+    emit progress(0, total);
+    for (const auto &pair : pairs)
+    {
+        if (cancelled.loadRelaxed())
+            return;
+        // a test case is skipped if any of its files can't be read
+        const auto input = read(pair.input);
+        const auto answer = pair.answer.isEmpty() ? TestData() : read(pair.answer);
+        if (!input.isNull() && (pair.answer.isEmpty() || !answer.isNull()))
+            append(input, answer);
+    }
+    flush();
+    if (!cancelled.loadRelaxed())
+        emit finished(imported, unmatched);
+}
+
+void TestImporter::importFiles(const QString &root, const QStringList &names)
+{
+    const QDir directory(root);
+    const auto read = [this, &root, &directory](const QString &name) {
+        QString error;
+        auto data = TestData::readFile(root.isEmpty() ? name : directory.filePath(name), task.threshold, &error);
+        if (data.isNull())
+        {
+            LOG_ERR(error);
+            emit failedToRead(error);
+        }
+        return data;
+    };
+
+    QStringList unmatched;
+    const auto pairs = match(names, &unmatched);
+    importPairs(pairs, unmatched, read);
+}
+
+void TestImporter::importZip(const QString &path)
+{
+    ZipArchive archive;
+    QString error;
+    if (!archive.open(path, &error))
+    {
+        LOG_ERR(error);
+        emit failedToRead(error);
+        emit finished(0, {});
+        return;
+    }
+
+    const auto names = archive.fileNames();
+    QHash<QString, int> indexes;
+    for (int i = 0; i < names.size(); ++i)
+        indexes.insert(names[i], i);
+
+    const auto read = [this, &archive, &indexes, &error](const QString &name) {
+        QByteArray content;
+        if (!archive.read(indexes.value(name), &content, &error))
+        {
+            LOG_ERR(error);
+            emit failedToRead(error);
+            return TestData();
+        }
+        // the same as TestData::readFile, which reads in QIODevice::Text mode and so drops every \r, the same test in a
+        // directory and in a zip archive must have the same content and hash
+        content.replace("\r", "");
+        return TestData::fromBytes(content, task.threshold);
+    };
+
+    QStringList unmatched;
+    const auto pairs = match(names, &unmatched);
+    importPairs(pairs, unmatched, read);
+}
+
+void TestImporter::importArchive(const QString &path)
+{
+    TestArchive archive;
+    QString error;
+    if (!archive.open(path, &error))
+    {
+        LOG_ERR(error);
+        emit failedToRead(error);
+        emit finished(0, {});
+        return;
+    }
+
+    total = archive.count();
+    emit progress(0, total);
+    for (int i = 0; i < archive.count(); ++i)
+    {
+        if (cancelled.loadRelaxed())
+            return;
+        TestData input, answer;
+        if (archive.read(i, task.threshold, &input, &answer, &error))
+        {
+            append(input, answer);
+        }
+        else
+        {
+            LOG_ERR(error);
+            emit failedToRead(error);
+        }
+    }
+    flush();
+    if (!cancelled.loadRelaxed())
+        emit finished(imported, {});
+}
+
+void TestImporter::append(const TestData &input, const TestData &answer)
+{
+    inputs.push_back(input);
+    answers.push_back(answer);
+    ++imported;
+    if (inputs.size() >= BATCH_SIZE || batchTimer.elapsed() >= BATCH_INTERVAL)
+        flush();
+}
+
+void TestImporter::flush()
+{
+    if (inputs.isEmpty() || cancelled.loadRelaxed())
+        return;
+    emit loaded(inputs, answers);
+    emit progress(imported, total);
+    inputs.clear();
+    answers.clear();
+    batchTimer.restart();
+}
+
+} // namespace Core
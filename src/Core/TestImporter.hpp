@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The TestImporter imports the test cases from a directory, a zip archive (e.g. a Polygon or Codeforces package), a
+ * Core::TestArchive or a list of files on Core::TestIOThread, so importing a package with thousands of files doesn't
+ * block the GUI.
+ * The input files and the answer files are paired by the Testcases Matching Rules, and by the layout of the Polygon
+ * packages, where the input is "tests/01" and the answer is "tests/01.a". The regular expressions are compiled once,
+ * and the answer files are looked up by name in the same directory, so pairing is linear in the number of files.
+ * The test cases are sorted by the natural order of the paths of the inputs, and sent back in batches.
+ */
+
+#ifndef TESTIMPORTER_HPP
+#define TESTIMPORTER_HPP
+
+#include "Core/TestData.hpp"
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+namespace Core
+{
+
+class TestImporter : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // a matching rule, the input file name matches the whole input regex, and the answer file name is the replacement
+    struct Rule
+    {
+        QString input;  // the regular expression of the input file name
+        QString answer; // the replacement of the answer file name, "\1" is the first captured group
+    };
+
+    // the information needed to import the test cases, everything depending on the settings is prepared here
+    struct Task
+    {
+        QString path;         // a directory, a zip archive or a test case archive, it's ignored if files is not empty
+        QStringList files;    // the files to import
+        QVector<Rule> rules;  // the Testcases Matching Rules
+        qint64 threshold = 0; // the files larger than this are kept in files, see TestData::fileThreshold
+    };
+
+    /**
+     * @brief construct an importer
+     * @param task the test cases to import
+     * @note the importer should be moved to the test I/O thread before calling start
+     */
+    explicit TestImporter(const Task &task);
+
+    /**
+     * @brief stop importing as soon as possible, it can be called on any thread
+     * @note no more signals are emitted after the current test case is read
+     */
+    void cancel();
+
+  public slots:
+    /**
+     * @brief import the test cases
+     */
+    void start();
+
+  signals:
+    /**
+     * @brief a batch of test cases is imported, they should be appended to the test cases
+     */
+    void loaded(const QVector<Core::TestData> &inputs, const QVector<Core::TestData> &expecteds);
+
+    /**
+     * @brief the number of test cases read so far, it's emitted with each batch
+     */
+    void progress(int done, int total);
+
+    /**
+     * @brief failed to read a file or the archive, the test cases which can't be read are skipped
+     */
+    void failedToRead(const QString &error);
+
+    /**
+     * @brief all test cases are imported
+     * @param imported the number of test cases imported
+     * @param unmatched the files which are neither an input nor an answer, relative to the imported directory or
+     *                  archive, or the full paths if the files are chosen one by one
+     */
+    void finished(int imported, const QStringList &unmatched);
+
+  private:
+    // a test case found in the files, the answer is empty for a single input
+    struct Pair
+    {
+        QString input;  // the name of the input file
+        QString answer; // the name of the answer file
+    };
+
+    /**
+     * @brief pair the files by the matching rules
+     * @param names the names of the files, the ones in the same directory are paired
+     * @param unmatched set to the names which are not paired
+     * @returns the test cases in the natural order of the inputs
+     */
+    QVector<Pair> match(const QStringList &names, QStringList *unmatched) const;
+
+    /**
+     * @brief read the test cases and send them back
+     * @param pairs the test cases found by match()
+     * @param unmatched the files which are not paired
+     * @param read reads a file by its name, and gives a null TestData if it fails
+     */
+    template <typename Reader> void importPairs(const QVector<Pair> &pairs, const QStringList &unmatched, Reader read);
+
+    /**
+     * @brief import the test cases from the files
+     * @param root the directory the names are relative to, empty if the names are full paths
+     */
+    void importFiles(const QString &root, const QStringList &names);
+
+    /**
+     * @brief import the test cases from a zip archive
+     */
+    void importZip(const QString &path);
+
+    /**
+     * @brief import the test cases from a test case archive
+     */
+    void importArchive(const QString &path);
+
+    /**
+     * @brief add an imported test case to the batch, the batch is sent if it's large or old enough
+     */
+    void append(const TestData &input, const TestData &answer);
+
+    /**
+     * @brief send the batch if it's not empty
+     */
+    void flush();
+
+    const Task task;
+    QAtomicInt cancelled;              // non-zero if cancel() is called
+    QVector<TestData> inputs, answers; // the batch of the imported test cases which are not sent yet
+    QElapsedTimer batchTimer;          // the time since the last batch is sent
+    int imported = 0;                  // the number of test cases imported so far
+    int total = 0;                     // the number of test cases to import
+};
+
+} // namespace Core
+
+#endif // TESTIMPORTER_HPP
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/TestLoader.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/TestArchive.hpp"
+#include <QFile>
+
+namespace Core
+{
+
+// a batch is sent when it has this number of test cases, or when it's older than BATCH_INTERVAL milliseconds
+static const int BATCH_SIZE = 256;
+static const int BATCH_INTERVAL = 50;
+
+/**
+ * @brief set the hash to the hash of the loaded data, and set upToDate to false if it's changed
+ */
+static void updateHash(const TestData &data, QByteArray *hash, bool *upToDate)
+{
+    const auto newHash = data.isNull() ? QByteArray() : data.hash();
+    *upToDate = *upToDate && newHash == *hash;
+    *hash = newHash;
+}
+
+TestLoader::TestLoader(const Task &task) : task(task)
+{
+}
+
+void TestLoader::cancel()
+{
+    cancelled.storeRelaxed(1);
+}
+
+void TestLoader::start()
+{
+    batchTimer.start();
+
+    auto snapshot = TestManifest::snapshot(task.sourceFilePath, task.inputRule, task.answerRule, task.maxMissing);
+    const bool fromArchive = !snapshot.archive.isEmpty() && (task.useArchive || snapshot.files.isEmpty());
+    LOG_INFO(BOOL_INFO_OF(fromArchive));
+
+    const bool finishedLoading =
+        fromArchive
+            ? loadArchive(TestArchive::path(task.sourceFilePath), &snapshot.archive, &snapshot.isArchiveSaved)
+            : loadFiles(&snapshot.files, &snapshot.isManifestSaved);
+    if (finishedLoading)
+        emit finished(snapshot);
+}
+
+bool TestLoader::loadFiles(QVector<TestManifest::Entry> *entries, bool *upToDate)
+{
+    // the hashes of the files read are sent back, so the unchanged files are not written again when saving
+    for (auto &entry : *entries)
+    {
+        if (cancelled.loadRelaxed())
+            return false;
+        const auto input = read(entry.input);
+        const auto answer = read(entry.answer);
+        updateHash(input, &entry.inputHash, upToDate);
+        updateHash(answer, &entry.answerHash, upToDate);
+        append(input, answer);
+    }
+    flush();
+    return !cancelled.loadRelaxed();
+}
+
+bool TestLoader::loadArchive(const QString &path, QVector<TestManifest::Entry> *entries, bool *upToDate)
+{
+    TestArchive archive;
+    QString error;
+    if (!archive.open(path, &error))
+    {
+        LOG_ERR(error);
+        emit failedToRead(error);
+        entries->clear();
+        *upToDate = false;
+        return !cancelled.loadRelaxed();
+    }
+
+    *entries = archive.entries();
+    *upToDate = true;
+    for (int i = 0; i < archive.count(); ++i)
+    {
+        if (cancelled.loadRelaxed())
+            return false;
+        TestData input, answer;
+        if (!archive.read(i, task.threshold, &input, &answer, &error))
+        {
+            LOG_ERR(error);
+            emit failedToRead(error);
+        }
+        updateHash(input, &(*entries)[i].inputHash, upToDate);
+        updateHash(answer, &(*entries)[i].answerHash, upToDate);
+        append(input, answer);
+    }
+    flush();
+    return !cancelled.loadRelaxed();
+}
+
+TestData TestLoader::read(const QString &path)
+{
+    if (path.isEmpty() || !QFile::exists(path))
+        return TestData();
+    QString error;
+    auto data = TestData::readFile(path, task.threshold, &error);
+    if (data.isNull())
+    {
+        LOG_ERR(error);
+        emit failedToRead(error);
+    }
+    return data;
+}
+
+void TestLoader::append(const TestData &input, const TestData &answer)
+{
+    inputs.push_back(input);
+    answers.push_back(answer);
+    if (inputs.size() >= BATCH_SIZE || batchTimer.elapsed() >= BATCH_INTERVAL)
+        flush();
+}
+
+void TestLoader::flush()
+{
+    if (inputs.isEmpty() || cancelled.loadRelaxed())
+        return;
+    emit loaded(inputs, answers);
+    inputs.clear();
+    answers.clear();
+    batchTimer.restart();
+}
+
+} // namespace Core
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The TestLoader loads the saved test cases of a source file on Core::TestIOThread, so opening a file doesn't block
+ * the GUI even if the test cases are large or on a slow drive.
+ * The test cases are found by Core::TestManifest::snapshot. They are loaded from the Core::TestArchive if the Test Case
+ * Storage is "Archive" or there are no test case files, otherwise they are loaded from the files. The test cases are
+ * sent back in batches in order, so the first ones are shown before all of them are loaded.
+ */
+
+#ifndef TESTLOADER_HPP
+#define TESTLOADER_HPP
+
+#include "Core/TestData.hpp"
+#include "Core/TestManifest.hpp"
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+
+namespace Core
+{
+
+class TestLoader : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // the information needed to load the test cases, everything depending on the settings is prepared here
+    struct Task
+    {
+        QString sourceFilePath;  // the path to the source file
+        QString inputRule;       // the Input File Save Path setting
+        QString answerRule;      // the Answer File Save Path setting
+        qint64 threshold = 0;    // the files larger than this are kept in files, see TestData::fileThreshold
+        int maxMissing = 0;      // the search stops after this number of consecutive indexes without files
+        bool useArchive = false; // whether the Test Case Storage is "Archive"
+    };
+
+    /**
+     * @brief construct a loader
+     * @param task the test cases to load
+     * @note the loader should be moved to the test I/O thread before calling start
+     */
+    explicit TestLoader(const Task &task);
+
+    /**
+     * @brief stop loading as soon as possible, it can be called on any thread
+     * @note no more signals are emitted after the current test case is loaded
+     */
+    void cancel();
+
+  public slots:
+    /**
+     * @brief load the test cases
+     */
+    void start();
+
+  signals:
+    /**
+     * @brief a batch of test cases is loaded, they should be appended to the loaded ones
+     */
+    void loaded(const QVector<Core::TestData> &inputs, const QVector<Core::TestData> &expecteds);
+
+    /**
+     * @brief failed to read a test case file, the test case is loaded with empty content instead
+     */
+    void failedToRead(const QString &error);
+
+    /**
+     * @brief all test cases are loaded
+     * @param snapshot the saved test cases, the hashes of the loaded ones are the hashes of what is loaded, and a
+     *                 test case failed to be read has an empty hash
+     */
+    void finished(const Core::TestManifest::Snapshot &snapshot);
+
+  private:
+    /**
+     * @brief load the test cases from the files
+     * @param entries the test case files, the hashes are updated
+     * @param upToDate set to false if a hash is changed
+     * @returns false if it's cancelled
+     */
+    bool loadFiles(QVector<TestManifest::Entry> *entries, bool *upToDate);
+
+    /**
+     * @brief load the test cases from an archive
+     * @param path the path to the archive
+     * @param entries set to the hashes of the test cases in the archive
+     * @param upToDate set to false if a hash is changed or the archive is invalid
+     * @returns false if it's cancelled
+     */
+    bool loadArchive(const QString &path, QVector<TestManifest::Entry> *entries, bool *upToDate);
+
+    /**
+     * @brief read a test case file, an empty path or a missing file gives a null TestData
+     */
+    TestData read(const QString &path);
+
+    /**
+     * @brief add a loaded test case to the batch, the batch is sent if it's large or old enough
+     */
+    void append(const TestData &input, const TestData &answer);
+
+    /**
+     * @brief send the batch if it's not empty
+     */
+    void flush();
+
+    const Task task;
+    QAtomicInt cancelled;              // non-zero if cancel() is called
+    QVector<TestData> inputs, answers; // the batch of the loaded test cases which are not sent yet
+    QElapsedTimer batchTimer;          // the time since the last batch is sent
+};
+
+} // namespace Core
+
+#endif // TESTLOADER_HPP
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/TestManifest.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/TestArchive.hpp"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+namespace Core
+{
+
+bool TestManifest::Entry::operator==(const Entry &other) const
+{
+    return input == other.input && answer == other.answer && inputHash == other.inputHash &&
+           answerHash == other.answerHash;
+}
+
+bool TestManifest::Entry::operator!=(const Entry &other) const
+{
+    return !(*this == other);
+}
+
+QString TestManifest::path(const QString &sourceFilePath)
+{
+    return testCaseFilePath("./${filename}.tests.json", sourceFilePath, 0);
+}
+
+QString TestManifest::testCaseFilePath(QString rule, const QString &sourceFilePath, int index, const QByteArray &id)
+{
+    QFileInfo fileInfo(sourceFilePath);
+    return fileInfo.dir().filePath(rule.replace("${filename}", fileInfo.fileName())
+                                       .replace("${basename}", fileInfo.completeBaseName())
+                                       .replace("${0-index}", QString::number(index))
+                                       .replace("${1-index}", QString::number(index + 1))
+                                       .replace("${hash}", QString::fromLatin1(id.toHex().left(HASH_NAME_LENGTH))));
+}
+
+bool TestManifest::read(const QString &path, QVector<Entry> *entries)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonParseError error;
+    const auto document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject())
+    {
+        LOG_WARN("Invalid test manifest " << path << ": " << error.errorString());
+        return false;
+    }
+
+    const auto object = document.object();
+    if (object.value("version").toInt() != VERSION || !object.value("tests").isArray())
+    {
+        LOG_WARN("Unsupported test manifest " << path);
+        return false;
+    }
+
+    const QDir dir = QFileInfo(path).dir();
+    const auto absolutePath = [&dir](const QJsonValue &value) {
+        const auto relativePath = value.toString();
+        return relativePath.isEmpty() ? QString() : QDir::cleanPath(dir.filePath(relativePath));
+    };
+
+    entries->clear();
+    for (const auto &test : object.value("tests").toArray())
+    {
+        const auto testObject = test.toObject();
+        entries->push_back({absolutePath(testObject.value("input")), absolutePath(testObject.value("answer")),
+                            QByteArray::fromHex(testObject.value("inputHash").toString().toLatin1()),
+                            QByteArray::fromHex(testObject.value("answerHash").toString().toLatin1())});
+    }
+    return true;
+}
+
+TestManifest::Snapshot TestManifest::snapshot(const QString &sourceFilePath, const QString &inputRule,
+                                              const QString &answerRule, int maxMissing)
+{
+    Snapshot result;
+
+    // the test cases added after the manifest is written, e.g. by other programs, are searched after the listed ones
+    // with a manifest, only the next index is checked, so it's still fast if nothing is added
+    const bool hasManifest = read(path(sourceFilePath), &result.files);
+    const int listed = result.files.size();
+    findUnlisted(sourceFilePath, inputRule, answerRule, hasManifest ? 1 : maxMissing, &result.files);
+    result.isManifestSaved = hasManifest && result.files.size() == listed;
+
+    const auto archivePath = TestArchive::path(sourceFilePath);
+    if (QFile::exists(archivePath))
+    {
+        TestArchive archive;
+        QString error;
+        result.isArchiveSaved = archive.open(archivePath, &error);
+        if (result.isArchiveSaved)
+            result.archive = archive.entries();
+        else
+            LOG_WARN(error);
+    }
+    else
+    {
+        result.isArchiveSaved = true;
+    }
+
+    LOG_INFO(INFO_OF(sourceFilePath) << INFO_OF(result.files.size()) << BOOL_INFO_OF(result.isManifestSaved)
+                                     << INFO_OF(result.archive.size()) << BOOL_INFO_OF(result.isArchiveSaved));
+    return result;
+}
+
+void TestManifest::findUnlisted(const QString &sourceFilePath, const QString &inputRule, const QString &answerRule,
+                                int maxMissing, QVector<Entry> *entries)
+{
+    if (inputRule.contains("${hash}") || answerRule.contains("${hash}"))
+        return;
+
+    int last = entries->size() - 1;
+    for (int i = entries->size(); i <= last + maxMissing; ++i)
+    {
+        const auto inputPath = testCaseFilePath(inputRule, sourceFilePath, i);
+        const auto answerPath = testCaseFilePath(answerRule, sourceFilePath, i);
+        const bool hasInput = QFile::exists(inputPath);
+        const bool hasAnswer = QFile::exists(answerPath);
+        if (!hasInput && !hasAnswer)
+            continue;
+        entries->resize(i + 1);
+        (*entries)[i].input = hasInput ? inputPath : QString();
+        (*entries)[i].answer = hasAnswer ? answerPath : QString();
+        last = i;
+    }
+}
+
+QByteArray TestManifest::serialize(const QString &path, const QVector<Entry> &entries)
+{
+    const bool hasFiles = std::any_of(entries.cbegin(), entries.cend(), [](const Entry &entry) {
+        return !entry.input.isEmpty() || !entry.answer.isEmpty();
+    });
+    if (!hasFiles)
+        return QByteArray();
+
+    const QDir dir = QFileInfo(path).dir();
+    const auto relativePath = [&dir](const QString &absolutePath) {
+        return absolutePath.isEmpty() ? QString() : dir.relativeFilePath(absolutePath);
+    };
+
+    QJsonArray tests;
+    for (const auto &entry : entries)
+    {
+        tests.push_back(QJsonObject{{"input", relativePath(entry.input)},
+                                    {"answer", relativePath(entry.answer)},
+                                    {"inputHash", QString::fromLatin1(entry.inputHash.toHex())},
+                                    {"answerHash", QString::fromLatin1(entry.answerHash.toHex())}});
+    }
+
+    const QJsonObject object{{"version", VERSION}, {"tests", tests}};
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+} // namespace Core
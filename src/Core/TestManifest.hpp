@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The TestManifest is the index of the saved test cases of a source file. It's written beside the test case files
+ * when they are saved, and it lists the files of the test cases in order, so the saved test cases are found by
+ * reading a single small file instead of checking all the paths where a test case file could be.
+ * The paths in the manifest file are relative to its directory, so the files can be moved together.
+ * The manifest also keeps the hashes of the files, so only the changed test cases need to be written when saving.
+ */
+
+#ifndef TESTMANIFEST_HPP
+#define TESTMANIFEST_HPP
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+namespace Core
+{
+
+class TestManifest
+{
+  public:
+    // the files of a test case, a path is empty if the test case doesn't have that file
+    struct Entry
+    {
+        QString input;         // the absolute path to the input file
+        QString answer;        // the absolute path to the answer file
+        QByteArray inputHash;  // the hash of the input file, see TestData::hash, empty if it's unknown
+        QByteArray answerHash; // the hash of the answer file, see TestData::hash, empty if it's unknown
+
+        bool operator==(const Entry &other) const;
+        bool operator!=(const Entry &other) const;
+    };
+
+    // the test cases of a source file saved on the disk, in the loose files and in the archive, see Core::TestArchive
+    struct Snapshot
+    {
+        QVector<Entry> files;         // the test cases saved in files, a hash is empty if it's unknown
+        bool isManifestSaved = false; // whether the manifest on the disk lists exactly the files
+        QVector<Entry> archive;       // the hashes of the test cases in the archive, empty if there is no archive
+        bool isArchiveSaved = false;  // whether the archive on the disk contains exactly the archive entries
+    };
+
+    /**
+     * @brief get the path to the manifest of a source file
+     */
+    static QString path(const QString &sourceFilePath);
+
+    /**
+     * @brief get the path to a test case file of a source file
+     * @param rule the Input File Save Path or the Answer File Save Path setting
+     * @param sourceFilePath the path to the source file
+     * @param index the index of the test case, starting from 0
+     * @param id the id of the test case for "${hash}", see Widgets::TestCasesModel::TestCaseData::id
+     */
+    static QString testCaseFilePath(QString rule, const QString &sourceFilePath, int index,
+                                    const QByteArray &id = QByteArray());
+
+    /**
+     * @brief read a manifest
+     * @param path the path to the manifest
+     * @param entries set to the test cases in the manifest
+     * @returns false if the manifest doesn't exist or it's invalid
+     * @note it can be used on any thread
+     */
+    static bool read(const QString &path, QVector<Entry> *entries);
+
+    /**
+     * @brief find the saved test cases of a source file, without reading the test case files
+     * @param sourceFilePath the path to the source file
+     * @param inputRule the Input File Save Path setting
+     * @param answerRule the Answer File Save Path setting
+     * @param maxMissing the unlisted test cases are searched until this number of consecutive indexes without files
+     *                   if there is no manifest, see findUnlisted
+     * @note it can be used on any thread
+     */
+    static Snapshot snapshot(const QString &sourceFilePath, const QString &inputRule, const QString &answerRule,
+                             int maxMissing);
+
+    /**
+     * @brief find the test case files which are not listed in a manifest, by checking the paths one by one
+     * @param sourceFilePath the path to the source file
+     * @param inputRule the Input File Save Path setting
+     * @param answerRule the Answer File Save Path setting
+     * @param maxMissing the search stops after this number of consecutive indexes without files
+     * @param entries the listed test cases, the found ones are appended
+     * @note it can be used on any thread
+     * @note the files named by "${hash}" can't be found by the indexes, so they are found only in the manifest
+     */
+    static void findUnlisted(const QString &sourceFilePath, const QString &inputRule, const QString &answerRule,
+                             int maxMissing, QVector<Entry> *entries);
+
+    /**
+     * @brief get the content of a manifest file
+     * @param path the path to the manifest
+     * @param entries the test cases to be listed in the manifest
+     * @returns an empty QByteArray if no test case has files, then the manifest should be removed
+     */
+    static QByteArray serialize(const QString &path, const QVector<Entry> &entries);
+
+  private:
+    static const int VERSION = 1;           // the version of the format of the manifest
+    static const int HASH_NAME_LENGTH = 16; // the number of hex digits of "${hash}" in the test case file names
+};
+
+} // namespace Core
+
+#endif // TESTMANIFEST_HPP
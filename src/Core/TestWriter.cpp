@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/TestWriter.hpp"
+#include "Core/EventLogger.hpp"
+#include "Core/TestArchive.hpp"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace Core
+{
+
+TestWriter::TestWriter(const Task &task) : task(task)
+{
+}
+
+void TestWriter::start()
+{
+    LOG_INFO(INFO_OF(task.files.size()) << INFO_OF(task.removed.size()) << BOOL_INFO_OF(task.writeManifest)
+                                        << BOOL_INFO_OF(task.writeArchive));
+
+    bool ok = true;
+    for (const auto &file : task.files)
+        ok = write(file.path, file.data.bytes()) && ok;
+
+    if (task.writeArchive && !task.inputs.isEmpty())
+    {
+        QString error;
+        if (!TestArchive::write(task.archivePath, task.inputs, task.answers, task.compress, task.safe, &error))
+        {
+            LOG_ERR(error);
+            emit failedToWrite(task.archivePath, error);
+            ok = false;
+        }
+    }
+
+    if (task.writeManifest && !task.manifest.isEmpty())
+        ok = write(task.manifestPath, task.manifest) && ok;
+
+    if (!ok)
+    {
+        LOG_WARN("Some files failed to be written, the old files are not removed");
+    }
+    else
+    {
+        for (const auto &path : task.removed)
+            remove(path);
+        if (task.writeManifest && task.manifest.isEmpty())
+            remove(task.manifestPath);
+        if (task.writeArchive && task.inputs.isEmpty())
+            remove(task.archivePath);
+    }
+
+    emit finished(ok);
+}
+
+bool TestWriter::write(const QString &path, const QByteArray &content)
+{
+    // the same as Util::saveFile, which can't be used here because it reads the settings and shows the messages
+    const auto dirPath = QFileInfo(path).absolutePath();
+    LOG_ERR_IF(!QDir().mkpath(dirPath), QString("Failed to create the directory [%1]").arg(dirPath));
+
+    bool ok = false;
+    if (task.safe)
+    {
+        QSaveFile file(path);
+        ok = file.open(QIODevice::WriteOnly | QIODevice::Text) && file.write(content) == content.size() &&
+             file.commit();
+    }
+    else
+    {
+        QFile file(path);
+        ok = file.open(QIODevice::WriteOnly | QIODevice::Text) && file.write(content) == content.size();
+    }
+
+    if (!ok)
+    {
+        LOG_ERR("Failed to save to [" << path << "]");
+        emit failedToWrite(path, QCoreApplication::translate("Util::FileUtil",
+                                                             "Failed to save to [%1]. Do I have write permission?")
+                                     .arg(path));
+    }
+    return ok;
+}
+
+void TestWriter::remove(const QString &path)
+{
+    if (QFile::exists(path) && !QFile::remove(path))
+        LOG_WARN("Failed to remove [" << path << "]");
+}
+
+} // namespace Core
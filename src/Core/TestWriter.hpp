@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The TestWriter writes the changed test case files, the manifest and the archive of a source file on
+ * Core::TestIOThread, so saving doesn't block the GUI. The unchanged files are not in the task at all, see
+ * Widgets::TestCases::saveToFiles. The files which are not needed any more are removed only if all the new ones are
+ * written, so no test case is lost, e.g. when the test cases are converted between the files and the archive.
+ * The writers are run one by one on the test I/O thread in the order they are started, so the thread works as a
+ * queue of the saves, and a later save is never overwritten by an earlier one.
+ */
+
+#ifndef TESTWRITER_HPP
+#define TESTWRITER_HPP
+
+#include "Core/TestData.hpp"
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+namespace Core
+{
+
+class TestWriter : public QObject
+{
+    Q_OBJECT
+
+  public:
+    // a test case file to be written
+    struct File
+    {
+        QString path;  // the path to the file
+        TestData data; // the content of the file
+    };
+
+    // the information needed to save the test cases, everything depending on the settings is prepared here
+    struct Task
+    {
+        QVector<File> files;        // the changed test case files
+        QStringList removed;        // the test case files which don't belong to any test case now
+        bool writeManifest = false; // whether the manifest is changed
+        QString manifestPath;       // the path to the manifest
+        QByteArray manifest;        // the content of the manifest, the manifest is removed if it's empty
+        bool writeArchive = false;  // whether the archive is changed
+        QString archivePath;        // the path to the archive, see Core::TestArchive
+        QVector<TestData> inputs;   // the inputs in the archive, the archive is removed if there are no test cases
+        QVector<TestData> answers;  // the answers in the archive
+        bool compress = false;      // whether to compress the archive
+        bool safe = false;          // whether to write the files with QSaveFile, see Util::saveFile
+    };
+
+    /**
+     * @brief construct a writer
+     * @param task the files to write and remove
+     * @note the writer should be moved to the test I/O thread before calling start
+     */
+    explicit TestWriter(const Task &task);
+
+  public slots:
+    /**
+     * @brief write and remove the files
+     */
+    void start();
+
+  signals:
+    /**
+     * @brief failed to write a file, the file should be written again in the next save
+     * @param path the path to the file
+     * @param error the reason of the failure
+     */
+    void failedToWrite(const QString &path, const QString &error);
+
+    /**
+     * @brief all files are written and removed
+     * @param ok whether all files are written successfully
+     */
+    void finished(bool ok);
+
+  private:
+    /**
+     * @brief write a file, the directory is created if it doesn't exist
+     * @returns false if failed to write it
+     */
+    bool write(const QString &path, const QByteArray &content);
+
+    /**
+     * @brief remove a file if it exists
+     */
+    static void remove(const QString &path);
+
+    const Task task;
+};
+
+} // namespace Core
+
+#endif // TESTWRITER_HPP
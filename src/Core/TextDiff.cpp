@@ -0,0 +1,647 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/TextDiff.hpp"
+#include "third_party/diff_match_patch/diff_match_patch.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLocale>
+#include <algorithm>
+#include <cmath>
+
+namespace Core
+{
+
+namespace
+{
+/**
+ * @brief get the number of UTF-16 code units of the character starting at a byte of UTF-8
+ * @returns 0 for a continuation byte, 2 for the first byte of a character out of the BMP, otherwise 1
+ */
+int utf16Units(char byte)
+{
+    const auto c = uchar(byte);
+    if ((c & 0xC0) == 0x80)
+        return 0;
+    return c >= 0xF0 ? 2 : 1;
+}
+} // namespace
+
+TextDiff::Text::Text(const QString &text) : content(text.toUtf8())
+{
+    split();
+}
+
+TextDiff::Text::Text(const TestData &data) : data(data), content(data.bytes())
+{
+    split();
+}
+
+void TextDiff::Text::split()
+{
+    starts.push_back(0);
+    for (int i = content.indexOf('\n'); i != -1; i = content.indexOf('\n', i + 1))
+        starts.push_back(i + 1);
+    starts.push_back(content.size() + 1);
+    for (int i = 0; i < count(); ++i)
+    {
+        const auto bytes = lineBytes(i);
+        int length = 0;
+        for (char c : bytes)
+            length += utf16Units(c);
+        longest = qMax(longest, length);
+    }
+}
+
+int TextDiff::Text::count() const
+{
+    return starts.size() - 1;
+}
+
+QString TextDiff::Text::line(int index) const
+{
+    return QString::fromUtf8(lineBytes(index));
+}
+
+QByteArray TextDiff::Text::lineBytes(int index) const
+{
+    const int start = starts[index];
+    int end = starts[index + 1] - 1;
+    if (end > start && content[end - 1] == '\r')
+        --end;
+    return QByteArray::fromRawData(content.constData() + start, end - start);
+}
+
+bool TextDiff::Text::hasLineBreak(int index) const
+{
+    return index + 1 < count();
+}
+
+int TextDiff::Text::maxLength() const
+{
+    return longest;
+}
+
+QString TextDiff::Text::toString() const
+{
+    return QString::fromUtf8(content);
+}
+
+int TextDiff::Chunk::rows() const
+{
+    return qMax(outputCount, expectedCount);
+}
+
+// finds the chunks of two texts, the lines are compared by their hashes before their contents
+class TextDiff::Comparer
+{
+  public:
+    Comparer(const Text &output, const Text &expected, int timeLimit, const QAtomicInt *cancelled)
+        : output(output), expected(expected), timeLimit(timeLimit), cancelled(cancelled)
+    {
+        timer.start();
+        outputHashes.reserve(output.count());
+        for (int i = 0; i < output.count(); ++i)
+            outputHashes.push_back(qHash(output.lineBytes(i)));
+        expectedHashes.reserve(expected.count());
+        for (int i = 0; i < expected.count(); ++i)
+            expectedHashes.push_back(qHash(expected.lineBytes(i)));
+    }
+
+    /**
+     * @brief compare the lines [a0, a1) of the output with the lines [b0, b1) of the expected output
+     */
+    void compare(int a0, int a1, int b0, int b1)
+    {
+        int prefix = 0;
+        while (a0 + prefix < a1 && b0 + prefix < b1 && equal(a0 + prefix, b0 + prefix))
+            ++prefix;
+        addChunk(true, a0, prefix, b0, prefix);
+        a0 += prefix;
+        b0 += prefix;
+
+        int suffix = 0;
+        while (a0 < a1 - suffix && b0 < b1 - suffix && equal(a1 - suffix - 1, b1 - suffix - 1))
+            ++suffix;
+        a1 -= suffix;
+        b1 -= suffix;
+
+        int x = 0, y = 0;
+        if (a0 < a1 && b0 < b1 && !shouldStop() && bisect(a0, a1, b0, b1, &x, &y))
+        {
+            compare(a0, x, b0, y);
+            compare(x, a1, y, b1);
+        }
+        else
+        {
+            addChunk(false, a0, a1 - a0, b0, b1 - b0);
+        }
+
+        addChunk(true, a1, suffix, b1, suffix);
+    }
+
+    /**
+     * @brief whether the time limit is exceeded or it's cancelled, then no more edit scripts are searched
+     */
+    bool shouldStop()
+    {
+        if (stopped)
+            return true;
+        if (cancelled != nullptr && cancelled->loadRelaxed())
+            stopped = true;
+        if (timeLimit >= 0 && timer.elapsed() > timeLimit)
+            stopped = timedOut = true;
+        return stopped;
+    }
+
+    QVector<Chunk> chunks;
+    bool timedOut = false; // whether the time limit is exceeded
+
+  private:
+    bool equal(int a, int b) const
+    {
+        return outputHashes[a] == expectedHashes[b] && output.lineBytes(a) == expected.lineBytes(b);
+    }
+
+    /**
+     * @brief add a chunk after the last one, it's merged with the last one if they are both equal or both changed
+     */
+    void addChunk(bool isEqual, int outputLine, int outputCount, int expectedLine, int expectedCount)
+    {
+        if (outputCount == 0 && expectedCount == 0)
+            return;
+        if (!chunks.isEmpty() && chunks.back().equal == isEqual)
+        {
+            chunks.back().outputCount += outputCount;
+            chunks.back().expectedCount += expectedCount;
+            return;
+        }
+        Chunk chunk;
+        chunk.outputLine = outputLine;
+        chunk.outputCount = outputCount;
+        chunk.expectedLine = expectedLine;
+        chunk.expectedCount = expectedCount;
+        chunk.equal = isEqual;
+        chunks.push_back(chunk);
+    }
+
+    /**
+     * @brief find the middle of the shortest edit script by searching from both ends
+     * @param x set to the line of the output to split at
+     * @param y set to the line of the expected output to split at
+     * @returns false if there's no common line, the edit distance is larger than MAX_COST, or it should stop
+     * @note it's the bisect of diff_match_patch on lines, the two parts are compared recursively
+     */
+    bool bisect(int a0, int a1, int b0, int b1, int *x, int *y)
+    {
+        const int n = a1 - a0;
+        const int m = b1 - b0;
+        const int maxD = qMin((n + m + 1) / 2, MAX_COST);
+        const int offset = maxD;
+        const int length = 2 * maxD + 2;
+        QVector<int> forward(length, -1), backward(length, -1);
+        forward[offset + 1] = 0;
+        backward[offset + 1] = 0;
+        const int delta = n - m;
+        // if the difference of the lengths is odd, the paths meet on a forward step, otherwise on a backward step
+        const bool front = delta % 2 != 0;
+        // the diagonals which are out of the grid are skipped
+        int k1start = 0, k1end = 0, k2start = 0, k2end = 0;
+
+        for (int d = 0; d < maxD && !shouldStop(); ++d)
+        {
+            for (int k1 = -d + k1start; k1 <= d - k1end; k1 += 2)
+            {
+                const int k1Offset = offset + k1;
+                int x1 = 0;
+                if (k1 == -d || (k1 != d && forward[k1Offset - 1] < forward[k1Offset + 1]))
+                    x1 = forward[k1Offset + 1];
+                else
+                    x1 = forward[k1Offset - 1] + 1;
+                int y1 = x1 - k1;
+                while (x1 < n && y1 < m && equal(a0 + x1, b0 + y1))
+                {
+                    ++x1;
+                    ++y1;
+                }
+                forward[k1Offset] = x1;
+                if (x1 > n)
+                {
+                    k1end += 2;
+                }
+                else if (y1 > m)
+                {
+                    k1start += 2;
+                }
+                else if (front)
+                {
+                    const int k2Offset = offset + delta - k1;
+                    if (k2Offset >= 0 && k2Offset < length && backward[k2Offset] != -1 &&
+                        x1 >= n - backward[k2Offset])
+                    {
+                        *x = a0 + x1;
+                        *y = b0 + y1;
+                        return true;
+                    }
+                }
+            }
+
+            for (int k2 = -d + k2start; k2 <= d - k2end; k2 += 2)
+            {
+                const int k2Offset = offset + k2;
+                int x2 = 0;
+                if (k2 == -d || (k2 != d && backward[k2Offset - 1] < backward[k2Offset + 1]))
+                    x2 = backward[k2Offset + 1];
+                else
+                    x2 = backward[k2Offset - 1] + 1;
+                int y2 = x2 - k2;
+                while (x2 < n && y2 < m && equal(a1 - x2 - 1, b1 - y2 - 1))
+                {
+                    ++x2;
+                    ++y2;
+                }
+                backward[k2Offset] = x2;
+                if (x2 > n)
+                {
+                    k2end += 2;
+                }
+                else if (y2 > m)
+                {
+                    k2start += 2;
+                }
+                else if (!front)
+                {
+                    const int k1Offset = offset + delta - k2;
+                    if (k1Offset >= 0 && k1Offset < length && forward[k1Offset] != -1)
+                    {
+                        const int x1 = forward[k1Offset];
+                        const int y1 = offset + x1 - k1Offset;
+                        if (x1 >= n - x2)
+                        {
+                            *x = a0 + x1;
+                            *y = b0 + y1;
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    const Text &output;
+    const Text &expected;
+    QVector<uint> outputHashes, expectedHashes;
+    const int timeLimit;
+    const QAtomicInt *cancelled;
+    QElapsedTimer timer;  // the time since the comparison starts
+    bool stopped = false; // whether shouldStop() has returned true
+};
+
+TextDiff TextDiff::compare(const QString &output, const TestData &expected, int timeLimit,
+                           const QAtomicInt *cancelled)
+{
+    TextDiff result;
+    result.outputText = Text(output);
+    result.expectedText = Text(expected);
+
+    Comparer comparer(result.outputText, result.expectedText, timeLimit, cancelled);
+    comparer.compare(0, result.outputText.count(), 0, result.expectedText.count());
+    result.diffChunks = comparer.chunks;
+    result.timedOut = comparer.timedOut;
+    for (auto &chunk : result.diffChunks)
+    {
+        chunk.row = result.rows;
+        result.rows += chunk.rows();
+    }
+    return result;
+}
+
+// reads the tokens of a text in order, the blanks are the same as in testlib
+// the tokens are found in the UTF-8 bytes, and only the tokens to compare are decoded
+class TextDiff::TokenReader
+{
+  public:
+    explicit TokenReader(const Text &text) : text(text)
+    {
+    }
+
+    /**
+     * @brief read the next token
+     * @returns false if there are no more tokens
+     */
+    bool next(Token *token)
+    {
+        for (; line < text.count(); ++line, position = column = 0)
+        {
+            const auto content = text.lineBytes(line);
+            while (position < content.size() && isBlank(content[position]))
+                advance(content[position]);
+            if (position < content.size())
+            {
+                const int startColumn = column;
+                start = position;
+                while (position < content.size() && !isBlank(content[position]))
+                    advance(content[position]);
+                token->line = line;
+                token->range = {startColumn, column - startColumn};
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief decode the token read last into the buffer, the buffer is reused for the tokens of ASCII characters
+     */
+    void lastToken(QString *buffer) const
+    {
+        const char *begin = text.lineBytes(line).constData() + start;
+        const int length = position - start;
+        if (std::any_of(begin, begin + length, [](char c) { return uchar(c) >= 0x80; }))
+        {
+            *buffer = QString::fromUtf8(begin, length);
+            return;
+        }
+        buffer->resize(length);
+        for (int i = 0; i < length; ++i)
+            (*buffer)[i] = QLatin1Char(begin[i]);
+    }
+
+  private:
+    static bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    void advance(char c)
+    {
+        ++position;
+        column += utf16Units(c);
+    }
+
+    const Text &text;
+    int line = 0;     // the line of the next token
+    int position = 0; // the byte in the line to read the next token from
+    int column = 0;   // the column of the position in UTF-16 code units
+    int start = 0;    // the first byte of the token read last
+};
+
+TextDiff TextDiff::compareTokens(const QString &output, const TestData &expected, Mode mode, double maxError,
+                                 const QAtomicInt *cancelled)
+{
+    TextDiff result;
+    result.diffMode = mode;
+    result.outputText = Text(output);
+    result.expectedText = Text(expected);
+
+    // the tokens are compared in pairs in order like the checkers, and a token without a pair is rejected
+    TokenReader outputReader(result.outputText), expectedReader(result.expectedText);
+    Token outputToken, expectedToken;
+    QString outputContent, expectedContent;
+    bool hasOutput = outputReader.next(&outputToken);
+    bool hasExpected = expectedReader.next(&expectedToken);
+    while ((hasOutput || hasExpected) && (cancelled == nullptr || cancelled->loadRelaxed() == 0))
+    {
+        bool accepted = hasOutput && hasExpected;
+        if (accepted)
+        {
+            outputReader.lastToken(&outputContent);
+            expectedReader.lastToken(&expectedContent);
+            accepted = acceptsToken(outputContent, expectedContent, mode, maxError);
+        }
+        if (!accepted)
+        {
+            if (result.rejected++ == 0)
+                result.firstRejected = hasOutput ? outputToken : expectedToken;
+            if (hasOutput)
+                result.outputRejected.push_back(outputToken);
+            if (hasExpected)
+                result.expectedRejected.push_back(expectedToken);
+        }
+        hasOutput = hasOutput && outputReader.next(&outputToken);
+        hasExpected = hasExpected && expectedReader.next(&expectedToken);
+    }
+
+    // the lines are shown by their line numbers, and a row is changed if it has a rejected token on either side
+    const int outputLines = result.outputText.count();
+    const int expectedLines = result.expectedText.count();
+    result.rows = qMax(outputLines, expectedLines);
+    QVector<bool> changed(result.rows, false);
+    for (const auto &token : qAsConst(result.outputRejected))
+        changed[token.line] = true;
+    for (const auto &token : qAsConst(result.expectedRejected))
+        changed[token.line] = true;
+
+    for (int row = 0; row < result.rows;)
+    {
+        int end = row + 1;
+        while (end < result.rows && changed[end] == changed[row])
+            ++end;
+        Chunk chunk;
+        chunk.row = chunk.outputLine = chunk.expectedLine = row;
+        chunk.outputCount = qBound(0, outputLines - row, end - row);
+        chunk.expectedCount = qBound(0, expectedLines - row, end - row);
+        chunk.equal = !changed[row];
+        result.diffChunks.push_back(chunk);
+        row = end;
+    }
+    return result;
+}
+
+void TextDiff::diffLine(QStringView output, QStringView expected, QVector<Range> *outputRanges,
+                        QVector<Range> *expectedRanges)
+{
+    outputRanges->clear();
+    expectedRanges->clear();
+
+    // an empty line is changed as a whole, and diff_match_patch doesn't accept null strings
+    if (output.isEmpty() || expected.isEmpty() || output.size() > CHARACTER_DIFF_LIMIT ||
+        expected.size() > CHARACTER_DIFF_LIMIT)
+    {
+        int prefix = 0;
+        while (prefix < output.size() && prefix < expected.size() && output[prefix] == expected[prefix])
+            ++prefix;
+        int suffix = 0;
+        while (suffix < output.size() - prefix && suffix < expected.size() - prefix &&
+               output[output.size() - suffix - 1] == expected[expected.size() - suffix - 1])
+        {
+            ++suffix;
+        }
+        if (output.size() > prefix + suffix)
+            outputRanges->push_back({prefix, int(output.size()) - prefix - suffix});
+        if (expected.size() > prefix + suffix)
+            expectedRanges->push_back({prefix, int(expected.size()) - prefix - suffix});
+        return;
+    }
+
+    diff_match_patch differ;
+    auto diffs = differ.diff_main(output.toString(), expected.toString(), false);
+    differ.diff_cleanupSemantic(diffs);
+    int outputPosition = 0, expectedPosition = 0;
+    for (const auto &diff : diffs)
+    {
+        const int length = diff.text.length();
+        switch (diff.operation)
+        {
+        case DELETE:
+            outputRanges->push_back({outputPosition, length});
+            outputPosition += length;
+            break;
+        case INSERT:
+            expectedRanges->push_back({expectedPosition, length});
+            expectedPosition += length;
+            break;
+        case EQUAL:
+            outputPosition += length;
+            expectedPosition += length;
+            break;
+        }
+    }
+}
+
+TextDiff::Mode TextDiff::mode() const
+{
+    return diffMode;
+}
+
+const TextDiff::Text &TextDiff::output() const
+{
+    return outputText;
+}
+
+const TextDiff::Text &TextDiff::expected() const
+{
+    return expectedText;
+}
+
+const QVector<TextDiff::Chunk> &TextDiff::chunks() const
+{
+    return diffChunks;
+}
+
+int TextDiff::chunkAt(int row) const
+{
+    const auto it = std::upper_bound(diffChunks.cbegin(), diffChunks.cend(), row,
+                                     [](int value, const Chunk &chunk) { return value < chunk.row; });
+    return int(it - diffChunks.cbegin()) - 1;
+}
+
+int TextDiff::rowCount() const
+{
+    return rows;
+}
+
+bool TextDiff::isEqual() const
+{
+    return std::none_of(diffChunks.cbegin(), diffChunks.cend(), [](const Chunk &chunk) { return !chunk.equal; });
+}
+
+bool TextDiff::isTimedOut() const
+{
+    return timedOut;
+}
+
+QVector<TextDiff::Range> TextDiff::rejectedTokens(int line, bool inOutput) const
+{
+    const auto &tokens = inOutput ? outputRejected : expectedRejected;
+    auto it = std::lower_bound(tokens.cbegin(), tokens.cend(), line,
+                               [](const Token &token, int value) { return token.line < value; });
+    QVector<Range> result;
+    for (; it != tokens.cend() && it->line == line; ++it)
+        result.push_back(it->range);
+    return result;
+}
+
+int TextDiff::rejectedCount() const
+{
+    return rejected;
+}
+
+bool TextDiff::firstDifference(int *row, int *column) const
+{
+    if (diffMode != Lines)
+    {
+        if (firstRejected.line == -1)
+            return false;
+        *row = firstRejected.line;
+        *column = firstRejected.range.start;
+        return true;
+    }
+
+    for (const auto &chunk : diffChunks)
+    {
+        if (!chunk.equal)
+        {
+            *row = chunk.row;
+            *column = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TextDiff::acceptsToken(QStringView output, QStringView expected, Mode mode, double maxError)
+{
+    static const QLocale locale = [] {
+        QLocale c = QLocale::c();
+        c.setNumberOptions(QLocale::RejectGroupSeparator);
+        return c;
+    }();
+
+    switch (mode)
+    {
+    case Lines:
+    case Tokens:
+        return output == expected;
+    case Integers:
+    {
+        bool outputOk = false, expectedOk = false;
+        const qlonglong outputValue = locale.toLongLong(output, &outputOk);
+        const qlonglong expectedValue = locale.toLongLong(expected, &expectedOk);
+        return outputOk && expectedOk && outputValue == expectedValue;
+    }
+    case Doubles:
+    {
+        bool outputOk = false, expectedOk = false;
+        const double result = locale.toDouble(output, &outputOk);
+        const double answer = locale.toDouble(expected, &expectedOk);
+        if (!outputOk || !expectedOk)
+            return false;
+
+        // the same as doubleCompare in testlib
+        if (std::isnan(answer))
+            return std::isnan(result);
+        if (std::isinf(answer))
+            return std::isinf(result) && (answer > 0) == (result > 0);
+        if (std::isnan(result) || std::isinf(result))
+            return false;
+        if (std::abs(result - answer) <= maxError + 1e-15)
+            return true;
+        const double minValue = qMin(answer * (1.0 - maxError), answer * (1.0 + maxError));
+        const double maxValue = qMax(answer * (1.0 - maxError), answer * (1.0 + maxError));
+        return result + 1e-15 >= minValue && result <= maxValue + 1e-15;
+    }
+    case YesNo:
+        return (expected.compare(QLatin1String("YES"), Qt::CaseInsensitive) == 0 ||
+                expected.compare(QLatin1String("NO"), Qt::CaseInsensitive) == 0) &&
+               output.compare(expected, Qt::CaseInsensitive) == 0;
+    }
+    return false;
+}
+
+} // namespace Core
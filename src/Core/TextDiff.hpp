@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The TextDiff compares the output and the expected output line by line for the Diff Viewer.
+ * The lines are compared by their hashes first, and the common prefix and suffix are skipped, so a usual wrong answer
+ * with a few different lines is compared in linear time. The rest is compared by the linear-space variant of the
+ * Myers algorithm, which finds the shortest edit script without keeping the whole trace. A part which is too different
+ * is regarded as changed as a whole instead of searching further, so the time is bounded for any input. When the
+ * time limit is exceeded, the rest of the texts are compared only by their common prefixes and suffixes.
+ * The characters are compared only within a pair of changed lines, and only when the line is shown.
+ * The texts are kept in UTF-8 and a line is decoded only when it's shown, so a file-backed expected output is compared
+ * in its mapped file without being decoded as a whole.
+ *
+ * In the token modes, the texts are compared like the testlib checkers instead: the tokens separated by blanks are
+ * compared in pairs in a single pass, and only the rejected tokens are highlighted. The lines are shown side by side
+ * by their line numbers, and a line is changed if it has a rejected token on either side.
+ */
+
+#ifndef TEXTDIFF_HPP
+#define TEXTDIFF_HPP
+
+#include "Core/TestData.hpp"
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+namespace Core
+{
+
+class TextDiff
+{
+  public:
+    // how the texts are compared
+    enum Mode
+    {
+        Lines,    // compare line by line
+        Tokens,   // like wcmp, the tokens must be the same
+        Integers, // like ncmp, the tokens must be the same signed 64-bit integers
+        Doubles,  // like rcmp, the tokens must be doubles with the absolute or relative error at most maxError
+        YesNo     // like nyesno, the tokens must be the same YES or NO, case insensitive
+    };
+
+    // the lines of a text, the line breaks are "\n" or "\r\n"
+    class Text
+    {
+      public:
+        Text() = default;
+        explicit Text(const QString &text);
+
+        /**
+         * @brief construct the lines of a test data
+         * @note a file-backed content is read from the mapped file, and it's kept mapped while this Text exists
+         */
+        explicit Text(const TestData &data);
+
+        /**
+         * @brief get the number of lines, it's the number of line breaks plus one
+         */
+        int count() const;
+
+        /**
+         * @brief get a line without the line break, only this line is decoded
+         */
+        QString line(int index) const;
+
+        /**
+         * @brief get a line without the line break in UTF-8, it refers to the text without copying it
+         */
+        QByteArray lineBytes(int index) const;
+
+        /**
+         * @brief whether a line ends with a line break, it's false only for the last line
+         */
+        bool hasLineBreak(int index) const;
+
+        /**
+         * @brief get the length of the longest line in UTF-16 code units, it's counted without decoding the lines
+         */
+        int maxLength() const;
+
+        /**
+         * @brief get the whole text
+         * @note it decodes the whole text, so it should only be used on demand
+         */
+        QString toString() const;
+
+      private:
+        void split();
+
+        TestData data;       // keeps the mapped file of the content, null if the text is not a test data
+        QByteArray content;  // the text in UTF-8, it refers to the mapped file if the test data is file-backed
+        QVector<int> starts; // the byte offset of each line, with the size of the content plus one at the back
+        int longest = 0;     // the length of the longest line
+    };
+
+    // a range of lines, which are equal in both texts, or changed
+    // in the side-by-side view, the lines are shown in max(outputCount, expectedCount) rows
+    struct Chunk
+    {
+        int row = 0;           // the first row of the chunk in the side-by-side view
+        int outputLine = 0;    // the first line in the output
+        int outputCount = 0;   // the number of lines in the output
+        int expectedLine = 0;  // the first line in the expected output
+        int expectedCount = 0; // the number of lines in the expected output
+        bool equal = true;     // whether the lines are equal
+
+        /**
+         * @brief get the number of rows in the side-by-side view
+         */
+        int rows() const;
+    };
+
+    // a range of characters in a line
+    struct Range
+    {
+        int start = 0;
+        int length = 0;
+    };
+
+    /**
+     * @brief compare two texts line by line
+     * @param timeLimit the time limit in milliseconds, -1 for no limit, see isTimedOut()
+     * @param cancelled stop as soon as possible if it's not nullptr and it becomes non-zero, the result is incomplete
+     * @note it can be used on any thread
+     */
+    static TextDiff compare(const QString &output, const TestData &expected, int timeLimit = -1,
+                            const QAtomicInt *cancelled = nullptr);
+
+    /**
+     * @brief compare two texts token by token like a testlib checker, in linear time
+     * @param mode the mode of comparison, it must not be Lines
+     * @param maxError the maximum absolute or relative error in the Doubles mode
+     * @param cancelled stop as soon as possible if it's not nullptr and it becomes non-zero, the result is incomplete
+     * @note it can be used on any thread
+     */
+    static TextDiff compareTokens(const QString &output, const TestData &expected, Mode mode, double maxError = 0,
+                                  const QAtomicInt *cancelled = nullptr);
+
+    /**
+     * @brief find the changed characters of a pair of changed lines
+     * @param outputRanges set to the characters of the output which are not in the expected output
+     * @param expectedRanges set to the characters of the expected output which are not in the output
+     * @note the long lines are only compared by their common prefix and suffix
+     */
+    static void diffLine(QStringView output, QStringView expected, QVector<Range> *outputRanges,
+                         QVector<Range> *expectedRanges);
+
+    Mode mode() const;
+
+    const Text &output() const;
+    const Text &expected() const;
+
+    /**
+     * @brief get the chunks in order, the adjacent chunks are never both equal or both changed
+     */
+    const QVector<Chunk> &chunks() const;
+
+    /**
+     * @brief get the index of the chunk containing a row
+     * @note the row must be less than rowCount()
+     */
+    int chunkAt(int row) const;
+
+    /**
+     * @brief get the number of rows in the side-by-side view
+     */
+    int rowCount() const;
+
+    /**
+     * @brief whether the texts are equal line by line
+     */
+    bool isEqual() const;
+
+    /**
+     * @brief whether the time limit is exceeded, then some changed lines may be shown as changed although they are
+     *        in both texts
+     */
+    bool isTimedOut() const;
+
+    /**
+     * @brief get the rejected tokens in a line in the token modes
+     * @param inOutput whether the line is in the output or in the expected output
+     */
+    QVector<Range> rejectedTokens(int line, bool inOutput) const;
+
+    /**
+     * @brief get the number of rejected pairs of tokens in the token modes, a token without a pair is also counted
+     */
+    int rejectedCount() const;
+
+    /**
+     * @brief find the first difference, which is the first rejected token in the token modes, or the first changed
+     *        line in the Lines mode
+     * @param row set to the row of the difference
+     * @param column set to the column of the difference
+     * @returns false if there is no difference
+     */
+    bool firstDifference(int *row, int *column) const;
+
+  private:
+    class Comparer;
+    class TokenReader;
+
+    // the position of a token
+    struct Token
+    {
+        int line = -1;
+        Range range;
+    };
+
+    /**
+     * @brief whether a checker accepts a token of the output for a token of the expected output
+     */
+    static bool acceptsToken(QStringView output, QStringView expected, Mode mode, double maxError);
+
+    static const int MAX_COST = 2048;              // the maximum edit distance searched in a part of the texts
+    static const int CHARACTER_DIFF_LIMIT = 10000; // the lines longer than this are not compared by characters
+
+    Mode diffMode = Lines;
+    Text outputText, expectedText;
+    QVector<Chunk> diffChunks;
+    int rows = 0;
+    bool timedOut = false;
+    QVector<Token> outputRejected, expectedRejected; // the rejected tokens in order
+    int rejected = 0;                                // the number of rejected pairs
+    Token firstRejected;                             // the first rejected token, line is -1 if there is none
+};
+
+} // namespace Core
+
+#endif // TEXTDIFF_HPP
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/VerdictCache.hpp"
+#include "Core/Compiler.hpp"
+#include "Core/EventLogger.hpp"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+
+namespace Core
+{
+
+QByteArray VerdictCache::executableHash(const QString &tmpFilePath, const QString &sourceFilePath,
+                                        const QString &lang, const QString &runCommand, const QString &args)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    // the results also depend on how the executable file is started
+    hash.addData(lang.toUtf8());
+    hash.addData(runCommand.toUtf8());
+    hash.addData(args.toUtf8());
+
+    QStringList files;
+    if (lang == "Java")
+    {
+        QDir classPath(Compiler::outputPath(tmpFilePath, sourceFilePath, "Java", false));
+        for (auto const &name : classPath.entryList({"*.class"}, QDir::Files, QDir::Name))
+            files.push_back(classPath.filePath(name));
+    }
+    else
+    {
+        files.push_back(Compiler::outputFilePath(tmpFilePath, sourceFilePath, lang, false));
+    }
+
+    if (files.isEmpty())
+        return QByteArray();
+
+    for (auto const &path : files)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly) || !hash.addData(&file))
+        {
+            LOG_WARN("Failed to hash " << path);
+            return QByteArray();
+        }
+        hash.addData(path.toUtf8());
+    }
+
+    return hash.result();
+}
+
+QByteArray VerdictCache::key(const QByteArray &testCaseId, const QString &checker, int timeLimit)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(testCaseId);
+    hash.addData(checker.toUtf8());
+    hash.addData(QByteArray::number(timeLimit));
+    return hash.result();
+}
+
+void VerdictCache::setExecutableHash(const QByteArray &hash)
+{
+    if (hash == executable)
+        return;
+    LOG_INFO("Executable file changed, dropping " << results.size() << " cached results");
+    executable = hash;
+    results.clear();
+}
+
+bool VerdictCache::contains(const QByteArray &key) const
+{
+    return !executable.isEmpty() && results.contains(key);
+}
+
+VerdictCache::Result VerdictCache::result(const QByteArray &key) const
+{
+    return results.value(key);
+}
+
+void VerdictCache::insert(const QByteArray &key, const QString &output, qint64 timeUsed)
+{
+    if (executable.isEmpty())
+        return;
+    results[key] = {output, timeUsed};
+}
+
+void VerdictCache::clear()
+{
+    executable.clear();
+    results.clear();
+}
+
+} // namespace Core
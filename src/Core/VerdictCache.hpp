@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The VerdictCache remembers the results of the accepted test cases.
+ * A result is identified by the executable file, the test case, the checker and the time limit,
+ * so if none of them is changed, the test case doesn't need to be executed again.
+ * Only the results of the latest executable file are kept, the results of the older ones are dropped.
+ */
+
+#ifndef VERDICTCACHE_HPP
+#define VERDICTCACHE_HPP
+
+#include <QHash>
+#include <QString>
+
+namespace Core
+{
+
+class VerdictCache
+{
+  public:
+    // the result of an accepted execution
+    struct Result
+    {
+        QString output;      // the stdout of the program
+        qint64 timeUsed = 0; // the time used by the program, in milliseconds
+    };
+
+    /**
+     * @brief get the hash of the executable file
+     * @param tmpFilePath the path to the temporary file which is compiled
+     * @param sourceFilePath the path to the original source file
+     * @param lang the language of the program, one of "C++", "Java" and "Python"
+     * @param runCommand the command for running a program
+     * @param args the command line arguments added at the back to start the program
+     * @returns the hash of the executable file, an empty QByteArray if the executable file can't be read
+     * @note For Java, all classes in the class path are hashed. For Python, the source file is hashed.
+     */
+    static QByteArray executableHash(const QString &tmpFilePath, const QString &sourceFilePath, const QString &lang,
+                                     const QString &runCommand, const QString &args);
+
+    /**
+     * @brief get the key of a test case
+     * @param testCaseId the id of the test case, see Widgets::TestCasesModel::TestCaseData::id
+     * @param checker the identity of the checker, see Core::Checker::identity
+     * @param timeLimit the time limit of the execution, in milliseconds
+     */
+    static QByteArray key(const QByteArray &testCaseId, const QString &checker, int timeLimit);
+
+    /**
+     * @brief set the hash of the current executable file
+     * @note all results are dropped if the hash is changed
+     */
+    void setExecutableHash(const QByteArray &hash);
+
+    /**
+     * @brief check whether there is an accepted result for the key with the current executable file
+     */
+    bool contains(const QByteArray &key) const;
+
+    /**
+     * @brief get the accepted result of the key
+     * @note the key must be contained in the cache
+     */
+    Result result(const QByteArray &key) const;
+
+    /**
+     * @brief save an accepted result of the current executable file
+     */
+    void insert(const QByteArray &key, const QString &output, qint64 timeUsed);
+
+    /**
+     * @brief remove all results
+     */
+    void clear();
+
+  private:
+    QByteArray executable;             // the hash of the current executable file
+    QHash<QByteArray, Result> results; // the accepted results of the current executable file
+};
+
+} // namespace Core
+
+#endif // VERDICTCACHE_HPP
@@ -0,0 +1,469 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Core/ZipArchive.hpp"
+#include <QCoreApplication>
+#include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace Core
+{
+
+static const quint32 LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static const quint32 CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static const quint32 END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+static const int LOCAL_HEADER_SIZE = 30;
+static const int CENTRAL_HEADER_SIZE = 46;
+static const int END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+static const int MAX_COMMENT_LENGTH = 0xffff;
+
+static const quint16 METHOD_STORED = 0;
+static const quint16 METHOD_DEFLATED = 8;
+static const quint16 FLAG_ENCRYPTED = 1;
+
+/*
+ * A decoder of the raw deflate format (RFC 1951), based on the ideas of puff.c in zlib by Mark Adler.
+ * The size of the output is known from the central directory, so the output is written into a preallocated buffer.
+ */
+class Inflater
+{
+  public:
+    Inflater(const uchar *input, qint64 inputSize, char *output, qint64 outputSize)
+        : input(input), inputSize(inputSize), output(output), outputSize(outputSize)
+    {
+    }
+
+    /**
+     * @brief decode the whole input
+     * @returns true if the input is valid and the output is filled exactly
+     */
+    bool run()
+    {
+        bool last = false;
+        do
+        {
+            last = bits(1) != 0;
+            const int type = bits(2);
+            bool ok = false;
+            if (type == 0)
+                ok = stored();
+            else if (type == 1)
+                ok = fixed();
+            else if (type == 2)
+                ok = dynamic();
+            if (!ok || exhausted)
+                return false;
+        } while (!last);
+        return outputPosition == outputSize;
+    }
+
+  private:
+    static const int MAX_BITS = 15;        // the maximum bits in a code
+    static const int MAX_LENGTH_CODES = 286; // the maximum number of literal/length codes
+    static const int MAX_DISTANCE_CODES = 30; // the maximum number of distance codes
+    static const int FIXED_LENGTH_CODES = 288; // the number of fixed literal/length codes
+
+    // a canonical Huffman code, the number of codes of each length and the symbols ordered by their codes
+    struct Huffman
+    {
+        std::array<int, MAX_BITS + 1> count;
+        std::array<int, FIXED_LENGTH_CODES> symbol;
+    };
+
+    int bits(int need)
+    {
+        quint32 value = bitBuffer;
+        while (bitCount < need)
+        {
+            if (inputPosition == inputSize)
+            {
+                exhausted = true;
+                return 0;
+            }
+            value |= quint32(input[inputPosition++]) << bitCount;
+            bitCount += 8;
+        }
+        bitBuffer = value >> need;
+        bitCount -= need;
+        return int(value & ((1U << need) - 1));
+    }
+
+    bool stored()
+    {
+        // the remaining bits in the current byte are discarded
+        bitBuffer = 0;
+        bitCount = 0;
+        if (inputPosition + 4 > inputSize)
+            return false;
+        const quint32 length = input[inputPosition] | (quint32(input[inputPosition + 1]) << 8);
+        const quint32 complement = input[inputPosition + 2] | (quint32(input[inputPosition + 3]) << 8);
+        inputPosition += 4;
+        if (length != (~complement & 0xffff) || inputPosition + length > inputSize ||
+            outputPosition + length > outputSize)
+        {
+            return false;
+        }
+        std::copy(input + inputPosition, input + inputPosition + length, output + outputPosition);
+        inputPosition += length;
+        outputPosition += length;
+        return true;
+    }
+
+    int decode(const Huffman &huffman)
+    {
+        int code = 0;  // the bits read so far
+        int first = 0; // the first code of the current length
+        int index = 0; // the index of the first symbol of the current length
+        for (int length = 1; length <= MAX_BITS; ++length)
+        {
+            code |= bits(1);
+            const int count = huffman.count[length];
+            if (code - count < first)
+                return huffman.symbol[index + (code - first)];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief construct a Huffman code from the code lengths of the symbols
+     * @returns 0 for a complete code, a positive number for an incomplete code, a negative number for an
+     *          over-subscribed code
+     */
+    static int construct(Huffman *huffman, const int *lengths, int n)
+    {
+        huffman->count.fill(0);
+        for (int symbol = 0; symbol < n; ++symbol)
+            ++huffman->count[lengths[symbol]];
+        if (huffman->count[0] == n)
+            return 0;
+
+        int left = 1;
+        for (int length = 1; length <= MAX_BITS; ++length)
+        {
+            left = (left << 1) - huffman->count[length];
+            if (left < 0)
+                return left;
+        }
+
+        std::array<int, MAX_BITS + 1> offsets;
+        offsets[1] = 0;
+        for (int length = 1; length < MAX_BITS; ++length)
+            offsets[length + 1] = offsets[length] + huffman->count[length];
+        for (int symbol = 0; symbol < n; ++symbol)
+        {
+            if (lengths[symbol] != 0)
+                huffman->symbol[offsets[lengths[symbol]]++] = symbol;
+        }
+        return left;
+    }
+
+    bool codes(const Huffman &lengthCode, const Huffman &distanceCode)
+    {
+        static const int LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                            31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                             2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const int DISTANCE_BASE[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,
+                                              33,  49,  65,  97,  129, 193,  257,  385,  513,  769,
+                                              1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const int DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                               6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        while (!exhausted)
+        {
+            int symbol = decode(lengthCode);
+            if (symbol < 0)
+                return false;
+            if (symbol < 256)
+            {
+                if (outputPosition == outputSize)
+                    return false;
+                output[outputPosition++] = char(symbol);
+            }
+            else if (symbol == 256)
+            {
+                return true;
+            }
+            else
+            {
+                symbol -= 257;
+                if (symbol >= 29)
+                    return false;
+                const qint64 length = LENGTH_BASE[symbol] + bits(LENGTH_EXTRA[symbol]);
+                symbol = decode(distanceCode);
+                if (symbol < 0 || symbol >= 30)
+                    return false;
+                const qint64 distance = DISTANCE_BASE[symbol] + bits(DISTANCE_EXTRA[symbol]);
+                if (distance > outputPosition || outputPosition + length > outputSize)
+                    return false;
+                // the source and the destination may overlap, so it's copied byte by byte
+                for (qint64 i = 0; i < length; ++i, ++outputPosition)
+                    output[outputPosition] = output[outputPosition - distance];
+            }
+        }
+        return false;
+    }
+
+    bool fixed()
+    {
+        static const auto tables = [] {
+            std::pair<Huffman, Huffman> result;
+            std::array<int, FIXED_LENGTH_CODES> lengths;
+            std::fill(lengths.begin(), lengths.begin() + 144, 8);
+            std::fill(lengths.begin() + 144, lengths.begin() + 256, 9);
+            std::fill(lengths.begin() + 256, lengths.begin() + 280, 7);
+            std::fill(lengths.begin() + 280, lengths.end(), 8);
+            construct(&result.first, lengths.data(), FIXED_LENGTH_CODES);
+            std::fill(lengths.begin(), lengths.begin() + MAX_DISTANCE_CODES, 5);
+            construct(&result.second, lengths.data(), MAX_DISTANCE_CODES);
+            return result;
+        }();
+        return codes(tables.first, tables.second);
+    }
+
+    bool dynamic()
+    {
+        static const int ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+        const int lengthCount = bits(5) + 257;
+        const int distanceCount = bits(5) + 1;
+        const int codeCount = bits(4) + 4;
+        if (lengthCount > MAX_LENGTH_CODES || distanceCount > MAX_DISTANCE_CODES)
+            return false;
+
+        std::array<int, MAX_LENGTH_CODES + MAX_DISTANCE_CODES> lengths{};
+        for (int i = 0; i < codeCount; ++i)
+            lengths[ORDER[i]] = bits(3);
+
+        Huffman lengthCode, distanceCode;
+        if (construct(&lengthCode, lengths.data(), 19) != 0)
+            return false;
+
+        // the code lengths of the literal/length codes and the distance codes
+        for (int index = 0; index < lengthCount + distanceCount;)
+        {
+            int symbol = decode(lengthCode);
+            if (symbol < 0 || exhausted)
+                return false;
+            if (symbol < 16)
+            {
+                lengths[index++] = symbol;
+                continue;
+            }
+            int length = 0;
+            if (symbol == 16)
+            {
+                if (index == 0)
+                    return false;
+                length = lengths[index - 1];
+                symbol = 3 + bits(2);
+            }
+            else if (symbol == 17)
+            {
+                symbol = 3 + bits(3);
+            }
+            else
+            {
+                symbol = 11 + bits(7);
+            }
+            if (index + symbol > lengthCount + distanceCount)
+                return false;
+            while (symbol--)
+                lengths[index++] = length;
+        }
+
+        // the end-of-block code is required, and only a single code is allowed to be incomplete
+        if (lengths[256] == 0)
+            return false;
+        int left = construct(&lengthCode, lengths.data(), lengthCount);
+        if (left < 0 || (left > 0 && lengthCount != lengthCode.count[0] + lengthCode.count[1]))
+            return false;
+        left = construct(&distanceCode, lengths.data() + lengthCount, distanceCount);
+        if (left < 0 || (left > 0 && distanceCount != distanceCode.count[0] + distanceCode.count[1]))
+            return false;
+
+        return codes(lengthCode, distanceCode);
+    }
+
+    const uchar *input;
+    qint64 inputSize;
+    qint64 inputPosition = 0;
+    char *output;
+    qint64 outputSize;
+    qint64 outputPosition = 0;
+    quint32 bitBuffer = 0;  // the bits read but not used yet
+    int bitCount = 0;       // the number of bits in bitBuffer
+    bool exhausted = false; // whether it has tried to read beyond the input
+};
+
+/**
+ * @brief calculate the CRC-32 of the data, the same as the one in zip archives
+ */
+static quint32 crc32(const char *data, qint64 size)
+{
+    static const auto table = [] {
+        std::array<quint32, 256> result;
+        for (quint32 i = 0; i < 256; ++i)
+        {
+            quint32 value = i;
+            for (int k = 0; k < 8; ++k)
+                value = (value & 1) ? 0xedb88320U ^ (value >> 1) : value >> 1;
+            result[i] = value;
+        }
+        return result;
+    }();
+
+    quint32 crc = 0xffffffffU;
+    for (qint64 i = 0; i < size; ++i)
+        crc = table[(crc ^ uchar(data[i])) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffU;
+}
+
+ZipArchive::~ZipArchive()
+{
+    if (mapped != nullptr)
+        file.unmap(mapped);
+}
+
+bool ZipArchive::open(const QString &path, QString *error)
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        *error = QCoreApplication::translate("Core::ZipArchive", "Failed to open [%1]. Do I have read permission?")
+                     .arg(path);
+        return false;
+    }
+
+    const auto invalid = [&error, &path] {
+        *error = QCoreApplication::translate("Core::ZipArchive", "[%1] is not a supported zip archive.").arg(path);
+        return false;
+    };
+
+    size = file.size();
+    if (size < END_OF_CENTRAL_DIRECTORY_SIZE)
+        return invalid();
+    mapped = file.map(0, size);
+    if (mapped == nullptr)
+    {
+        *error = QCoreApplication::translate("Core::ZipArchive", "Failed to map [%1] into the memory: %2")
+                     .arg(path)
+                     .arg(file.errorString());
+        return false;
+    }
+
+    // the end of central directory record is at the end of the archive, followed by a comment of variable length
+    qint64 end = size - END_OF_CENTRAL_DIRECTORY_SIZE;
+    const qint64 lowest = qMax(qint64(0), end - MAX_COMMENT_LENGTH);
+    while (end >= lowest && qFromLittleEndian<quint32>(mapped + end) != END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+        --end;
+    if (end < lowest)
+        return invalid();
+
+    const int count = qFromLittleEndian<quint16>(mapped + end + 10);
+    const qint64 directorySize = qFromLittleEndian<quint32>(mapped + end + 12);
+    qint64 position = qFromLittleEndian<quint32>(mapped + end + 16);
+    if (position + directorySize > end)
+        return invalid();
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (position + CENTRAL_HEADER_SIZE > end ||
+            qFromLittleEndian<quint32>(mapped + position) != CENTRAL_HEADER_SIGNATURE)
+        {
+            return invalid();
+        }
+        Entry entry;
+        entry.flags = qFromLittleEndian<quint16>(mapped + position + 8);
+        entry.method = qFromLittleEndian<quint16>(mapped + position + 10);
+        entry.crc = qFromLittleEndian<quint32>(mapped + position + 16);
+        entry.size = qFromLittleEndian<quint32>(mapped + position + 20);
+        entry.length = qFromLittleEndian<quint32>(mapped + position + 24);
+        const int nameLength = qFromLittleEndian<quint16>(mapped + position + 28);
+        const int extraLength = qFromLittleEndian<quint16>(mapped + position + 30);
+        const int commentLength = qFromLittleEndian<quint16>(mapped + position + 32);
+        entry.headerOffset = qFromLittleEndian<quint32>(mapped + position + 42);
+        if (position + CENTRAL_HEADER_SIZE + nameLength > end)
+            return invalid();
+        entry.name = QString::fromUtf8(reinterpret_cast<const char *>(mapped + position + CENTRAL_HEADER_SIZE),
+                                       nameLength);
+        position += CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+
+        // the names of the directories end with "/"
+        if (!entry.name.endsWith('/'))
+            entries.push_back(entry);
+    }
+    return true;
+}
+
+QStringList ZipArchive::fileNames() const
+{
+    QStringList result;
+    for (const auto &entry : entries)
+        result.push_back(entry.name);
+    return result;
+}
+
+bool ZipArchive::read(int index, QByteArray *content, QString *error) const
+{
+    const auto &entry = entries[index];
+    const auto failed = [&error, &entry, this](const QString &reason) {
+        *error = QCoreApplication::translate("Core::ZipArchive", "Failed to read [%1] in [%2]: %3")
+                     .arg(entry.name)
+                     .arg(file.fileName())
+                     .arg(reason);
+        return false;
+    };
+
+    if (entry.flags & FLAG_ENCRYPTED)
+        return failed(QCoreApplication::translate("Core::ZipArchive", "It's encrypted."));
+    if (entry.method != METHOD_STORED && entry.method != METHOD_DEFLATED)
+        return failed(QCoreApplication::translate("Core::ZipArchive", "The compression method is not supported."));
+    if (entry.length > quint32(std::numeric_limits<int>::max()))
+        return failed(QCoreApplication::translate("Core::ZipArchive", "It's too large."));
+
+    const qint64 header = entry.headerOffset;
+    if (header + LOCAL_HEADER_SIZE > size || qFromLittleEndian<quint32>(mapped + header) != LOCAL_HEADER_SIGNATURE)
+        return failed(QCoreApplication::translate("Core::ZipArchive", "The archive is corrupted."));
+    const qint64 data = header + LOCAL_HEADER_SIZE + qFromLittleEndian<quint16>(mapped + header + 26) +
+                        qFromLittleEndian<quint16>(mapped + header + 28);
+    if (data + entry.size > size)
+        return failed(QCoreApplication::translate("Core::ZipArchive", "The archive is corrupted."));
+
+    content->resize(int(entry.length));
+    if (entry.method == METHOD_STORED)
+    {
+        if (entry.size != entry.length)
+            return failed(QCoreApplication::translate("Core::ZipArchive", "The archive is corrupted."));
+        std::copy(mapped + data, mapped + data + entry.size, content->data());
+    }
+    else if (!Inflater(mapped + data, entry.size, content->data(), entry.length).run())
+    {
+        return failed(QCoreApplication::translate("Core::ZipArchive", "The archive is corrupted."));
+    }
+
+    if (crc32(content->constData(), content->size()) != entry.crc)
+        return failed(QCoreApplication::translate("Core::ZipArchive", "The archive is corrupted."));
+    return true;
+}
+
+} // namespace Core
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The ZipArchive reads the files in a zip archive, e.g. a problem package downloaded from Polygon or Codeforces.
+ * Only what is needed to import the test cases is supported: the stored and the deflated files, without encryption
+ * and ZIP64. The archive is mapped into the memory, and the deflated files are decompressed by a small inflater, so
+ * it doesn't depend on any library.
+ */
+
+#ifndef ZIPARCHIVE_HPP
+#define ZIPARCHIVE_HPP
+
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+
+namespace Core
+{
+
+class ZipArchive
+{
+  public:
+    ZipArchive() = default;
+    ~ZipArchive();
+
+    /**
+     * @brief open a zip archive and read its central directory
+     * @param path the path to the zip archive
+     * @param error set to the reason of the failure if failed to open the archive
+     * @note it can be used on any thread
+     */
+    bool open(const QString &path, QString *error);
+
+    /**
+     * @brief get the paths of the files in the archive, the directories are not included
+     * @note the paths are separated by "/", and they are relative to the root of the archive
+     */
+    QStringList fileNames() const;
+
+    /**
+     * @brief read a file in the archive
+     * @param index the index of the file in fileNames()
+     * @param content set to the content of the file
+     * @param error set to the reason of the failure if failed to read the file
+     */
+    bool read(int index, QByteArray *content, QString *error) const;
+
+  private:
+    Q_DISABLE_COPY(ZipArchive)
+
+    // a file in the central directory
+    struct Entry
+    {
+        QString name;             // the path to the file in the archive
+        quint16 flags = 0;        // the general purpose bit flags
+        quint16 method = 0;       // the compression method, 0 for stored and 8 for deflated
+        quint32 crc = 0;          // the CRC-32 of the content
+        quint32 size = 0;         // the size of the compressed data
+        quint32 length = 0;       // the size of the content
+        quint32 headerOffset = 0; // the offset of the local file header
+    };
+
+    QFile file;              // the opened archive
+    uchar *mapped = nullptr; // the mapped archive, nullptr if it's not opened
+    qint64 size = 0;         // the size of the archive
+    QVector<Entry> entries;  // the files in the archive
+};
+
+} // namespace Core
+
+#endif // ZIPARCHIVE_HPP
@@ -61,6 +61,7 @@ void LanguageServer::openDocument(QString const &path, QCodeEditor *editor, Mess
     m_editor = editor;
     openFile = path;
     logger = log;
+    diagnostics.clear();
 
     if (lsp == nullptr)
         return;
@@ -100,6 +101,7 @@ void LanguageServer::closeDocument()
     openFile = "";
     logger = nullptr;
     m_editor = nullptr;
+    diagnostics.clear();
 }
 
 void LanguageServer::requestLinting()
@@ -121,6 +123,22 @@ bool LanguageServer::isDocumentOpen() const
     return !openFile.isEmpty() && lsp != nullptr;
 }
 
+bool LanguageServer::isAttachedTo(QCodeEditor *editor) const
+{
+    return editor != nullptr && m_editor == editor;
+}
+
+void LanguageServer::redrawSquiggles()
+{
+    if (m_editor == nullptr)
+        return;
+
+    m_editor->clearSquiggle();
+    for (const auto &diagnostic : diagnostics)
+        m_editor->squiggle(diagnostic.level, diagnostic.start, diagnostic.stop, diagnostic.tooltip);
+    emit squigglesReset();
+}
+
 void LanguageServer::updateSettings()
 {
     if (lsp != nullptr)
@@ -132,8 +150,12 @@ void LanguageServer::updateSettings()
         lsp = nullptr;
     }
 
+    diagnostics.clear();
     if (m_editor != nullptr)
+    {
         m_editor->clearSquiggle();
+        emit squigglesReset();
+    }
 
     if (shouldCreateClient())
     {
@@ -229,7 +251,7 @@ void LanguageServer::onLSPServerNotificationArrived(QString const &method, QJson
 {
     if (method == "textDocument/publishDiagnostics" && m_editor != nullptr) // Linting
     {
-        m_editor->clearSquiggle();
+        diagnostics.clear();
         QJsonArray doc = QJsonDocument::fromVariant(param.toVariantMap()).object()["diagnostics"].toArray();
         for (auto e : doc)
         {
@@ -248,9 +270,10 @@ void LanguageServer::onLSPServerNotificationArrived(QString const &method, QJson
             stop.first = end["line"].toInt() + 1;
             stop.second = end["character"].toInt();
 
-            m_editor->squiggle(level, start, stop,
-                               tooltip.remove(" (fix available)")); // We do not provide quick fix so remove this text.
+            // We do not provide quick fix so remove this text.
+            diagnostics.push_back({level, start, stop, tooltip.remove(" (fix available)")});
         }
+        redrawSquiggles();
     }
 }
 
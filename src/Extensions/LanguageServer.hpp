@@ -21,6 +21,7 @@
 #include <QCodeEditor>
 #include <QJsonObject>
 #include <QProcess>
+#include <QVector>
 
 class MessageLogger;
 class LSPClient;
@@ -40,10 +41,21 @@ class LanguageServer : public QObject
     void requestLinting();
 
     bool isDocumentOpen() const;
+    bool isAttachedTo(QCodeEditor *editor) const;
+
+    /**
+     * @brief clear the squiggles of the editor and add the last published diagnostics again
+     * @note squigglesReset is emitted, so that the other squiggles can be added again
+     */
+    void redrawSquiggles();
 
     void updateSettings();
     void updatePath(QString const &);
 
+  signals:
+    // all squiggles of the editor are cleared, the other squiggles should be added again
+    void squigglesReset();
+
   private slots:
     void onLSPServerNotificationArrived(QString const &method, QJsonObject const &param);
     void onLSPServerResponseArrived(QJsonObject const &method, QJsonObject const &param);
@@ -54,6 +66,14 @@ class LanguageServer : public QObject
     void onLSPServerNewStderr(const QString &content);
 
   private:
+    struct Diagnostic
+    {
+        QCodeEditor::SeverityLevel level;
+        QPair<int, int> start;
+        QPair<int, int> stop;
+        QString tooltip;
+    };
+
     void performConnection();
     void createClient();
     bool shouldCreateClient();
@@ -67,6 +87,7 @@ class LanguageServer : public QObject
     bool isInitialized = false;
     QString language;
     QString openFile;
+    QVector<Diagnostic> diagnostics; // the last published diagnostics of the open document
 };
 } // namespace Extensions
 
@@ -207,7 +207,8 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
             .end()
             .dir(TRKEY("Java"))
                 .page("Java Commands", tr("%1 Commands").arg(tr("Java")),
-                      {"Java/Compile Command", "Java/Output Path", "Java/Class Name", "Java/Run Command", "Java/Run Arguments", "Java/Compiler Output Codec"})
+                      {"Java/Compile Command", "Java/Output Path", "Java/Class Name", "Java/Run Command", "Java/Run Arguments", "Java/Compiler Output Codec",
+                       "Java/Use Class Data Sharing"})
                 .page("Java Template", tr("%1 Template").arg(tr("Java")),
                       {"Java/Template Path", "Java/Template Cursor Position Regex", "Java/Template Cursor Position Offset Type",
                        "Java/Template Cursor Position Offset Characters"})
@@ -219,7 +220,7 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
             .end()
             .dir(TRKEY("Python"))
                 .page("Python Commands", tr("%1 Commands").arg(tr("Python")),
-                      {"Python/Run Command", "Python/Run Arguments"})
+                      {"Python/Run Command", "Python/Run Arguments", "Python/Precompile", "Python/Use Fork Server"})
                 .page("Python Template", tr("%1 Template").arg(tr("Python")),
                       {"Python/Template Path", "Python/Template Cursor Position Regex", "Python/Template Cursor Position Offset Type",
                       "Python/Template Cursor Position Offset Characters"})
@@ -244,7 +245,11 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
 #endif
             .page(TRKEY("Save Session"), {"Hot Exit/Enable", "Hot Exit/Auto Save", "Hot Exit/Auto Save Interval"})
             .page(TRKEY("Bind file and problem"), {"Restore Old Problem Url", "Open Old File For Old Problem Url"})
-            .page(TRKEY("Test Cases"), {"Run On Empty Testcase", "Check On Testcases With Empty Output", "Auto Uncheck Accepted Testcases"})
+            .page(TRKEY("Test Cases"), {"Run On Empty Testcase", "Check On Testcases With Empty Output", "Auto Uncheck Accepted Testcases",
+                                        "Run Changed Testcases Only", "Testcase Execution Order", "Parallel Executions Limit",
+                                        "Use Native Launcher", "Collect Performance Counters", "Track Runtime History",
+                                        "Runtime Regression Threshold", "Stop At First Unaccepted Testcase",
+                                        "Merge Duplicate Test Cases"})
             .page(TRKEY("Load External File Changes"), {"Auto Load External Changes If No Unsaved Modification", "Ask For Loading External Changes"})
             .page(TRKEY("Stopwatch"), {"Display Stopwatch", "Toggle Stopwatch On Tab Switch", "Hide Stopwatch Result"})
         .end()
@@ -263,11 +268,13 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
                 "Competitive Companion/Set Time Limit For Tab", "Competitive Companion/Connection Port",
                 "Competitive Companion/Head Comments", "Competitive Companion/Head Comments Time Format",
                 "Competitive Companion/Head Comments Powered By CP Editor"}, false)
+            .page(TRKEY("Performance Advisor"), {"Performance Advisor"})
             .page(TRKEY("CF Tool"), {"CF/Path", "CF/Show Toast Messages"})
             .page(TRKEY("WakaTime"),{"WakaTime/Enable", "WakaTime/Path", "WakaTime/Api Key", "WakaTime/Proxy"})
         .end()
         .dir(TRKEY("File Path"))
-            .page(TRKEY("Testcases"), {"Input File Save Path", "Answer File Save Path", "Testcases Matching Rules"})
+            .page(TRKEY("Testcases"), {"Input File Save Path", "Answer File Save Path", "Test Case Storage",
+                                       "Compress Test Case Archive", "Testcases Matching Rules"})
             .page(TRKEY("Problem URL"), {"Default File Paths For Problem URLs"})
             .page(TRKEY("Default Paths"), DefaultPathManager::actionSettingsList() << "Default Path/Names And Paths")
         .end()
@@ -275,8 +282,11 @@ PreferencesWindow::PreferencesWindow(QWidget *parent) : QMainWindow(parent)
                                    "Hotkey/Change View Mode", "Hotkey/Snippets"})
         .dir(TRKEY("Advanced"))
             .page(TRKEY("Update"), {"Check Update", "Beta"})
-            .page(TRKEY("Limits"), {"Default Time Limit", "Output Length Limit", "Output Display Length Limit", "Message Length Limit",
-                                    "HTML Diff Viewer Length Limit", "Open File Length Limit", "Display Test Case Length Limit"})
+            .page(TRKEY("Limits"), {"Default Time Limit", "Limit CPU Time", "Wall Time Limit Factor",
+                                    "Time Limit Calibration/Scale Time Limits",
+                                    "Time Limit Calibration/Reference Benchmark Time", "Output Length Limit",
+                                    "Output Display Length Limit", "Message Length Limit", "Open File Length Limit",
+                                    "Display Test Case Length Limit", "Diff Viewer Time Limit"})
             .page(TRKEY("Network Proxy"), {"Proxy/Enabled", "Proxy/Type", "Proxy/Host Name", "Proxy/Port", "Proxy/User", "Proxy/Password"})
         .end()
     .ensureAtTop();
@@ -117,6 +117,7 @@ def addDefaultPaths(obj):
         ("Load Single Test Case", "${testcase}", "testcase"),
         ("Add Pairs Of Test Cases", "${testcase}", "testcase"),
         ("Save Test Case To A File", "${testcase}", "testcase"),
+        ("Export And Import Test Cases", "${testcase}", "testcase"),
         ("Custom Checker", "${checker}", "checker"),
         ("Export And Import Settings", "${settings}", "settings"),
         ("Export And Load Session", "${session}", "session"),
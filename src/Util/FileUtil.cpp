@@ -70,6 +70,12 @@ QString fileNameWithSuffix(const QString &name, const QString &lang)
 
 bool saveFile(const QString &path, const QString &content, const QString &head, bool safe, MessageLogger *log,
               bool createDirectory)
+{
+    return saveFile(path, content.toUtf8(), head, safe, log, createDirectory);
+}
+
+bool saveFile(const QString &path, const QByteArray &content, const QString &head, bool safe, MessageLogger *log,
+              bool createDirectory)
 {
     if (createDirectory)
     {
@@ -88,7 +94,7 @@ bool saveFile(const QString &path, const QString &content, const QString &head,
             LOG_ERR("Failed to open [" << path << "]");
             return false;
         }
-        file.write(content.toUtf8());
+        file.write(content);
         if (!file.commit())
         {
             if (log != nullptr)
@@ -111,7 +117,7 @@ bool saveFile(const QString &path, const QString &content, const QString &head,
             LOG_ERR("unsafe: Failed to open [" << path << "]");
             return false;
         }
-        if (file.write(content.toUtf8()) == -1)
+        if (file.write(content) == -1)
         {
             if (log != nullptr)
                 log->error(head, QCoreApplication::translate("Util::FileUtil",
@@ -40,6 +40,13 @@ QString fileNameFilter(bool cpp, bool java, bool python);
 bool saveFile(const QString &path, const QString &content, const QString &head = "Save File", bool safe = true,
               MessageLogger *log = nullptr, bool createDirectory = false);
 
+/**
+ * @brief save the content encoded in UTF-8 to a file, the same as the QString overload
+ * @note it's useful when the content is already encoded, e.g. Core::TestData::bytes()
+ */
+bool saveFile(const QString &path, const QByteArray &content, const QString &head = "Save File", bool safe = true,
+              MessageLogger *log = nullptr, bool createDirectory = false);
+
 /**
  * @brief get the content of a file
  * @param path the path to the file
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/ComplexityDialog.hpp"
+#include "Core/EventLogger.hpp"
+#include "generated/SettingsHelper.hpp"
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include <limits>
+
+namespace Widgets
+{
+
+ComplexityDialog::ComplexityDialog(QWidget *parent) : QDialog(parent)
+{
+    setWindowTitle(tr("Estimate Complexity"));
+
+    auto *mainLayout = new QVBoxLayout(this);
+
+    auto *descriptionLabel =
+        new QLabel(tr("The generator is executed with increasing sizes, and its output is used as the input of the "
+                      "solution. The time used is fitted against the common complexities to predict the time used at "
+                      "the maximum size."));
+    descriptionLabel->setWordWrap(true);
+    mainLayout->addWidget(descriptionLabel);
+
+    auto *formLayout = new QFormLayout();
+    mainLayout->addLayout(formLayout);
+
+    generatorEdit = new QLineEdit();
+    generatorEdit->setPlaceholderText(tr("e.g. python gen.py ${n}"));
+    generatorEdit->setToolTip(tr("The command to generate an input, ${n} is replaced by the size.\nIt's executed in "
+                                 "the directory of the source file, and the input is read from its stdout."));
+    formLayout->addRow(tr("Generator Command"), generatorEdit);
+
+    minimumSizeSpinBox = new QSpinBox();
+    minimumSizeSpinBox->setRange(1, std::numeric_limits<int>::max());
+    formLayout->addRow(tr("Minimum Size"), minimumSizeSpinBox);
+
+    maximumSizeSpinBox = new QSpinBox();
+    maximumSizeSpinBox->setRange(1, std::numeric_limits<int>::max());
+    maximumSizeSpinBox->setToolTip(tr("The maximum size in the constraints of the problem"));
+    formLayout->addRow(tr("Maximum Size"), maximumSizeSpinBox);
+
+    growthFactorSpinBox = new QSpinBox();
+    growthFactorSpinBox->setRange(2, 10);
+    growthFactorSpinBox->setToolTip(tr("The ratio of two consecutive sizes"));
+    formLayout->addRow(tr("Growth Factor"), growthFactorSpinBox);
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    mainLayout->addWidget(buttonBox);
+    connect(buttonBox->button(QDialogButtonBox::Ok), &QPushButton::clicked, this, &ComplexityDialog::submit);
+    connect(buttonBox->button(QDialogButtonBox::Cancel), &QPushButton::clicked, this, &QDialog::reject);
+
+    generatorEdit->setText(SettingsHelper::getComplexityEstimatorGeneratorCommand());
+    minimumSizeSpinBox->setValue(SettingsHelper::getComplexityEstimatorMinimumSize());
+    maximumSizeSpinBox->setValue(SettingsHelper::getComplexityEstimatorMaximumSize());
+    growthFactorSpinBox->setValue(SettingsHelper::getComplexityEstimatorGrowthFactor());
+}
+
+void ComplexityDialog::submit()
+{
+    LOG_INFO(INFO_OF(generatorEdit->text()) << INFO_OF(minimumSizeSpinBox->value())
+                                            << INFO_OF(maximumSizeSpinBox->value())
+                                            << INFO_OF(growthFactorSpinBox->value()));
+
+    if (generatorEdit->text().trimmed().isEmpty())
+    {
+        QMessageBox::warning(this, tr("Estimate Complexity"), tr("The generator command is empty."));
+        return;
+    }
+
+    if (minimumSizeSpinBox->value() > maximumSizeSpinBox->value())
+    {
+        QMessageBox::warning(this, tr("Estimate Complexity"),
+                             tr("The minimum size can't be larger than the maximum size."));
+        return;
+    }
+
+    SettingsHelper::setComplexityEstimatorGeneratorCommand(generatorEdit->text());
+    SettingsHelper::setComplexityEstimatorMinimumSize(minimumSizeSpinBox->value());
+    SettingsHelper::setComplexityEstimatorMaximumSize(maximumSizeSpinBox->value());
+    SettingsHelper::setComplexityEstimatorGrowthFactor(growthFactorSpinBox->value());
+
+    accept();
+}
+
+} // namespace Widgets
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The ComplexityDialog asks for the generator and the sizes used by Core::ComplexityEstimator.
+ * The values are saved in the settings when it's accepted, and they are restored the next time.
+ */
+
+#ifndef COMPLEXITYDIALOG_HPP
+#define COMPLEXITYDIALOG_HPP
+
+#include <QDialog>
+
+class QLineEdit;
+class QSpinBox;
+
+namespace Widgets
+{
+class ComplexityDialog : public QDialog
+{
+    Q_OBJECT
+
+  public:
+    explicit ComplexityDialog(QWidget *parent = nullptr);
+
+  private slots:
+    void submit();
+
+  private:
+    QLineEdit *generatorEdit = nullptr;
+    QSpinBox *minimumSizeSpinBox = nullptr;
+    QSpinBox *maximumSizeSpinBox = nullptr;
+    QSpinBox *growthFactorSpinBox = nullptr;
+};
+} // namespace Widgets
+
+#endif // COMPLEXITYDIALOG_HPP
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/DiffView.hpp"
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QMenu>
+#include <QPainter>
+#include <QScrollBar>
+#include <generated/SettingsHelper.hpp>
+
+namespace Widgets
+{
+DiffView::DiffView(Side side, QWidget *parent) : QAbstractScrollArea(parent), side(side)
+{
+    setFont(SettingsHelper::getTestCasesFont());
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setBackgroundRole(QPalette::Base);
+}
+
+void DiffView::setDiff(const QSharedPointer<const Core::TextDiff> &diff)
+{
+    this->diff = diff;
+    ranges.clear();
+    showLineBreaks = SettingsHelper::isDisplayEOLNInDiff();
+    updateScrollBars();
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    viewport()->update();
+}
+
+void DiffView::paintEvent(QPaintEvent * /*event*/)
+{
+    if (diff.isNull())
+        return;
+
+    QPainter painter(viewport());
+    const QFontMetrics metrics(font());
+    const int lineHeight = metrics.height();
+    const int gutter = gutterWidth();
+    const int width = viewport()->width();
+    const int firstRow = verticalScrollBar()->value();
+    const int lastRow = qMin(diff->rowCount(), firstRow + viewport()->height() / lineHeight + 1);
+
+    // only the visible columns of a line are drawn, they are found by the average width of the characters
+    const int charWidth = qMax(1, metrics.averageCharWidth());
+    const int scrollX = horizontalScrollBar()->value();
+    const int firstColumn = scrollX / charWidth;
+    const int columns = (width - gutter) / charWidth + 2;
+    const int textLeft = gutter - scrollX % charWidth;
+
+    const auto &lines = text();
+    const QColor changedColor = side == Output ? QColor(255, 0, 0, 40) : QColor(0, 200, 0, 40);
+    const QColor highlightColor = side == Output ? QColor(255, 0, 0, 110) : QColor(0, 200, 0, 110);
+    const QColor fillerColor(128, 128, 128, 40);
+    const QColor lineNumberColor = palette().color(QPalette::Disabled, QPalette::Text);
+
+    int chunkIndex = diff->chunkAt(qMin(firstRow, diff->rowCount() - 1));
+    for (int row = firstRow; row < lastRow; ++row)
+    {
+        while (row >= diff->chunks()[chunkIndex].row + diff->chunks()[chunkIndex].rows())
+            ++chunkIndex;
+        const auto &chunk = diff->chunks()[chunkIndex];
+        const int offset = row - chunk.row;
+        const int count = side == Output ? chunk.outputCount : chunk.expectedCount;
+        const QRect rowRect(0, (row - firstRow) * lineHeight, width, lineHeight);
+
+        // the rows without lines on this side keep the lines of both sides aligned
+        if (offset >= count)
+        {
+            painter.fillRect(rowRect, fillerColor);
+            continue;
+        }
+
+        const int line = (side == Output ? chunk.outputLine : chunk.expectedLine) + offset;
+        // only the visible lines are decoded
+        const auto content = lines.line(line);
+        const auto visible = content.mid(qMin(firstColumn, int(content.size())), columns);
+        const auto columnX = [&](int column) {
+            return textLeft + metrics.horizontalAdvance(visible.left(qBound(0, column - firstColumn, visible.size())));
+        };
+
+        if (!chunk.equal)
+        {
+            painter.fillRect(rowRect, changedColor);
+            // in the token modes, a line without a pair may have rejected tokens too
+            if (diff->mode() != Core::TextDiff::Lines || (offset < chunk.outputCount && offset < chunk.expectedCount))
+            {
+                for (const auto &range : changedRanges(chunk, row))
+                {
+                    if (range.start + range.length < firstColumn || range.start > firstColumn + columns)
+                        continue;
+                    const int left = columnX(range.start);
+                    painter.fillRect(QRect(left, rowRect.top(), columnX(range.start + range.length) - left, lineHeight),
+                                     highlightColor);
+                }
+            }
+        }
+
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(textLeft, rowRect.top() + metrics.ascent(), QString(visible).replace('\t', ' '));
+        if (showLineBreaks && lines.hasLineBreak(line) && content.size() >= firstColumn &&
+            content.size() <= firstColumn + columns)
+        {
+            painter.setPen(lineNumberColor);
+            painter.drawText(columnX(content.size()), rowRect.top() + metrics.ascent(), "¶");
+        }
+
+        painter.fillRect(QRect(0, rowRect.top(), gutter, lineHeight), palette().color(QPalette::AlternateBase));
+        painter.setPen(lineNumberColor);
+        painter.drawText(QRect(0, rowRect.top(), gutter - charWidth, lineHeight), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(line + 1));
+    }
+}
+
+void DiffView::showPosition(int row, int column)
+{
+    if (diff.isNull())
+        return;
+    const QFontMetrics metrics(font());
+    verticalScrollBar()->setValue(row - verticalScrollBar()->pageStep() / 2);
+    const int x = column * qMax(1, metrics.averageCharWidth());
+    if (x < horizontalScrollBar()->value() || x >= horizontalScrollBar()->value() + horizontalScrollBar()->pageStep())
+        horizontalScrollBar()->setValue(x - horizontalScrollBar()->pageStep() / 2);
+}
+
+void DiffView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void DiffView::contextMenuEvent(QContextMenuEvent *event)
+{
+    if (diff.isNull())
+        return;
+    QMenu menu;
+    menu.addAction(tr("Copy All"), [this] { QApplication::clipboard()->setText(text().toString()); });
+    menu.exec(event->globalPos());
+}
+
+const Core::TextDiff::Text &DiffView::text() const
+{
+    return side == Output ? diff->output() : diff->expected();
+}
+
+const QVector<Core::TextDiff::Range> &DiffView::changedRanges(const Core::TextDiff::Chunk &chunk, int row)
+{
+    auto it = ranges.find(row);
+    if (it != ranges.end())
+        return it.value();
+
+    if (ranges.size() >= MAX_CACHED_RANGES)
+        ranges.clear();
+    const int offset = row - chunk.row;
+    if (diff->mode() != Core::TextDiff::Lines)
+    {
+        const int line = (side == Output ? chunk.outputLine : chunk.expectedLine) + offset;
+        return ranges.insert(row, diff->rejectedTokens(line, side == Output)).value();
+    }
+    QVector<Core::TextDiff::Range> outputRanges, expectedRanges;
+    Core::TextDiff::diffLine(diff->output().line(chunk.outputLine + offset),
+                             diff->expected().line(chunk.expectedLine + offset), &outputRanges, &expectedRanges);
+    return ranges.insert(row, side == Output ? outputRanges : expectedRanges).value();
+}
+
+void DiffView::updateScrollBars()
+{
+    if (diff.isNull())
+        return;
+    const QFontMetrics metrics(font());
+    const int visibleRows = qMax(1, viewport()->height() / metrics.height());
+    verticalScrollBar()->setRange(0, qMax(0, diff->rowCount() - visibleRows));
+    verticalScrollBar()->setPageStep(visibleRows);
+    verticalScrollBar()->setSingleStep(1);
+
+    // one more column for "¶", the ranges of both sides are the same so they can be scrolled together
+    const int longest = qMax(diff->output().maxLength(), diff->expected().maxLength());
+    const int textWidth = (longest + 1) * qMax(1, metrics.averageCharWidth());
+    const int visibleWidth = qMax(1, viewport()->width() - gutterWidth());
+    horizontalScrollBar()->setRange(0, qMax(0, textWidth - visibleWidth));
+    horizontalScrollBar()->setPageStep(visibleWidth);
+    horizontalScrollBar()->setSingleStep(metrics.averageCharWidth());
+}
+
+int DiffView::gutterWidth() const
+{
+    const QFontMetrics metrics(font());
+    const int lines = diff.isNull() ? 1 : qMax(diff->output().count(), diff->expected().count());
+    const int digits = QString::number(lines).size();
+    return (digits + 2) * metrics.horizontalAdvance('9');
+}
+} // namespace Widgets
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The DiffView shows one side of a Core::TextDiff in the side-by-side Diff Viewer, the rows of both sides are aligned.
+ * Only the visible rows are painted, and only the visible part of a line is drawn, so a diff of huge outputs, or of a
+ * single huge line, is shown as fast as a small one. The changed lines are highlighted, and the characters of a pair
+ * of changed lines are compared when they are shown for the first time. In the token modes, the rejected tokens are
+ * highlighted instead of the changed characters.
+ */
+
+#ifndef DIFFVIEW_HPP
+#define DIFFVIEW_HPP
+
+#include "Core/TextDiff.hpp"
+#include <QAbstractScrollArea>
+#include <QHash>
+#include <QSharedPointer>
+
+namespace Widgets
+{
+class DiffView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+  public:
+    enum Side
+    {
+        Output,  // the output of the program, the lines not in the expected output are red
+        Expected // the expected output, the lines not in the output are green
+    };
+
+    explicit DiffView(Side side, QWidget *parent = nullptr);
+
+    /**
+     * @brief show a diff, the scroll bars are reset
+     * @note the diff is shared by the views of both sides
+     */
+    void setDiff(const QSharedPointer<const Core::TextDiff> &diff);
+
+    /**
+     * @brief scroll to show a position in the middle of the view
+     */
+    void showPosition(int row, int column);
+
+  protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+  private:
+    /**
+     * @brief get the text of this side
+     * @note the diff must be set
+     */
+    const Core::TextDiff::Text &text() const;
+
+    /**
+     * @brief get the changed characters of a row in a changed chunk, which has lines on both sides, or the rejected
+     *        tokens of a row in the token modes
+     */
+    const QVector<Core::TextDiff::Range> &changedRanges(const Core::TextDiff::Chunk &chunk, int row);
+
+    /**
+     * @brief update the ranges of the scroll bars by the size of the diff and the viewport
+     */
+    void updateScrollBars();
+
+    int gutterWidth() const;
+
+    // the changed characters are cached for at most this number of rows
+    static const int MAX_CACHED_RANGES = 4096;
+
+    const Side side;
+    QSharedPointer<const Core::TextDiff> diff;
+    QHash<int, QVector<Core::TextDiff::Range>> ranges; // the changed characters of the shown rows
+    bool showLineBreaks = false;                        // whether "¶" is shown at the end of the lines
+};
+} // namespace Widgets
+
+#endif // DIFFVIEW_HPP
@@ -17,17 +17,34 @@
 
 #include "Widgets/DiffViewer.hpp"
 #include "Core/EventLogger.hpp"
-#include "Core/MessageLogger.hpp"
-#include "third_party/diff_match_patch/diff_match_patch.h"
+#include "Widgets/DiffView.hpp"
+#include <QComboBox>
+#include <QFutureWatcher>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QProgressBar>
 #include <QScrollBar>
-#include <QTextEdit>
+#include <QSignalBlocker>
+#include <QStatusBar>
+#include <QToolBar>
 #include <QVBoxLayout>
+#include <QtConcurrent>
+#include <algorithm>
 #include <generated/SettingsHelper.hpp>
 
 namespace Widgets
 {
+// the items of the mode combo box, in order
+const DiffViewer::ModeItem DiffViewer::MODES[] = {
+    {QT_TRANSLATE_NOOP("Widgets::DiffViewer", "Lines"), Core::TextDiff::Lines, 0},
+    {QT_TRANSLATE_NOOP("Widgets::DiffViewer", "wcmp - Tokens"), Core::TextDiff::Tokens, 0},
+    {QT_TRANSLATE_NOOP("Widgets::DiffViewer", "ncmp - Integers"), Core::TextDiff::Integers, 0},
+    {QT_TRANSLATE_NOOP("Widgets::DiffViewer", "rcmp4 - Doubles, max error 1e-4"), Core::TextDiff::Doubles, 1e-4},
+    {QT_TRANSLATE_NOOP("Widgets::DiffViewer", "rcmp6 - Doubles, max error 1e-6"), Core::TextDiff::Doubles, 1e-6},
+    {QT_TRANSLATE_NOOP("Widgets::DiffViewer", "rcmp9 - Doubles, max error 1e-9"), Core::TextDiff::Doubles, 1e-9},
+    {QT_TRANSLATE_NOOP("Widgets::DiffViewer", "nyesno - YES/NO"), Core::TextDiff::YesNo, 0},
+};
+
 DiffViewer::DiffViewer(QWidget *parent) : QMainWindow(parent)
 {
     auto *widget = new QWidget(this);
@@ -37,89 +54,175 @@ DiffViewer::DiffViewer(QWidget *parent) : QMainWindow(parent)
     setWindowTitle(tr("Diff Viewer"));
     resize(720, 480);
 
+    auto *toolBar = addToolBar(tr("Diff"));
+    toolBar->setMovable(false);
+    toolBar->addWidget(new QLabel(tr("Compare:"), toolBar));
+    modeComboBox = new QComboBox(toolBar);
+    for (const auto &item : MODES)
+        modeComboBox->addItem(tr(item.name));
+    modeComboBox->setToolTip(tr("Compare line by line, or compare the tokens like a checker and show only the tokens "
+                                "which are rejected"));
+    toolBar->addWidget(modeComboBox);
+    jumpAction = toolBar->addAction(tr("Jump to First Difference"), this, &DiffViewer::jumpToFirstDifference);
+    jumpAction->setShortcut(Qt::Key_F8);
+    jumpAction->setEnabled(false);
+    connect(modeComboBox, qOverload<int>(&QComboBox::currentIndexChanged), this, &DiffViewer::compare);
+
     auto *leftLayout = new QVBoxLayout();
     outputLabel = new QLabel(tr("Output"), widget);
     leftLayout->addWidget(outputLabel);
-    outputEdit = new QTextEdit(widget);
-    outputEdit->setReadOnly(true);
-    outputEdit->setWordWrapMode(QTextOption::NoWrap);
-    leftLayout->addWidget(outputEdit);
+    outputView = new DiffView(DiffView::Output, widget);
+    leftLayout->addWidget(outputView);
     layout->addLayout(leftLayout);
 
     auto *rightLayout = new QVBoxLayout();
     expectedLabel = new QLabel(tr("Expected"), widget);
     rightLayout->addWidget(expectedLabel);
-    expectedEdit = new QTextEdit(widget);
-    expectedEdit->setReadOnly(true);
-    expectedEdit->setWordWrapMode(QTextOption::NoWrap);
-    rightLayout->addWidget(expectedEdit);
+    expectedView = new DiffView(DiffView::Expected, widget);
+    rightLayout->addWidget(expectedView);
     layout->addLayout(rightLayout);
 
-    connect(expectedEdit->horizontalScrollBar(), &QScrollBar::valueChanged, outputEdit->horizontalScrollBar(),
+    connect(expectedView->horizontalScrollBar(), &QScrollBar::valueChanged, outputView->horizontalScrollBar(),
             &QScrollBar::setValue);
-    connect(outputEdit->horizontalScrollBar(), &QScrollBar::valueChanged, expectedEdit->horizontalScrollBar(),
+    connect(outputView->horizontalScrollBar(), &QScrollBar::valueChanged, expectedView->horizontalScrollBar(),
             &QScrollBar::setValue);
-    connect(expectedEdit->verticalScrollBar(), &QScrollBar::valueChanged, outputEdit->verticalScrollBar(),
+    connect(expectedView->verticalScrollBar(), &QScrollBar::valueChanged, outputView->verticalScrollBar(),
             &QScrollBar::setValue);
-    connect(outputEdit->verticalScrollBar(), &QScrollBar::valueChanged, expectedEdit->verticalScrollBar(),
+    connect(outputView->verticalScrollBar(), &QScrollBar::valueChanged, expectedView->verticalScrollBar(),
             &QScrollBar::setValue);
+
+    statusLabel = new QLabel(this);
+    statusBar()->addWidget(statusLabel, 1);
+    busyIndicator = new QProgressBar(this);
+    busyIndicator->setRange(0, 0); // a busy indicator without progress
+    busyIndicator->setMaximumWidth(120);
+    busyIndicator->hide();
+    statusBar()->addPermanentWidget(busyIndicator);
+}
+
+DiffViewer::~DiffViewer()
+{
+    // the comparison holds its own copies of the texts, so it's safe to let it stop later
+    cancel();
+}
+
+void DiffViewer::setText(const QString &output, const Core::TestData &expected, Core::Checker::CheckerType checker)
+{
+    LOG_INFO(INFO_OF(output.length()) << BOOL_INFO_OF(expected.isFileBacked()) << INFO_OF(checker));
+    outputText = output;
+    expectedData = expected;
+
+    // the mode chosen by the user is kept until the checker is changed
+    if (checker != lastChecker)
+    {
+        lastChecker = checker;
+        const QSignalBlocker blocker(modeComboBox);
+        modeComboBox->setCurrentIndex(modeIndex(checker));
+    }
+    compare();
+}
+
+void DiffViewer::compare()
+{
+    cancel();
+
+    // the settings are read on the GUI thread, and the flag is shared with the comparison, which may outlive this
+    const int timeLimit = SettingsHelper::getDiffViewerTimeLimit();
+    const auto &item = MODES[modeComboBox->currentIndex()];
+    const auto mode = item.mode;
+    const double maxError = item.maxError;
+    const auto output = outputText;
+    const auto expected = expectedData; // a file-backed expected output is compared in its mapped file
+    cancelled.reset(new QAtomicInt(0));
+    const auto flag = cancelled;
+    watcher = new QFutureWatcher<Core::TextDiff>(this);
+    connect(watcher, &QFutureWatcher<Core::TextDiff>::finished, this, &DiffViewer::onComparisonFinished);
+    watcher->setFuture(QtConcurrent::run([output, expected, timeLimit, mode, maxError, flag] {
+        if (mode == Core::TextDiff::Lines)
+            return Core::TextDiff::compare(output, expected, timeLimit, flag.data());
+        return Core::TextDiff::compareTokens(output, expected, mode, maxError, flag.data());
+    }));
+
+    statusLabel->setText(tr("Comparing..."));
+    busyIndicator->show();
 }
 
-void DiffViewer::setText(const QString &output, const QString &expected)
+void DiffViewer::onComparisonFinished()
 {
-    if (output.length() <= SettingsHelper::getHTMLDiffViewerLengthLimit() &&
-        expected.length() <= SettingsHelper::getHTMLDiffViewerLengthLimit())
+    // the rows of both sides are aligned, so both views share the same diff
+    diff.reset(new Core::TextDiff(watcher->result()));
+    watcher->deleteLater();
+    watcher = nullptr;
+    busyIndicator->hide();
+    outputView->setDiff(diff);
+    expectedView->setDiff(diff);
+    jumpAction->setEnabled(!diff->isEqual());
+
+    QString status;
+    if (diff->mode() == Core::TextDiff::Lines)
     {
-        LOG_INFO("Diff viewer is using HTML Text");
-        diff_match_patch differ;
-        differ.Diff_EditCost = 10;
-        const auto nonNullOutput = output.isNull() ? "" : output;
-        const auto nonNullExpected = expected.isNull() ? "" : expected;
-        auto diffs = differ.diff_main(nonNullOutput, nonNullExpected);
-        differ.diff_cleanupEfficiency(diffs);
-
-        QString outputHTML;
-        QString expectedHTML;
-        outputHTML = expectedHTML = "<body style='background-color: white; color: black;'>";
-        for (auto const &diff : diffs)
-        {
-            QString text = diff.text.toHtmlEscaped().replace(" ", "&nbsp;");
-            if (SettingsHelper::isDisplayEOLNInDiff())
-                text.replace("\n", "&para;<br>");
-            else
-                text.replace("\n", "<br>");
-            switch (diff.operation)
-            {
-            case INSERT:
-                expectedHTML += QString("<ins style=\"background:#8f8;\">") + text + QString("</ins>");
-                break;
-            case DELETE:
-                outputHTML += "<s style=\"background:#f88;\">" + text + "</s>";
-                break;
-            case EQUAL:
-                outputHTML += "<span>" + text + "</span>";
-                expectedHTML += "<span>" + text + "</span>";
-                break;
-            }
-        }
-        outputHTML += "</body>";
-        expectedHTML += "</body>";
-        outputEdit->setHtml(outputHTML);
-        expectedEdit->setHtml(expectedHTML);
+        const int changes = int(std::count_if(diff->chunks().cbegin(), diff->chunks().cend(),
+                                              [](const Core::TextDiff::Chunk &chunk) { return !chunk.equal; }));
+        LOG_INFO(INFO_OF(changes) << BOOL_INFO_OF(diff->isTimedOut()));
+        status = changes == 0 ? tr("No differences") : tr("%1 changed blocks").arg(changes);
     }
     else
     {
-        LOG_INFO("Diff viewer is using Plain Text");
-        emit toLongForHtml();
-        outputEdit->setPlainText(output);
-        expectedEdit->setPlainText(expected);
+        LOG_INFO(INFO_OF(diff->rejectedCount()));
+        status = diff->rejectedCount() == 0 ? tr("All tokens are accepted")
+                                            : tr("%1 rejected tokens").arg(diff->rejectedCount());
+    }
+    if (diff->isTimedOut())
+    {
+        status += " " + tr("(The time limit is exceeded, some lines may be shown as changed although they are the "
+                           "same. You can change the limit at %1.)")
+                            .arg(SettingsHelper::pathOfDiffViewerTimeLimit());
     }
+    statusLabel->setText(status);
+}
 
-    auto resetScrollBar = [](QScrollBar *scrollBar) { scrollBar->setValue(scrollBar->minimum()); };
+void DiffViewer::jumpToFirstDifference()
+{
+    int row = 0, column = 0;
+    if (diff.isNull() || !diff->firstDifference(&row, &column))
+        return;
+    LOG_INFO(INFO_OF(row) << INFO_OF(column));
+    // the views are scrolled together
+    outputView->showPosition(row, column);
+}
 
-    resetScrollBar(outputEdit->horizontalScrollBar());
-    resetScrollBar(outputEdit->verticalScrollBar());
-    resetScrollBar(expectedEdit->horizontalScrollBar());
-    resetScrollBar(outputEdit->verticalScrollBar());
+int DiffViewer::modeIndex(Core::Checker::CheckerType checker)
+{
+    switch (checker)
+    {
+    case Core::Checker::Wcmp:
+        return 1;
+    case Core::Checker::Ncmp:
+        return 2;
+    case Core::Checker::Rcmp4:
+        return 3;
+    case Core::Checker::Rcmp6:
+        return 4;
+    case Core::Checker::Rcmp9:
+        return 5;
+    case Core::Checker::Nyesno:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+void DiffViewer::cancel()
+{
+    if (watcher == nullptr)
+        return;
+    LOG_INFO("Cancel the running comparison");
+    cancelled->storeRelaxed(1);
+    watcher->disconnect(this);
+    if (watcher->isFinished())
+        watcher->deleteLater();
+    else
+        connect(watcher, &QFutureWatcher<Core::TextDiff>::finished, watcher, &QObject::deleteLater);
+    watcher = nullptr;
 }
 } // namespace Widgets
@@ -18,29 +18,86 @@
 #ifndef DIFFVIEWER_HPP
 #define DIFFVIEWER_HPP
 
+#include "Core/Checker.hpp"
+#include "Core/TextDiff.hpp"
+#include <QAtomicInt>
 #include <QMainWindow>
+#include <QSharedPointer>
 
-class QHBoxLayout;
-class QVBoxLayout;
+class QAction;
+class QComboBox;
 class QLabel;
-class QTextEdit;
+class QProgressBar;
+template <typename T> class QFutureWatcher;
 
 namespace Widgets
 {
+class DiffView;
+
 class DiffViewer : public QMainWindow
 {
     Q_OBJECT
 
   public:
     explicit DiffViewer(QWidget *parent = nullptr);
-    void setText(const QString &output, const QString &expected);
 
-  signals:
-    void toLongForHtml();
+    /**
+     * @brief destruct the viewer, the running comparison is cancelled
+     */
+    ~DiffViewer() override;
+
+    /**
+     * @brief compare the output with the expected output in the background and show the diff side by side when it's
+     *        finished
+     * @param checker the checker of the test cases, the tokens are compared like it if it's a testlib checker
+     * @note the running comparison is cancelled, and the current diff is shown until the new one is finished
+     */
+    void setText(const QString &output, const Core::TestData &expected, Core::Checker::CheckerType checker);
+
+  private slots:
+    /**
+     * @brief compare the texts in the mode chosen in the mode combo box
+     */
+    void compare();
+
+    void onComparisonFinished();
+
+    void jumpToFirstDifference();
 
   private:
-    QLabel *outputLabel = nullptr, *expectedLabel = nullptr;
-    QTextEdit *outputEdit = nullptr, *expectedEdit = nullptr;
+    // an item of the mode combo box
+    struct ModeItem
+    {
+        const char *name;
+        Core::TextDiff::Mode mode;
+        double maxError; // the maximum error in the Doubles mode
+    };
+
+    static const ModeItem MODES[7];
+
+    /**
+     * @brief get the index of the mode which compares like a checker
+     */
+    static int modeIndex(Core::Checker::CheckerType checker);
+
+    /**
+     * @brief cancel the running comparison, its result is dropped
+     */
+    void cancel();
+
+    QLabel *outputLabel = nullptr, *expectedLabel = nullptr, *statusLabel = nullptr;
+    DiffView *outputView = nullptr, *expectedView = nullptr;
+    QComboBox *modeComboBox = nullptr;
+    QAction *jumpAction = nullptr;
+    QProgressBar *busyIndicator = nullptr;             // shown while comparing
+    QFutureWatcher<Core::TextDiff> *watcher = nullptr; // the running comparison, nullptr if none
+    QSharedPointer<QAtomicInt> cancelled;              // set to stop the running comparison
+    QSharedPointer<const Core::TextDiff> diff;         // the shown diff, shared by both views
+    QString outputText;                                // the output to compare
+    Core::TestData expectedData;                       // the expected output to compare, it may be file-backed
+
+    // the checker of the last texts, the mode is chosen by it when it's changed
+    Core::Checker::CheckerType lastChecker = Core::Checker::IgnoreTrailingSpaces;
 };
 } // namespace Widgets
 #endif // DIFFVIEWER_HPP
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/HeatGutter.hpp"
+#include <QCodeEditor>
+#include <QHelpEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QTextLayout>
+#include <QToolTip>
+#include <cmath>
+
+namespace Widgets
+{
+HeatGutter::HeatGutter(QCodeEditor *editor, QWidget *parent) : QWidget(parent), editor(editor)
+{
+    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Expanding);
+    setCursor(Qt::PointingHandCursor);
+    hide();
+
+    connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, qOverload<>(&QWidget::update));
+    connect(editor, &QCodeEditor::textChanged, this, qOverload<>(&QWidget::update));
+    connect(editor, &QCodeEditor::fontChanged, this, qOverload<>(&QWidget::update));
+}
+
+void HeatGutter::setHeat(const QMap<int, qint64> &lineSamples, qint64 totalSamples)
+{
+    this->totalSamples = totalSamples;
+    executionCounts = false;
+    setLines(lineSamples);
+}
+
+void HeatGutter::setExecutionCounts(const QMap<int, qint64> &lineCounts)
+{
+    totalSamples = 0;
+    executionCounts = true;
+    setLines(lineCounts);
+}
+
+void HeatGutter::setLines(const QMap<int, qint64> &lineSamples)
+{
+    lines.clear();
+    maxSamples = 0;
+
+    for (auto it = lineSamples.cbegin(); it != lineSamples.cend(); ++it)
+    {
+        auto block = editor->document()->findBlockByNumber(it.key() - 1);
+        if (!block.isValid())
+            continue;
+        lines.push_back({QTextCursor(block), it.value()});
+        maxSamples = qMax(maxSamples, it.value());
+    }
+
+    setVisible(!lines.isEmpty());
+    updateGeometry();
+    update();
+}
+
+void HeatGutter::clear()
+{
+    lines.clear();
+    totalSamples = maxSamples = 0;
+    hide();
+}
+
+QSize HeatGutter::sizeHint() const
+{
+    if (executionCounts)
+    {
+        // the widest count, with a little padding on both sides
+        const QFontMetrics metrics(editor->font());
+        return {metrics.boundingRect("8888").width() + metrics.averageCharWidth(), 0};
+    }
+    return {fontMetrics().averageCharWidth(), 0};
+}
+
+bool HeatGutter::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip)
+    {
+        auto *helpEvent = static_cast<QHelpEvent *>(event);
+        for (const auto &line : qAsConst(lines))
+        {
+            if (lineRect(line.cursor).contains(helpEvent->pos()) && executionCounts)
+            {
+                QToolTip::showText(helpEvent->globalPos(),
+                                   tr("Line %1: executed %2 times\nClick to hide the execution counts")
+                                       .arg(line.cursor.blockNumber() + 1)
+                                       .arg(line.samples));
+                return true;
+            }
+            if (lineRect(line.cursor).contains(helpEvent->pos()))
+            {
+                QToolTip::showText(helpEvent->globalPos(),
+                                   tr("Line %1: %2 samples (%3%)\nClick to hide the profile")
+                                       .arg(line.cursor.blockNumber() + 1)
+                                       .arg(line.samples)
+                                       .arg(100.0 * line.samples / qMax(totalSamples, qint64(1)), 0, 'f', 1));
+                return true;
+            }
+        }
+        if (executionCounts)
+            QToolTip::showText(helpEvent->globalPos(), tr("Click to hide the execution counts"));
+        else
+            QToolTip::showText(helpEvent->globalPos(), tr("Click to hide the profile"));
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+void HeatGutter::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setFont(editor->font());
+    for (const auto &line : qAsConst(lines))
+    {
+        const auto rect = lineRect(line.cursor);
+        if (!rect.intersects(this->rect()))
+            continue;
+        if (executionCounts)
+        {
+            // the counts differ by orders of magnitude, so the heat is logarithmic, and the lines never executed
+            // are gray
+            const double heat = std::log1p(double(line.samples)) / std::log1p(double(qMax(maxSamples, qint64(1))));
+            painter.fillRect(rect, line.samples == 0 ? QColor(128, 128, 128, 60)
+                                                     : QColor(230, 30, 30, 40 + int(150 * heat)));
+            painter.setPen(palette().color(QPalette::Text));
+            painter.drawText(rect.adjusted(0, 0, -fontMetrics().averageCharWidth() / 2, 0),
+                             Qt::AlignRight | Qt::AlignTop, shortCount(line.samples));
+            continue;
+        }
+        // the hottest line is opaque red, the others are more transparent
+        const double heat = double(line.samples) / double(qMax(maxSamples, qint64(1)));
+        painter.fillRect(rect, QColor(230, 30, 30, 40 + int(215 * heat)));
+    }
+}
+
+void HeatGutter::mousePressEvent(QMouseEvent *)
+{
+    clear();
+}
+
+QString HeatGutter::shortCount(qint64 count)
+{
+    if (count < 10000)
+        return QString::number(count);
+    const char *suffixes = "kMGTPE";
+    double value = count;
+    int suffix = -1;
+    while (value >= 999.5 && suffix < 5)
+    {
+        value /= 1000;
+        ++suffix;
+    }
+    return QString::number(value, 'f', value < 9.95 ? 1 : 0) + QChar(suffixes[suffix]);
+}
+
+QRect HeatGutter::lineRect(const QTextCursor &cursor) const
+{
+    const auto block = cursor.block();
+    if (!block.isValid() || !block.isVisible())
+        return {};
+
+    // the line may be wrapped into several rows
+    const auto top = editor->cursorRect(QTextCursor(block)).top();
+    const auto height = block.layout() != nullptr ? int(block.layout()->boundingRect().height()) : 0;
+    const auto topLeft = mapFrom(window(), editor->viewport()->mapTo(window(), QPoint(0, top)));
+    return {0, topLeft.y(), width(), qMax(height, editor->fontMetrics().height())};
+}
+} // namespace Widgets
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The HeatGutter is a narrow bar beside the code editor, which shows how hot each line is in a profile.
+ * It can also show the execution counts of the lines, then it's wide enough for the counts to be written on the lines.
+ * The lines are followed by text cursors, so the heat stays on the same lines while the code is edited.
+ * It's hidden until a profile or execution counts are set, and it's hidden again when it's clicked.
+ */
+
+#ifndef HEATGUTTER_HPP
+#define HEATGUTTER_HPP
+
+#include <QMap>
+#include <QTextCursor>
+#include <QVector>
+#include <QWidget>
+
+class QCodeEditor;
+
+namespace Widgets
+{
+class HeatGutter : public QWidget
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief construct a HeatGutter for the editor
+     */
+    explicit HeatGutter(QCodeEditor *editor, QWidget *parent = nullptr);
+
+    /**
+     * @brief show the heat of the lines
+     * @param lineSamples the number of samples of each line, starting from 1
+     * @param totalSamples the number of all samples, to show the percentages in the tooltips
+     */
+    void setHeat(const QMap<int, qint64> &lineSamples, qint64 totalSamples);
+
+    /**
+     * @brief show the execution counts of the lines
+     * @param lineCounts the execution count of each executable line, starting from 1
+     */
+    void setExecutionCounts(const QMap<int, qint64> &lineCounts);
+
+    /**
+     * @brief remove the heat and hide the gutter
+     */
+    void clear();
+
+    QSize sizeHint() const override;
+
+  protected:
+    bool event(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+
+  private:
+    struct HotLine
+    {
+        QTextCursor cursor; // at the start of the line, it moves with the line when the code is edited
+        qint64 samples = 0;
+    };
+
+    /**
+     * @brief get the rectangle of a line in the gutter
+     */
+    QRect lineRect(const QTextCursor &cursor) const;
+
+    /**
+     * @brief set the lines and show the gutter
+     */
+    void setLines(const QMap<int, qint64> &lineSamples);
+
+    /**
+     * @brief format an execution count in at most 4 characters, e.g. 1234, 12k, 3.4M
+     */
+    static QString shortCount(qint64 count);
+
+    QCodeEditor *editor;
+    QVector<HotLine> lines;
+    qint64 totalSamples = 0;
+    qint64 maxSamples = 0;        // the samples of the hottest line, it's painted in the deepest color
+    bool executionCounts = false; // whether the samples are the execution counts instead of a profile
+};
+} // namespace Widgets
+
+#endif // HEATGUTTER_HPP
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/Sparkline.hpp"
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+
+namespace Widgets
+{
+Sparkline::Sparkline(QWidget *parent) : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+}
+
+void Sparkline::setValues(const QVector<qint64> &values, bool highlighted)
+{
+    this->values = values;
+    this->highlighted = highlighted;
+    update();
+}
+
+QSize Sparkline::sizeHint() const
+{
+    return {fontMetrics().averageCharWidth() * 10, fontMetrics().height()};
+}
+
+void Sparkline::paintEvent(QPaintEvent * /*event*/)
+{
+    if (values.isEmpty())
+        return;
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    const auto range = std::minmax_element(values.cbegin(), values.cend());
+    const qint64 minimum = *range.first, maximum = *range.second;
+    const QRectF area = QRectF(rect()).adjusted(2, 2, -2, -2);
+
+    const auto pointAt = [&](int i) {
+        const double x = values.size() == 1 ? area.right() : area.left() + area.width() * i / (values.size() - 1);
+        if (maximum == minimum)
+            return QPointF(x, area.center().y());
+        return QPointF(x, area.bottom() - area.height() * (values[i] - minimum) / (maximum - minimum));
+    };
+
+    QPainterPath path(pointAt(0));
+    for (int i = 1; i < values.size(); ++i)
+        path.lineTo(pointAt(i));
+    painter.setPen(QPen(palette().color(QPalette::WindowText), 1));
+    painter.drawPath(path);
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(highlighted ? QColor(Qt::red) : palette().color(QPalette::Highlight));
+    painter.drawEllipse(pointAt(values.size() - 1), 2, 2);
+}
+} // namespace Widgets
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The Sparkline is a tiny line chart of a series of values without axes, it shows the trend at a glance.
+ * The last value is marked by a dot, which is red if it's highlighted.
+ */
+
+#ifndef SPARKLINE_HPP
+#define SPARKLINE_HPP
+
+#include <QVector>
+#include <QWidget>
+
+namespace Widgets
+{
+class Sparkline : public QWidget
+{
+    Q_OBJECT
+
+  public:
+    explicit Sparkline(QWidget *parent = nullptr);
+
+    /**
+     * @brief set the values to draw
+     * @param values the values in order, the last one is the latest
+     * @param highlighted whether the last value is highlighted as a warning
+     */
+    void setValues(const QVector<qint64> &values, bool highlighted);
+
+    QSize sizeHint() const override;
+
+  protected:
+    void paintEvent(QPaintEvent *event) override;
+
+  private:
+    QVector<qint64> values;
+    bool highlighted = false;
+};
+} // namespace Widgets
+
+#endif // SPARKLINE_HPP
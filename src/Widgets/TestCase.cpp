@@ -18,25 +18,25 @@
 #include "Widgets/TestCase.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
-#include "Util/Util.hpp"
-#include "Widgets/DiffViewer.hpp"
+#include "Core/SpeedCalibration.hpp"
+#include "Widgets/Sparkline.hpp"
 #include "Widgets/TestCaseEdit.hpp"
+#include "Widgets/TestCasesModel.hpp"
 #include <QCheckBox>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QLocale>
 #include <QMenu>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QSplitter>
 #include <QVBoxLayout>
-#include <generated/SettingsHelper.hpp>
 
 namespace Widgets
 {
-TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QString &in, const QString &exp)
-    : QWidget(parent), log(logger), id(0)
+TestCase::TestCase(TestCasesModel *model, MessageLogger *logger, QWidget *parent)
+    : QWidget(parent), model(model), log(logger)
 {
-    LOG_INFO("Testcase " << index << " is being created");
     mainLayout = new QHBoxLayout(this);
     inputUpLayout = new QHBoxLayout();
     outputUpLayout = new QHBoxLayout();
@@ -52,15 +52,15 @@ TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QStr
     inputLabel = new QLabel(tr("Input"), this);
     outputLabel = new QLabel(tr("Output"), this);
     expectedLabel = new QLabel(tr("Expected"), this);
+    usageLabel = new QLabel(this);
     runButton = new QPushButton(tr("Run"), this);
     diffButton = new QPushButton("**", this);
     delButton = new QPushButton(tr("Del"), this);
-    inputEdit = new TestCaseEdit(TestCaseEdit::Input, index, log, in, this);
-    outputEdit = new TestCaseEdit(TestCaseEdit::Output, index, log, QString(), this);
-    expectedEdit = new TestCaseEdit(TestCaseEdit::Expected, index, log, exp, this);
-    diffViewer = new DiffViewer(this);
-
-    setID(index);
+    killButton = new QPushButton(tr("Kill"), this);
+    inputEdit = new TestCaseEdit(TestCaseEdit::Input, id, log, QString(), this);
+    outputEdit = new TestCaseEdit(TestCaseEdit::Output, id, log, QString(), this);
+    expectedEdit = new TestCaseEdit(TestCaseEdit::Expected, id, log, QString(), this);
+    runtimeSparkline = new Sparkline(this);
 
     checkBox->setMinimumWidth(20);
     checkBox->setChecked(true);
@@ -70,6 +70,9 @@ TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QStr
     inputUpLayout->addWidget(inputLabel);
     inputUpLayout->addWidget(runButton);
     outputUpLayout->addWidget(outputLabel);
+    outputUpLayout->addWidget(runtimeSparkline);
+    outputUpLayout->addWidget(usageLabel);
+    outputUpLayout->addWidget(killButton);
     outputUpLayout->addWidget(diffButton);
     expectedUpLayout->addWidget(expectedLabel);
     expectedUpLayout->addWidget(delButton);
@@ -90,81 +93,207 @@ TestCase::TestCase(int index, MessageLogger *logger, QWidget *parent, const QStr
 
     splitter->setChildrenCollapsible(false);
 
-    runButton->setToolTip(tr("Test on a single testcase"));
+    runButton->setToolTip(tr("Test on a single testcase, right click for more actions"));
+    runButton->setContextMenuPolicy(Qt::CustomContextMenu);
     diffButton->setToolTip(tr("Open the Diff Viewer"));
+    usageLabel->setToolTip(tr("CPU usage and memory usage of the running program"));
+    killButton->setToolTip(tr("Kill the running program"));
+    usageLabel->hide();
+    runtimeSparkline->hide();
+    killButton->hide();
 
+    connect(model, &TestCasesModel::dataChanged, this, &TestCase::onDataChanged);
     connect(checkBox, &QCheckBox::toggled, this, &TestCase::onCheckBoxToggled);
     connect(runButton, &QPushButton::clicked, this, &TestCase::onRunButtonClicked);
-    connect(diffButton, &QPushButton::clicked, this, &TestCase::onDiffButtonClicked);
+    connect(runButton, &QPushButton::customContextMenuRequested, this, &TestCase::onRunButtonContextMenuRequested);
+    connect(diffButton, &QPushButton::clicked, this, [this] {
+        LOG_INFO("Diff button clicked for " << INFO_OF(id));
+        emit requestDiff(id);
+    });
     connect(delButton, &QPushButton::clicked, this, &TestCase::onDelButtonClicked);
-    connect(diffViewer, &DiffViewer::toLongForHtml, this, &TestCase::onToLongForHtml);
-    connect(expectedEdit, &TestCaseEdit::requestCopyOutputToExpected, this,
-            [this] { expectedEdit->modifyText(output()); });
+    connect(killButton, &QPushButton::clicked, this, [this] {
+        LOG_INFO("Kill button clicked for " << INFO_OF(id));
+        emit requestKill(id);
+    });
+    connect(expectedEdit, &TestCaseEdit::requestCopyOutputToExpected, this, [this] {
+        if (id != -1)
+            model->setExpected(id, model->testCase(id).output);
+    });
+
+    // the edits by the user are written back to the model
+    connect(inputEdit, &TestCaseEdit::textChanged, this, [this] {
+        if (!updating && id != -1)
+            model->setInput(id, inputEdit->getData());
+    });
+    connect(expectedEdit, &TestCaseEdit::textChanged, this, [this] {
+        if (!updating && id != -1)
+            model->setExpected(id, expectedEdit->getData());
+    });
+    connect(splitter, &QSplitter::splitterMoved, this, [this] {
+        if (!updating && id != -1)
+            model->setSplitterSizes(id, splitter->sizes());
+    });
 }
 
-void TestCase::setInput(const QString &text)
+void TestCase::setRow(int row)
 {
-    inputEdit->modifyText(text);
+    id = row;
+    inputEdit->setID(id);
+    outputEdit->setID(id);
+    expectedEdit->setID(id);
+
+    if (id == -1)
+    {
+        updating = true;
+        inputEdit->showText(QString());
+        outputEdit->showText(QString());
+        expectedEdit->showText(QString());
+        updating = false;
+        return;
+    }
+
+    inputLabel->setText(tr("Input #%1").arg(id + 1));
+    outputLabel->setText(tr("Output #%1").arg(id + 1));
+    expectedLabel->setText(tr("Expected #%1").arg(id + 1));
+
+    for (int role : {int(Qt::CheckStateRole), int(TestCasesModel::InputRole), int(TestCasesModel::OutputRole),
+                     int(TestCasesModel::ExpectedRole), int(TestCasesModel::VerdictRole),
+                     int(TestCasesModel::DetailsRole), int(TestCasesModel::UsageRole),
+                     int(TestCasesModel::RuntimeHistoryRole), int(TestCasesModel::SplitterSizesRole)})
+        updateRole(role, true);
 }
 
-void TestCase::setOutput(const QString &text)
+int TestCase::row() const
 {
-    outputEdit->modifyText(text);
-    outputEdit->startAnimation();
-
-    if (!diffViewer->isHidden())
-        diffViewer->setText(text, expected());
+    return id;
 }
 
-void TestCase::setExpected(const QString &text)
+void TestCase::setTestCaseEditFont(const QFont &font)
 {
-    expectedEdit->modifyText(text);
+    inputEdit->setFont(font);
+    outputEdit->setFont(font);
+    expectedEdit->setFont(font);
 }
 
-void TestCase::clearOutput()
+void TestCase::updateHeight()
 {
-    outputEdit->modifyText(QString());
-    currentVerdict = UNKNOWN;
-    diffButton->setStyleSheet("");
-    diffButton->setText("**");
+    inputEdit->startAnimation();
+    outputEdit->startAnimation();
+    expectedEdit->startAnimation();
 }
 
-QString TestCase::input() const
+void TestCase::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
 {
-    return inputEdit->getText();
+    if (id < topLeft.row() || id > bottomRight.row())
+        return;
+    for (int role : roles)
+        updateRole(role, false);
 }
 
-QString TestCase::output() const
+void TestCase::onCheckBoxToggled(bool checked)
 {
-    return outputEdit->getText();
+    inputEdit->setVisible(checked);
+    outputEdit->setVisible(checked);
+    expectedEdit->setVisible(checked);
+    if (!updating && id != -1)
+        model->setChecked(id, checked);
 }
 
-QString TestCase::expected() const
+void TestCase::onRunButtonClicked()
 {
-    return expectedEdit->getText();
+    LOG_INFO("Run button clicked for " << INFO_OF(id));
+    model->setChecked(id, true);
+    emit requestRun(id);
 }
 
-bool TestCase::isEmpty() const
+void TestCase::onRunButtonContextMenuRequested(const QPoint &pos)
 {
-    return input().isEmpty() && expected().isEmpty();
+    auto *menu = new QMenu(this);
+    menu->setAttribute(Qt::WA_DeleteOnClose);
+    menu->addAction(tr("Profile on this test"), [this] {
+        LOG_INFO("Profile requested for " << INFO_OF(id));
+        emit requestProfile(id);
+    });
+    menu->addAction(tr("Show execution counts on this test"), [this] {
+        LOG_INFO("Execution counts requested for " << INFO_OF(id));
+        emit requestExecutionCounts(id);
+    });
+    menu->popup(runButton->mapToGlobal(pos));
 }
 
-void TestCase::setID(int index)
+void TestCase::onDelButtonClicked()
 {
-    LOG_INFO("Changed testcase ID to " << index);
-    id = index;
-    inputLabel->setText(tr("Input #%1").arg(id + 1));
-    outputLabel->setText(tr("Output #%1").arg(id + 1));
-    expectedLabel->setText(tr("Expected #%1").arg(id + 1));
+    LOG_INFO("Del button clicked for " << INFO_OF(id));
+    const auto &testcase = model->testCase(id);
+    if (testcase.input.isEmpty() && testcase.expected.isEmpty())
+    {
+        emit requestDelete(id);
+    }
+    else
+    {
+        const int index = id;
+        auto res = QMessageBox::question(this, tr("Delete Testcase"),
+                                         tr("Are you sure you want to delete test case #%1?").arg(index + 1));
+        if (res == QMessageBox::Yes)
+            emit requestDelete(index);
+    }
 }
 
-void TestCase::setVerdict(Verdict verdict)
+void TestCase::updateRole(int role, bool rebinding)
 {
-    currentVerdict = verdict;
+    const auto &testcase = model->testCase(id);
+    updating = true;
 
-    LOG_INFO("Changed verdict to " << INFO_OF(verdict));
+    switch (role)
+    {
+    case Qt::CheckStateRole:
+        checkBox->setChecked(testcase.checked);
+        break;
+    case TestCasesModel::InputRole:
+        updateText(inputEdit, testcase.input, rebinding);
+        break;
+    case TestCasesModel::OutputRole:
+        updateText(outputEdit, testcase.output, rebinding);
+        if (!rebinding)
+            outputEdit->startAnimation();
+        break;
+    case TestCasesModel::ExpectedRole:
+        updateText(expectedEdit, testcase.expected, rebinding);
+        break;
+    case TestCasesModel::VerdictRole:
+        updateVerdict();
+        break;
+    case TestCasesModel::DetailsRole:
+        updateDetails();
+        break;
+    case TestCasesModel::UsageRole:
+        updateUsage();
+        break;
+    case TestCasesModel::RuntimeHistoryRole:
+        updateRuntimeHistory();
+        break;
+    case TestCasesModel::SplitterSizesRole:
+        // the sizes are proportional, so the default sizes split the widget equally
+        splitter->setSizes(testcase.splitterSizes.isEmpty() ? QList<int>{1, 1, 1} : testcase.splitterSizes);
+        break;
+    default:
+        break;
+    }
 
-    switch (currentVerdict)
+    updating = false;
+}
+
+void TestCase::updateText(TestCaseEdit *edit, const Core::TestData &data, bool rebinding)
+{
+    if (rebinding)
+        edit->showText(data);
+    else if (edit->getData() != data)
+        edit->modifyText(data);
+}
+
+void TestCase::updateVerdict()
+{
+    switch (model->testCase(id).verdict)
     {
     case UNKNOWN:
         diffButton->setStyleSheet("");
@@ -186,105 +315,88 @@ void TestCase::setVerdict(Verdict verdict)
         diffButton->setStyleSheet("background: #b0b");
         diffButton->setText("RE");
         break;
+    case ILE:
+        diffButton->setStyleSheet("background: #c70");
+        diffButton->setText("ILE");
+        break;
     default:
         Q_UNREACHABLE();
         break;
     }
 }
 
-TestCase::Verdict TestCase::verdict() const
-{
-    return currentVerdict;
-}
-
-void TestCase::setChecked(bool checked)
-{
-    checkBox->setChecked(checked);
-}
-
-bool TestCase::isChecked() const
-{
-    return checkBox->isChecked();
-}
-
-void TestCase::setTestCaseEditFont(const QFont &font)
-{
-    inputEdit->setFont(font);
-    outputEdit->setFont(font);
-    expectedEdit->setFont(font);
-}
-
-void TestCase::updateHeight()
-{
-    inputEdit->startAnimation();
-    outputEdit->startAnimation();
-    expectedEdit->startAnimation();
-}
-
-QList<int> TestCase::splitterSizes() const
+void TestCase::updateDetails()
 {
-    return splitter->sizes();
-}
+    const auto &testcase = model->testCase(id);
+    const auto &perfCounters = testcase.perfCounters;
 
-void TestCase::restoreSplitterSizes(const QList<int> &sizes)
-{
-    splitter->setSizes(sizes);
-}
-
-void TestCase::onCheckBoxToggled(bool checked)
-{
-    if (checked)
+    QStringList details;
+    if (testcase.timeUsed >= 0)
     {
-        inputEdit->show();
-        outputEdit->show();
-        expectedEdit->show();
+        details.push_back(tr("Time used: %1ms").arg(testcase.timeUsed));
+        if (Core::SpeedCalibration::isCalibrated())
+        {
+            const auto normalized = Core::SpeedCalibration::normalizedTime(testcase.timeUsed);
+            details.push_back(tr("Normalized time used on the reference judge: %1ms").arg(normalized));
+        }
     }
-    else
+    if (perfCounters.isValid())
     {
-        inputEdit->hide();
-        outputEdit->hide();
-        expectedEdit->hide();
+        const auto number = [](qint64 value) { return value == -1 ? tr("unknown") : QLocale().toString(value); };
+        const auto ipc = perfCounters.ipc();
+        details.push_back(tr("Instructions: %1").arg(number(perfCounters.instructions)));
+        details.push_back(tr("Cycles: %1").arg(number(perfCounters.cycles)));
+        details.push_back(tr("Instructions per cycle: %1").arg(ipc < 0 ? tr("unknown") : QString::number(ipc, 'f', 2)));
+        details.push_back(tr("Cache misses: %1").arg(number(perfCounters.cacheMisses)));
+        details.push_back(tr("Branch misses: %1").arg(number(perfCounters.branchMisses)));
     }
-}
+    if (!perfCounters.error.isEmpty())
+        details.push_back(perfCounters.error);
 
-void TestCase::onRunButtonClicked()
-{
-    LOG_INFO("Run button clicked for " << INFO_OF(id));
-    checkBox->setChecked(true);
-    emit requestRun(id);
+    if (details.isEmpty())
+        diffButton->setToolTip(tr("Open the Diff Viewer"));
+    else
+        diffButton->setToolTip(tr("Open the Diff Viewer") + "\n\n" + details.join('\n'));
 }
 
-void TestCase::onDiffButtonClicked()
+void TestCase::updateUsage()
 {
-    LOG_INFO("Diff button clicked for " << INFO_OF(id));
-    diffViewer->setText(output(), expected());
-    Util::showWidgetOnTop(diffViewer);
+    const auto &testcase = model->testCase(id);
+    if (testcase.running)
+        usageLabel->setText(tr("CPU %1% · %2 MB")
+                                .arg(testcase.cpuUsage)
+                                .arg(QString::number(testcase.memoryUsed / 1048576.0, 'f', 1)));
+    usageLabel->setVisible(testcase.running);
+    killButton->setVisible(testcase.running);
 }
 
-void TestCase::onDelButtonClicked()
+void TestCase::updateRuntimeHistory()
 {
-    LOG_INFO("Del button clicked for " << INFO_OF(id));
-    if (isEmpty())
+    const auto &samples = model->testCase(id).runtimeHistory;
+    if (samples.size() < 2)
     {
-        emit deleted(this);
+        runtimeSparkline->hide();
+        return;
     }
-    else
+
+    QVector<qint64> times;
+    QStringList texts;
+    for (const auto &sample : samples)
     {
-        auto res = QMessageBox::question(this, tr("Delete Testcase"),
-                                         tr("Are you sure you want to delete test case #%1?").arg(id + 1));
-        if (res == QMessageBox::Yes)
-            emit deleted(this);
+        times.push_back(sample.timeUsed);
+        texts.push_back(QString::number(sample.timeUsed));
     }
-}
-
-void TestCase::onToLongForHtml()
-{
-    log->warn(tr("Diff Viewer[%1]").arg(id + 1),
-              tr("The output/expected contains more than %1 characters, HTML diff viewer is disabled. You can change "
-                 "the length limit at %2.")
-                  .arg(SettingsHelper::getHTMLDiffViewerLengthLimit())
-                  .arg(SettingsHelper::pathOfHTMLDiffViewerLengthLimit()),
-              false);
+    const bool regressed = model->testCase(id).regressed;
+    runtimeSparkline->setValues(times, regressed);
+
+    auto tooltip = tr("Time used by the last %1 executions (ms): %2").arg(samples.size()).arg(texts.join(", "));
+    if (samples.back().memoryUsed > 0)
+        tooltip += "\n" + tr("Memory used by the last execution: %1 MB")
+                              .arg(QString::number(samples.back().memoryUsed / 1048576.0, 'f', 1));
+    if (regressed)
+        tooltip += "\n" + tr("The latest build is slower than the previous build on this test");
+    runtimeSparkline->setToolTip(tooltip);
+    runtimeSparkline->show();
 }
 
 } // namespace Widgets
@@ -15,9 +15,16 @@
  *
  */
 
+/*
+ * The TestCase is the widget of a test case in the TestCasesView. It doesn't own the test case, it's bound to a row of
+ * the TestCasesModel and shows it, and the changes made in it are written back to the model.
+ * The widgets are reused for other rows when the view is scrolled, so only the visible test cases have widgets.
+ */
+
 #ifndef TESTCASE_HPP
 #define TESTCASE_HPP
 
+#include <QModelIndex>
 #include <QWidget>
 
 class MessageLogger;
@@ -29,10 +36,16 @@ class QPushButton;
 class QSplitter;
 class QVBoxLayout;
 
+namespace Core
+{
+class TestData;
+}
+
 namespace Widgets
 {
-class DiffViewer;
+class Sparkline;
 class TestCaseEdit;
+class TestCasesModel;
 
 class TestCase : public QWidget
 {
@@ -45,53 +58,79 @@ class TestCase : public QWidget
         WA,  // Wrong answer
         TLE, // Time Limit Exceeded
         RE,  // Runtime Error
+        ILE, // Idleness Limit Exceeded, the wall time limit is exceeded but the CPU time limit is not
         UNKNOWN
     };
 
-    explicit TestCase(int index, MessageLogger *logger, QWidget *parent = nullptr, const QString &in = QString(),
-                      const QString &exp = QString());
-    void setInput(const QString &text);
-    void setOutput(const QString &text);
-    void setExpected(const QString &text);
-    void clearOutput();
-    QString input() const;
-    QString output() const;
-    QString expected() const;
-    bool isEmpty() const;
-    void setID(int index);
-    void setVerdict(Verdict verdict);
-    Verdict verdict() const;
-    void setChecked(bool checked);
-    bool isChecked() const;
+    explicit TestCase(TestCasesModel *model, MessageLogger *logger, QWidget *parent = nullptr);
+
+    /**
+     * @brief bind the widget to a row of the model and show it
+     * @param row the row to show, -1 to unbind the widget and drop the texts shown in it
+     */
+    void setRow(int row);
+
+    /**
+     * @brief the row shown in the widget, -1 if it's not bound
+     */
+    int row() const;
+
     void setTestCaseEditFont(const QFont &font);
     void updateHeight();
-    QList<int> splitterSizes() const;
-    void restoreSplitterSizes(const QList<int> &sizes);
 
   signals:
-    void deleted(TestCase *widget);
+    void requestDelete(int index);
     void requestRun(int index);
+    void requestProfile(int index);
+    void requestExecutionCounts(int index);
+    void requestKill(int index);
+    void requestDiff(int index);
 
   private slots:
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
     void onCheckBoxToggled(bool checked);
     void onRunButtonClicked();
-    void onDiffButtonClicked();
+    void onRunButtonContextMenuRequested(const QPoint &pos);
     void onDelButtonClicked();
-    void onToLongForHtml();
 
   private:
+    /**
+     * @brief update the parts of the widget showing a role of the model
+     * @param rebinding whether the widget is bound to another row, then the texts are replaced without the history
+     */
+    void updateRole(int role, bool rebinding);
+
+    /**
+     * @brief show the text in the edit if it's changed
+     */
+    void updateText(TestCaseEdit *edit, const Core::TestData &data, bool rebinding);
+
+    /**
+     * @brief show the verdict of the last execution on the diff button
+     */
+    void updateVerdict();
+
+    /**
+     * @brief show the details of the last execution in the tooltip of the diff button
+     */
+    void updateDetails();
+
+    void updateUsage();
+    void updateRuntimeHistory();
+
     QHBoxLayout *mainLayout = nullptr, *inputUpLayout = nullptr, *outputUpLayout = nullptr, *expectedUpLayout = nullptr;
     QSplitter *splitter = nullptr;
     QWidget *inputWidget = nullptr, *outputWidget = nullptr, *expectedWidget = nullptr;
     QVBoxLayout *inputLayout = nullptr, *outputLayout = nullptr, *expectedLayout = nullptr;
     QCheckBox *checkBox = nullptr;
-    QLabel *inputLabel = nullptr, *outputLabel = nullptr, *expectedLabel = nullptr;
-    QPushButton *runButton = nullptr, *diffButton = nullptr, *delButton = nullptr;
+    QLabel *inputLabel = nullptr, *outputLabel = nullptr, *expectedLabel = nullptr, *usageLabel = nullptr;
+    QPushButton *runButton = nullptr, *diffButton = nullptr, *delButton = nullptr, *killButton = nullptr;
     TestCaseEdit *inputEdit = nullptr, *outputEdit = nullptr, *expectedEdit = nullptr;
-    DiffViewer *diffViewer = nullptr;
+    Sparkline *runtimeSparkline = nullptr;
+    TestCasesModel *model;
     MessageLogger *log;
-    Verdict currentVerdict = UNKNOWN;
-    int id;
+    bool updating = false; // whether the widget is being updated from the model, so the changes are not written back
+    int id = -1;
 };
 } // namespace Widgets
 #endif // TESTCASE_HPP
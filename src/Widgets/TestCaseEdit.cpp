@@ -87,39 +87,54 @@ void TestCaseEdit::dropEvent(QDropEvent *event)
     }
 }
 
-void TestCaseEdit::modifyText(const QString &text, bool keepHistory)
+void TestCaseEdit::modifyText(const Core::TestData &data, bool keepHistory)
 {
-    this->text = text;
+    updateText(data, keepHistory, true);
+}
+
+void TestCaseEdit::showText(const Core::TestData &data)
+{
+    updateText(data, false, false);
+    animation->stop();
+    setMinimumHeight(targetHeight());
+}
+
+void TestCaseEdit::updateText(const Core::TestData &data, bool keepHistory, bool warnIfTooLong)
+{
+    this->data = data;
 
     const int limit = role == Output ? SettingsHelper::getOutputDisplayLengthLimit()
                                      : SettingsHelper::getDisplayTestCaseLengthLimit();
 
-    QString displayText;
+    // only the beginning is decoded, so a large file-backed content is never loaded into the memory entirely
+    QString displayText = data.preview(limit + 1);
 
-    if (text.length() <= limit)
+    if (displayText.length() <= limit)
     {
-        displayText = text;
         if (role != Output)
             setReadOnly(false);
     }
     else
     {
-        LOG_INFO("Too long: " << INFO_OF(role) << INFO_OF(id) << INFO_OF(text.length()));
+        LOG_INFO("Too long: " << INFO_OF(role) << INFO_OF(id) << BOOL_INFO_OF(data.isFileBacked()));
 
         setReadOnly(true);
 
-        displayText = text.left(limit) + "...";
-
-        const QString name = role == Input ? tr("Input") : (role == Output ? tr("Output") : tr("Expected"));
-        const QString setLimitPlace = role == Output ? SettingsHelper::pathOfOutputDisplayLengthLimit()
-                                                     : SettingsHelper::pathOfDisplayTestCaseLengthLimit();
-
-        log->warn(QString("%1[%2]").arg(name).arg(id + 1),
-                  tr("Only the first %1 characters are shown. Now the test case editor is read-only. You can set "
-                     "the length limit at %2.")
-                      .arg(limit)
-                      .arg(setLimitPlace),
-                  false);
+        displayText = displayText.left(limit) + "...";
+
+        if (warnIfTooLong)
+        {
+            const QString name = role == Input ? tr("Input") : (role == Output ? tr("Output") : tr("Expected"));
+            const QString setLimitPlace = role == Output ? SettingsHelper::pathOfOutputDisplayLengthLimit()
+                                                         : SettingsHelper::pathOfDisplayTestCaseLengthLimit();
+
+            log->warn(QString("%1[%2]").arg(name).arg(id + 1),
+                      tr("Only the first %1 characters are shown. Now the test case editor is read-only. You can "
+                         "set the length limit at %2.")
+                          .arg(limit)
+                          .arg(setLimitPlace),
+                      false);
+        }
     }
 
     if (keepHistory)
@@ -135,16 +150,25 @@ void TestCaseEdit::modifyText(const QString &text, bool keepHistory)
 }
 
 QString TestCaseEdit::getText()
+{
+    return getData().text();
+}
+
+Core::TestData TestCaseEdit::getData()
 {
     if (!isReadOnly())
-        text = toPlainText();
-    return text;
+        data = toPlainText();
+    return data;
+}
+
+void TestCaseEdit::setID(int id)
+{
+    this->id = id;
 }
 
 void TestCaseEdit::startAnimation()
 {
-    int newHeight = qMin(fontMetrics().boundingRect("f").height() * (document()->lineCount() + 2),
-                         SettingsHelper::getTestCaseMaximumHeight());
+    int newHeight = targetHeight();
     if (newHeight != minimumHeight())
     {
         animation->stop();
@@ -154,6 +178,12 @@ void TestCaseEdit::startAnimation()
     }
 }
 
+int TestCaseEdit::targetHeight() const
+{
+    return qMin(fontMetrics().boundingRect("f").height() * (document()->lineCount() + 2),
+                SettingsHelper::getTestCaseMaximumHeight());
+}
+
 void TestCaseEdit::onCustomContextMenuRequested(const QPoint &pos)
 {
     auto *menu = createStandardContextMenu();
@@ -165,7 +195,7 @@ void TestCaseEdit::onCustomContextMenuRequested(const QPoint &pos)
         QString fileName =
             DefaultPathManager::getSaveFileName("Save Test Case To A File", this, tr("Save test case to file"));
         if (!fileName.isEmpty())
-            Util::saveFile(fileName, getText(), tr("Save test case to file"), true, log);
+            Util::saveFile(fileName, getData().bytes(), tr("Save test case to file"), true, log);
     });
 
     if (role != Output)
@@ -200,7 +230,7 @@ void TestCaseEdit::onCustomContextMenuRequested(const QPoint &pos)
 
 void TestCaseEdit::loadFromFile(const QString &path)
 {
-    auto content = Util::readFile(path, "Load Testcase From File", log);
+    auto content = Core::TestData::fromFile(path, "Load Testcase From File", log);
     if (!content.isNull())
         modifyText(content);
 }
@@ -18,6 +18,7 @@
 #ifndef TESTCASEEDIT_HPP
 #define TESTCASEEDIT_HPP
 
+#include "Core/TestData.hpp"
 #include <QPlainTextEdit>
 
 class MessageLogger;
@@ -42,9 +43,22 @@ class TestCaseEdit : public QPlainTextEdit
     void dragEnterEvent(QDragEnterEvent *event) override;
     void dragMoveEvent(QDragMoveEvent *event) override;
     void dropEvent(QDropEvent *event) override;
-    void modifyText(const QString &text, bool keepHistory = true);
+    void modifyText(const Core::TestData &data, bool keepHistory = true);
+
+    /**
+     * @brief show the text of another test case, without the undo history or the warning about the length limit
+     * @note the height is changed at once instead of animated
+     */
+    void showText(const Core::TestData &data);
+
     QString getText();
 
+    /**
+     * @brief get the content without decoding it, only a preview is shown if it's too long
+     */
+    Core::TestData getData();
+    void setID(int id);
+
   public slots:
     void startAnimation();
 
@@ -56,11 +70,13 @@ class TestCaseEdit : public QPlainTextEdit
 
   private:
     void loadFromFile(const QString &path);
+    void updateText(const Core::TestData &data, bool keepHistory, bool warnIfTooLong);
+    int targetHeight() const;
 
   private:
     QPropertyAnimation *animation;
     MessageLogger *log;
-    QString text;
+    Core::TestData data;
     Role role;
     int id;
 };
@@ -18,27 +18,39 @@
 #include "Widgets/TestCases.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/TestArchive.hpp"
 #include "Core/TestCasesCopyPaster.hpp"
+#include "Core/TestImporter.hpp"
+#include "Core/TestIOThread.hpp"
+#include "Core/TestLoader.hpp"
+#include "Core/TestManifest.hpp"
+#include "Core/TestWriter.hpp"
 #include "Settings/DefaultPathManager.hpp"
 #include "Util/FileUtil.hpp"
-#include "Widgets/TestCase.hpp"
+#include "Util/Util.hpp"
+#include "Widgets/DiffViewer.hpp"
+#include "Widgets/TestCasesModel.hpp"
+#include "Widgets/TestCasesView.hpp"
 #include "generated/SettingsHelper.hpp"
 #include <QComboBox>
 #include <QFileInfo>
 #include <QHBoxLayout>
+#include <QHash>
 #include <QLabel>
 #include <QMenu>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QPushButton>
-#include <QScrollArea>
 #include <QSet>
 #include <QVBoxLayout>
+#include <algorithm>
+#include <limits>
 
 #define VALIDATE_INDEX(x) validateIndex(x, __func__)
 
 namespace Widgets
 {
-const int TestCases::MAX_NUMBER_OF_TESTCASES;
+const int TestCases::MAX_MISSING_TEST_CASE_FILES;
 
 TestCases::TestCases(MessageLogger *logger, QWidget *parent) : QWidget(parent), log(logger)
 {
@@ -52,9 +64,8 @@ TestCases::TestCases(MessageLogger *logger, QWidget *parent) : QWidget(parent),
     moreButton = new QPushButton(tr("More"));
     addCheckerButton = new QPushButton(tr("Add Checker"));
     checkerComboBox = new QComboBox();
-    scrollArea = new QScrollArea();
-    scrollAreaWidget = new QWidget();
-    scrollAreaLayout = new QVBoxLayout(scrollAreaWidget);
+    model = new TestCasesModel(this);
+    view = new TestCasesView(model, log, this);
 
     titleLayout->addWidget(label);
     titleLayout->addWidget(verdicts);
@@ -63,11 +74,9 @@ TestCases::TestCases(MessageLogger *logger, QWidget *parent) : QWidget(parent),
     checkerLayout->addWidget(checkerLabel);
     checkerLayout->addWidget(checkerComboBox);
     checkerLayout->addWidget(addCheckerButton);
-    scrollArea->setWidgetResizable(true);
-    scrollArea->setWidget(scrollAreaWidget);
     mainLayout->addLayout(titleLayout);
     mainLayout->addLayout(checkerLayout);
-    mainLayout->addWidget(scrollArea);
+    mainLayout->addWidget(view);
 
     verdicts->setToolTip(tr("Unaccepted / Accepted / Total"));
     addCheckerButton->setToolTip(tr("Add a custom testlib checker"));
@@ -82,99 +91,91 @@ TestCases::TestCases(MessageLogger *logger, QWidget *parent) : QWidget(parent),
         LOG_INFO(paths.join(", "));
         if (!paths.isEmpty())
         {
-            QVariantList rules = SettingsHelper::getTestcasesMatchingRules();
-            QSet<QString> remain;
-            for (auto const &path : paths)
-                remain.insert(QFileInfo(path).fileName());
-            // load pairs
-            for (auto const &rule : rules)
-            {
-                QRegularExpression inputRegex("^" + rule.toStringList().front() + "$");
-                QString answerReplace(rule.toStringList().back());
-                for (auto const &path : paths)
-                {
-                    auto inputFile = QFileInfo(path).fileName();
-                    if (!remain.contains(inputFile))
-                        continue;
-                    if (!inputRegex.match(inputFile).hasMatch())
-                        continue;
-                    auto answerFile = inputFile;
-                    answerFile.replace(inputRegex, answerReplace);
-                    if (!remain.contains(answerFile))
-                        continue;
-                    remain.remove(inputFile);
-                    remain.remove(answerFile);
-                    auto answerPath = QFileInfo(path).dir().filePath(answerFile);
-                    auto input = loadTestCaseFromFile(path, tr("Testcases"));
-                    auto answer = loadTestCaseFromFile(answerPath, tr("Testcases"));
-                    if (!input.isNull() && !answer.isNull())
-                    {
-                        addTestCase(input, answer);
-                        log->info(tr("Load Testcases"),
-                                  tr("A pair of testcases [%1] and [%2] is loaded").arg(path).arg(answerPath));
-                    }
-                }
-            }
-            // load single input
-            for (auto const &rule : rules)
-            {
-                QRegularExpression inputRegex("^" + rule.toStringList().front() + "$");
-                for (auto const &path : paths)
-                {
-                    auto inputFile = QFileInfo(path).fileName();
-                    if (!remain.contains(inputFile))
-                        continue;
-                    if (!inputRegex.match(inputFile).hasMatch())
-                        continue;
-                    remain.remove(inputFile);
-                    auto input = loadTestCaseFromFile(path, tr("Testcases"));
-                    if (!input.isNull())
-                    {
-                        addTestCase(input, QString());
-                        log->info(tr("Load Testcases"), tr("An input [%1] is loaded").arg(path));
-                    }
-                }
-            }
-            if (!remain.isEmpty())
-            {
-                QStringList remainPaths;
-                for (auto const &path : remain)
-                    remainPaths.push_back(QString("[%1]").arg(path));
-                log->warn(tr("Load Testcases"),
-                          tr("The following files are not loaded because they are not matched:%1. You can set the "
-                             "matching rules at %2.")
-                              .arg(remainPaths.join(", "))
-                              .arg(SettingsHelper::pathOfTestcasesMatchingRules()),
-                          false);
-            }
+            Core::TestImporter::Task task;
+            task.files = paths;
+            importTestCases(task);
         }
     });
 
+    moreMenu->addAction(tr("Import Test Cases From Directory"), [this] {
+        const auto path = DefaultPathManager::getExistingDirectory("Export And Import Test Cases", this,
+                                                                   tr("Import Test Cases"));
+        LOG_INFO(INFO_OF(path));
+        if (!path.isEmpty())
+        {
+            Core::TestImporter::Task task;
+            task.path = path;
+            importTestCases(task);
+        }
+    });
+
+    moreMenu->addAction(tr("Import Test Cases From Archive"), [this] {
+        const auto path = DefaultPathManager::getOpenFileName(
+            "Export And Import Test Cases", this, tr("Import Test Cases"),
+            tr("Test Case Archives") + " (*.tests);;" + tr("Zip Archives") + " (*.zip)");
+        LOG_INFO(INFO_OF(path));
+        if (!path.isEmpty())
+        {
+            Core::TestImporter::Task task;
+            task.path = path;
+            importTestCases(task);
+        }
+    });
+
+    moreMenu->addAction(tr("Export Test Cases To Archive"), [this] {
+        const auto path = DefaultPathManager::getSaveFileName("Export And Import Test Cases", this,
+                                                              tr("Export Test Cases"),
+                                                              tr("Test Case Archives") + " (*.tests)");
+        LOG_INFO(INFO_OF(path));
+        if (path.isEmpty())
+            return;
+
+        Core::TestWriter::Task task;
+        task.writeArchive = true;
+        task.archivePath = path;
+        for (int i = 0; i < count(); ++i)
+        {
+            task.inputs.push_back(model->testCase(i).input);
+            task.answers.push_back(model->testCase(i).expected);
+        }
+        task.compress = SettingsHelper::isCompressTestCaseArchive();
+        task.safe = !SettingsHelper::isSaveFaster();
+
+        auto *writer = createWriter(task);
+        connect(writer, &Core::TestWriter::failedToWrite, this,
+                [this](const QString &, const QString &error) { log->error(tr("Export Test Cases"), error); });
+        connect(writer, &Core::TestWriter::finished, this, [this, path](bool ok) {
+            if (ok)
+                log->info(tr("Export Test Cases"), tr("The test cases are exported to [%1]").arg(path));
+        });
+        QMetaObject::invokeMethod(writer, "start", Qt::QueuedConnection);
+    });
+
     //: Here "Check" means to check the checkbox
     moreMenu->addAction(tr("Check All"), [this] {
         LOG_INFO("Check All");
-        for (auto *t : testcases)
-            t->setChecked(true);
+        for (int i = 0; i < count(); ++i)
+            model->setChecked(i, true);
     });
 
     moreMenu->addAction(tr("Uncheck All"), [this] {
         LOG_INFO("Uncheck All");
-        for (auto *t : testcases)
-            t->setChecked(false);
+        for (int i = 0; i < count(); ++i)
+            model->setChecked(i, false);
     });
 
     moreMenu->addAction(tr("Uncheck Accepted"), [this] {
         LOG_INFO("Uncheck Accepted");
-        for (auto *t : testcases)
-            if (t->verdict() == TestCase::AC)
-                t->setChecked(false);
+        for (int i = 0; i < count(); ++i)
+            if (model->testCase(i).verdict == TestCase::AC)
+                model->setChecked(i, false);
     });
 
     //: This action checks the checkboxes which were not checked, and unchecks the ones which were checked
     moreMenu->addAction(tr("Invert"), [this] {
         LOG_INFO("Invert");
-        for (auto *t : testcases)
-            t->setChecked(t->isChecked() ^ 1);
+        for (int i = 0; i < count(); ++i)
+            model->setChecked(i, !isChecked(i));
     });
 
     moreMenu->addAction(tr("Delete All"), [this] {
@@ -183,23 +184,31 @@ TestCases::TestCases(MessageLogger *logger, QWidget *parent) : QWidget(parent),
         if (res != QMessageBox::Yes)
             return;
 
-        for (int i = 0; i < count(); ++i)
-        {
-            onChildDeleted(testcases[i]);
-            --i;
-        }
+        clear();
     });
 
     moreMenu->addAction(tr("Delete Empty"), [this] {
         LOG_INFO("Delete Empty");
+        removeTestCases([this](int index) {
+            return model->testCase(index).input.isEmpty() && model->testCase(index).expected.isEmpty();
+        });
+    });
+
+    moreMenu->addAction(tr("Delete Duplicates"), [this] {
+        LOG_INFO("Delete Duplicates");
+        // the first one of the same test cases is kept
+        QSet<QByteArray> ids;
+        QVector<bool> duplicate(count());
         for (int i = 0; i < count(); ++i)
         {
-            if (testcases[i]->isEmpty())
-            {
-                onChildDeleted(testcases[i]);
-                --i;
-            }
+            const auto &testcase = model->testCase(i);
+            if (testcase.input.isEmpty() && testcase.expected.isEmpty())
+                continue;
+            const auto id = model->id(i);
+            duplicate[i] = ids.contains(id);
+            ids.insert(id);
         }
+        removeTestCases([&duplicate](int index) { return duplicate[index]; });
     });
 
     moreMenu->addAction(tr("Delete Checked"), [this] {
@@ -210,14 +219,7 @@ TestCases::TestCases(MessageLogger *logger, QWidget *parent) : QWidget(parent),
         if (res != QMessageBox::Yes)
             return;
 
-        for (int i = 0; i < count(); ++i)
-        {
-            if (isChecked(i))
-            {
-                onChildDeleted(testcases[i]);
-                --i;
-            }
-        }
+        removeTestCases([this](int index) { return isChecked(index); });
     });
 
     moreMenu->addAction(tr("Copy Test Cases"), [this] {
@@ -260,168 +262,330 @@ TestCases::TestCases(MessageLogger *logger, QWidget *parent) : QWidget(parent),
                                tr("nyesno - Compare YES/NOs, case insensitive")});
     checkerComboBox->setCurrentIndex(0);
 
+    connect(model, &TestCasesModel::verdictsChanged, this, &TestCases::updateVerdicts);
+    connect(model, &TestCasesModel::dataChanged, this, &TestCases::onOutputChanged);
+    connect(model, &TestCasesModel::rowsRemoved, this, &TestCases::onRowsRemoved);
+    connect(model, &TestCasesModel::modelReset, this, &TestCases::onRowsRemoved);
+    connect(view, &TestCasesView::requestDelete, this, [this](int index) { model->removeRows(index, 1); });
+    connect(view, &TestCasesView::requestRun, this, &TestCases::requestRun);
+    connect(view, &TestCasesView::requestProfile, this, &TestCases::requestProfile);
+    connect(view, &TestCasesView::requestExecutionCounts, this, &TestCases::requestExecutionCounts);
+    connect(view, &TestCasesView::requestKill, this, &TestCases::requestKill);
+    connect(view, &TestCasesView::requestDiff, this, &TestCases::showDiff);
     connect(checkerComboBox, qOverload<int>(&QComboBox::currentIndexChanged), this, &TestCases::checkerChanged);
     connect(addButton, &QPushButton::clicked, this, &TestCases::on_addButton_clicked);
     connect(addCheckerButton, &QPushButton::clicked, this, &TestCases::on_addCheckerButton_clicked);
 }
 
+TestCases::~TestCases()
+{
+    stopLoading();
+    stopImporting();
+}
+
 void TestCases::setInput(int index, const QString &input)
 {
     if (VALIDATE_INDEX(index))
-        testcases[index]->setInput(input);
+        model->setInput(index, input);
 }
 
 void TestCases::setOutput(int index, const QString &output)
 {
     if (VALIDATE_INDEX(index))
-        testcases[index]->setOutput(output);
+        model->setOutput(index, output);
 }
 
 void TestCases::setExpected(int index, const QString &expected)
 {
     if (VALIDATE_INDEX(index))
-        testcases[index]->setExpected(expected);
+        model->setExpected(index, expected);
+}
+
+void TestCases::addTestCase(const Core::TestData &input, const Core::TestData &expected)
+{
+    LOG_INFO("New testcase added");
+    addTestCases({input}, {expected});
 }
 
-void TestCases::addTestCase(const QString &input, const QString &expected)
+void TestCases::addTestCases(const QVector<Core::TestData> &inputs, const QVector<Core::TestData> &expecteds)
 {
-    if (count() >= MAX_NUMBER_OF_TESTCASES)
+    // the ids of the existing test cases are counted by the model, only the new ones are tracked here
+    QHash<QByteArray, int> newIds;
+
+    const bool merge = SettingsHelper::isMergeDuplicateTestCases();
+    QVector<Core::TestData> newInputs, newExpecteds;
+    QStringList duplicates;
+    for (int i = 0; i < inputs.size() && i < expecteds.size(); ++i)
     {
-        LOG_WARN("Max testcase limit reached");
-        QMessageBox::warning(this, tr("Add Test Case"),
-                             tr("There are already %1 test cases, you can't add more.").arg(count()));
+        // an empty test case is a placeholder to be filled, so it's never a duplicate
+        if (!inputs[i].isEmpty() || !expecteds[i].isEmpty())
+        {
+            TestCasesModel::TestCaseData testcase;
+            testcase.input = inputs[i];
+            testcase.expected = expecteds[i];
+            const auto id = testcase.id();
+            const int index = count() + newInputs.size();
+            const int existing = model->idCount(id) > 0 ? model->firstRowOf(id) : newIds.value(id, -1);
+            if (existing != -1)
+            {
+                duplicates.push_back(merge ? QString("#%1").arg(existing + 1)
+                                           : QString("#%1 = #%2").arg(index + 1).arg(existing + 1));
+                if (merge)
+                    continue;
+            }
+            else
+            {
+                newIds.insert(id, index);
+            }
+        }
+        newInputs.push_back(inputs[i]);
+        newExpecteds.push_back(expecteds[i]);
+    }
+
+    LOG_INFO(INFO_OF(newInputs.size()) << INFO_OF(duplicates.size()) << BOOL_INFO_OF(merge));
+    model->appendTestCases(newInputs, newExpecteds);
+
+    if (duplicates.isEmpty())
+        return;
+    if (merge)
+    {
+        log->info(tr("Test Cases"), tr("%1 test cases are not added because they are the same as the test cases %2.")
+                                        .arg(duplicates.size())
+                                        .arg(duplicates.join(", ")));
     }
     else
     {
-        LOG_INFO("New testcase added");
-        auto *testcase = new TestCase(count(), log, this, input, expected);
-        connect(testcase, &TestCase::deleted, this, &TestCases::onChildDeleted);
-        connect(testcase, &TestCase::requestRun, this, &TestCases::requestRun);
-        testcases.push_back(testcase);
-        scrollAreaLayout->addWidget(testcase);
-        updateVerdicts();
+        log->warn(tr("Test Cases"),
+                  tr("Duplicate test cases are added: %1. You can delete them by Delete Duplicates in the More menu, "
+                     "or skip them when they are added at %2.")
+                      .arg(duplicates.join(", "))
+                      .arg(SettingsHelper::pathOfMergeDuplicateTestCases()),
+                  false);
     }
 }
 
 void TestCases::clearOutput()
 {
     for (int i = 0; i < count(); ++i)
-        testcases[i]->clearOutput();
-    updateVerdicts();
+        model->clearOutput(i);
 }
 
 void TestCases::clear()
 {
-    while (count() > 0)
-        onChildDeleted(testcases.front());
+    stopLoading();
+    stopImporting();
+    model->clear();
 }
 
 QString TestCases::input(int index) const
 {
-    return VALIDATE_INDEX(index) ? testcases[index]->input() : QString();
+    return VALIDATE_INDEX(index) ? model->testCase(index).input.text() : QString();
 }
 
 QString TestCases::output(int index) const
 {
-    return VALIDATE_INDEX(index) ? testcases[index]->output() : QString();
+    return VALIDATE_INDEX(index) ? model->testCase(index).output : QString();
 }
 
 QString TestCases::expected(int index) const
 {
-    return VALIDATE_INDEX(index) ? testcases[index]->expected() : QString();
+    return VALIDATE_INDEX(index) ? model->testCase(index).expected.text() : QString();
 }
 
-void TestCases::loadStatus(const QStringList &inputList, const QStringList &expectedList)
+Core::TestData TestCases::inputData(int index) const
 {
-    clear();
-    for (int i = 0; i < inputList.length() && i < expectedList.length(); ++i)
-        addTestCase(inputList[i], expectedList[i]);
+    return VALIDATE_INDEX(index) ? model->testCase(index).input : Core::TestData();
 }
 
-QStringList TestCases::inputs() const
+Core::TestData TestCases::expectedData(int index) const
 {
-    QStringList res;
-    for (int i = 0; i < count(); ++i)
-        res.append(testcases[i]->input());
-    return res;
+    return VALIDATE_INDEX(index) ? model->testCase(index).expected : Core::TestData();
 }
 
-QStringList TestCases::expecteds() const
+QByteArray TestCases::testCaseId(int index) const
 {
-    QStringList res;
-    for (int i = 0; i < count(); ++i)
-        res.append(testcases[i]->expected());
-    return res;
+    return VALIDATE_INDEX(index) ? model->id(index) : QByteArray();
 }
 
-void TestCases::loadFromSavedFiles(const QString &filePath)
+void TestCases::loadStatus(const QStringList &inputList, const QStringList &expectedList,
+                           const QStringList &inputFiles, const QStringList &expectedFiles)
 {
     clear();
 
-    for (int i = MAX_NUMBER_OF_TESTCASES - 1; i >= 0; --i)
+    // the file-backed ones are copied into the temporary directory again without being decoded
+    const auto threshold = Core::TestData::fileThreshold();
+    const auto data = [this, threshold](const QStringList &texts, const QStringList &files, int i) {
+        if (i >= files.length() || files[i].isEmpty())
+            return Core::TestData(texts[i]);
+        QString error;
+        const auto result = Core::TestData::readFile(files[i], threshold, &error);
+        if (result.isNull())
+            log->error(tr("Restore Test Cases"), error);
+        return result.isNull() ? Core::TestData(texts[i]) : result;
+    };
+
+    QVector<Core::TestData> inputs, expecteds;
+    for (int i = 0; i < inputList.length() && i < expectedList.length(); ++i)
     {
-        auto inputPath = inputFilePath(filePath, i);
-        auto answerPath = answerFilePath(filePath, i);
-        if (QFile::exists(inputPath) || QFile::exists(answerPath))
-        {
-            for (int j = 0; j <= i; ++j)
-            {
-                addTestCase(loadTestCaseFromFile(inputFilePath(filePath, j), tr("Input #%1").arg(j + 1)),
-                            loadTestCaseFromFile(answerFilePath(filePath, j), tr("Expected #%1").arg(j + 1)));
-            }
-            break;
-        }
+        inputs.push_back(data(inputList, inputFiles, i));
+        expecteds.push_back(data(expectedList, expectedFiles, i));
     }
+    model->appendTestCases(inputs, expecteds);
+}
 
-    if (count() == 0)
-        addTestCase();
+void TestCases::loadFromSavedFiles(const QString &filePath)
+{
+    clear();
+    savedFilePath = filePath;
+
+    // the files are read on the test I/O thread, and the test cases are appended when they are loaded
+    Core::TestLoader::Task task;
+    task.sourceFilePath = filePath;
+    task.inputRule = SettingsHelper::getInputFileSavePath();
+    task.answerRule = SettingsHelper::getAnswerFileSavePath();
+    task.threshold = Core::TestData::fileThreshold();
+    task.maxMissing = MAX_MISSING_TEST_CASE_FILES;
+    task.useArchive = SettingsHelper::getTestCaseStorage() == "Archive";
+
+    createLoader(task);
+    connect(loader, &Core::TestLoader::finished, this, &TestCases::onLoadingFinished);
+    QMetaObject::invokeMethod(loader, "start", Qt::QueuedConnection);
+}
+
+bool TestCases::isLoading() const
+{
+    return loader != nullptr;
 }
 
 void TestCases::saveToFiles(const QString &filePath, bool safe)
 {
+    // the files of the test cases which are not loaded yet would be overwritten
+    if (isLoading())
+    {
+        LOG_INFO("The test cases are still being loaded, they are not saved");
+        return;
+    }
+
+    // it's the first time to save the test cases of this file, e.g. the file is saved as a new file, or the test
+    // cases are restored from the session, so the saved test cases are found in the same way as they are loaded
+    if (filePath != savedFilePath)
+    {
+        saved = Core::TestManifest::snapshot(filePath, SettingsHelper::getInputFileSavePath(),
+                                             SettingsHelper::getAnswerFileSavePath(), MAX_MISSING_TEST_CASE_FILES);
+        savedFilePath = filePath;
+    }
+
+    QHash<QString, QByteArray> savedFiles;
+    for (const auto &entry : qAsConst(saved.files))
+    {
+        if (!entry.input.isEmpty())
+            savedFiles.insert(entry.input, entry.inputHash);
+        if (!entry.answer.isEmpty())
+            savedFiles.insert(entry.answer, entry.answerHash);
+    }
+
+    // only the changed files are written, the hashes are cached, so it's cheap if nothing is changed
+    // with the archive, the test cases are not saved in files, so the saved files are removed, and vice versa
+    const bool useArchive = SettingsHelper::getTestCaseStorage() == "Archive";
+    Core::TestWriter::Task task;
+    Core::TestManifest::Snapshot current;
+    QSet<QString> files;
+    bool hasContent = false;
+    const auto addFile = [&](const QString &path, const Core::TestData &data, const QByteArray &hash) {
+        // the duplicate test cases share the same files if the files are named by the hashes
+        if (files.contains(path))
+            return;
+        files.insert(path);
+        if (savedFiles.value(path) != hash)
+            task.files.push_back({path, data});
+    };
     for (int i = 0; i < count(); ++i)
     {
-        if (!input(i).isEmpty())
-            Util::saveFile(inputFilePath(filePath, i), input(i), tr("Save Input #%1").arg(i + 1), safe, log, true);
-        if (!expected(i).isEmpty())
-            Util::saveFile(answerFilePath(filePath, i), expected(i), tr("Save Expected #%1").arg(i + 1), safe, log,
-                           true);
+        const auto &testcase = model->testCase(i);
+        const auto id = useArchive ? QByteArray() : model->id(i);
+        Core::TestManifest::Entry entry;
+        if (!testcase.input.isEmpty())
+        {
+            entry.inputHash = testcase.input.hash();
+            if (!useArchive)
+            {
+                entry.input = inputFilePath(filePath, i, id);
+                addFile(entry.input, testcase.input, entry.inputHash);
+            }
+        }
+        if (!testcase.expected.isEmpty())
+        {
+            entry.answerHash = testcase.expected.hash();
+            if (!useArchive)
+            {
+                entry.answer = answerFilePath(filePath, i, id);
+                addFile(entry.answer, testcase.expected, entry.answerHash);
+            }
+        }
+        hasContent = hasContent || !testcase.input.isEmpty() || !testcase.expected.isEmpty();
+        (useArchive ? current.archive : current.files).push_back(entry);
     }
-    for (int i = count(); i < MAX_NUMBER_OF_TESTCASES; ++i)
+    if (!hasContent)
+        current.archive.clear();
+
+    // the files of the removed test cases are known from the manifest, so the paths are not checked one by one
+    for (auto it = savedFiles.cbegin(); it != savedFiles.cend(); ++it)
     {
-        auto inputPath = inputFilePath(filePath, i);
-        auto answerPath = answerFilePath(filePath, i);
-        if (QFile::exists(inputPath))
-            QFile::remove(inputPath);
-        if (QFile::exists(answerPath))
-            QFile::remove(answerPath);
+        if (!files.contains(it.key()))
+            task.removed.push_back(it.key());
     }
+
+    task.writeManifest = !saved.isManifestSaved || current.files != saved.files;
+    task.writeArchive = !saved.isArchiveSaved || current.archive != saved.archive;
+    if (task.files.isEmpty() && task.removed.isEmpty() && !task.writeManifest && !task.writeArchive)
+        return;
+
+    LOG_INFO(INFO_OF(task.files.size()) << INFO_OF(task.removed.size()) << BOOL_INFO_OF(task.writeManifest)
+                                        << BOOL_INFO_OF(task.writeArchive));
+    task.manifestPath = Core::TestManifest::path(filePath);
+    task.manifest = Core::TestManifest::serialize(task.manifestPath, current.files);
+    task.archivePath = Core::TestArchive::path(filePath);
+    if (task.writeArchive && !current.archive.isEmpty())
+    {
+        for (int i = 0; i < count(); ++i)
+        {
+            task.inputs.push_back(model->testCase(i).input);
+            task.answers.push_back(model->testCase(i).expected);
+        }
+    }
+    task.compress = SettingsHelper::isCompressTestCaseArchive();
+    task.safe = safe && !SettingsHelper::isSaveFaster();
+
+    // the files are written on the test I/O thread, they are regarded as saved unless they fail to be written
+    current.isManifestSaved = current.isArchiveSaved = true;
+    saved = current;
+    auto *writer = createWriter(task);
+    connect(writer, &Core::TestWriter::failedToWrite, this, &TestCases::onFailedToWrite);
+    QMetaObject::invokeMethod(writer, "start", Qt::QueuedConnection);
 }
 
-QString TestCases::loadTestCaseFromFile(const QString &path, const QString &head)
+Core::TestData TestCases::loadTestCaseFromFile(const QString &path, const QString &head)
 {
-    return Util::readFile(path, tr("Load %1").arg(head), log, true);
+    return Core::TestData::fromFile(path, tr("Load %1").arg(head), log, true);
 }
 
 void TestCases::setTestCaseEditFont(const QFont &font)
 {
-    for (auto *t : testcases)
-        t->setTestCaseEditFont(font);
+    view->setTestCaseEditFont(font);
 }
 
 void TestCases::updateHeights()
 {
-    for (auto *t : testcases)
-        t->updateHeight();
+    view->updateHeights();
 }
 
 QVariantList TestCases::splitterStates() const
 {
     QVariantList states;
-    for (auto *t : testcases)
+    for (int i = 0; i < count(); ++i)
     {
         QVariantList tmp;
-        for (auto size : t->splitterSizes())
+        for (auto size : model->testCase(i).splitterSizes)
             tmp.push_back(size);
         states.push_back(tmp);
     }
@@ -435,18 +599,14 @@ void TestCases::restoreSplitterStates(const QVariantList &states)
         QList<int> sizes;
         for (auto const &var : states[i].toList())
             sizes.push_back(var.toInt());
-        testcases[i]->restoreSplitterSizes(sizes);
+        if (!sizes.isEmpty())
+            model->setSplitterSizes(i, sizes);
     }
 }
 
-int TestCases::id(TestCase *testcase) const
-{
-    return testcases.indexOf(testcase);
-}
-
 int TestCases::count() const
 {
-    return testcases.count();
+    return model->rowCount();
 }
 
 void TestCases::setCheckerIndex(int index)
@@ -508,22 +668,75 @@ Core::Checker::CheckerType TestCases::checkerType() const
 void TestCases::setChecked(int index, bool checked)
 {
     if (VALIDATE_INDEX(index))
-        testcases[index]->setChecked(checked);
+        model->setChecked(index, checked);
 }
 
 bool TestCases::isChecked(int index) const
 {
-    return VALIDATE_INDEX(index) ? testcases[index]->isChecked() : false;
+    return VALIDATE_INDEX(index) ? model->testCase(index).checked : false;
+}
+
+void TestCases::setTimeUsed(int index, qint64 timeUsed)
+{
+    if (VALIDATE_INDEX(index))
+        model->setTimeUsed(index, timeUsed);
+}
+
+void TestCases::setPerfCounters(int index, const Core::PerfCounters::Counters &counters)
+{
+    if (VALIDATE_INDEX(index))
+        model->setPerfCounters(index, counters);
+}
+
+void TestCases::setUsage(int index, int cpuUsage, qint64 memoryUsed)
+{
+    if (VALIDATE_INDEX(index))
+        model->setUsage(index, cpuUsage, memoryUsed);
+}
+
+void TestCases::clearUsage(int index)
+{
+    if (VALIDATE_INDEX(index))
+        model->clearUsage(index);
+}
+
+void TestCases::setRuntimeHistory(int index, const QVector<Core::RuntimeHistory::Sample> &samples, bool regressed)
+{
+    if (VALIDATE_INDEX(index))
+        model->setRuntimeHistory(index, samples, regressed);
+}
+
+QVector<int> TestCases::executionOrder(QVector<int> indexes, const QString &order) const
+{
+    if (order == "Previously failing first")
+    {
+        std::stable_sort(indexes.begin(), indexes.end(), [this](int a, int b) {
+            const auto &x = model->testCase(a), &y = model->testCase(b);
+            if (x.lastFailed != y.lastFailed)
+                return x.lastFailed;
+            return x.failures > y.failures;
+        });
+    }
+    else if (order == "Slowest first")
+    {
+        // the test cases which haven't been executed are unknown, so they are considered the slowest
+        const auto timeUsed = [this](int index) {
+            const auto time = model->testCase(index).timeUsed;
+            return time < 0 ? std::numeric_limits<qint64>::max() : time;
+        };
+        std::stable_sort(indexes.begin(), indexes.end(),
+                         [&timeUsed](int a, int b) { return timeUsed(a) > timeUsed(b); });
+    }
+    return indexes;
 }
 
 void TestCases::setVerdict(int index, TestCase::Verdict verdict)
 {
     if (VALIDATE_INDEX(index))
     {
-        testcases[index]->setVerdict(verdict);
-        updateVerdicts();
+        model->setVerdict(index, verdict);
         if (verdict == TestCase::AC && SettingsHelper::isAutoUncheckAcceptedTestcases())
-            testcases[index]->setChecked(false);
+            model->setChecked(index, false);
     }
 }
 
@@ -544,15 +757,24 @@ void TestCases::on_addCheckerButton_clicked()
     }
 }
 
-void TestCases::onChildDeleted(TestCase *widget)
+void TestCases::onOutputChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
 {
-    testcases.removeOne(widget);
-    widget->hide();
-    scrollAreaLayout->removeWidget(widget);
-    delete widget;
-    for (int i = 0; i < count(); ++i)
-        testcases[i]->setID(i);
-    updateVerdicts();
+    if (!roles.contains(TestCasesModel::OutputRole))
+        return;
+
+    for (int i = topLeft.row(); i <= bottomRight.row(); ++i)
+    {
+        auto *diffViewer = diffViewers.value(i);
+        if (diffViewer != nullptr && !diffViewer->isHidden())
+            diffViewer->setText(output(i), expectedData(i), checkerType());
+    }
+}
+
+void TestCases::onRowsRemoved()
+{
+    // the Diff Viewers belong to the indexes, which are changed
+    qDeleteAll(diffViewers);
+    diffViewers.clear();
 }
 
 bool TestCases::validateIndex(int index, const QString &funcName) const
@@ -565,49 +787,197 @@ bool TestCases::validateIndex(int index, const QString &funcName) const
 
 void TestCases::updateVerdicts()
 {
-    int accepted = 0;
-    int unaccepted = 0;
-    for (auto *t : testcases)
+    auto text = QString(R"(<span style="color:red">%1</span> / <span style="color:green">%2</span> / %3)")
+                    .arg(model->unacceptedCount())
+                    .arg(model->acceptedCount())
+                    .arg(count());
+    if (isLoading())
+        text += " " + tr("(Loading...)");
+    else if (importer != nullptr)
+        text += " " + tr("(Importing...)");
+    verdicts->setText(text);
+}
+
+void TestCases::onTestCasesLoaded(const QVector<Core::TestData> &inputs, const QVector<Core::TestData> &expecteds)
+{
+    model->appendTestCases(inputs, expecteds);
+}
+
+void TestCases::onLoadingFinished(const Core::TestManifest::Snapshot &snapshot)
+{
+    LOG_INFO(INFO_OF(snapshot.files.size()) << INFO_OF(snapshot.archive.size()));
+    loader->deleteLater();
+    loader = nullptr;
+    saved = snapshot;
+    if (count() == 0)
+        addTestCase();
+    updateVerdicts();
+}
+
+void TestCases::onFailedToWrite(const QString &path, const QString &error)
+{
+    LOG_INFO(INFO_OF(path));
+    log->error(tr("Save Test Cases"), error);
+    // the saved test cases are found again in the next save, so the failed files are written again
+    savedFilePath.clear();
+}
+
+void TestCases::stopLoading()
+{
+    if (loader == nullptr)
+        return;
+    LOG_INFO("Stop loading the test cases");
+    loader->disconnect(this);
+    loader->cancel();
+    loader->deleteLater();
+    loader = nullptr;
+    // the test cases not loaded are still on the disk, so the saved test cases are found again when saving
+    savedFilePath.clear();
+    updateVerdicts();
+}
+
+void TestCases::createLoader(const Core::TestLoader::Task &task)
+{
+    loader = new Core::TestLoader(task);
+    loader->moveToThread(Core::TestIOThread::instance());
+    connect(loader, &Core::TestLoader::loaded, this, &TestCases::onTestCasesLoaded);
+    connect(loader, &Core::TestLoader::failedToRead, this,
+            [this](const QString &error) { log->error(tr("Load Test Cases"), error); });
+    updateVerdicts();
+}
+
+void TestCases::importTestCases(Core::TestImporter::Task task)
+{
+    if (isLoading() || importer != nullptr)
     {
-        switch (t->verdict())
+        log->warn(tr("Import Test Cases"),
+                  tr("The test cases are still being loaded or imported, please try again later"));
+        return;
+    }
+
+    for (const auto &rule : SettingsHelper::getTestcasesMatchingRules())
+        task.rules.push_back({rule.toStringList().front(), rule.toStringList().back()});
+    task.threshold = Core::TestData::fileThreshold();
+
+    // the progress dialog is shown only if importing takes a while
+    importProgress = new QProgressDialog(tr("Importing test cases..."), tr("Cancel"), 0, 0, this);
+    importProgress->setWindowTitle(tr("Import Test Cases"));
+    importProgress->setMinimumDuration(500);
+    connect(importProgress, &QProgressDialog::canceled, this, &TestCases::stopImporting);
+
+    importer = new Core::TestImporter(task);
+    importer->moveToThread(Core::TestIOThread::instance());
+    connect(importer, &Core::TestImporter::loaded, this, &TestCases::addTestCases);
+    connect(importer, &Core::TestImporter::failedToRead, this,
+            [this](const QString &error) { log->error(tr("Import Test Cases"), error); });
+    connect(importer, &Core::TestImporter::progress, this, [this](int done, int total) {
+        importProgress->setMaximum(total);
+        importProgress->setValue(done);
+    });
+    connect(importer, &Core::TestImporter::finished, this, [this, task](int imported, const QStringList &unmatched) {
+        LOG_INFO(INFO_OF(imported) << INFO_OF(unmatched.size()));
+        importer->deleteLater();
+        importer = nullptr;
+        importProgress->disconnect(this);
+        importProgress->deleteLater();
+        importProgress = nullptr;
+        updateVerdicts();
+
+        if (task.files.isEmpty())
+            log->info(tr("Import Test Cases"), tr("%1 test cases are imported from [%2]").arg(imported).arg(task.path));
+        else
+            log->info(tr("Load Testcases"), tr("%1 test cases are loaded").arg(imported));
+
+        if (unmatched.isEmpty())
+            return;
+        if (task.files.isEmpty())
+        {
+            // a package has many other files, e.g. the statements and the solutions, so they are not listed
+            log->warn(tr("Import Test Cases"),
+                      tr("%1 files are not imported because they are not matched. You can set the matching rules at "
+                         "%2.")
+                          .arg(unmatched.size())
+                          .arg(SettingsHelper::pathOfTestcasesMatchingRules()),
+                      false);
+        }
+        else
         {
-        case TestCase::AC:
-            ++accepted;
-            break;
-        case TestCase::WA:
-        case TestCase::TLE:
-        case TestCase::RE:
-            ++unaccepted;
-            break;
-        case TestCase::UNKNOWN:
-            break;
-        default:
-            Q_UNREACHABLE();
-            break;
+            QStringList remainPaths;
+            for (auto const &path : unmatched)
+                remainPaths.push_back(QString("[%1]").arg(path));
+            log->warn(tr("Load Testcases"),
+                      tr("The following files are not loaded because they are not matched:%1. You can set the "
+                         "matching rules at %2.")
+                          .arg(remainPaths.join(", "))
+                          .arg(SettingsHelper::pathOfTestcasesMatchingRules()),
+                      false);
         }
+    });
+
+    updateVerdicts();
+    QMetaObject::invokeMethod(importer, "start", Qt::QueuedConnection);
+}
+
+void TestCases::stopImporting()
+{
+    if (importer == nullptr)
+        return;
+    LOG_INFO("Stop importing the test cases");
+    importer->disconnect(this);
+    importer->cancel();
+    importer->deleteLater();
+    importer = nullptr;
+    importProgress->disconnect(this);
+    importProgress->deleteLater();
+    importProgress = nullptr;
+    updateVerdicts();
+}
+
+Core::TestWriter *TestCases::createWriter(const Core::TestWriter::Task &task)
+{
+    auto *writer = new Core::TestWriter(task);
+    writer->moveToThread(Core::TestIOThread::instance());
+    connect(writer, &Core::TestWriter::finished, writer, &QObject::deleteLater);
+    return writer;
+}
+
+template <typename Predicate> void TestCases::removeTestCases(Predicate predicate)
+{
+    // from the back, so that the indexes of the test cases to be checked are not changed
+    for (int end = count() - 1; end >= 0; --end)
+    {
+        if (!predicate(end))
+            continue;
+        int begin = end;
+        while (begin > 0 && predicate(begin - 1))
+            --begin;
+        model->removeRows(begin, end - begin + 1);
+        end = begin;
     }
-    verdicts->setText(QString(R"(<span style="color:red">%1</span> / <span style="color:green">%2</span> / %3)")
-                          .arg(unaccepted)
-                          .arg(accepted)
-                          .arg(count()));
 }
 
-QString TestCases::inputFilePath(const QString &filePath, int index)
+void TestCases::showDiff(int index)
 {
-    return testCaseFilePath(SettingsHelper::getInputFileSavePath(), filePath, index);
+    if (!VALIDATE_INDEX(index))
+        return;
+
+    auto *diffViewer = diffViewers.value(index);
+    if (diffViewer == nullptr)
+    {
+        diffViewer = new DiffViewer(this);
+        diffViewers.insert(index, diffViewer);
+    }
+    diffViewer->setText(output(index), expectedData(index), checkerType());
+    Util::showWidgetOnTop(diffViewer);
 }
 
-QString TestCases::answerFilePath(const QString &filePath, int index)
+QString TestCases::inputFilePath(const QString &filePath, int index, const QByteArray &id)
 {
-    return testCaseFilePath(SettingsHelper::getAnswerFileSavePath(), filePath, index);
+    return Core::TestManifest::testCaseFilePath(SettingsHelper::getInputFileSavePath(), filePath, index, id);
 }
 
-QString TestCases::testCaseFilePath(QString rule, const QString &filePath, int index)
+QString TestCases::answerFilePath(const QString &filePath, int index, const QByteArray &id)
 {
-    QFileInfo fileInfo(filePath);
-    return fileInfo.dir().filePath(rule.replace("${filename}", fileInfo.fileName())
-                                       .replace("${basename}", fileInfo.completeBaseName())
-                                       .replace("${0-index}", QString::number(index))
-                                       .replace("${1-index}", QString::number(index + 1)));
+    return Core::TestManifest::testCaseFilePath(SettingsHelper::getAnswerFileSavePath(), filePath, index, id);
 }
 } // namespace Widgets
@@ -19,6 +19,14 @@
 #define TESTCASES_HPP
 
 #include "Core/Checker.hpp"
+#include "Core/PerfCounters.hpp"
+#include "Core/RuntimeHistory.hpp"
+#include "Core/TestData.hpp"
+#include "Core/TestImporter.hpp"
+#include "Core/TestLoader.hpp"
+#include "Core/TestManifest.hpp"
+#include "Core/TestWriter.hpp"
+#include <QMap>
 #include <QWidget>
 
 class MessageLogger;
@@ -26,13 +34,15 @@ class QComboBox;
 class QHBoxLayout;
 class QLabel;
 class QMenu;
+class QProgressDialog;
 class QPushButton;
-class QScrollArea;
 class QVBoxLayout;
 
 namespace Widgets
 {
-class TestCase;
+class DiffViewer;
+class TestCasesModel;
+class TestCasesView;
 
 class TestCases : public QWidget
 {
@@ -41,25 +51,50 @@ class TestCases : public QWidget
   public:
     explicit TestCases(MessageLogger *logger, QWidget *parent = nullptr);
 
+    /**
+     * @brief destruct the test cases, the loading is stopped
+     */
+    ~TestCases() override;
+
     QString input(int index) const;
     QString output(int index) const;
     QString expected(int index) const;
 
+    /**
+     * @brief get the input or the expected output without decoding it
+     * @note it's preferred to input() and expected() for large test cases, e.g. to run or check them
+     */
+    Core::TestData inputData(int index) const;
+    Core::TestData expectedData(int index) const;
+
+    /**
+     * @brief get the id of a test case, see TestCasesModel::TestCaseData::id
+     */
+    QByteArray testCaseId(int index) const;
+
     void setInput(int index, const QString &input);
     void setOutput(int index, const QString &output);
     void setExpected(int index, const QString &expected);
 
-    void loadStatus(const QStringList &inputList, const QStringList &expectedList);
+    /**
+     * @brief replace the test cases with the ones in the status of a tab
+     * @param inputFiles the files of the file-backed inputs, empty for the ones in inputList, see MainWindow::toStatus
+     * @param expectedFiles the files of the file-backed expected outputs, empty for the ones in expectedList
+     */
+    void loadStatus(const QStringList &inputList, const QStringList &expectedList, const QStringList &inputFiles,
+                    const QStringList &expectedFiles);
 
-    QStringList inputs() const;
-    QStringList expecteds() const;
+    void addTestCase(const Core::TestData &input = Core::TestData(), const Core::TestData &expected = Core::TestData());
 
-    void addTestCase(const QString &input = QString(), const QString &expected = QString());
+    /**
+     * @brief append test cases, the ones with the same input and expected output as an existing one are duplicates
+     * @note the duplicates are reported, and they are skipped if Merge Duplicate Test Cases is enabled
+     */
+    void addTestCases(const QVector<Core::TestData> &inputs, const QVector<Core::TestData> &expecteds);
 
     void clearOutput();
     void clear();
 
-    int id(TestCase *testcase) const;
     int count() const;
 
     void setCheckerIndex(int index);
@@ -72,10 +107,38 @@ class TestCases : public QWidget
     void setChecked(int index, bool checked);
     bool isChecked(int index) const;
 
+    void setTimeUsed(int index, qint64 timeUsed);
+    void setPerfCounters(int index, const Core::PerfCounters::Counters &counters);
+    void setUsage(int index, int cpuUsage, qint64 memoryUsed);
+    void clearUsage(int index);
+    void setRuntimeHistory(int index, const QVector<Core::RuntimeHistory::Sample> &samples, bool regressed);
+
+    /**
+     * @brief sort the indexes of test cases in the execution order
+     * @param indexes the indexes of the test cases to be executed
+     * @param order one of the options of the Testcase Execution Order setting
+     * @note the sort is stable, test cases with the same priority are executed in the order they are listed
+     */
+    QVector<int> executionOrder(QVector<int> indexes, const QString &order) const;
+
+    /**
+     * @brief load the saved test cases of a source file in the background
+     * @note the test cases are appended when they are loaded, see isLoading()
+     */
     void loadFromSavedFiles(const QString &filePath);
+
+    /**
+     * @brief whether the saved test cases are still being loaded
+     */
+    bool isLoading() const;
+
+    /**
+     * @brief save the test cases and the manifest of a source file in the background
+     * @note only the changed files are written, and nothing is saved while the test cases are being loaded
+     */
     void saveToFiles(const QString &filePath, bool safe);
 
-    QString loadTestCaseFromFile(const QString &path, const QString &head);
+    Core::TestData loadTestCaseFromFile(const QString &path, const QString &head);
 
     void setTestCaseEditFont(const QFont &font);
 
@@ -90,29 +153,81 @@ class TestCases : public QWidget
   signals:
     void checkerChanged();
     void requestRun(int index);
+    void requestProfile(int index);
+    void requestExecutionCounts(int index);
+    void requestKill(int index);
 
   private slots:
     void on_addButton_clicked();
     void on_addCheckerButton_clicked();
-    void onChildDeleted(TestCase *widget);
+    void onOutputChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+    void onRowsRemoved();
+    void onTestCasesLoaded(const QVector<Core::TestData> &inputs, const QVector<Core::TestData> &expecteds);
+    void onLoadingFinished(const Core::TestManifest::Snapshot &snapshot);
+    void onFailedToWrite(const QString &path, const QString &error);
 
   private:
     bool validateIndex(int index, const QString &funcName) const;
     void updateVerdicts();
-    static QString inputFilePath(const QString &filePath, int index);
-    static QString answerFilePath(const QString &filePath, int index);
-    static QString testCaseFilePath(QString rule, const QString &filePath, int index);
 
-    static const int MAX_NUMBER_OF_TESTCASES = 100;
-    QVBoxLayout *mainLayout = nullptr, *scrollAreaLayout = nullptr;
+    /**
+     * @brief stop loading the saved test cases, the loaded ones are kept
+     */
+    void stopLoading();
+
+    /**
+     * @brief create a loader on the test I/O thread, the loaded test cases are appended
+     * @note the caller should connect the finished signal and start the loader
+     */
+    void createLoader(const Core::TestLoader::Task &task);
+
+    /**
+     * @brief import the test cases in the background with a progress dialog, they are appended when they are read
+     * @param task the files to import, the matching rules and the threshold are filled here
+     */
+    void importTestCases(Core::TestImporter::Task task);
+
+    /**
+     * @brief stop importing the test cases, the imported ones are kept
+     */
+    void stopImporting();
+
+    /**
+     * @brief create a writer on the test I/O thread, it's deleted when it's finished
+     * @note the caller should start the writer
+     */
+    Core::TestWriter *createWriter(const Core::TestWriter::Task &task);
+
+    /**
+     * @brief remove the test cases matching the predicate, the consecutive ones are removed together
+     */
+    template <typename Predicate> void removeTestCases(Predicate predicate);
+
+    /**
+     * @brief open the Diff Viewer of a test case
+     */
+    void showDiff(int index);
+
+    static QString inputFilePath(const QString &filePath, int index, const QByteArray &id);
+    static QString answerFilePath(const QString &filePath, int index, const QByteArray &id);
+
+    // the saved files are searched until this number of consecutive indexes have no files
+    static const int MAX_MISSING_TEST_CASE_FILES = 100;
+
+    QVBoxLayout *mainLayout = nullptr;
     QHBoxLayout *titleLayout = nullptr, *checkerLayout = nullptr;
     QPushButton *addButton = nullptr, *moreButton = nullptr, *addCheckerButton = nullptr;
     QMenu *moreMenu = nullptr;
     QComboBox *checkerComboBox = nullptr;
-    QScrollArea *scrollArea = nullptr;
-    QWidget *scrollAreaWidget = nullptr;
     QLabel *label = nullptr, *verdicts = nullptr, *checkerLabel = nullptr;
-    QList<TestCase *> testcases;
+    TestCasesModel *model = nullptr;
+    TestCasesView *view = nullptr;
+    Core::TestLoader *loader = nullptr;        // the loader of the saved test cases, nullptr if not loading
+    Core::TestImporter *importer = nullptr;    // the importer of the test cases, nullptr if not importing
+    QProgressDialog *importProgress = nullptr; // the progress of the importer
+    QMap<int, DiffViewer *> diffViewers;       // the opened Diff Viewers, the keys are the test case indexes
+    QString savedFilePath;                     // the source file of the saved test cases, empty if it's unknown
+    Core::TestManifest::Snapshot saved;        // the test cases saved on the disk
     MessageLogger *log;
     bool choosingChecker = false;
 };
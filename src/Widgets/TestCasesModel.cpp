@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/TestCasesModel.hpp"
+#include "Core/EventLogger.hpp"
+#include <QCryptographicHash>
+
+namespace Widgets
+{
+TestCasesModel::TestCasesModel(QObject *parent) : QAbstractListModel(parent)
+{
+}
+
+int TestCasesModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : testcases.size();
+}
+
+QVariant TestCasesModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= testcases.size())
+        return QVariant();
+
+    const auto &testcase = testcases[index.row()];
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return tr("Test #%1").arg(index.row() + 1);
+    case Qt::CheckStateRole:
+        return testcase.checked ? Qt::Checked : Qt::Unchecked;
+    case InputRole:
+        return testcase.input.text();
+    case OutputRole:
+        return testcase.output;
+    case ExpectedRole:
+        return testcase.expected.text();
+    case VerdictRole:
+        return testcase.verdict;
+    default:
+        return QVariant();
+    }
+}
+
+bool TestCasesModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.row() >= testcases.size())
+        return false;
+
+    switch (role)
+    {
+    case Qt::CheckStateRole:
+        setChecked(index.row(), value.toInt() == Qt::Checked);
+        return true;
+    case InputRole:
+        setInput(index.row(), value.toString());
+        return true;
+    case ExpectedRole:
+        setExpected(index.row(), value.toString());
+        return true;
+    default:
+        return false;
+    }
+}
+
+Qt::ItemFlags TestCasesModel::flags(const QModelIndex &index) const
+{
+    return QAbstractListModel::flags(index) | Qt::ItemIsUserCheckable | Qt::ItemIsEditable;
+}
+
+bool TestCasesModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+    if (parent.isValid() || row < 0 || count <= 0 || row + count > testcases.size())
+        return false;
+
+    LOG_INFO(INFO_OF(row) << INFO_OF(count));
+    beginRemoveRows(parent, row, row + count - 1);
+    for (int i = row; i < row + count; ++i)
+    {
+        countVerdict(testcases[i].verdict, -1);
+        uncountId(i);
+    }
+    testcases.remove(row, count);
+    ids.remove(row, count);
+    uncountedRows -= count;
+    endRemoveRows();
+    emit verdictsChanged();
+    return true;
+}
+
+QByteArray TestCasesModel::TestCaseData::id() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(input.hash());
+    hash.addData(expected.hash());
+    return hash.result();
+}
+
+const TestCasesModel::TestCaseData &TestCasesModel::testCase(int row) const
+{
+    return testcases[row];
+}
+
+QByteArray TestCasesModel::id(int row) const
+{
+    auto &id = ids[row];
+    if (id.isEmpty())
+    {
+        id = testcases[row].id();
+        ++idCounts[id];
+        --uncountedRows;
+    }
+    return id;
+}
+
+int TestCasesModel::idCount(const QByteArray &id) const
+{
+    // only the rows added or changed since the last count are hashed
+    for (int row = 0; uncountedRows > 0 && row < ids.size(); ++row)
+        this->id(row);
+    return idCounts.value(id);
+}
+
+int TestCasesModel::firstRowOf(const QByteArray &id) const
+{
+    for (int row = 0; row < ids.size(); ++row)
+    {
+        if (this->id(row) == id)
+            return row;
+    }
+    return -1;
+}
+
+void TestCasesModel::appendTestCases(const QVector<Core::TestData> &inputs, const QVector<Core::TestData> &expecteds)
+{
+    const int count = qMin(inputs.size(), expecteds.size());
+    if (count == 0)
+        return;
+
+    beginInsertRows(QModelIndex(), testcases.size(), testcases.size() + count - 1);
+    testcases.reserve(testcases.size() + count);
+    for (int i = 0; i < count; ++i)
+    {
+        TestCaseData testcase;
+        testcase.input = inputs[i];
+        testcase.expected = expecteds[i];
+        testcases.push_back(testcase);
+    }
+    ids.resize(testcases.size());
+    uncountedRows += count;
+    endInsertRows();
+    emit verdictsChanged();
+}
+
+void TestCasesModel::clear()
+{
+    beginResetModel();
+    testcases.clear();
+    accepted = unaccepted = 0;
+    ids.clear();
+    idCounts.clear();
+    uncountedRows = 0;
+    endResetModel();
+    emit verdictsChanged();
+}
+
+void TestCasesModel::setInput(int row, const Core::TestData &input)
+{
+    if (testcases[row].input == input)
+        return;
+    testcases[row].input = input;
+    uncountId(row);
+    notify(row, InputRole);
+}
+
+void TestCasesModel::setOutput(int row, const QString &output)
+{
+    testcases[row].output = output;
+    notify(row, OutputRole);
+}
+
+void TestCasesModel::setExpected(int row, const Core::TestData &expected)
+{
+    if (testcases[row].expected == expected)
+        return;
+    testcases[row].expected = expected;
+    uncountId(row);
+    notify(row, ExpectedRole);
+}
+
+void TestCasesModel::setChecked(int row, bool checked)
+{
+    if (testcases[row].checked == checked)
+        return;
+    testcases[row].checked = checked;
+    notify(row, Qt::CheckStateRole);
+}
+
+void TestCasesModel::setVerdict(int row, TestCase::Verdict verdict)
+{
+    auto &testcase = testcases[row];
+    countVerdict(testcase.verdict, -1);
+    testcase.verdict = verdict;
+    countVerdict(verdict, 1);
+
+    if (verdict != TestCase::UNKNOWN)
+    {
+        testcase.lastFailed = verdict != TestCase::AC;
+        if (testcase.lastFailed)
+            ++testcase.failures;
+    }
+
+    notify(row, VerdictRole);
+    emit verdictsChanged();
+}
+
+void TestCasesModel::setTimeUsed(int row, qint64 timeUsed)
+{
+    testcases[row].timeUsed = timeUsed;
+    notify(row, DetailsRole);
+}
+
+void TestCasesModel::setPerfCounters(int row, const Core::PerfCounters::Counters &counters)
+{
+    testcases[row].perfCounters = counters;
+    notify(row, DetailsRole);
+}
+
+void TestCasesModel::setUsage(int row, int cpuUsage, qint64 memoryUsed)
+{
+    auto &testcase = testcases[row];
+    testcase.running = true;
+    testcase.cpuUsage = cpuUsage;
+    testcase.memoryUsed = memoryUsed;
+    notify(row, UsageRole);
+}
+
+void TestCasesModel::clearUsage(int row)
+{
+    if (!testcases[row].running)
+        return;
+    testcases[row].running = false;
+    notify(row, UsageRole);
+}
+
+void TestCasesModel::setRuntimeHistory(int row, const QVector<Core::RuntimeHistory::Sample> &samples, bool regressed)
+{
+    testcases[row].runtimeHistory = samples;
+    testcases[row].regressed = regressed;
+    notify(row, RuntimeHistoryRole);
+}
+
+void TestCasesModel::setSplitterSizes(int row, const QList<int> &sizes)
+{
+    testcases[row].splitterSizes = sizes;
+    notify(row, SplitterSizesRole);
+}
+
+void TestCasesModel::clearOutput(int row)
+{
+    auto &testcase = testcases[row];
+    testcase.output.clear();
+    countVerdict(testcase.verdict, -1);
+    testcase.verdict = TestCase::UNKNOWN;
+    testcase.perfCounters = Core::PerfCounters::Counters();
+    const auto index = this->index(row);
+    emit dataChanged(index, index, {OutputRole, VerdictRole, DetailsRole});
+    emit verdictsChanged();
+}
+
+int TestCasesModel::acceptedCount() const
+{
+    return accepted;
+}
+
+int TestCasesModel::unacceptedCount() const
+{
+    return unaccepted;
+}
+
+void TestCasesModel::notify(int row, int role)
+{
+    const auto index = this->index(row);
+    emit dataChanged(index, index, {role});
+}
+
+void TestCasesModel::uncountId(int row)
+{
+    auto &id = ids[row];
+    if (id.isEmpty())
+        return;
+    auto count = idCounts.find(id);
+    if (--count.value() == 0)
+        idCounts.erase(count);
+    id.clear();
+    ++uncountedRows;
+}
+
+void TestCasesModel::countVerdict(TestCase::Verdict verdict, int delta)
+{
+    switch (verdict)
+    {
+    case TestCase::AC:
+        accepted += delta;
+        break;
+    case TestCase::WA:
+    case TestCase::TLE:
+    case TestCase::RE:
+    case TestCase::ILE:
+        unaccepted += delta;
+        break;
+    case TestCase::UNKNOWN:
+        break;
+    default:
+        Q_UNREACHABLE();
+        break;
+    }
+}
+} // namespace Widgets
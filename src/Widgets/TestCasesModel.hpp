@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The TestCasesModel stores the test cases of a tab: the texts, the check states and the results of the executions.
+ * It's the single source of truth of the test cases, the TestCasesView only creates the widgets for the visible rows
+ * and binds them to the rows, so thousands of test cases don't need thousands of widgets.
+ * The numbers of accepted and unaccepted verdicts are counted when the verdicts change, so they are available in O(1).
+ * The ids of the test cases are counted as well, so the duplicates are found without hashing all test cases again.
+ * A row is hashed only when its id is needed for the first time after it's added or changed.
+ */
+
+#ifndef TESTCASESMODEL_HPP
+#define TESTCASESMODEL_HPP
+
+#include "Core/PerfCounters.hpp"
+#include "Core/RuntimeHistory.hpp"
+#include "Core/TestData.hpp"
+#include "Widgets/TestCase.hpp"
+#include <QAbstractListModel>
+#include <QHash>
+
+namespace Widgets
+{
+class TestCasesModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+  public:
+    enum Role
+    {
+        InputRole = Qt::UserRole + 1, // the input, a QString
+        OutputRole,                   // the output of the last execution, a QString
+        ExpectedRole,                 // the expected output, a QString
+        VerdictRole,                  // the verdict of the last execution, a TestCase::Verdict
+        DetailsRole,                  // the time used and the performance counters of the last execution
+        UsageRole,                    // the live resource usage of the running execution
+        RuntimeHistoryRole,           // the time used by the recent executions
+        SplitterSizesRole             // the sizes of the splitter between the input, the output and the expected
+    };
+
+    // everything about a test case
+    struct TestCaseData
+    {
+        Core::TestData input;
+        QString output;
+        Core::TestData expected;
+        bool checked = true;
+        TestCase::Verdict verdict = TestCase::UNKNOWN;
+        bool lastFailed = false;                              // whether the last verdict is not AC, kept when cleared
+        int failures = 0;                                     // the number of executions which are not accepted
+        qint64 timeUsed = -1;                                 // the time used by the last execution, -1 if none
+        Core::PerfCounters::Counters perfCounters;            // the hardware events counted in the last execution
+        bool running = false;                                 // whether the live resource usage is available
+        int cpuUsage = 0;                                     // the CPU usage of the running execution in percent
+        qint64 memoryUsed = 0;                                // the resident set size of the running execution in bytes
+        QVector<Core::RuntimeHistory::Sample> runtimeHistory; // the recent executions, the oldest first
+        bool regressed = false;                               // whether the latest build is slower than before
+        QList<int> splitterSizes;                             // empty if the splitter is never moved
+
+        /**
+         * @brief get the id of the test case, the SHA-1 of the hashes of the input and the expected output
+         * @note the id doesn't depend on the position, so it's stable when the test cases are reordered, and the
+         *       duplicate test cases have the same id
+         */
+        QByteArray id() const;
+    };
+
+    explicit TestCasesModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+
+    /**
+     * @brief get a test case
+     * @note the row must be valid
+     */
+    const TestCaseData &testCase(int row) const;
+
+    /**
+     * @brief get the id of a test case, it's cached until the test case is changed
+     * @note the row must be valid
+     */
+    QByteArray id(int row) const;
+
+    /**
+     * @brief get the number of test cases with an id
+     */
+    int idCount(const QByteArray &id) const;
+
+    /**
+     * @brief get the first row with an id, -1 if there is none
+     */
+    int firstRowOf(const QByteArray &id) const;
+
+    /**
+     * @brief append test cases at the end in a single insertion
+     * @note the extra inputs or expecteds are ignored if their numbers are different
+     */
+    void appendTestCases(const QVector<Core::TestData> &inputs, const QVector<Core::TestData> &expecteds);
+
+    /**
+     * @brief remove all test cases
+     */
+    void clear();
+
+    void setInput(int row, const Core::TestData &input);
+    void setOutput(int row, const QString &output);
+    void setExpected(int row, const Core::TestData &expected);
+    void setChecked(int row, bool checked);
+    void setVerdict(int row, TestCase::Verdict verdict);
+    void setTimeUsed(int row, qint64 timeUsed);
+    void setPerfCounters(int row, const Core::PerfCounters::Counters &counters);
+    void setUsage(int row, int cpuUsage, qint64 memoryUsed);
+    void clearUsage(int row);
+    void setRuntimeHistory(int row, const QVector<Core::RuntimeHistory::Sample> &samples, bool regressed);
+    void setSplitterSizes(int row, const QList<int> &sizes);
+
+    /**
+     * @brief clear the output, the verdict and the performance counters of a test case
+     */
+    void clearOutput(int row);
+
+    int acceptedCount() const;
+    int unacceptedCount() const;
+
+  signals:
+    /**
+     * @brief the verdict of a test case is changed, or test cases are added or removed
+     */
+    void verdictsChanged();
+
+  private:
+    /**
+     * @brief emit dataChanged for a role of a row
+     */
+    void notify(int row, int role);
+
+    /**
+     * @brief add the verdict of a test case to the counts, or remove it with a negative delta
+     */
+    void countVerdict(TestCase::Verdict verdict, int delta);
+
+    /**
+     * @brief remove the id of a row from the counts, it's counted again when it's needed
+     */
+    void uncountId(int row);
+
+    QVector<TestCaseData> testcases;
+    int accepted = 0;                        // the number of test cases with the AC verdict
+    int unaccepted = 0;                      // the number of test cases with a verdict other than AC and UNKNOWN
+    mutable QVector<QByteArray> ids;         // the id of each row, empty if it's not counted
+    mutable QHash<QByteArray, int> idCounts; // the number of the counted rows with each id
+    mutable int uncountedRows = 0;           // the number of the rows whose ids are not counted
+};
+} // namespace Widgets
+
+#endif // TESTCASESMODEL_HPP
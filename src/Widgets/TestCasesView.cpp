@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+#include "Widgets/TestCasesView.hpp"
+#include "Core/EventLogger.hpp"
+#include "Widgets/TestCase.hpp"
+#include "Widgets/TestCasesModel.hpp"
+#include <QEvent>
+#include <QHash>
+#include <QScrollBar>
+#include <QTimer>
+
+namespace Widgets
+{
+TestCasesView::TestCasesView(TestCasesModel *model, MessageLogger *logger, QWidget *parent)
+    : QAbstractScrollArea(parent), model(model), log(logger)
+{
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    viewport()->setBackgroundRole(QPalette::NoRole);
+    // the widgets post layout requests to the viewport when their heights change
+    viewport()->installEventFilter(this);
+    verticalScrollBar()->setSingleStep(fontMetrics().height() * 2);
+
+    heights.fill(0, model->rowCount());
+
+    connect(model, &TestCasesModel::rowsInserted, this, &TestCasesView::onRowsInserted);
+    connect(model, &TestCasesModel::rowsRemoved, this, &TestCasesView::onRowsRemoved);
+    connect(model, &TestCasesModel::modelReset, this, &TestCasesView::onModelReset);
+}
+
+void TestCasesView::setTestCaseEditFont(const QFont &font)
+{
+    editFont = font;
+    hasEditFont = true;
+    for (auto *widget : qAsConst(pool))
+        widget->setTestCaseEditFont(font);
+}
+
+void TestCasesView::updateHeights()
+{
+    for (auto *widget : qAsConst(pool))
+    {
+        if (widget->row() != -1)
+            widget->updateHeight();
+    }
+}
+
+void TestCasesView::scrollToRow(int row)
+{
+    if (row < 0 || row >= heights.size())
+        return;
+
+    updatePrefixSums();
+    const int top = int(rowTop(row));
+
+    auto *scrollBar = verticalScrollBar();
+    if (top < scrollBar->value())
+        scrollBar->setValue(top);
+    else if (top + rowHeight(row) > scrollBar->value() + viewport()->height())
+        scrollBar->setValue(top + rowHeight(row) - viewport()->height());
+}
+
+bool TestCasesView::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == viewport() && event->type() == QEvent::LayoutRequest)
+        scheduleLayout();
+    return QAbstractScrollArea::eventFilter(watched, event);
+}
+
+void TestCasesView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    layoutRows();
+}
+
+void TestCasesView::scrollContentsBy(int, int)
+{
+    layoutRows();
+}
+
+void TestCasesView::onRowsInserted(const QModelIndex &, int first, int last)
+{
+    heights.insert(first, last - first + 1, 0);
+    invalidatePrefixSums(first);
+
+    // the rows after the inserted rows are moved
+    for (auto *widget : qAsConst(pool))
+    {
+        if (widget->row() >= first)
+        {
+            widget->hide();
+            widget->setRow(-1);
+        }
+    }
+
+    scheduleLayout();
+}
+
+void TestCasesView::onRowsRemoved(const QModelIndex &, int first, int last)
+{
+    for (int i = first; i <= last; ++i)
+    {
+        if (heights[i] > 0)
+        {
+            measuredHeight -= heights[i];
+            --measuredRows;
+        }
+    }
+    heights.remove(first, last - first + 1);
+    invalidatePrefixSums(first);
+
+    // the rows after the removed rows are moved
+    for (auto *widget : qAsConst(pool))
+    {
+        if (widget->row() >= first)
+        {
+            widget->hide();
+            widget->setRow(-1);
+        }
+    }
+
+    scheduleLayout();
+}
+
+void TestCasesView::onModelReset()
+{
+    heights.fill(0, model->rowCount());
+    measuredHeight = 0;
+    measuredRows = 0;
+    invalidatePrefixSums(0);
+    unbindAll();
+    scheduleLayout();
+}
+
+void TestCasesView::scheduleLayout()
+{
+    if (layoutScheduled)
+        return;
+    layoutScheduled = true;
+    QTimer::singleShot(0, this, [this] {
+        layoutScheduled = false;
+        layoutRows();
+    });
+}
+
+void TestCasesView::layoutRows()
+{
+    updateScrollBar();
+
+    const int rows = heights.size();
+    const int position = verticalScrollBar()->value();
+
+    // find the first visible row, which is the first row whose bottom is below the position
+    int row = 0;
+    int high = rows;
+    while (row < high)
+    {
+        const int middle = (row + high) / 2;
+        if (rowTop(middle + 1) <= position)
+            row = middle + 1;
+        else
+            high = middle;
+    }
+    const int top = int(rowTop(row));
+
+    // the widgets already bound to the visible rows are kept, so that the editors don't lose the cursors
+    QHash<int, TestCase *> bound;
+    QVector<TestCase *> spare;
+    for (auto *widget : qAsConst(pool))
+    {
+        if (widget->row() >= row)
+            bound.insert(widget->row(), widget);
+        else
+            spare.push_back(widget);
+    }
+
+    bool heightsChanged = false;
+    for (int y = top - position; row < rows && y < viewport()->height(); ++row)
+    {
+        auto *widget = bound.take(row);
+        if (widget == nullptr)
+        {
+            widget = spare.isEmpty() ? createWidget() : spare.takeLast();
+            widget->setRow(row);
+        }
+
+        const int height = qMax(widget->sizeHint().height(), widget->minimumSizeHint().height());
+        if (heights[row] != height)
+        {
+            if (heights[row] > 0)
+                measuredHeight -= heights[row];
+            else
+                ++measuredRows;
+            measuredHeight += height;
+            heights[row] = height;
+            invalidatePrefixSums(row);
+            heightsChanged = true;
+        }
+
+        widget->setGeometry(0, y, viewport()->width(), height);
+        widget->show();
+        y += height;
+    }
+
+    for (auto *widget : qAsConst(bound))
+        spare.push_back(widget);
+    for (auto *widget : qAsConst(spare))
+    {
+        if (widget->row() != -1)
+        {
+            widget->hide();
+            widget->setRow(-1);
+        }
+    }
+
+    // the range is updated later, changing it here may scroll the view while it's being laid out
+    if (heightsChanged)
+        scheduleLayout();
+}
+
+void TestCasesView::updateScrollBar()
+{
+    updatePrefixSums();
+    const qint64 total = rowTop(heights.size());
+
+    auto *scrollBar = verticalScrollBar();
+    const QSignalBlocker blocker(scrollBar);
+    scrollBar->setPageStep(viewport()->height());
+    scrollBar->setRange(0, int(qMax(qint64(0), total - viewport()->height())));
+}
+
+int TestCasesView::rowHeight(int row) const
+{
+    return heights[row] > 0 ? heights[row] : unmeasuredHeight();
+}
+
+int TestCasesView::unmeasuredHeight() const
+{
+    if (measuredRows > 0)
+        return int(measuredHeight / measuredRows);
+    return fontMetrics().height() * 8;
+}
+
+qint64 TestCasesView::rowTop(int row) const
+{
+    // the average height changes when a row is measured, so the unmeasured rows are counted instead of summed
+    return measuredTops[row] + qint64(unmeasuredTops[row]) * unmeasuredHeight();
+}
+
+void TestCasesView::invalidatePrefixSums(int row)
+{
+    validTops = qMin(validTops, row);
+}
+
+void TestCasesView::updatePrefixSums()
+{
+    const int rows = heights.size();
+    measuredTops.resize(rows + 1);
+    unmeasuredTops.resize(rows + 1);
+    measuredTops[0] = 0;
+    unmeasuredTops[0] = 0;
+    for (int row = qMin(validTops, rows); row < rows; ++row)
+    {
+        measuredTops[row + 1] = measuredTops[row] + heights[row];
+        unmeasuredTops[row + 1] = unmeasuredTops[row] + (heights[row] > 0 ? 0 : 1);
+    }
+    validTops = rows;
+}
+
+void TestCasesView::unbindAll()
+{
+    for (auto *widget : qAsConst(pool))
+    {
+        widget->hide();
+        widget->setRow(-1);
+    }
+}
+
+TestCase *TestCasesView::createWidget()
+{
+    LOG_INFO(INFO_OF(pool.size()));
+    auto *widget = new TestCase(model, log, viewport());
+    if (hasEditFont)
+        widget->setTestCaseEditFont(editFont);
+    connect(widget, &TestCase::requestDelete, this, &TestCasesView::requestDelete);
+    connect(widget, &TestCase::requestRun, this, &TestCasesView::requestRun);
+    connect(widget, &TestCase::requestProfile, this, &TestCasesView::requestProfile);
+    connect(widget, &TestCase::requestExecutionCounts, this, &TestCasesView::requestExecutionCounts);
+    connect(widget, &TestCase::requestKill, this, &TestCasesView::requestKill);
+    connect(widget, &TestCase::requestDiff, this, &TestCasesView::requestDiff);
+    pool.push_back(widget);
+    return widget;
+}
+} // namespace Widgets
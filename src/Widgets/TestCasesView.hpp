@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The TestCasesView shows the rows of a TestCasesModel in a vertical list, but only the visible rows have widgets.
+ * A small pool of TestCase widgets is bound to the visible rows, and they are bound to other rows when the view is
+ * scrolled, so the number of widgets depends on the height of the view instead of the number of test cases.
+ * The heights of the rows are measured when they are shown, and the average height is used for the other rows.
+ * The tops of the rows are kept as prefix sums of the measured heights and the numbers of the unmeasured rows, so the
+ * first visible row is found by a binary search, and only the sums after a changed row are updated.
+ */
+
+#ifndef TESTCASESVIEW_HPP
+#define TESTCASESVIEW_HPP
+
+#include <QAbstractScrollArea>
+#include <QFont>
+#include <QVector>
+
+class MessageLogger;
+
+namespace Widgets
+{
+class TestCase;
+class TestCasesModel;
+
+class TestCasesView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+  public:
+    explicit TestCasesView(TestCasesModel *model, MessageLogger *logger, QWidget *parent = nullptr);
+
+    /**
+     * @brief set the font of the test case editors, including the ones created later
+     */
+    void setTestCaseEditFont(const QFont &font);
+
+    /**
+     * @brief update the heights of the test case editors of the visible rows
+     */
+    void updateHeights();
+
+    /**
+     * @brief scroll the view so that a row is visible
+     */
+    void scrollToRow(int row);
+
+  signals:
+    void requestDelete(int index);
+    void requestRun(int index);
+    void requestProfile(int index);
+    void requestExecutionCounts(int index);
+    void requestKill(int index);
+    void requestDiff(int index);
+
+  protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+  private slots:
+    void onRowsInserted(const QModelIndex &parent, int first, int last);
+    void onRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onModelReset();
+
+  private:
+    /**
+     * @brief lay out the widgets of the visible rows later, the layout requests of the same event are merged
+     */
+    void scheduleLayout();
+
+    /**
+     * @brief bind the widgets to the visible rows and place them
+     */
+    void layoutRows();
+
+    /**
+     * @brief update the range of the scroll bar by the heights of the rows
+     */
+    void updateScrollBar();
+
+    /**
+     * @brief the height of a row, the average measured height if it's not measured
+     */
+    int rowHeight(int row) const;
+
+    /**
+     * @brief the height used for the rows which are not measured
+     */
+    int unmeasuredHeight() const;
+
+    /**
+     * @brief the top of a row in the contents, the total height if row is the number of rows
+     * @note updatePrefixSums should be called before this
+     */
+    qint64 rowTop(int row) const;
+
+    /**
+     * @brief mark the prefix sums after a row as outdated, it's called when the heights of the rows are changed
+     */
+    void invalidatePrefixSums(int row);
+
+    /**
+     * @brief update the outdated prefix sums
+     */
+    void updatePrefixSums();
+
+    /**
+     * @brief unbind all widgets, it's used when the rows are moved
+     */
+    void unbindAll();
+
+    TestCase *createWidget();
+
+    TestCasesModel *model;
+    MessageLogger *log;
+    QVector<TestCase *> pool;     // the widgets, bound to the visible rows or unbound
+    QVector<int> heights;         // the measured height of each row, 0 if it's not measured
+    qint64 measuredHeight = 0;    // the sum of the measured heights
+    int measuredRows = 0;         // the number of the measured rows
+    QVector<qint64> measuredTops; // the sum of the measured heights of the rows before each row, and of all rows
+    QVector<int> unmeasuredTops;  // the number of the unmeasured rows before each row, and of all rows
+    int validTops = 0;            // the prefix sums are up to date until the top of this row
+    bool layoutScheduled = false;
+    QFont editFont;
+    bool hasEditFont = false;
+};
+} // namespace Widgets
+
+#endif // TESTCASESVIEW_HPP
@@ -21,6 +21,7 @@
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
 #include "Core/SessionManager.hpp"
+#include "Core/SpeedCalibration.hpp"
 #include "Core/StyleManager.hpp"
 #include "Core/Translator.hpp"
 #include "Extensions/CFTool.hpp"
@@ -277,6 +278,14 @@ void AppWindow::setConnections()
 
     connect(preferencesWindow, &PreferencesWindow::settingsApplied, this, &AppWindow::onSettingsApplied);
 
+    for (auto *languageServer : {cppServer, javaServer, pythonServer})
+    {
+        connect(languageServer, &Extensions::LanguageServer::squigglesReset, this, [this] {
+            if (currentWindow() != nullptr)
+                currentWindow()->showPerformanceHints();
+        });
+    }
+
     connect(server, &Extensions::CompanionServer::onRequestArrived, this, &AppWindow::onIncomingCompanionRequest);
 
     connect(trayIcon, &QSystemTrayIcon::activated, this, &AppWindow::onTrayIconActivated);
@@ -429,6 +438,7 @@ void AppWindow::openTab(MainWindow *window, MainWindow *after)
             [this](QString const &head, QString const &body) { trayIcon->showMessage(head, body); });
     connect(window, &MainWindow::compileOrRunTriggered, this, &AppWindow::onCompileOrRunTriggered);
     connect(window, &MainWindow::fileSaved, this, &AppWindow::onFileSaved);
+    connect(window, &MainWindow::performanceHintsChanged, this, &AppWindow::onPerformanceHintsChanged);
 
     ui->tabWidget->setCurrentIndex(
         ui->tabWidget->insertTab(after ? ui->tabWidget->indexOf(after) + 1 : ui->tabWidget->currentIndex() + 1, window,
@@ -774,7 +784,7 @@ void AppWindow::on_actionExportSession_triggered()
                                             tr("CP Editor Session File") + " (*.json)");
     if (!path.isEmpty())
     {
-        if (!Util::saveFile(path, sessionManager->currentSessionText(), "Export Session"))
+        if (!Util::saveFile(path, sessionManager->currentSessionText(true), "Export Session"))
         {
             QMessageBox::warning(this, tr("Export Session"),
                                  tr("Failed to export the current session to [%1]").arg(path));
@@ -972,6 +982,21 @@ void AppWindow::onEditorTextChanged(MainWindow *window)
     }
 }
 
+void AppWindow::onPerformanceHintsChanged(MainWindow *window)
+{
+    // the squiggles can't be removed one by one, so the diagnostics of the language server are added again
+    for (auto *languageServer : {cppServer, javaServer, pythonServer})
+    {
+        if (languageServer->isAttachedTo(window->getEditor()))
+        {
+            languageServer->redrawSquiggles(); // the hints are shown again in the handler of squigglesReset
+            return;
+        }
+    }
+    window->getEditor()->clearSquiggle();
+    window->showPerformanceHints();
+}
+
 void AppWindow::updateLanguageServerFilePath(MainWindow *window, const QString &path)
 {
     if (currentWindow() == window)
@@ -1055,6 +1080,14 @@ void AppWindow::onSettingsApplied(const QString &pagePath)
             server->updatePort(0);
     }
 
+    if (pageChanged("Advanced/Limits"))
+    {
+        // the benchmark is run only once, it can be run again by Actions->Calibrate Time Limits
+        if (SettingsHelper::isTimeLimitCalibrationScaleTimeLimits() &&
+            SettingsHelper::getTimeLimitCalibrationBenchmarkTime() == 0)
+            Core::SpeedCalibration::instance()->calibrate();
+    }
+
     if (pageChanged("Appearance/General"))
     {
         setWindowOpacity(SettingsHelper::getOpacity() / 100.0);
@@ -1247,6 +1280,22 @@ void AppWindow::on_actionRunDetached_triggered()
     }
 }
 
+void AppWindow::on_actionEstimateComplexity_triggered()
+{
+    if (currentWindow() != nullptr)
+    {
+        currentWindow()->estimateComplexity();
+    }
+}
+
+void AppWindow::on_actionCalibrateTimeLimits_triggered()
+{
+    if (currentWindow() != nullptr)
+    {
+        currentWindow()->calibrateTimeLimits();
+    }
+}
+
 void AppWindow::on_actionKillProcesses_triggered()
 {
     if (currentWindow() != nullptr)
@@ -1529,6 +1578,7 @@ MainWindow *AppWindow::currentWindow()
 void AppWindow::reAttachLanguageServer(MainWindow *window)
 {
     window->getEditor()->clearSquiggle();
+    window->showPerformanceHints();
     lspTimerCpp->stop();
     lspTimerJava->stop();
     lspTimerPython->stop();
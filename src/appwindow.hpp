@@ -140,6 +140,10 @@ class AppWindow : public QMainWindow
 
     void on_actionRunDetached_triggered();
 
+    void on_actionEstimateComplexity_triggered();
+
+    void on_actionCalibrateTimeLimits_triggered();
+
     void on_actionKillProcesses_triggered();
 
     void on_actionUseSnippets_triggered();
@@ -186,6 +190,8 @@ class AppWindow : public QMainWindow
 
     void onEditorTextChanged(MainWindow *window);
 
+    void onPerformanceHintsChanged(MainWindow *window);
+
     void updateLanguageServerFilePath(MainWindow *window, const QString &path);
 
     void onEditorLanguageChanged(MainWindow *window);
@@ -21,7 +21,13 @@
 #include "Core/Compiler.hpp"
 #include "Core/EventLogger.hpp"
 #include "Core/MessageLogger.hpp"
+#include "Core/PerformanceAdvisor.hpp"
 #include "Core/Runner.hpp"
+#include "Core/RuntimeRecorder.hpp"
+#include "Core/SessionManager.hpp"
+#include "Core/SpeedCalibration.hpp"
+#include "Core/TestIOThread.hpp"
+#include "Core/VerdictCache.hpp"
 #include "Extensions/CFTool.hpp"
 #include "Extensions/ClangFormatter.hpp"
 #include "Extensions/CompanionServer.hpp"
@@ -31,6 +37,8 @@
 #include "Settings/PreferencesWindow.hpp"
 #include "Util/FileUtil.hpp"
 #include "Util/QCodeEditorUtil.hpp"
+#include "Widgets/ComplexityDialog.hpp"
+#include "Widgets/HeatGutter.hpp"
 #include "Widgets/Stopwatch.hpp"
 #include "Widgets/TestCases.hpp"
 #include "Widgets/ProblemDialog.hpp"
@@ -38,7 +46,9 @@
 #include "generated/SettingsHelper.hpp"
 #include "generated/version.hpp"
 #include <QCodeEditor>
+#include <QDateTime>
 #include <QFileSystemWatcher>
+#include <QHBoxLayout>
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QMimeData>
@@ -47,6 +57,7 @@
 #include <QTemporaryDir>
 #include <QTextBlock>
 #include <QTimer>
+#include <cmath>
 
 #include "../ui/ui_mainwindow.h"
 
@@ -61,6 +72,8 @@ MainWindow::MainWindow(int index, AppWindow *parent)
 {
     LOG_INFO(INFO_OF(index));
 
+    verdictCache = new Core::VerdictCache();
+
     ui->setupUi(this);
 
     log = new MessageLogger(appWindow->getPreferencesWindow(), this);
@@ -70,6 +83,10 @@ MainWindow::MainWindow(int index, AppWindow *parent)
     ui->testCasesLayout->addWidget(testcases);
     connect(testcases, &Widgets::TestCases::checkerChanged, this, &MainWindow::updateChecker);
     connect(testcases, &Widgets::TestCases::requestRun, this, &MainWindow::runTestCase);
+    connect(testcases, &Widgets::TestCases::requestProfile, this, &MainWindow::profileTestCase);
+    connect(testcases, &Widgets::TestCases::requestExecutionCounts, this, &MainWindow::showExecutionCounts);
+    connect(testcases, &Widgets::TestCases::requestKill, this, &MainWindow::killTestCase);
+    ui->resourceUsage->hide();
 
     problemDialog = new Widgets::ProblemDialog();
     problemDialog->showNormal();
@@ -105,6 +122,7 @@ MainWindow::~MainWindow()
 
     delete cftool;
     delete tmpDir;
+    delete verdictCache;
 
     delete ui;
     delete autoSaveTimer;
@@ -121,7 +139,13 @@ void MainWindow::setEditor()
     editor->setSizePolicy(QSizePolicy::Policy::Expanding, QSizePolicy::Policy::Expanding);
     editor->setAcceptDrops(false);
 
-    ui->editorArea->addWidget(editor);
+    // the heat gutter is beside the line numbers, it's shown after profiling
+    heatGutter = new Widgets::HeatGutter(editor, this);
+    auto *editorLayout = new QHBoxLayout();
+    editorLayout->setSpacing(0);
+    editorLayout->addWidget(heatGutter);
+    editorLayout->addWidget(editor);
+    ui->editorArea->addLayout(editorLayout);
 
     connect(editor, &QCodeEditor::textChanged, this, &MainWindow::onTextChanged);
     connect(editor, &QCodeEditor::fontChanged, this, &MainWindow::onEditorFontChanged);
@@ -143,6 +167,8 @@ void MainWindow::compile()
     if (SettingsHelper::isSaveFileOnCompilation())
         saveFile(IgnoreUntitled, tr("Compiler"), true);
 
+    updatePerformanceHints();
+
     killProcesses();
 
     compiler = new Core::Compiler();
@@ -151,13 +177,13 @@ void MainWindow::compile()
     if (path.isEmpty())
         return;
 
-    if (language == "Python")
+    if (language == "Python" && !SettingsHelper::isPythonPrecompile())
     {
         onCompilationFinished("");
         return;
     }
 
-    if (language != "C++" && language != "Java")
+    if (language != "C++" && language != "Java" && language != "Python")
     {
         log->warn(tr("Compiler"), tr("Please set the language"));
         return;
@@ -168,7 +194,8 @@ void MainWindow::compile()
     connect(compiler, &Core::Compiler::compilationErrorOccurred, this, &MainWindow::onCompilationErrorOccurred);
     connect(compiler, &Core::Compiler::compilationFailed, this, &MainWindow::onCompilationFailed);
     connect(compiler, &Core::Compiler::compilationKilled, this, &MainWindow::onCompilationKilled);
-    compiler->start(path, filePath, compileCommand(), language);
+    compiler->start(path, filePath, language == "Python" ? SettingsHelper::getPythonRunCommand() : compileCommand(),
+                    language);
 }
 
 void MainWindow::run()
@@ -186,19 +213,40 @@ void MainWindow::run()
         return;
     }
 
+    if (testcases->isLoading())
+        log->warn(tr("Runner"), tr("The test cases are still being loaded, only the loaded test cases are executed"));
+
     checker->clearTasks();
+    runRecords.clear();
+    updateVerdictCache();
+
+    const bool runChangedOnly = SettingsHelper::isRunChangedTestcasesOnly();
+    int reused = 0;
+    QVector<int> indexes;
 
     for (int i = 0; i < testcases->count(); ++i)
     {
-        if ((!testcases->input(i).trimmed().isEmpty() || SettingsHelper::isRunOnEmptyTestcase()) &&
+        if ((!testcases->inputData(i).isBlank() || SettingsHelper::isRunOnEmptyTestcase()) &&
             testcases->isChecked(i))
         {
-            run(i);
+            if (runChangedOnly && reuseAcceptedResult(i))
+                ++reused;
+            else
+                indexes.push_back(i);
         }
     }
 
-    if (runner.empty())
-        log->warn(tr("Runner"), tr("All inputs are empty, nothing to run"));
+    if (indexes.isEmpty())
+    {
+        if (reused == 0)
+            log->warn(tr("Runner"), tr("All inputs are empty, nothing to run"));
+        else
+            log->info(tr("Runner"), tr("All test cases are unchanged and accepted, nothing to run"));
+        return;
+    }
+
+    pendingRuns = testcases->executionOrder(indexes, SettingsHelper::getTestcaseExecutionOrder());
+    startPendingRuns();
 }
 
 void MainWindow::run(int index)
@@ -212,13 +260,184 @@ void MainWindow::run(int index)
     auto *tmp = new Core::Runner(index);
     connect(tmp, &Core::Runner::runStarted, this, &MainWindow::onRunStarted);
     connect(tmp, &Core::Runner::runFinished, this, &MainWindow::onRunFinished);
+    connect(tmp, &Core::Runner::runCountersRead, this, &MainWindow::onRunCountersRead);
     connect(tmp, &Core::Runner::failedToStartRun, this, &MainWindow::onFailedToStartRun);
     connect(tmp, &Core::Runner::runOutputLimitExceeded, this, &MainWindow::onRunOutputLimitExceeded);
     connect(tmp, &Core::Runner::runKilled, this, &MainWindow::onRunKilled);
+    connect(tmp, &Core::Runner::runUsageSampled, this, &MainWindow::onRunUsageSampled);
+    runner.push_back(tmp);
+    runRecords[index] = {verdictCacheKey(index), QString(), 0};
+    ++runningCount; // failedToStartRun may be emitted in Runner::run
     tmp->run(tmpPath(), filePath, language, SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
-             SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString(), testcases->input(index),
+             SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString(), testcases->inputData(index),
              timeLimit());
-    runner.push_back(tmp);
+}
+
+void MainWindow::startPendingRuns()
+{
+    // 0 means no limit, then all test cases are started at once
+    const int limit = SettingsHelper::getParallelExecutionsLimit();
+    while (!pendingRuns.isEmpty() && (limit == 0 || runningCount < limit))
+        run(pendingRuns.takeFirst());
+    if (pendingRuns.isEmpty() && runningCount == 0)
+        saveRuntimes();
+}
+
+void MainWindow::clearRunUsage(int index)
+{
+    testcases->clearUsage(index);
+    runUsages.remove(index);
+    updateResourceUsage();
+}
+
+void MainWindow::clearRunUsages()
+{
+    for (auto it = runUsages.cbegin(); it != runUsages.cend(); ++it)
+        testcases->clearUsage(it.key());
+    runUsages.clear();
+    updateResourceUsage();
+}
+
+void MainWindow::updateResourceUsage()
+{
+    if (runUsages.isEmpty())
+    {
+        ui->resourceUsage->hide();
+        return;
+    }
+
+    int cpuUsage = 0;
+    qint64 memoryUsed = 0;
+    for (const auto &usage : runUsages)
+    {
+        cpuUsage += usage.cpuUsage;
+        memoryUsed += usage.memoryUsed;
+    }
+    ui->resourceUsage->setText(tr("Running %1: CPU %2% · %3 MB")
+                                   .arg(runUsages.size())
+                                   .arg(cpuUsage)
+                                   .arg(QString::number(memoryUsed / 1048576.0, 'f', 1)));
+    ui->resourceUsage->show();
+}
+
+void MainWindow::startComplexityEstimation()
+{
+    killProcesses();
+
+    if (!QStringList({"C++", "Java", "Python"}).contains(language))
+    {
+        log->warn(tr("Complexity Estimator"), tr("Wrong language, please set the language"));
+        return;
+    }
+
+    complexityEstimator = new Core::ComplexityEstimator(SettingsHelper::getComplexityEstimatorGeneratorCommand(),
+                                                        SettingsHelper::getComplexityEstimatorMinimumSize(),
+                                                        SettingsHelper::getComplexityEstimatorMaximumSize(),
+                                                        SettingsHelper::getComplexityEstimatorGrowthFactor());
+    connect(complexityEstimator, &Core::ComplexityEstimator::measured, this, &MainWindow::onComplexityMeasured);
+    connect(complexityEstimator, &Core::ComplexityEstimator::finished, this, &MainWindow::onComplexityEstimated);
+    connect(complexityEstimator, &Core::ComplexityEstimator::failed, this, &MainWindow::onComplexityEstimationFailed);
+    complexityEstimator->start(tmpPath(), filePath, language,
+                               SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
+                               SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString(),
+                               timeLimit());
+}
+
+void MainWindow::stopRunsAfterUnaccepted(int index)
+{
+    if (!SettingsHelper::isStopAtFirstUnacceptedTestcase() || (pendingRuns.isEmpty() && runningCount == 0))
+        return;
+
+    LOG_INFO("Stopping executions after " << INFO_OF(index) << INFO_OF(pendingRuns.size()) << INFO_OF(runningCount));
+    log->warn(tr("Runner"), tr("Test case #%1 is not accepted, the other %2 test cases are stopped")
+                                .arg(index + 1)
+                                .arg(pendingRuns.size() + runningCount));
+
+    pendingRuns.clear();
+    runningCount = 0;
+    clearRunUsages();
+    saveRuntimes();
+
+    // This is called in the slots of the runners, so the runners can't be deleted immediately.
+    // Disconnect them to ignore the results of the killed executions.
+    for (auto &t : runner)
+    {
+        t->disconnect(this);
+        t->deleteLater();
+    }
+    runner.clear();
+}
+
+void MainWindow::updateVerdictCache()
+{
+    executableHash =
+        Core::VerdictCache::executableHash(tmpPath(), filePath, language,
+                                           SettingsManager::get(QString("%1/Run Command").arg(language)).toString(),
+                                           SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString());
+    verdictCache->setExecutableHash(executableHash);
+}
+
+QByteArray MainWindow::verdictCacheKey(int index) const
+{
+    return Core::VerdictCache::key(testcases->testCaseId(index), checker->identity(), timeLimit());
+}
+
+bool MainWindow::reuseAcceptedResult(int index)
+{
+    const auto key = verdictCacheKey(index);
+    if (!verdictCache->contains(key))
+        return false;
+
+    const auto result = verdictCache->result(key);
+    LOG_INFO("Reusing the accepted result of " << INFO_OF(index));
+    log->info(getRunnerHead(index),
+              tr("Test case #%1 is unchanged, reused the accepted result in %2ms").arg(index + 1).arg(result.timeUsed));
+    testcases->setOutput(index, result.output);
+    testcases->setVerdict(index, Widgets::TestCase::AC);
+    return true;
+}
+
+void MainWindow::recordRuntime(int index, qint64 timeUsed)
+{
+    if (!SettingsHelper::isTrackRuntimeHistory() || executableHash.isEmpty())
+        return;
+
+    const auto problem = !problemURL.isEmpty() ? problemURL : filePath;
+    if (problem.isEmpty())
+        return;
+
+    // the samples are recorded in one transaction when the run finishes, the samples of a problem are saved together
+    if (problem != runtimeProblem)
+    {
+        saveRuntimes();
+        runtimeProblem = problem;
+    }
+
+    Core::RuntimeHistory::Sample sample;
+    sample.build = executableHash;
+    sample.timeUsed = timeUsed;
+    sample.recordedAt = QDateTime::currentMSecsSinceEpoch();
+    if (runRecords.contains(index))
+        sample.memoryUsed = runRecords[index].peakMemoryUsed;
+    runtimeSamples.push_back({testcases->testCaseId(index), sample});
+}
+
+void MainWindow::saveRuntimes()
+{
+    if (runtimeSamples.isEmpty())
+        return;
+
+    Core::RuntimeRecorder::Task task;
+    task.problem = runtimeProblem;
+    task.samples = runtimeSamples;
+    task.historyLimit = 30; // the sparkline shows the last 30 executions
+    runtimeSamples.clear();
+
+    auto *recorder = new Core::RuntimeRecorder(task);
+    recorder->moveToThread(Core::TestIOThread::instance());
+    connect(recorder, &Core::RuntimeRecorder::finished, recorder, &QObject::deleteLater);
+    connect(recorder, &Core::RuntimeRecorder::finished, this, &MainWindow::onRuntimesRecorded);
+    QMetaObject::invokeMethod(recorder, "start", Qt::QueuedConnection);
 }
 
 void MainWindow::runTestCase(int index)
@@ -234,9 +453,292 @@ void MainWindow::runTestCase(int index)
         return;
     }
 
+    checker->clearTasks();
+    runRecords.clear();
+    updateVerdictCache();
+
     run(index);
 }
 
+void MainWindow::killTestCase(int index)
+{
+    LOG_INFO(INFO_OF(index));
+
+    for (int i = 0; i < runner.size(); ++i)
+    {
+        if (runner[i]->index() == index && runner[i]->isRunning())
+        {
+            // runKilled is emitted when it's deleted
+            delete runner.takeAt(i);
+            --runningCount;
+            clearRunUsage(index);
+            startPendingRuns();
+            return;
+        }
+    }
+}
+
+void MainWindow::profileTestCase(int index)
+{
+    LOG_INFO(INFO_OF(index));
+
+    if (language != "C++")
+    {
+        log->warn(tr("Profiler"), tr("Only C++ solutions can be profiled"));
+        return;
+    }
+
+    if (!Core::Profiler::isSupported())
+    {
+        log->warn(tr("Profiler"), tr("Profiling is only supported on Linux"));
+        return;
+    }
+
+    if (SettingsHelper::isSaveFileOnExecution())
+        saveFile(IgnoreUntitled, tr("Profiler"), true);
+
+    killProcesses();
+    log->clear();
+    heatGutter->clear();
+
+    auto path = tmpPath();
+    if (path.isEmpty())
+        return;
+
+    profiler = new Core::Profiler(index);
+    connect(profiler, &Core::Profiler::profilingStarted, this, &MainWindow::onProfilingStarted);
+    connect(profiler, &Core::Profiler::profilingFinished, this, &MainWindow::onProfilingFinished);
+    connect(profiler, &Core::Profiler::profilingFailed, this, &MainWindow::onProfilingFailed);
+    log->info(tr("Profiler"), tr("Compiling with debug information for profiling test case #%1").arg(index + 1));
+    profiler->start(path, filePath, compileCommand(),
+                    SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString(),
+                    testcases->inputData(index), timeLimit());
+}
+
+void MainWindow::onProfilingStarted(int index)
+{
+    log->info(tr("Profiler"), tr("Profiling on test case #%1").arg(index + 1));
+}
+
+void MainWindow::onProfilingFinished(int index, const Core::Profiler::Result &result)
+{
+    const int hotspots = 10;
+
+    if (result.totalSamples == 0)
+    {
+        log->warn(tr("Profiler"), tr("No samples are collected on test case #%1, it finished too quickly")
+                                      .arg(index + 1));
+        return;
+    }
+
+    const auto percentage = [&result](qint64 samples) {
+        return QString::number(100.0 * samples / result.totalSamples, 'f', 1) + '%';
+    };
+
+    QStringList lines;
+    lines.push_back(tr("Hot lines:"));
+    for (int i = 0; i < result.lines.size() && i < hotspots; ++i)
+    {
+        const auto &hotspot = result.lines[i];
+        lines.push_back(
+            tr("%1 line %2 in %3").arg(percentage(hotspot.samples), 6).arg(hotspot.line).arg(hotspot.function));
+    }
+    lines.push_back(tr("Hot functions:"));
+    for (int i = 0; i < result.functions.size() && i < hotspots; ++i)
+    {
+        const auto &hotspot = result.functions[i];
+        lines.push_back(QString("%1 %2").arg(percentage(hotspot.samples), 6).arg(hotspot.function));
+    }
+
+    log->info(tr("Profiler"), tr("Test case #%1 is profiled with %2 samples%3\n%4")
+                                  .arg(index + 1)
+                                  .arg(result.totalSamples)
+                                  .arg(result.timeLimitExceeded ? tr(", it's killed at the time limit") : QString())
+                                  .arg(lines.join('\n')));
+
+    heatGutter->setHeat(result.lineSamples, result.totalSamples);
+}
+
+void MainWindow::onProfilingFailed(int index, const QString &error)
+{
+    log->error(tr("Profiler"), tr("Failed to profile test case #%1: %2").arg(index + 1).arg(error));
+}
+
+void MainWindow::showExecutionCounts(int index)
+{
+    LOG_INFO(INFO_OF(index));
+
+    if (language != "C++")
+    {
+        log->warn(tr("Coverage"), tr("The execution counts are only available for C++ solutions"));
+        return;
+    }
+
+    if (SettingsHelper::isSaveFileOnExecution())
+        saveFile(IgnoreUntitled, tr("Coverage"), true);
+
+    killProcesses();
+    log->clear();
+    heatGutter->clear();
+
+    auto path = tmpPath();
+    if (path.isEmpty())
+        return;
+
+    coverageRunner = new Core::CoverageRunner(index);
+    connect(coverageRunner, &Core::CoverageRunner::coverageStarted, this, &MainWindow::onCoverageStarted);
+    connect(coverageRunner, &Core::CoverageRunner::coverageFinished, this, &MainWindow::onCoverageFinished);
+    connect(coverageRunner, &Core::CoverageRunner::coverageFailed, this, &MainWindow::onCoverageFailed);
+    log->info(tr("Coverage"), tr("Compiling the coverage build for test case #%1").arg(index + 1));
+    coverageRunner->start(path, filePath, compileCommand(),
+                          SettingsManager::get(QString("%1/Run Arguments").arg(language)).toString(),
+                          testcases->inputData(index), timeLimit());
+}
+
+void MainWindow::onCoverageStarted(int index)
+{
+    log->info(tr("Coverage"), tr("Counting the executions on test case #%1").arg(index + 1));
+}
+
+void MainWindow::onCoverageFinished(int index, const Core::CoverageRunner::Result &result)
+{
+    int hottestLine = 0;
+    for (auto it = result.lineCounts.cbegin(); it != result.lineCounts.cend(); ++it)
+    {
+        if (hottestLine == 0 || it.value() > result.lineCounts[hottestLine])
+            hottestLine = it.key();
+    }
+
+    log->info(tr("Coverage"), tr("On test case #%1, %2 of %3 lines are executed, line %4 is executed the most "
+                                 "(%5 times)")
+                                  .arg(index + 1)
+                                  .arg(result.executedLines)
+                                  .arg(result.lineCounts.size())
+                                  .arg(hottestLine)
+                                  .arg(result.lineCounts[hottestLine]));
+
+    heatGutter->setExecutionCounts(result.lineCounts);
+}
+
+void MainWindow::onCoverageFailed(int index, const QString &error)
+{
+    log->error(tr("Coverage"), tr("Failed to count the executions on test case #%1: %2").arg(index + 1).arg(error));
+}
+
+void MainWindow::onComplexityMeasured(const Core::ComplexityEstimator::Measurement &measurement)
+{
+    log->info(tr("Complexity Estimator"), tr("n = %1: %2ms").arg(measurement.size).arg(measurement.timeUsed));
+}
+
+void MainWindow::onComplexityEstimated(const QVector<Core::ComplexityEstimator::Measurement> &measurements,
+                                       qint64 exceededSize)
+{
+    // the timings shorter than this are mostly the startup time, so they can't tell the complexity
+    const qint64 reliableTime = 50;
+    const qint64 maximumSize = SettingsHelper::getComplexityEstimatorMaximumSize();
+
+    if (exceededSize > 0)
+    {
+        log->error(tr("Complexity Estimator"),
+                   tr("The time limit %1ms is exceeded at n = %2").arg(timeLimit()).arg(exceededSize));
+    }
+
+    const auto fits = Core::ComplexityEstimator::fit(measurements);
+    if (fits.isEmpty())
+    {
+        log->warn(tr("Complexity Estimator"),
+                  tr("At least three sizes within the time limit are needed to estimate the complexity, please use a "
+                     "smaller minimum size or a smaller growth factor"));
+        return;
+    }
+
+    const auto &best = fits.front();
+    const auto predicted = qint64(std::ceil(best.predict(maximumSize)));
+
+    QStringList others;
+    for (int i = 1; i < fits.size() && i < 4; ++i)
+        others.push_back(tr("%1 (error %2%)").arg(fits[i].complexity).arg(fits[i].error * 100, 0, 'f', 1));
+
+    log->info(tr("Complexity Estimator"), tr("The best fit is %1 with an error of %2%, the other close fits are %3")
+                                              .arg(best.complexity)
+                                              .arg(best.error * 100, 0, 'f', 1)
+                                              .arg(others.join(", ")));
+
+    const auto message = tr("The predicted time at n = %1 is %2ms, the time limit is %3ms")
+                             .arg(maximumSize)
+                             .arg(predicted)
+                             .arg(timeLimit());
+    if (predicted > timeLimit() || exceededSize > 0)
+        log->error(tr("Complexity Estimator"), message);
+    else
+        log->info(tr("Complexity Estimator"), message);
+
+    if (measurements.back().timeUsed < reliableTime)
+    {
+        log->warn(tr("Complexity Estimator"),
+                  tr("All sizes finish within %1ms, the estimation may be inaccurate").arg(reliableTime));
+    }
+}
+
+void MainWindow::onComplexityEstimationFailed(const QString &error)
+{
+    log->error(tr("Complexity Estimator"), error);
+}
+
+void MainWindow::onTimeLimitsCalibrated(qint64 benchmarkTime, double speedFactor)
+{
+    if (speedFactor < 0)
+    {
+        log->info(tr("Time Limit Calibration"), tr("The benchmark took %1ms").arg(benchmarkTime));
+        log->warn(tr("Time Limit Calibration"),
+                  tr("The time limits are not scaled until the benchmark time on the judge is set at %1")
+                      .arg(SettingsHelper::pathOfTimeLimitCalibrationReferenceBenchmarkTime()));
+        return;
+    }
+
+    log->info(tr("Time Limit Calibration"),
+              tr("The benchmark took %1ms, this machine is %2 times as slow as the reference judge")
+                  .arg(benchmarkTime)
+                  .arg(QString::number(speedFactor, 'f', 2)));
+    if (SettingsHelper::isTimeLimitCalibrationScaleTimeLimits())
+    {
+        log->info(tr("Time Limit Calibration"),
+                  tr("The time limit of this tab is %1ms on this machine").arg(timeLimit()));
+    }
+    else
+    {
+        log->warn(tr("Time Limit Calibration"), tr("The time limits are not scaled, you can enable it at %1")
+                                                    .arg(SettingsHelper::pathOfTimeLimitCalibrationScaleTimeLimits()));
+    }
+}
+
+void MainWindow::onRuntimesRecorded(const QString &problem, const Core::RuntimeHistory::Histories &histories)
+{
+    if (problem != (!problemURL.isEmpty() ? problemURL : filePath))
+        return;
+
+    // the test cases may have been changed since the run, so they are found by their ids
+    const auto threshold = SettingsHelper::getRuntimeRegressionThreshold() / 100.0;
+    for (int index = 0; index < testcases->count(); ++index)
+    {
+        const auto samples = histories.find(testcases->testCaseId(index));
+        if (samples == histories.end())
+            continue;
+        const auto regression = Core::RuntimeHistory::detectRegression(*samples, threshold);
+        testcases->setRuntimeHistory(index, *samples, regression.regressed);
+        if (regression.regressed)
+        {
+            log->warn(getRunnerHead(index),
+                      tr("Test case #%1 is slower than the previous build: %2ms -> %3ms, which is beyond the noise "
+                         "threshold of %4%")
+                          .arg(index + 1)
+                          .arg(regression.previousTime)
+                          .arg(regression.currentTime)
+                          .arg(qRound(regression.threshold * 100)));
+        }
+    }
+}
+
 void MainWindow::loadTests()
 {
     if (!isUntitled() && SettingsHelper::isSaveTests())
@@ -416,6 +918,8 @@ MainWindow::EditorStatus::EditorStatus(const QMap<QString, QVariant> &status)
     FROMSTATUS_DEFAULT(customTimeLimit, -1).toInt();
     FROMSTATUS(input).toStringList();
     FROMSTATUS(expected).toStringList();
+    FROMSTATUS(inputFiles).toStringList();
+    FROMSTATUS(expectedFiles).toStringList();
     FROMSTATUS(customCheckers).toStringList();
     FROMSTATUS(testcasesIsShow).toList();
     FROMSTATUS(testCaseSplitterStates).toList();
@@ -443,6 +947,8 @@ QMap<QString, QVariant> MainWindow::EditorStatus::toMap() const
     TOSTATUS(customTimeLimit);
     TOSTATUS(input);
     TOSTATUS(expected);
+    TOSTATUS(inputFiles);
+    TOSTATUS(expectedFiles);
     TOSTATUS(customCheckers);
     TOSTATUS(testcasesIsShow);
     TOSTATUS(testCaseSplitterStates);
@@ -450,7 +956,7 @@ QMap<QString, QVariant> MainWindow::EditorStatus::toMap() const
 }
 #undef TOSTATUS
 
-MainWindow::EditorStatus MainWindow::toStatus() const
+MainWindow::EditorStatus MainWindow::toStatus(bool inlineTests) const
 {
     EditorStatus status;
 
@@ -468,10 +974,18 @@ MainWindow::EditorStatus MainWindow::toStatus() const
     status.horizontalScrollBarValue = editor->horizontalScrollBar()->value();
     status.verticalScrollbarValue = editor->verticalScrollBar()->value();
     status.customTimeLimit = customTimeLimit;
-    status.input = testcases->inputs();
-    status.expected = testcases->expecteds();
+    // the file-backed test cases are referred to by their copies, so the large contents are not decoded every time
+    const auto addTest = [inlineTests](const Core::TestData &data, QStringList &texts, QStringList &files) {
+        const auto path = !inlineTests && data.isFileBacked() ? Core::SessionManager::testFilePath(data) : QString();
+        texts.push_back(path.isEmpty() ? data.text() : QString());
+        files.push_back(path);
+    };
     for (int i = 0; i < testcases->count(); ++i)
+    {
+        addTest(testcases->inputData(i), status.input, status.inputFiles);
+        addTest(testcases->expectedData(i), status.expected, status.expectedFiles);
         status.testcasesIsShow.push_back(testcases->isChecked(i));
+    }
     status.testCaseSplitterStates = testcases->splitterStates();
 
     return status;
@@ -500,7 +1014,7 @@ void MainWindow::loadStatus(const EditorStatus &status, bool duplicate)
     editor->horizontalScrollBar()->setValue(status.horizontalScrollBarValue);
     editor->verticalScrollBar()->setValue(status.verticalScrollbarValue);
     customTimeLimit = status.customTimeLimit;
-    testcases->loadStatus(status.input, status.expected);
+    testcases->loadStatus(status.input, status.expected, status.inputFiles, status.expectedFiles);
     for (int i = 0; i < status.testcasesIsShow.count() && i < testcases->count(); ++i)
         testcases->setChecked(i, status.testcasesIsShow[i].toBool());
     testcases->restoreSplitterStates(status.testCaseSplitterStates);
@@ -573,8 +1087,13 @@ void MainWindow::applyCompanion(const Extensions::CompanionData &data)
 
     testcases->clear();
 
+    QVector<Core::TestData> inputs, expecteds;
     for (auto const &testcase : data.testcases)
-        testcases->addTestCase(testcase.input, testcase.output);
+    {
+        inputs.push_back(testcase.input);
+        expecteds.push_back(testcase.output);
+    }
+    testcases->addTestCases(inputs, expecteds);
 
     setProblemURL(data.url);
 
@@ -614,10 +1133,10 @@ void MainWindow::applySettings(const QString &pagePath)
     }
 
     if (pageChanged("Appearance/General"))
-    {
         testcases->updateHeights();
+
+    if (pageChanged("Appearance/General") || pageChanged("Language/Python/Python Commands"))
         updateCompileAndRunButtons();
-    }
 
     if (pageChanged("Appearance/Font"))
     {
@@ -628,6 +1147,9 @@ void MainWindow::applySettings(const QString &pagePath)
     if (pageChanged("Language/C++/C++ Commands"))
         updateChecker();
 
+    if (pageChanged("Extensions/Performance Advisor"))
+        updatePerformanceHints();
+
     if (pageChanged("Actions/Auto Save"))
     {
         if (SettingsHelper::isAutoSave())
@@ -786,6 +1308,55 @@ void MainWindow::detachedExecution()
     compile();
 }
 
+void MainWindow::calibrateTimeLimits()
+{
+    log->info(tr("Time Limit Calibration"), tr("The benchmark is running, it takes a few seconds"));
+    connect(Core::SpeedCalibration::instance(), &Core::SpeedCalibration::calibrated, this,
+            &MainWindow::onTimeLimitsCalibrated, Qt::UniqueConnection);
+    Core::SpeedCalibration::instance()->calibrate();
+}
+
+void MainWindow::showPerformanceHints()
+{
+    for (const auto &finding : performanceFindings)
+    {
+        auto level = QCodeEditor::SeverityLevel::Warning;
+        if (finding.severity == Core::PerformanceAdvisor::Information)
+            level = QCodeEditor::SeverityLevel::Information;
+        else if (finding.severity == Core::PerformanceAdvisor::Hint)
+            level = QCodeEditor::SeverityLevel::Hint;
+        editor->squiggle(level, {finding.startLine, finding.startColumn}, {finding.endLine, finding.endColumn},
+                         tr("%1\nQuick fix: %2").arg(finding.message, finding.fix));
+    }
+}
+
+void MainWindow::updatePerformanceHints()
+{
+    if (!SettingsHelper::isPerformanceAdvisor())
+    {
+        if (performanceFindings.isEmpty())
+            return;
+        performanceFindings.clear();
+    }
+    else
+    {
+        performanceFindings = Core::PerformanceAdvisor::analyze(editor->toPlainText(), language);
+    }
+    emit performanceHintsChanged(this);
+}
+
+void MainWindow::estimateComplexity()
+{
+    LOG_INFO("Requested complexity estimation");
+    Widgets::ComplexityDialog dialog(this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+    emit compileOrRunTriggered();
+    afterCompile = EstimateComplexity;
+    log->clear();
+    compile();
+}
+
 void MainWindow::killProcesses()
 {
     LOG_INFO("Killing all processes");
@@ -809,6 +1380,10 @@ void MainWindow::killProcesses()
         delete t;
     }
     runner.clear();
+    pendingRuns.clear();
+    runningCount = 0;
+    clearRunUsages();
+    saveRuntimes();
 
     if (detachedRunner != nullptr)
     {
@@ -816,6 +1391,24 @@ void MainWindow::killProcesses()
         detachedRunner = nullptr;
     }
 
+    if (profiler != nullptr)
+    {
+        delete profiler;
+        profiler = nullptr;
+    }
+
+    if (coverageRunner != nullptr)
+    {
+        delete coverageRunner;
+        coverageRunner = nullptr;
+    }
+
+    if (complexityEstimator != nullptr)
+    {
+        delete complexityEstimator;
+        complexityEstimator = nullptr;
+    }
+
     killingProcesses = false;
 }
 
@@ -1033,6 +1626,7 @@ bool MainWindow::saveFile(SaveMode mode, const QString &head, bool safe)
 
     setFilePath(filePath); // make sure that the file path is the canonical file path and the file watcher is working
     emit fileSaved(this);
+    updatePerformanceHints();
     emit editorTextChanged(this); // make sure that the tab title is updated
 
     saveTests(safe);
@@ -1094,7 +1688,7 @@ void MainWindow::updateTimeLimit()
 {
     bool ok = false;
     const int limit = QInputDialog::getInt(this, tr("Set Time Limit"), tr("Custom time limit for this tab: (ms)"),
-                                           timeLimit(), 1, 3600000, 1000, &ok);
+                                           rawTimeLimit(), 1, 3600000, 1000, &ok);
     if (ok)
         customTimeLimit = limit;
 }
@@ -1267,7 +1861,7 @@ void MainWindow::updateChecker()
         checker = new Core::Checker(testcases->checkerText(), log, this);
     else
         checker = new Core::Checker(testcases->checkerType(), log, this);
-    connect(checker, &Core::Checker::checkFinished, testcases, &Widgets::TestCases::setVerdict);
+    connect(checker, &Core::Checker::checkFinished, this, &MainWindow::onCheckFinished);
     checker->prepare();
 }
 
@@ -1288,16 +1882,21 @@ QString MainWindow::compileCommand() const
     return customCompileCommand;
 }
 
-int MainWindow::timeLimit() const
+int MainWindow::rawTimeLimit() const
 {
     if (customTimeLimit == -1)
         return SettingsHelper::getDefaultTimeLimit();
     return customTimeLimit;
 }
 
+int MainWindow::timeLimit() const
+{
+    return Core::SpeedCalibration::scaledTimeLimit(rawTimeLimit());
+}
+
 void MainWindow::updateCompileAndRunButtons() const
 {
-    if (language == "Python")
+    if (language == "Python" && !SettingsHelper::isPythonPrecompile())
     {
         ui->runOnly->show();
         ui->compile->hide();
@@ -1357,7 +1956,7 @@ void MainWindow::onCompilationStarted()
 
 void MainWindow::onCompilationFinished(const QString &warning)
 {
-    if (language != "Python")
+    if (language != "Python" || SettingsHelper::isPythonPrecompile())
     {
         log->info(tr("Compiler"), tr("Compilation has finished"));
         if (!warning.trimmed().isEmpty())
@@ -1370,6 +1969,10 @@ void MainWindow::onCompilationFinished(const QString &warning)
     {
         run();
     }
+    else if (afterCompile == EstimateComplexity)
+    {
+        startComplexityEstimation();
+    }
     else if (afterCompile == RunDetached)
     {
         if (SettingsHelper::isSaveFileOnExecution())
@@ -1435,17 +2038,35 @@ void MainWindow::onRunStarted(int index)
 }
 
 void MainWindow::onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed,
-                               bool tle)
+                               qint64 cpuTimeUsed, bool tle, bool ile, bool crashed)
 {
     auto head = getRunnerHead(index);
 
-    if (exitCode == 0)
+    if (runRecords.contains(index))
+    {
+        runRecords[index].output = out;
+        runRecords[index].timeUsed = timeUsed;
+    }
+
+    auto timeText = cpuTimeUsed >= 0 ? tr("%1ms (CPU time: %2ms)").arg(timeUsed).arg(cpuTimeUsed)
+                                     : tr("%1ms").arg(timeUsed);
+    if (Core::SpeedCalibration::isCalibrated())
     {
-        log->info(head, tr("Execution for test case #%1 has finished in %2ms").arg(index + 1).arg(timeUsed));
+        const auto normalized = Core::SpeedCalibration::normalizedTime(timeUsed);
+        timeText += tr(", normalized to %1ms on the reference judge").arg(normalized);
+    }
 
-        if ((!out.isEmpty() && !testcases->expected(index).isEmpty()) ||
+    // with a CPU time limit, the program may exceed it a little before it exits normally
+    const bool accepted = exitCode == 0 && !crashed && !tle && !ile;
+
+    if (accepted)
+    {
+        log->info(head, tr("Execution for test case #%1 has finished in %2").arg(index + 1).arg(timeText));
+        recordRuntime(index, timeUsed);
+
+        if ((!out.isEmpty() && !testcases->expectedData(index).isEmpty()) ||
             (SettingsHelper::isCheckOnTestcasesWithEmptyOutput() && exitCode == 0))
-            checker->reqeustCheck(index, testcases->input(index), out, testcases->expected(index));
+            checker->reqeustCheck(index, testcases->inputData(index), out, testcases->expectedData(index));
     }
 
     else
@@ -1455,23 +2076,70 @@ void MainWindow::onRunFinished(int index, const QString &out, const QString &err
             log->warn(head, tr("Time Limit Exceeded"));
             testcases->setVerdict(index, Widgets::TestCase::TLE);
         }
+        else if (ile)
+        {
+            log->warn(head, tr("Idleness Limit Exceeded: the wall time limit is exceeded, but the CPU time limit is "
+                               "not. The program may be waiting for input or blocked."));
+            testcases->setVerdict(index, Widgets::TestCase::ILE);
+        }
         else
             testcases->setVerdict(index, Widgets::TestCase::RE);
 
-        log->error(head, tr("Execution for test case #%1 has finished with non-zero exitcode %2 in %3ms")
-                             .arg(index + 1)
-                             .arg(exitCode)
-                             .arg(timeUsed));
+        // the killed executions are also killed by signals, but they aren't crashes
+        if (crashed && !tle && !ile)
+        {
+            log->error(head, tr("Execution for test case #%1 has crashed with signal %2 in %3")
+                                 .arg(index + 1)
+                                 .arg(exitCode)
+                                 .arg(timeText));
+        }
+        else
+        {
+            log->error(head, tr("Execution for test case #%1 has finished with exitcode %2 in %3")
+                                 .arg(index + 1)
+                                 .arg(exitCode)
+                                 .arg(timeText));
+        }
     }
 
     if (!err.trimmed().isEmpty())
         log->error(head + tr("/stderr"), err);
     testcases->setOutput(index, out);
+    testcases->setTimeUsed(index, timeUsed);
+    clearRunUsage(index);
+
+    --runningCount;
+    if (!accepted)
+        stopRunsAfterUnaccepted(index);
+    startPendingRuns();
+}
+
+void MainWindow::onCheckFinished(int index, Widgets::TestCase::Verdict verdict)
+{
+    if (verdict == Widgets::TestCase::AC && runRecords.contains(index))
+    {
+        const auto &record = runRecords[index];
+        verdictCache->insert(record.cacheKey, record.output, record.timeUsed);
+    }
+    testcases->setVerdict(index, verdict);
+    if (verdict != Widgets::TestCase::AC)
+        stopRunsAfterUnaccepted(index);
+}
+
+void MainWindow::onRunCountersRead(int index, const Core::PerfCounters::Counters &counters)
+{
+    testcases->setPerfCounters(index, counters);
 }
 
 void MainWindow::onFailedToStartRun(int index, const QString &error)
 {
     log->error(getRunnerHead(index), error, false);
+    if (index != -1) // not the detached runner
+    {
+        clearRunUsage(index);
+        --runningCount;
+        startPendingRuns();
+    }
 }
 
 void MainWindow::onRunOutputLimitExceeded(int index, const QString &type)
@@ -1493,3 +2161,12 @@ void MainWindow::onRunKilled(int index)
                tr("%1 has been killed")
                    .arg(index == -1 ? tr("Detached runner") : tr("Runner for testcase #%1").arg(index + 1)));
 }
+
+void MainWindow::onRunUsageSampled(int index, int cpuUsage, qint64 memoryUsed)
+{
+    runUsages[index] = {cpuUsage, memoryUsed};
+    if (runRecords.contains(index))
+        runRecords[index].peakMemoryUsed = qMax(runRecords[index].peakMemoryUsed, memoryUsed);
+    testcases->setUsage(index, cpuUsage, memoryUsed);
+    updateResourceUsage();
+}
@@ -18,7 +18,15 @@
 #ifndef MAINWINDOW_HPP
 #define MAINWINDOW_HPP
 
+#include "Core/ComplexityEstimator.hpp"
+#include "Core/CoverageRunner.hpp"
+#include "Core/PerfCounters.hpp"
+#include "Core/PerformanceAdvisor.hpp"
+#include "Core/Profiler.hpp"
+#include "Core/RuntimeHistory.hpp"
+#include "Widgets/TestCase.hpp"
 #include <QMainWindow>
+#include <QMap>
 
 class AppWindow;
 class MessageLogger;
@@ -39,6 +47,7 @@ namespace Core
 class Checker;
 class Compiler;
 class Runner;
+class VerdictCache;
 } // namespace Core
 
 namespace Extensions
@@ -49,6 +58,7 @@ struct CompanionData;
 
 namespace Widgets
 {
+class HeatGutter;
 class TestCases;
 class Stopwatch;
 class ProblemDialog;
@@ -66,6 +76,7 @@ class MainWindow : public QMainWindow
         int editorCursor{}, editorAnchor{}, horizontalScrollBarValue{}, verticalScrollbarValue{}, untitledIndex{},
             checkerIndex{}, customTimeLimit{};
         QStringList input, expected, customCheckers;
+        QStringList inputFiles, expectedFiles; // the copies of the file-backed test cases, empty for the ones inline
         QVariantList testcasesIsShow; // This can't be renamed to "isChecked" because that's not compatible
         QVariantList testCaseSplitterStates;
 
@@ -93,7 +104,12 @@ class MainWindow : public QMainWindow
     void setProblemURL(const QString &url);
     void setUntitledIndex(int index);
 
-    EditorStatus toStatus() const;
+    /**
+     * @brief get the status of this tab
+     * @param inlineTests whether to put the file-backed test cases into the status instead of referring to the copies
+     *        kept for the session, see Core::SessionManager::testFilePath
+     */
+    EditorStatus toStatus(bool inlineTests = false) const;
     void loadStatus(const EditorStatus &status, bool duplicate = false);
 
     bool save(bool force, const QString &head, bool safe = true);
@@ -104,6 +120,14 @@ class MainWindow : public QMainWindow
 
     void killProcesses();
     void detachedExecution();
+    void estimateComplexity();
+    void calibrateTimeLimits();
+
+    /**
+     * @brief add the squiggles of the last Performance Advisor findings to the editor
+     * @note the existing squiggles are not cleared
+     */
+    void showPerformanceHints();
     void compileOnly();
     void runOnly();
     void compileAndRun();
@@ -147,10 +171,14 @@ class MainWindow : public QMainWindow
     void onCompilationKilled();
 
     void onRunStarted(int index);
-    void onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed, bool tle);
+    void onRunFinished(int index, const QString &out, const QString &err, int exitCode, qint64 timeUsed,
+                       qint64 cpuTimeUsed, bool tle, bool ile, bool crashed);
+    void onRunCountersRead(int index, const Core::PerfCounters::Counters &counters);
     void onFailedToStartRun(int index, const QString &error);
     void onRunOutputLimitExceeded(int index, const QString &type);
     void onRunKilled(int index);
+    void onRunUsageSampled(int index, int cpuUsage, qint64 memoryUsed);
+    void onCheckFinished(int index, Widgets::TestCase::Verdict verdict);
 
     void onFileWatcherChanged(const QString &);
     void onEditorFontChanged(const QFont &newFont);
@@ -158,6 +186,26 @@ class MainWindow : public QMainWindow
     void updateCursorInfo();
     void updateChecker();
     void runTestCase(int index);
+    void killTestCase(int index);
+
+    void profileTestCase(int index);
+    void onProfilingStarted(int index);
+    void onProfilingFinished(int index, const Core::Profiler::Result &result);
+    void onProfilingFailed(int index, const QString &error);
+
+    void showExecutionCounts(int index);
+    void onCoverageStarted(int index);
+    void onCoverageFinished(int index, const Core::CoverageRunner::Result &result);
+    void onCoverageFailed(int index, const QString &error);
+
+    void onComplexityMeasured(const Core::ComplexityEstimator::Measurement &measurement);
+    void onComplexityEstimated(const QVector<Core::ComplexityEstimator::Measurement> &measurements,
+                               qint64 exceededSize);
+    void onComplexityEstimationFailed(const QString &error);
+
+    void onTimeLimitsCalibrated(qint64 benchmarkTime, double speedFactor);
+
+    void onRuntimesRecorded(const QString &problem, const Core::RuntimeHistory::Histories &histories);
     // UI Slots
 
     void on_compile_clicked();
@@ -180,6 +228,7 @@ class MainWindow : public QMainWindow
     void editorLanguageChanged(MainWindow *window);
     void compileOrRunTriggered();
     void fileSaved(MainWindow *window);
+    void performanceHintsChanged(MainWindow *window);
 
   private:
     enum SaveMode
@@ -193,7 +242,24 @@ class MainWindow : public QMainWindow
     {
         Nothing,
         Run,
-        RunDetached
+        RunDetached,
+        EstimateComplexity
+    };
+
+    // the latest sampled resource usage of an execution
+    struct RunUsage
+    {
+        int cpuUsage = 0;      // the CPU usage in percent
+        qint64 memoryUsed = 0; // the resident set size in bytes
+    };
+
+    // the information of an execution on a test case, used to save accepted results in the verdict cache
+    struct RunRecord
+    {
+        QByteArray cacheKey;        // the key of the test case in verdictCache
+        QString output;             // the stdout of the execution
+        qint64 timeUsed = 0;        // the time used by the execution
+        qint64 peakMemoryUsed = -1; // the peak resident set size sampled during the execution, -1 if not sampled
     };
 
     Ui::MainWindow *ui;
@@ -205,6 +271,23 @@ class MainWindow : public QMainWindow
     QVector<Core::Runner *> runner;
     Core::Checker *checker = nullptr;
     Core::Runner *detachedRunner = nullptr;
+    Core::Profiler *profiler = nullptr;
+    Core::CoverageRunner *coverageRunner = nullptr;
+    Core::ComplexityEstimator *complexityEstimator = nullptr;
+    Core::VerdictCache *verdictCache = nullptr;
+    QByteArray executableHash; // the hash of the executable file being run, see Core::VerdictCache::executableHash
+    QMap<int, RunRecord> runRecords; // the records of the current executions, the keys are the test case indexes
+    QMap<int, RunUsage> runUsages;   // the resource usage of the running executions, the keys are the test case indexes
+    QVector<int> pendingRuns;        // the indexes of the test cases waiting for execution, in the execution order
+    int runningCount = 0;            // the number of test cases which are being executed
+
+    // the problem and the runtimes of the test cases which are not saved yet, see recordRuntime and saveRuntimes
+    QString runtimeProblem;
+    QVector<QPair<QByteArray, Core::RuntimeHistory::Sample>> runtimeSamples;
+
+    // the findings of the Performance Advisor when the code was last saved or compiled, see updatePerformanceHints
+    QVector<Core::PerformanceAdvisor::Finding> performanceFindings;
+
     QTemporaryDir *tmpDir = nullptr;
     AfterCompile afterCompile = Nothing;
 
@@ -226,6 +309,7 @@ class MainWindow : public QMainWindow
     Extensions::CFTool *cftool = nullptr;
 
     Widgets::TestCases *testcases = nullptr;
+    Widgets::HeatGutter *heatGutter = nullptr;
     Widgets::Stopwatch *stopwatch = nullptr;
     Widgets::ProblemDialog *problemDialog = nullptr;
 
@@ -238,6 +322,18 @@ class MainWindow : public QMainWindow
     void compile();
     void run();
     void run(int index);
+    void startPendingRuns();
+    void startComplexityEstimation();
+    void stopRunsAfterUnaccepted(int index);
+    void clearRunUsage(int index);
+    void clearRunUsages();
+    void updateResourceUsage();
+    void updateVerdictCache();
+    QByteArray verdictCacheKey(int index) const;
+    bool reuseAcceptedResult(int index);
+    void recordRuntime(int index, qint64 timeUsed);
+    void saveRuntimes();
+    void updatePerformanceHints();
     void loadTests();
     void saveTests(bool safe);
     void setCFToolUI();
@@ -249,6 +345,7 @@ class MainWindow : public QMainWindow
     void performCompileAndRunDiagonistics();
     static QString getRunnerHead(int index);
     QString compileCommand() const;
+    int rawTimeLimit() const;
     int timeLimit() const;
     void updateCompileAndRunButtons() const;
     void setStopwatch();
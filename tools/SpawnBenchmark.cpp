@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2019-2021 Ashar Khan <ashar786khan@gmail.com>
+ *
+ * This file is part of CP Editor.
+ *
+ * CP Editor is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * I will not be responsible if CP Editor behaves in unexpected way and
+ * causes your ratings to go down and or lose any important contest.
+ *
+ * Believe Software is "Software" and it isn't immune to bugs.
+ *
+ */
+
+/*
+ * The benchmark of the overhead from starting a process to receiving its exit,
+ * comparing QProcess (the way Core::Runner uses it) and Core::NativeLauncher.
+ * Build it with -DBUILD_SPAWN_BENCHMARK=On and run:
+ *     spawn-benchmark [program] [count]
+ * The program (/bin/true by default) is executed <count> (500 by default) times one by one with each method.
+ */
+
+#include "Core/NativeLauncher.hpp"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QProcess>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const auto args = QCoreApplication::arguments();
+    const QString program = args.size() > 1 ? args[1] : "/bin/true";
+    const int count = args.size() > 2 ? args[2].toInt() : 500;
+
+    QTextStream out(stdout);
+    QTemporaryFile input;
+    if (count <= 0 || !input.open())
+    {
+        out << "Usage: spawn-benchmark [program] [count]" << Qt::endl;
+        return 1;
+    }
+
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int i = 0; i < count; ++i)
+    {
+        QProcess process;
+        process.setStandardInputFile(input.fileName());
+        QEventLoop loop;
+        QObject::connect(&process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), &loop,
+                         &QEventLoop::quit);
+        QObject::connect(&process, &QProcess::errorOccurred, &loop, &QEventLoop::quit);
+        process.start(program, QStringList());
+        loop.exec();
+    }
+    const double qprocessTime = timer.nsecsElapsed() / 1e3 / count;
+    out << "QProcess:        " << qprocessTime << " us per process" << Qt::endl;
+
+    if (!Core::NativeLauncher::isSupported())
+    {
+        out << "NativeLauncher:  not supported on this system" << Qt::endl;
+        return 0;
+    }
+
+    auto *launcher = Core::NativeLauncher::instance();
+    Core::NativeLauncher::Request request;
+    request.program = program;
+    request.inputPath = input.fileName();
+    request.timeLimit = 10000;
+    request.outputLimit = 1 << 20;
+
+    timer.restart();
+    for (int i = 0; i < count; ++i)
+    {
+        QEventLoop loop;
+        auto *launch = launcher->launch(request);
+        QObject::connect(launch, &Core::NativeLaunch::finished, &loop, &QEventLoop::quit);
+        QObject::connect(launch, &Core::NativeLaunch::failedToLaunch, &loop, &QEventLoop::quit);
+        loop.exec();
+        delete launch;
+    }
+    const double nativeTime = timer.nsecsElapsed() / 1e3 / count;
+    out << "NativeLauncher:  " << nativeTime << " us per process" << Qt::endl;
+    out << "Speedup:         " << qprocessTime / nativeTime << "x" << Qt::endl;
+
+    return 0;
+}